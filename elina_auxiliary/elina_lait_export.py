@@ -0,0 +1,149 @@
+#
+#
+#  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+#  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+#  This software is distributed under GNU Lesser General Public License Version 3.0.
+#  For more information, see the ELINA project website at:
+#  http://elina.ethz.ch
+#
+#  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+#  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+#  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+#  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+#  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+#  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+#  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+#  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+#  CONTRACT, TORT OR OTHERWISE).
+#
+#
+
+# Export a trained Lait network (opt_oct_lait.pt, opt_pk_lait.pt) to the flat
+# binary format read by elina_lait_gcn.c, so that the transformers can run
+# without Python:
+#
+#   python3 elina_lait_export.py ../elina_poly/opt_pk_lait.pt ../elina_poly/opt_pk_lait.bin
+#
+# Files in the legacy torch serialisation (all shipped models) are read
+# directly and need neither torch nor sklearn; newer zip-based checkpoints
+# are loaded through torch.
+#
+# Layout, little endian:
+#   "LAIT", u32 version, u32 input_dim, u32 hidden_dim, u32 output_dim,
+#   u32 number of graph convolutions, u32 number of linear layers,
+#   f64 scaler mean[input_dim], f64 scaler scale[input_dim],
+#   per graph convolution: f32 weight[in][out], f32 bias[out],
+#   per linear layer:      f32 weight[out][in], f32 bias[out]
+
+import sys
+import struct
+import pickle
+import zipfile
+import collections
+
+
+class _Opaque:
+    def __init__(self, *args, **kwargs):
+        self.args = args
+        self.state = None
+
+    def __setstate__(self, state):
+        self.state = state
+
+
+class _NdArray:
+    def __setstate__(self, state):
+        self.shape, self.dtype, self.raw = state[1], state[2], state[4]
+
+    def values(self):
+        return list(struct.unpack('<%dd' % self.shape[0], self.raw))
+
+
+class _Storage:
+    def __init__(self, key):
+        self.key = key
+        self.data = None
+
+
+def _rebuild_tensor(storage, offset, size, stride, *args):
+    return (storage, offset, tuple(size))
+
+
+class _LegacyUnpickler(pickle.Unpickler):
+    def __init__(self, f, storages):
+        super().__init__(f, encoding='latin1')
+        self.storages = storages
+
+    def find_class(self, module, name):
+        if name == '_rebuild_tensor_v2':
+            return _rebuild_tensor
+        if module == 'collections' and name == 'OrderedDict':
+            return collections.OrderedDict
+        if module == '_codecs' and name == 'encode':
+            return lambda s, enc='latin1': s.encode(enc)
+        if module.startswith('numpy') and name == '_reconstruct':
+            return lambda *args: _NdArray()
+        return type(name, (_Opaque,), {'__module__': module})
+
+    def persistent_load(self, pid):
+        key = pid[2]
+        if key not in self.storages:
+            self.storages[key] = _Storage(key)
+        return self.storages[key]
+
+
+def load_legacy(path):
+    storages = {}
+    with open(path, 'rb') as f:
+        for _ in range(3):  # magic number, protocol version, system info
+            pickle.load(f)
+        checkpoint = _LegacyUnpickler(f, storages).load()
+        for key in pickle.load(f):
+            numel = struct.unpack('<q', f.read(8))[0]
+            storages[key].data = f.read(4 * numel)
+
+    def tensor(t):
+        storage, offset, size = t
+        numel = 1
+        for s in size:
+            numel *= s
+        return list(struct.unpack('<%df' % numel, storage.data[4 * offset:4 * (offset + numel)]))
+
+    state = {k: tensor(v) for k, v in checkpoint['state_dict'].items()}
+    scaler = checkpoint['scaler'].state
+    return state, scaler['mean_'].values(), scaler['scale_'].values()
+
+
+def load_torch(path):
+    import torch
+    checkpoint = torch.load(path, map_location='cpu')
+    state = {k: v.flatten().tolist() for k, v in checkpoint['state_dict'].items()}
+    scaler = checkpoint['scaler']
+    return state, list(scaler.mean_), list(scaler.scale_)
+
+
+def export(src, dst):
+    state, mean, scale = load_torch(src) if zipfile.is_zipfile(src) else load_legacy(src)
+
+    gc = sorted(k[:-len('.weight')] for k in state if k.startswith('gc') and k.endswith('.weight'))
+    fc = sorted((k[:-len('.weight')] for k in state if k.startswith('action_net.') and k.endswith('.weight')),
+                key=lambda k: int(k.split('.')[1]))
+    input_dim = len(mean)
+    hidden_dim = len(state[gc[0] + '.bias'])
+    output_dim = len(state[fc[-1] + '.bias'])
+
+    with open(dst, 'wb') as f:
+        f.write(b'LAIT')
+        f.write(struct.pack('<6I', 1, input_dim, hidden_dim, output_dim, len(gc), len(fc)))
+        f.write(struct.pack('<%dd' % input_dim, *mean))
+        f.write(struct.pack('<%dd' % input_dim, *scale))
+        for layer in gc + fc:
+            for suffix in ('.weight', '.bias'):
+                values = state[layer + suffix]
+                f.write(struct.pack('<%df' % len(values), *values))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: elina_lait_export.py model.pt model.bin')
+    export(sys.argv[1], sys.argv[2])
@@ -0,0 +1,255 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ********************************************************************** */
+/* elina_lait_gcn.c: native inference for the Lait graph network */
+/* ********************************************************************** */
+
+#include <stdint.h>
+#include <string.h>
+#include "elina_lait_gcn.h"
+
+/* ====================================================================== */
+/* Loading */
+/* ====================================================================== */
+
+static bool elina_lait_read_layer(FILE* f, elina_lait_layer_t* layer,
+				  size_t nbin, size_t nbout)
+{
+  layer->nbin = nbin;
+  layer->nbout = nbout;
+  layer->weight = (float*)malloc(nbin*nbout*sizeof(float));
+  layer->bias = (float*)malloc(nbout*sizeof(float));
+  return fread(layer->weight,sizeof(float),nbin*nbout,f)==nbin*nbout &&
+	 fread(layer->bias,sizeof(float),nbout,f)==nbout;
+}
+
+elina_lait_gcn_t* elina_lait_gcn_load(const char* path)
+{
+  FILE* f = fopen(path,"rb");
+  if (f==NULL){
+    fprintf(stderr,"elina_lait_gcn_load: cannot open %s\n",path);
+    return NULL;
+  }
+  char magic[4];
+  uint32_t header[6];
+  if (fread(magic,1,4,f)!=4 || memcmp(magic,ELINA_LAIT_GCN_MAGIC,4) ||
+      fread(header,sizeof(uint32_t),6,f)!=6 ||
+      header[0]!=ELINA_LAIT_GCN_VERSION || header[4]==0 || header[5]==0){
+    fprintf(stderr,"elina_lait_gcn_load: %s is not an exported Lait network"
+	    " (convert the .pt file with elina_lait_export.py)\n",path);
+    fclose(f);
+    return NULL;
+  }
+  elina_lait_gcn_t* gcn = (elina_lait_gcn_t*)calloc(1,sizeof(elina_lait_gcn_t));
+  gcn->input_dim = header[1];
+  gcn->hidden_dim = header[2];
+  gcn->output_dim = header[3];
+  gcn->nbgc = header[4];
+  gcn->nbfc = header[5];
+  gcn->mean = (double*)malloc(gcn->input_dim*sizeof(double));
+  gcn->scale = (double*)malloc(gcn->input_dim*sizeof(double));
+  gcn->gc = (elina_lait_layer_t*)calloc(gcn->nbgc,sizeof(elina_lait_layer_t));
+  gcn->fc = (elina_lait_layer_t*)calloc(gcn->nbfc,sizeof(elina_lait_layer_t));
+  bool ok = fread(gcn->mean,sizeof(double),gcn->input_dim,f)==gcn->input_dim &&
+	    fread(gcn->scale,sizeof(double),gcn->input_dim,f)==gcn->input_dim;
+  size_t i;
+  for (i=0; ok && i<gcn->nbgc; i++){
+    ok = elina_lait_read_layer(f,&gcn->gc[i],
+			       i==0 ? gcn->input_dim : gcn->hidden_dim,
+			       gcn->hidden_dim);
+  }
+  for (i=0; ok && i<gcn->nbfc; i++){
+    ok = elina_lait_read_layer(f,&gcn->fc[i],gcn->hidden_dim,
+			       i==gcn->nbfc-1 ? gcn->output_dim : gcn->hidden_dim);
+  }
+  fclose(f);
+  if (!ok){
+    fprintf(stderr,"elina_lait_gcn_load: %s is truncated\n",path);
+    elina_lait_gcn_free(gcn);
+    return NULL;
+  }
+  return gcn;
+}
+
+void elina_lait_gcn_free(elina_lait_gcn_t* gcn)
+{
+  size_t i;
+  if (gcn==NULL) return;
+  for (i=0; i<gcn->nbgc; i++){
+    free(gcn->gc[i].weight);
+    free(gcn->gc[i].bias);
+  }
+  for (i=0; i<gcn->nbfc; i++){
+    free(gcn->fc[i].weight);
+    free(gcn->fc[i].bias);
+  }
+  free(gcn->gc);
+  free(gcn->fc);
+  free(gcn->mean);
+  free(gcn->scale);
+  free(gcn);
+}
+
+/* ====================================================================== */
+/* Inference */
+/* ====================================================================== */
+
+/* dst (n x nbout) = src (n x nbin) * weight (nbin x nbout) */
+static void elina_lait_gc_support(float* dst, const float* src, size_t n,
+				  const elina_lait_layer_t* layer)
+{
+  size_t i,k,j;
+  size_t nbin = layer->nbin, nbout = layer->nbout;
+  memset(dst,0,n*nbout*sizeof(float));
+  for (i=0; i<n; i++){
+    float* d = dst + i*nbout;
+    for (k=0; k<nbin; k++){
+      float s = src[i*nbin+k];
+      const float* w;
+      if (s==0) continue;
+      w = layer->weight + k*nbout;
+      for (j=0; j<nbout; j++){
+	d[j] += s*w[j];
+      }
+    }
+  }
+}
+
+/* dst = relu(adj * support + bias), adj in compressed row form */
+static void elina_lait_gc_propagate(float* dst, const float* support, size_t n,
+				    const size_t* rowptr, const int* col,
+				    const float* val,
+				    const elina_lait_layer_t* layer)
+{
+  size_t i,e,j;
+  size_t nbout = layer->nbout;
+  for (i=0; i<n; i++){
+    float* d = dst + i*nbout;
+    memset(d,0,nbout*sizeof(float));
+    for (e=rowptr[i]; e<rowptr[i+1]; e++){
+      const float* s = support + (size_t)col[e]*nbout;
+      float w = val[e];
+      for (j=0; j<nbout; j++){
+	d[j] += w*s[j];
+      }
+    }
+    for (j=0; j<nbout; j++){
+      d[j] += layer->bias[j];
+      if (d[j] < 0) d[j] = 0;
+    }
+  }
+}
+
+/* dst (n x nbout) = src (n x nbin) * weight^T + bias, optionally rectified */
+static void elina_lait_fc(float* dst, const float* src, size_t n,
+			  const elina_lait_layer_t* layer, bool relu)
+{
+  size_t i,j,k;
+  size_t nbin = layer->nbin, nbout = layer->nbout;
+  for (i=0; i<n; i++){
+    const float* s = src + i*nbin;
+    for (j=0; j<nbout; j++){
+      const float* w = layer->weight + j*nbin;
+      float acc = 0;
+      for (k=0; k<nbin; k++){
+	acc += s[k]*w[k];
+      }
+      acc += layer->bias[j];
+      dst[i*nbout+j] = relu && acc < 0 ? 0 : acc;
+    }
+  }
+}
+
+void elina_lait_gcn_scores(const elina_lait_gcn_t* gcn,
+			   size_t nbnodes, const int* features,
+			   size_t nbedges, const int* edges,
+			   float* scores)
+{
+  size_t i,j,e;
+  size_t in = gcn->input_dim, hid = gcn->hidden_dim, out = gcn->output_dim;
+  if (nbnodes==0) return;
+
+  /* adjacency in compressed row form */
+  size_t* rowptr = (size_t*)calloc(nbnodes+1,sizeof(size_t));
+  int* col = (int*)malloc((nbedges ? nbedges : 1)*sizeof(int));
+  float* val = (float*)malloc((nbedges ? nbedges : 1)*sizeof(float));
+  for (e=0; e<nbedges; e++){
+    rowptr[edges[3*e]+1]++;
+  }
+  for (i=0; i<nbnodes; i++){
+    rowptr[i+1] += rowptr[i];
+  }
+  size_t* fill = (size_t*)malloc(nbnodes*sizeof(size_t));
+  memcpy(fill,rowptr,nbnodes*sizeof(size_t));
+  for (e=0; e<nbedges; e++){
+    size_t pos = fill[edges[3*e]]++;
+    col[pos] = edges[3*e+1];
+    val[pos] = (float)edges[3*e+2];
+  }
+  free(fill);
+
+  size_t width = in > hid ? in : hid;
+  float* x = (float*)malloc(nbnodes*width*sizeof(float));
+  float* tmp = (float*)malloc(nbnodes*width*sizeof(float));
+  for (i=0; i<nbnodes; i++){
+    for (j=0; j<in; j++){
+      x[i*in+j] = (float)(((double)features[i*in+j] - gcn->mean[j])/gcn->scale[j]);
+    }
+  }
+  for (i=0; i<gcn->nbgc; i++){
+    elina_lait_gc_support(tmp,x,nbnodes,&gcn->gc[i]);
+    elina_lait_gc_propagate(x,tmp,nbnodes,rowptr,col,val,&gcn->gc[i]);
+  }
+  for (i=0; i<gcn->nbfc; i++){
+    float* t;
+    elina_lait_fc(tmp,x,nbnodes,&gcn->fc[i],i+1<gcn->nbfc);
+    t = x; x = tmp; tmp = t;
+  }
+  memcpy(scores,x,nbnodes*out*sizeof(float));
+  free(x);
+  free(tmp);
+  free(rowptr);
+  free(col);
+  free(val);
+}
+
+void elina_lait_gcn_predict(const elina_lait_gcn_t* gcn,
+			    size_t nbnodes, const int* features,
+			    size_t nbedges, const int* edges,
+			    int* res)
+{
+  size_t i,j;
+  size_t out = gcn->output_dim;
+  if (nbnodes==0) return;
+  float* scores = (float*)malloc(nbnodes*out*sizeof(float));
+  elina_lait_gcn_scores(gcn,nbnodes,features,nbedges,edges,scores);
+  /* argmax over the output scores, first index on ties as torch.max */
+  for (i=0; i<nbnodes; i++){
+    const float* s = scores + i*out;
+    size_t best = 0;
+    for (j=1; j<out; j++){
+      if (s[j] > s[best]) best = j;
+    }
+    res[i] = (int)best;
+  }
+  free(scores);
+}
@@ -0,0 +1,93 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ********************************************************************** */
+/* elina_lait_gcn.h: native inference for the Lait graph network */
+/* ********************************************************************** */
+
+/* The Lait transformers of the Octagon and Polyhedra domains decide which
+   constraints of a join to drop with a graph convolutional network.  This
+   module evaluates the trained network without Python: the weights are read
+   from the flat file written by elina_lait_export.py, and the message passing
+   is done with a sparse adjacency times dense feature products. */
+
+#ifndef _ELINA_LAIT_GCN_H_
+#define _ELINA_LAIT_GCN_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "elina_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ELINA_LAIT_GCN_MAGIC "LAIT"
+#define ELINA_LAIT_GCN_VERSION 1
+
+/* One dense layer, y = x*weight + bias.  Graph convolutions store weight as
+   nbin x nbout (the torch layout of GraphConvolution), linear layers as
+   nbout x nbin (the torch layout of nn.Linear). */
+typedef struct elina_lait_layer_t {
+  size_t nbin;
+  size_t nbout;
+  float* weight;
+  float* bias;
+} elina_lait_layer_t;
+
+typedef struct elina_lait_gcn_t {
+  size_t input_dim;
+  size_t hidden_dim;
+  size_t output_dim;
+  double* mean;		/* feature standardisation (StandardScaler) */
+  double* scale;
+  size_t nbgc;		/* graph convolutions, each followed by a ReLU */
+  elina_lait_layer_t* gc;
+  size_t nbfc;		/* fully connected head, ReLU between layers */
+  elina_lait_layer_t* fc;
+} elina_lait_gcn_t;
+
+/* Read a network exported by elina_lait_export.py.  Returns NULL, after a
+   message on stderr, if the file cannot be read or has the wrong format. */
+elina_lait_gcn_t* elina_lait_gcn_load(const char* path);
+void elina_lait_gcn_free(elina_lait_gcn_t* gcn);
+
+/* Output scores of the network, scores[i*output_dim+j] for class j of node i,
+   before the argmax of elina_lait_gcn_predict.  Same arguments otherwise. */
+void elina_lait_gcn_scores(const elina_lait_gcn_t* gcn,
+			   size_t nbnodes, const int* features,
+			   size_t nbedges, const int* edges,
+			   float* scores);
+
+/* Classify the nbnodes nodes of a constraint graph.
+   features: nbnodes x input_dim integer features, row-major
+   edges: nbedges triples (src,dst,weight); parallel edges add up
+   res: on return res[i] is 1 if node i should be dropped, 0 otherwise */
+void elina_lait_gcn_predict(const elina_lait_gcn_t* gcn,
+			    size_t nbnodes, const int* features,
+			    size_t nbedges, const int* edges,
+			    int* res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+#
+#
+#  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+#  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+#  This software is distributed under GNU Lesser General Public License Version 3.0.
+#  For more information, see the ELINA project website at:
+#  http://elina.ethz.ch
+#
+#  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+#  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+#  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+#  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+#  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+#  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+#  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+#  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+#  CONTRACT, TORT OR OTHERWISE).
+#
+#
+
+# Reference scores of a trained Lait network on a few fixed constraint graphs,
+# checked by elina_test_lait_gcn against the native forward pass:
+#
+#   python3 elina_lait_reference.py ../elina_oct/opt_oct_lait.pt ../elina_oct/opt_oct_lait.ref
+#
+# The scores come from PolicyGCN (opt_oct_lait_model.py, next to the .pt file)
+# when torch is installed.  Otherwise PolicyGCN.forward is replayed with numpy
+# on the parameters of the .pt file, in the same float32 arithmetic; the first
+# line of the output records which of the two produced it.
+#
+# Layout, text:
+#   "# backend", graph count, then per graph:
+#   nbnodes nbedges, nbnodes rows of input_dim integer features,
+#   nbedges rows "src dst weight", nbnodes rows of output_dim scores
+
+import os
+import sys
+import random
+import zipfile
+
+from elina_lait_export import load_legacy, load_torch
+
+
+# (nodes, variables, seed) of the fixed graphs
+GRAPHS = [(1, 2, 1), (7, 4, 2), (20, 9, 3), (64, 24, 4), (150, 40, 5)]
+
+
+def make_graph(mean, scale, nbnodes, nbvars, seed):
+    """A constraint graph shaped like the ones opt_oct_lait builds: every node
+    is a constraint over two variables and nodes sharing a variable are joined
+    by unit edges, self loops included.  Features are drawn around the
+    statistics of the training set."""
+    rng = random.Random(seed)
+    cons = [rng.sample(range(nbvars), min(2, nbvars)) for _ in range(nbnodes)]
+    var_to_cons = [[i for i, c in enumerate(cons) if v in c] for v in range(nbvars)]
+    edges = [[a, b, 1] for nodes in var_to_cons for a in nodes for b in nodes]
+    features = []
+    for _ in range(nbnodes):
+        row = [max(0, int(round(rng.gauss(m, s)))) for m, s in zip(mean, scale)]
+        row[2] = nbnodes
+        features.append(row)
+    return features, edges
+
+
+def scores_torch(pt, graphs):
+    import torch
+    sys.path.insert(0, os.path.dirname(os.path.abspath(pt)))
+    name = os.path.basename(pt)[:-len('.pt')] + '_model'
+    model = __import__(name).PolicyGCN.load(pt)
+    model.eval()
+    with torch.no_grad():
+        return ['torch ' + torch.__version__,
+                [model(x, edges).tolist() for x, edges in graphs]]
+
+
+def scores_numpy(pt, graphs):
+    import numpy as np
+    state, mean, scale = load_torch(pt) if zipfile.is_zipfile(pt) else load_legacy(pt)
+    mean, scale = np.array(mean), np.array(scale)
+    hid = len(state['gc1.bias'])
+
+    def param(key, shape):
+        return np.array(state[key], dtype=np.float32).reshape(shape)
+
+    gc = [(param(k + '.weight', (-1, hid)), param(k + '.bias', (hid,)))
+          for k in ('gc1', 'gc2', 'gc3')]
+    fc = sorted(k[:-len('.weight')] for k in state if k.startswith('action_net.') and k.endswith('.weight'))
+    fc = sorted(fc, key=lambda k: int(k.split('.')[1]))
+    fc = [(np.array(state[k + '.weight'], dtype=np.float32).reshape(len(state[k + '.bias']), -1),
+           param(k + '.bias', (-1,))) for k in fc]
+
+    res = []
+    for x, edges in graphs:
+        n = len(x)
+        # StandardScaler.transform in float64, then torch.FloatTensor
+        x = ((np.array(x, dtype=np.float64) - mean) / scale).astype(np.float32)
+        # torch.sparse adds up duplicate entries
+        adj = np.zeros((n, n), dtype=np.float32)
+        for a, b, w in edges:
+            adj[a, b] += w
+        for w, b in gc:
+            x = np.maximum(adj @ (x @ w) + b, 0)
+        for i, (w, b) in enumerate(fc):
+            x = x @ w.T + b
+            if i + 1 < len(fc):
+                x = np.maximum(x, 0)
+        res.append(x.tolist())
+    return ['numpy ' + np.__version__ + ' replay of PolicyGCN.forward', res]
+
+
+def reference(pt, dst):
+    state, mean, scale = load_torch(pt) if zipfile.is_zipfile(pt) else load_legacy(pt)
+    graphs = [make_graph(mean, scale, *g) for g in GRAPHS]
+    try:
+        import torch  # noqa: F401
+        backend, scores = scores_torch(pt, graphs)
+    except ImportError:
+        backend, scores = scores_numpy(pt, graphs)
+
+    with open(dst, 'w') as f:
+        f.write('# %s, %s\n' % (os.path.basename(pt), backend))
+        f.write('%d\n' % len(graphs))
+        for (x, edges), s in zip(graphs, scores):
+            f.write('%d %d\n' % (len(x), len(edges)))
+            for row in x:
+                f.write(' '.join(str(v) for v in row) + '\n')
+            for e in edges:
+                f.write('%d %d %d\n' % tuple(e))
+            for row in s:
+                f.write(' '.join('%.9g' % v for v in row) + '\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: elina_lait_reference.py model.pt model.ref')
+    reference(sys.argv[1], sys.argv[2])
@@ -0,0 +1,128 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Compare the native Lait forward pass with the reference scores written by
+   elina_lait_reference.py:
+
+     ./elina_test_lait_gcn ../elina_oct/opt_oct_lait.bin ../elina_oct/opt_oct_lait.ref
+
+   Every score must agree within ATOL + RTOL*|reference|, and the predicted
+   class must agree on every node whose two scores are further apart than
+   that. */
+
+#include <math.h>
+#include <string.h>
+#include "elina_lait_gcn.h"
+
+#define ATOL 1e-4
+#define RTOL 1e-4
+
+static bool read_ints(FILE* f, int* dst, size_t n)
+{
+  size_t i;
+  for (i=0; i<n; i++){
+    if (fscanf(f,"%d",dst+i)!=1) return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc!=3){
+    fprintf(stderr,"usage: %s model.bin model.ref\n",argv[0]);
+    return 2;
+  }
+  elina_lait_gcn_t* gcn = elina_lait_gcn_load(argv[1]);
+  FILE* f = fopen(argv[2],"r");
+  if (gcn==NULL || f==NULL){
+    fprintf(stderr,"cannot read %s\n",gcn==NULL ? argv[1] : argv[2]);
+    return 2;
+  }
+  char line[256];
+  size_t nbgraphs;
+  if (fgets(line,sizeof(line),f)==NULL || fscanf(f,"%zu",&nbgraphs)!=1){
+    fprintf(stderr,"%s: bad header\n",argv[2]);
+    return 2;
+  }
+  printf("%s: %s",argv[2],line+2);
+
+  size_t in = gcn->input_dim, out = gcn->output_dim;
+  size_t g, i, j, nbfail = 0, nbscores = 0;
+  double maxerr = 0;
+  for (g=0; g<nbgraphs; g++){
+    size_t nbnodes, nbedges;
+    if (fscanf(f,"%zu %zu",&nbnodes,&nbedges)!=2){
+      fprintf(stderr,"%s: truncated at graph %zu\n",argv[2],g);
+      return 2;
+    }
+    int* features = (int*)malloc(nbnodes*in*sizeof(int));
+    int* edges = (int*)malloc(3*(nbedges ? nbedges : 1)*sizeof(int));
+    float* scores = (float*)malloc(nbnodes*out*sizeof(float));
+    int* res = (int*)malloc(nbnodes*sizeof(int));
+    double* ref = (double*)malloc(nbnodes*out*sizeof(double));
+    if (!read_ints(f,features,nbnodes*in) || !read_ints(f,edges,3*nbedges)){
+      fprintf(stderr,"%s: truncated at graph %zu\n",argv[2],g);
+      return 2;
+    }
+    for (i=0; i<nbnodes*out; i++){
+      if (fscanf(f,"%lf",ref+i)!=1){
+	fprintf(stderr,"%s: truncated at graph %zu\n",argv[2],g);
+	return 2;
+      }
+    }
+    elina_lait_gcn_scores(gcn,nbnodes,features,nbedges,edges,scores);
+    elina_lait_gcn_predict(gcn,nbnodes,features,nbedges,edges,res);
+    for (i=0; i<nbnodes; i++){
+      const double* r = ref + i*out;
+      size_t best = 0, second;
+      for (j=0; j<out; j++){
+	double err = fabs(scores[i*out+j] - r[j]);
+	if (err > maxerr) maxerr = err;
+	if (err > ATOL + RTOL*fabs(r[j])){
+	  printf("graph %zu node %zu class %zu: %.9g, reference %.9g\n",
+		 g,i,j,scores[i*out+j],r[j]);
+	  nbfail++;
+	}
+	if (r[j] > r[best]) best = j;
+      }
+      nbscores += out;
+      /* the reference class, unless the reference itself is a near tie */
+      second = best==0 ? 1 : 0;
+      for (j=0; j<out; j++){
+	if (j!=best && r[j] > r[second]) second = j;
+      }
+      if (out > 1 && (size_t)res[i]!=best &&
+	  r[best] - r[second] > 2*(ATOL + RTOL*fabs(r[best]))){
+	printf("graph %zu node %zu: class %d, reference %zu\n",g,i,res[i],best);
+	nbfail++;
+      }
+    }
+    free(features);
+    free(edges);
+    free(scores);
+    free(res);
+    free(ref);
+  }
+  fclose(f);
+  elina_lait_gcn_free(gcn);
+  printf("%zu graphs, %zu scores, max abs error %.3g: %s\n",
+	 nbgraphs,nbscores,maxerr,nbfail ? "FAILED" : "ok");
+  return nbfail ? 1 : 0;
+}
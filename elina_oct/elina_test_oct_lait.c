@@ -22,6 +22,7 @@
 #include "opt_oct_internal.h"
 #include "opt_oct_hmat.h"
 #include "opt_oct_lait.h"
+#include <time.h>
 
 int mat_head[6][7] = {
     {1, 1, 0, 0, 1},
@@ -114,7 +115,10 @@ int main(int argc, char** argv) {
     elina_manager_t * man = opt_oct_manager_alloc();
 
     // call opt_oct_lait_init at the start of the analysis to initialize Lait
-    opt_oct_lait_init("/home/hej/ELINA/elina_oct", "/home/hej/ELINA/elina_oct/opt_oct_lait.pt");
+    // the model is opt_oct_lait.bin, exported from opt_oct_lait.pt with
+    // elina_auxiliary/elina_lait_export.py (a build with LAIT_PYTHON=1 takes
+    // the directory of opt_oct_lait.py and the .pt file instead)
+    opt_oct_lait_init(".", argc > 1 ? argv[1] : "opt_oct_lait.bin");
 
     // the first join input
     opt_oct_t* oa = generate_oct(man, mat_oa, 18, 56);
@@ -146,5 +150,24 @@ int main(int argc, char** argv) {
     elina_lincons0_array_fprint(stdout, &arr_lait, NULL);
     elina_lincons0_array_clear(&arr_lait);
 
+    // latency of the join and of Lait on its output
+    int runs = 100;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i=0; i<runs; i++) {
+        opt_oct_t* tmp = opt_oct_join(man, false, oa, ob);
+        opt_oct_free(man, tmp);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double join_us = ((end.tv_sec - start.tv_sec)*1e6 + (end.tv_nsec - start.tv_nsec)/1e3)/runs;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i=0; i<runs; i++) {
+        opt_oct_t* tmp = opt_oct_lait(man, false, oa, ob, res, head, 0);
+        opt_oct_free(man, tmp);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double lait_us = ((end.tv_sec - start.tv_sec)*1e6 + (end.tv_nsec - start.tv_nsec)/1e3)/runs;
+    printf("join: %.1f us, lait: %.1f us per join\n", join_us, lait_us);
+
     return 0;
 }
\ No newline at end of file
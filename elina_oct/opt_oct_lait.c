@@ -20,8 +20,18 @@
 
 #include "opt_oct_hmat.h"
 #include "opt_oct_lait.h"
+#if defined(LAIT_PYTHON)
 #include "python3.6/Python.h"
 
+/* the lait function of opt_oct_lait.py, imported once by opt_oct_lait_init */
+static PyObject* opt_oct_lait_func = NULL;
+#else
+#include "elina_lait_gcn.h"
+
+/* the network loaded by opt_oct_lait_init */
+static elina_lait_gcn_t* opt_oct_lait_gcn = NULL;
+#endif
+
 void compute_partition(opt_oct_mat_t* oo, int dim, int *num_comp, int *num_cons_arg, int **map, int **cm, int **cons_count, int **var_count, int **var_cons) {
   *map = (int*)malloc(dim * sizeof(int));
   memset(*map, 0, dim * sizeof(int));
@@ -128,6 +138,7 @@ array_comp_list_t * compute_finest(opt_oct_mat_t * oo, unsigned short int dim){
 	return res;
 }
 
+#if defined(LAIT_PYTHON)
 // python_path: the path contatining the python file opt_oct_lait.py
 // model_path: the path to opt_oct_lait_model.pt
 void opt_oct_lait_init(char* python_path, char* model_path) {
@@ -152,8 +163,18 @@ void opt_oct_lait_init(char* python_path, char* model_path) {
 	PyObject* pArgs = PyTuple_New(1);
 	PyTuple_SetItem(pArgs, 0, PyBytes_FromString(model_path));
 	PyObject* res = PyObject_CallObject(pFunc, pArgs);
+	opt_oct_lait_func = PyObject_GetAttrString(pModule, "lait");
 	PyGILState_Release(gstate);
 }
+#else
+// python_path: unused, kept for compatibility with the Python build
+// model_path: the path to opt_oct_lait.bin, exported from opt_oct_lait.pt
+//             by elina_auxiliary/elina_lait_export.py
+void opt_oct_lait_init(char* python_path, char* model_path) {
+	elina_lait_gcn_free(opt_oct_lait_gcn);
+	opt_oct_lait_gcn = elina_lait_gcn_load(model_path);
+}
+#endif
 
 // oa: the first join input
 // ob: the second join input
@@ -183,19 +204,6 @@ opt_oct_t* opt_oct_lait(elina_manager_t* man, bool destructive, opt_oct_t* o1, o
     int num_cons2, num_comp2;
     compute_partition(oo2, dim, &num_comp2, &num_cons2, &map2, &cm2, &cons_count2, &var_count2, &var_cons2);
 
-    PyGILState_STATE gstate = PyGILState_Ensure();
-
-    PyObject* pName = PyUnicode_DecodeFSDefault("opt_oct_lait");
-    PyObject* pModule = PyImport_Import(pName);
-    PyObject* pFunc = PyObject_GetAttrString(pModule, "lait");
-	PyObject* pArgs = PyTuple_New(3);
-
-    PyObject* pBlockLens = PyList_New(0);
-    for (int i=0; i<num_comp; i++) {
-        PyList_Append(pBlockLens, PyLong_FromLong(cons_count[i+1]));
-    }
-    PyTuple_SetItem(pArgs, 0, pBlockLens);
-
     int num_cons_predict = 0;
     int cons_dim[num_cons][2];
     if (!oo_res->is_dense) {
@@ -282,16 +290,6 @@ opt_oct_t* opt_oct_lait(elina_manager_t* man, bool destructive, opt_oct_t* o1, o
         features[k][11] = oo_head->mat[pos] != INFINITY && oo_head->mat[pos] == oo_res->mat[pos];
     }
 
-    PyObject* pFeatures = PyList_New(0);
-    for (int i=0; i<num_cons_predict; i++) {
-        PyObject* pFeature = PyList_New(num_features);
-        for (int j=0; j<num_features; j++) {
-            PyList_SetItem(pFeature, j, PyLong_FromLong(features[i][j]));
-        }
-        PyList_Append(pFeatures, pFeature);
-    }
-    PyTuple_SetItem(pArgs, 1, pFeatures);
-
     int var_to_cons[2*dim][num_cons_predict];
     int var_to_cons_count[2*dim];
     for (int i=0; i<2*dim; i++) var_to_cons_count[i] = 0;
@@ -306,29 +304,75 @@ opt_oct_t* opt_oct_lait(elina_manager_t* man, bool destructive, opt_oct_t* o1, o
         ++var_to_cons_count[j];
     }
 
-    PyObject* pEdges = PyList_New(0);
+    /* constraints sharing a row or column of the matrix are adjacent */
+    size_t num_edges = 0;
+    for (int i=0; i<2*dim; i++) num_edges += (size_t)var_to_cons_count[i]*var_to_cons_count[i];
+    int* edges = (int*)malloc(3*(num_edges ? num_edges : 1)*sizeof(int));
+    num_edges = 0;
     for (int i=0; i<2*dim; i++) {
         for (int j=0; j<var_to_cons_count[i]; j++) {
             for (int k=0; k<var_to_cons_count[i]; k++) {
-                PyObject* pEdge = PyList_New(3);
-                PyList_SetItem(pEdge, 0, PyLong_FromLong(var_to_cons[i][j]));
-                PyList_SetItem(pEdge, 1, PyLong_FromLong(var_to_cons[i][k]));
-                PyList_SetItem(pEdge, 2, PyLong_FromLong(1));
-                PyList_Append(pEdges, pEdge);
+                edges[3*num_edges] = var_to_cons[i][j];
+                edges[3*num_edges+1] = var_to_cons[i][k];
+                edges[3*num_edges+2] = 1;
+                ++num_edges;
             }
         }
     }
+
+    int* remove = (int*)calloc(num_cons_predict ? num_cons_predict : 1, sizeof(int));
+#if defined(LAIT_PYTHON)
+    PyGILState_STATE gstate = PyGILState_Ensure();
+
+    PyObject* pArgs = PyTuple_New(3);
+
+    PyObject* pBlockLens = PyList_New(num_comp);
+    for (int i=0; i<num_comp; i++) {
+        PyList_SetItem(pBlockLens, i, PyLong_FromLong(cons_count[i+1]));
+    }
+    PyTuple_SetItem(pArgs, 0, pBlockLens);
+
+    PyObject* pFeatures = PyList_New(num_cons_predict);
+    for (int i=0; i<num_cons_predict; i++) {
+        PyObject* pFeature = PyList_New(num_features);
+        for (int j=0; j<num_features; j++) {
+            PyList_SetItem(pFeature, j, PyLong_FromLong(features[i][j]));
+        }
+        PyList_SetItem(pFeatures, i, pFeature);
+    }
+    PyTuple_SetItem(pArgs, 1, pFeatures);
+
+    PyObject* pEdges = PyList_New(num_edges);
+    for (size_t i=0; i<num_edges; i++) {
+        PyObject* pEdge = PyList_New(3);
+        for (int j=0; j<3; j++) {
+            PyList_SetItem(pEdge, j, PyLong_FromLong(edges[3*i+j]));
+        }
+        PyList_SetItem(pEdges, i, pEdge);
+    }
     PyTuple_SetItem(pArgs, 2, pEdges);
 
-    PyObject* pRemove = PyObject_CallObject(pFunc, pArgs);
+    PyObject* pRemove = PyObject_CallObject(opt_oct_lait_func, pArgs);
+    for (int k=0; k<num_cons_predict; k++) {
+        remove[k] = PyLong_AsLong(PyList_GetItem(pRemove, k));
+    }
+
+    PyGILState_Release(gstate);
+#else
+    if (opt_oct_lait_gcn != NULL && num_cons_predict > 0) {
+        elina_lait_gcn_predict(opt_oct_lait_gcn, num_cons_predict, &features[0][0], num_edges, edges, remove);
+    }
+#endif
+    free(edges);
 
     for (int k=0; k<num_cons_predict; k++) {
-        if (PyLong_AsLong(PyList_GetItem(pRemove, k)) == 1) {
+        if (remove[k] == 1) {
             int i = cons_dim[k][0];
             int j = cons_dim[k][1];
             oo_res->mat[opt_matpos2(i, j)] = INFINITY;
         }
     }
+    free(remove);
     if (!oo_res->is_dense) {
         oo_res->acl = compute_finest(oo_res, dim);
     }
@@ -355,7 +399,5 @@ opt_oct_t* opt_oct_lait(elina_manager_t* man, bool destructive, opt_oct_t* o1, o
     free(var_count_h);
     free(var_cons_h);
 
-    PyGILState_Release(gstate);
-
     return o_res;
 }
\ No newline at end of file
@@ -543,6 +543,227 @@ void test_bound_linexpr(unsigned short int dim, size_t nbcons){
 
 }
 
+elina_lincons0_array_t generate_random_signed_lincons0_array(unsigned short int dim, size_t nbcons){
+	size_t i;
+	unsigned short int j, k;
+	elina_lincons0_array_t  lincons0 = elina_lincons0_array_make(nbcons);
+	for(i=0; i < nbcons; i++){
+		lincons0.p[i].constyp = rand()%4 ? ELINA_CONS_SUPEQ : ELINA_CONS_EQ;
+		elina_linexpr0_t * linexpr0 = elina_linexpr0_alloc(ELINA_LINEXPR_SPARSE,dim);
+		elina_scalar_set_to_int(linexpr0->cst.val.scalar,rand()%20,ELINA_SCALAR_MPQ);
+		k = 0;
+		for(j=0; j < dim; j++){
+			int r = rand()%7-3;
+			if(!r){
+				continue;
+			}
+			elina_linterm_t * linterm = &linexpr0->p.linterm[k];
+			linterm->dim = j;
+			elina_scalar_set_to_int(linterm->coeff.val.scalar,r,ELINA_SCALAR_MPQ);
+			k++;
+		}
+		elina_linexpr0_reinit(linexpr0,k);
+		lincons0.p[i].linexpr0 = linexpr0;
+	}
+	return lincons0;
+}
+
+
+void test_lp_queries(unsigned short int dim, size_t nbcons){
+	elina_manager_t * man_lp = opt_pk_manager_alloc(false);
+	elina_manager_t * man_gen = opt_pk_manager_alloc(false);
+	opt_pk_set_lp_mode((opt_pk_internal_t *)man_lp->internal,OPT_PK_LP_ALWAYS);
+	opt_pk_set_lp_mode((opt_pk_internal_t *)man_gen->internal,OPT_PK_LP_NEVER);
+	elina_lincons0_array_t lincons1 = generate_random_signed_lincons0_array(dim,nbcons);
+	elina_lincons0_array_t lincons2 = generate_random_signed_lincons0_array(dim,nbcons/2+1);
+	opt_pk_array_t * top = opt_pk_top(man_lp,dim,0);
+	opt_pk_array_t * top_gen = opt_pk_top(man_gen,dim,0);
+	// oa and ob are queried by linear programming, oc and od by the generator path
+	opt_pk_array_t * oa = opt_pk_meet_lincons_array(man_lp,false,top,&lincons1);
+	opt_pk_array_t * ob = opt_pk_meet_lincons_array(man_lp,false,top,&lincons2);
+	opt_pk_array_t * oc = opt_pk_meet_lincons_array(man_gen,false,top_gen,&lincons1);
+	opt_pk_array_t * od = opt_pk_meet_lincons_array(man_gen,false,top_gen,&lincons2);
+	elina_linexpr0_t * linexpr = generate_random_linexpr0(dim);
+	elina_interval_t * itv_lp = opt_pk_bound_linexpr(man_lp,oa,linexpr);
+	elina_interval_t * itv_gen = opt_pk_bound_linexpr(man_gen,oc,linexpr);
+	printf("Bound (LP) ");
+	elina_interval_print(itv_lp);
+	printf("\nBound (generators) ");
+	elina_interval_print(itv_gen);
+	printf("\nbound agree: %d\n",elina_interval_equal(itv_lp,itv_gen));
+	size_t i;
+	bool agree = true;
+	for(i=0; i < lincons2.size; i++){
+		bool sat_lp = opt_pk_sat_lincons(man_lp,oa,&lincons2.p[i]);
+		bool sat_gen = opt_pk_sat_lincons(man_gen,oc,&lincons2.p[i]);
+		agree = agree && (sat_lp==sat_gen);
+	}
+	printf("sat lincons agree: %d\n",agree);
+	bool leq_lp = opt_pk_is_leq(man_lp,oa,ob);
+	bool leq_gen = opt_pk_is_leq(man_gen,oc,od);
+	printf("is leq (LP) %d (generators) %d\n",leq_lp,leq_gen);
+	opt_pk_minimize(man_lp,oa);
+	printf("minimize (LP) is equal: %d\n",opt_pk_is_eq(man_gen,oa,oc));
+	elina_interval_free(itv_lp);
+	elina_interval_free(itv_gen);
+	elina_linexpr0_free(linexpr);
+	opt_pk_free(man_lp,top);
+	opt_pk_free(man_gen,top_gen);
+	opt_pk_free(man_lp,oa);
+	opt_pk_free(man_lp,ob);
+	opt_pk_free(man_gen,oc);
+	opt_pk_free(man_gen,od);
+	elina_lincons0_array_clear(&lincons1);
+	elina_lincons0_array_clear(&lincons2);
+	elina_manager_free(man_lp);
+	elina_manager_free(man_gen);
+}
+
+
+opt_pk_array_t * lazy_meet_assign_meet(elina_manager_t * man, unsigned short int dim, elina_lincons0_array_t * lincons1,
+					elina_dim_t * tdim, elina_linexpr0_t ** expr_array, elina_lincons0_array_t * lincons2){
+	opt_pk_array_t * op = opt_pk_top(man,dim,0);
+	op = opt_pk_meet_lincons_array(man,true,op,lincons1);
+	op = opt_pk_assign_linexpr_array(man,true,op,tdim,expr_array,1,NULL);
+	op = opt_pk_meet_lincons_array(man,true,op,lincons2);
+	return op;
+}
+
+void test_lazy_queries(elina_manager_t * man_lazy, elina_manager_t * man, unsigned short int dim,
+		       opt_pk_array_t * oa, opt_pk_array_t * ob){
+	// each query gets its own copy of oa, so that all of them start from unconverted blocks
+	opt_pk_array_t * bot = opt_pk_bottom(man_lazy,dim,0);
+	opt_pk_array_t * oa1 = opt_pk_copy(man_lazy,oa);
+	opt_pk_array_t * oa2 = opt_pk_copy(man_lazy,oa);
+	opt_pk_array_t * oa3 = opt_pk_copy(man_lazy,oa);
+	opt_pk_array_t * oa4 = opt_pk_copy(man_lazy,oa);
+	bool leq_bot = opt_pk_is_leq(man_lazy,oa1,bot);
+	bool eq_bot = opt_pk_is_eq(man_lazy,oa2,bot);
+	bool leq_ab = opt_pk_is_leq(man_lazy,oa3,ob);
+	bool leq_ba = opt_pk_is_leq(man_lazy,ob,oa4);
+	bool bot_lazy = opt_pk_is_bottom(man_lazy,oa);
+	bool bot_eager = opt_pk_is_bottom(man,ob);
+	// an overflow makes the conversion give up, the answers then differ without being wrong
+	bool ovf_lazy = man_lazy->result.exclog!=NULL;
+	bool ovf_eager = man->result.exclog!=NULL;
+	printf("is bottom (lazy) %d (eager) %d\n",bot_lazy,bot_eager);
+	printf("lazy is leq bottom %d, is eq bottom %d, agree with is bottom: %d\n",leq_bot,eq_bot,
+	       leq_bot==bot_lazy && eq_bot==bot_lazy);
+	printf("lazy is leq eager %d, eager is leq lazy %d\n",leq_ab,leq_ba);
+	printf("overflow (lazy) %d (eager) %d\n",ovf_lazy,ovf_eager);
+	opt_pk_free(man_lazy,bot);
+	opt_pk_free(man_lazy,oa1);
+	opt_pk_free(man_lazy,oa2);
+	opt_pk_free(man_lazy,oa3);
+	opt_pk_free(man_lazy,oa4);
+}
+
+void test_lazy(unsigned short int dim, size_t nbcons){
+	elina_manager_t * man_lazy = opt_pk_manager_alloc(false);
+	elina_manager_t * man = opt_pk_manager_alloc(false);
+	opt_pk_set_lazy((opt_pk_internal_t *)man_lazy->internal,true);
+	elina_lincons0_array_t lincons1 = generate_random_signed_lincons0_array(dim,nbcons);
+	elina_lincons0_array_t lincons2 = generate_random_signed_lincons0_array(dim,nbcons/2+1);
+	// x0 - x(dim-1) >= 1 and x(dim-1) - x0 >= 0 cannot hold together
+	elina_lincons0_array_t lincons3 = elina_lincons0_array_make(2);
+	size_t i;
+	for(i=0; i < 2; i++){
+		elina_linexpr0_t * linexpr0 = elina_linexpr0_alloc(ELINA_LINEXPR_SPARSE,2);
+		elina_scalar_set_to_int(linexpr0->cst.val.scalar,i ? 0 : -1,ELINA_SCALAR_MPQ);
+		linexpr0->p.linterm[0].dim = 0;
+		elina_scalar_set_to_int(linexpr0->p.linterm[0].coeff.val.scalar,i ? -1 : 1,ELINA_SCALAR_MPQ);
+		linexpr0->p.linterm[1].dim = dim-1;
+		elina_scalar_set_to_int(linexpr0->p.linterm[1].coeff.val.scalar,i ? 1 : -1,ELINA_SCALAR_MPQ);
+		elina_linexpr0_reinit(linexpr0,dim > 1 ? 2 : 1);
+		lincons3.p[i].constyp = ELINA_CONS_SUPEQ;
+		lincons3.p[i].linexpr0 = linexpr0;
+		lincons3.p[i].scalar = NULL;
+	}
+	elina_dim_t * tdim = (elina_dim_t *)malloc(sizeof(elina_dim_t));
+	tdim[0] = 0;
+	elina_linexpr0_t ** expr_array = (elina_linexpr0_t**)malloc(sizeof(elina_linexpr0_t*));
+	// x0 occurs in the expression, hence the assignment is invertible
+	expr_array[0] = generate_random_linexpr0(dim);
+	// meet, assign, meet: the lazy manager only updates constraints
+	elina_manager_clear_exclog(man_lazy);
+	elina_manager_clear_exclog(man);
+	opt_pk_array_t * oa = lazy_meet_assign_meet(man_lazy,dim,&lincons1,tdim,expr_array,&lincons2);
+	opt_pk_array_t * ob = lazy_meet_assign_meet(man,dim,&lincons1,tdim,expr_array,&lincons2);
+	test_lazy_queries(man_lazy,man,dim,oa,ob);
+	opt_pk_free(man_lazy,oa);
+	opt_pk_free(man,ob);
+	// the same with a last meet that makes the result empty
+	printf("Testing Lazy Double Description (empty result)\n");
+	elina_manager_clear_exclog(man_lazy);
+	elina_manager_clear_exclog(man);
+	oa = lazy_meet_assign_meet(man_lazy,dim,&lincons1,tdim,expr_array,&lincons3);
+	ob = lazy_meet_assign_meet(man,dim,&lincons1,tdim,expr_array,&lincons3);
+	test_lazy_queries(man_lazy,man,dim,oa,ob);
+	opt_pk_free(man_lazy,oa);
+	opt_pk_free(man,ob);
+	elina_linexpr0_free(expr_array[0]);
+	free(expr_array);
+	free(tdim);
+	elina_lincons0_array_clear(&lincons1);
+	elina_lincons0_array_clear(&lincons2);
+	elina_lincons0_array_clear(&lincons3);
+	elina_manager_free(man_lazy);
+	elina_manager_free(man);
+}
+
+bool test_forget_lazy(unsigned short int dim, size_t nbcons){
+	elina_manager_t * man_lazy = opt_pk_manager_alloc(false);
+	elina_manager_t * man = opt_pk_manager_alloc(false);
+	opt_pk_set_lazy((opt_pk_internal_t *)man_lazy->internal,true);
+	elina_lincons0_array_t lincons0 = generate_random_signed_lincons0_array(dim,nbcons);
+	size_t size = dim/2 > 0 ? dim/2 : 1;
+	elina_dim_t * tdim = (elina_dim_t *)malloc(size*sizeof(elina_dim_t));
+	size_t i;
+	for(i=0; i < size; i++){
+		tdim[i] = i;
+	}
+	elina_manager_clear_exclog(man_lazy);
+	elina_manager_clear_exclog(man);
+	// the lazy manager eliminates on constraints by Fourier-Motzkin
+	opt_pk_array_t * oa = opt_pk_top(man_lazy,dim,0);
+	oa = opt_pk_meet_lincons_array(man_lazy,true,oa,&lincons0);
+	opt_pk_array_t * oa1 = opt_pk_forget_array(man_lazy,false,oa,tdim,size,false);
+	opt_pk_array_t * ob = opt_pk_top(man,dim,0);
+	ob = opt_pk_meet_lincons_array(man,true,ob,&lincons0);
+	opt_pk_array_t * ob1 = opt_pk_forget_array(man,false,ob,tdim,size,false);
+	bool bot_lazy = opt_pk_is_bottom(man_lazy,oa1);
+	bool bot = opt_pk_is_bottom(man,ob1);
+	printf("is bottom (lazy) %d (eager) %d\n",bot_lazy,bot);
+	// the lazy result must not be wider, unless the eager reference itself overflowed
+	bool agree = bot_lazy==bot;
+	bool leq = bot_lazy || !bot;
+	for(i=0; !bot_lazy && !bot && i < dim; i++){
+		elina_interval_t * itv_lazy = opt_pk_bound_dimension(man_lazy,oa1,i);
+		elina_interval_t * itv = opt_pk_bound_dimension(man,ob1,i);
+		agree = agree && elina_interval_equal(itv_lazy,itv);
+		leq = leq && elina_interval_is_leq(itv_lazy,itv);
+		elina_interval_free(itv_lazy);
+		elina_interval_free(itv);
+	}
+	bool ovf_lazy = man_lazy->result.exclog!=NULL;
+	bool ovf_eager = man->result.exclog!=NULL;
+	printf("forget bounds agree: %d, lazy included in eager: %d\n",agree,leq);
+	printf("overflow (lazy) %d (eager) %d\n",ovf_lazy,ovf_eager);
+	bool res = leq || ovf_eager;
+	if(!res){
+		printf("FAILED: lazy forget lost precision\n");
+	}
+	opt_pk_free(man_lazy,oa);
+	opt_pk_free(man_lazy,oa1);
+	opt_pk_free(man,ob);
+	opt_pk_free(man,ob1);
+	free(tdim);
+	elina_lincons0_array_clear(&lincons0);
+	elina_manager_free(man_lazy);
+	elina_manager_free(man);
+	return res;
+}
+
 
 int main(int argc, char **argv){
 	if(argc < 3){
@@ -575,6 +796,13 @@ int main(int argc, char **argv){
 	test_sat_lincons(dim,nbcons);
 	printf("Testing Bound Linexpr\n");
         test_bound_linexpr(dim,nbcons);
-				
-	
+	printf("Testing LP Queries\n");
+	test_lp_queries(dim,nbcons);
+	printf("Testing Lazy Double Description\n");
+	test_lazy(dim,nbcons);
+	printf("Testing Lazy Forget\n");
+	if(!test_forget_lazy(dim,nbcons)){
+		return 1;
+	}
+	return 0;
 }
@@ -20,6 +20,7 @@
 
 #include "opt_pk.h"
 #include "opt_pk_lait.h"
+#include <time.h>
 
 int mat_oa[18][17] = {
     {4, -2, 2, -2, 3, 1, 5, 2, 6, -1, 0},
@@ -111,7 +112,10 @@ int main(int argc, char** argv) {
 
 
     // call opt_pk_lait_init at the start of the analysis to initialize Lait
-    opt_pk_lait_init("/home/hej/ELINA/elina_poly", "/home/hej/ELINA/elina_poly/opt_pk_lait.pt");
+    // the model is opt_pk_lait.bin, exported from opt_pk_lait.pt with
+    // elina_auxiliary/elina_lait_export.py (a build with LAIT_PYTHON=1 takes
+    // the directory of opt_pk_lait.py and the .pt file instead)
+    opt_pk_lait_init(".", argc > 1 ? argv[1] : "opt_pk_lait.bin");
 
     // the first join input
     opt_pk_array_t* oa = generate_poly(man, mat_oa, 18, 76);
@@ -143,5 +147,24 @@ int main(int argc, char** argv) {
     elina_lincons0_array_fprint(stdout, &arr_lait, NULL);
     elina_lincons0_array_clear(&arr_lait);
 
+    // latency of the join and of Lait on its output
+    int runs = 100;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i=0; i<runs; i++) {
+        opt_pk_array_t* tmp = opt_pk_join(man, false, oa, ob);
+        opt_pk_free(man, tmp);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double join_us = ((end.tv_sec - start.tv_sec)*1e6 + (end.tv_nsec - start.tv_nsec)/1e3)/runs;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i=0; i<runs; i++) {
+        opt_pk_array_t* tmp = opt_pk_lait(man, false, oa, ob, res, head, 0);
+        opt_pk_free(man, tmp);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double lait_us = ((end.tv_sec - start.tv_sec)*1e6 + (end.tv_nsec - start.tv_nsec)/1e3)/runs;
+    printf("join: %.1f us, lait: %.1f us per join\n", join_us, lait_us);
+
     return 0;
 }
\ No newline at end of file
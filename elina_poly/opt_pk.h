@@ -123,10 +123,29 @@ elina_manager_t* opt_pk_manager_alloc(bool strict);
 
 opt_pk_internal_t* opt_pk_manager_get_internal(elina_manager_t* man);
 
+typedef enum opt_pk_lp_mode_t {
+  OPT_PK_LP_NEVER=0,  /* always convert to generators */
+  OPT_PK_LP_AUTO,     /* use linear programming when cheaper than the conversion */
+  OPT_PK_LP_ALWAYS    /* use linear programming whenever possible */
+} opt_pk_lp_mode_t;
+
 /* For setting options when one has a elina_manager_t object, one can use the
    ELINA function elina_manager_get_internal with a cast. */
 
 void opt_pk_set_approximate_max_coeff_size(opt_pk_internal_t* opk, size_t size);
+void opt_pk_set_lp_mode(opt_pk_internal_t* opk, opt_pk_lp_mode_t mode);
+  /* Selects how bound queries, entailment checks and redundancy removal are
+     answered on blocks that only have constraints: by linear programming on
+     the constraints, or by converting to generators. */
+void opt_pk_set_lazy(opt_pk_internal_t* opk, bool lazy);
+  /* If true, meet with constraints, invertible assignments, addition and
+     permutation of dimensions only update the constraints of the blocks they
+     touch. Generators are then recomputed on demand, by the operations that
+     need them (join, widening, projection, emptiness and inclusion tests).
+     Converting the constraints of several operations at once can overflow
+     where the step by step conversion of the eager mode stays exact; the
+     overflow is then reported as an exception and the answer is only an
+     approximation. Default is false. */
 //void opt_pk_print(elina_manager_t* man, opt_pk_t* po, char** name_of_dim);
 
 /* ============================================================ */
@@ -0,0 +1,108 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ********************************************************************** */
+/* opt_pk_arena.c: operation-scoped scratch memory */
+/* ********************************************************************** */
+
+#include <stdlib.h>
+#include <string.h>
+#include "opt_pk_arena.h"
+
+/* Alignment of the returned blocks, enough for any scalar type */
+#define OPT_PK_ARENA_ALIGN 16
+#define OPT_PK_ARENA_HEADER ((sizeof(opt_pk_arena_chunk_t) + OPT_PK_ARENA_ALIGN - 1) & ~(size_t)(OPT_PK_ARENA_ALIGN - 1))
+
+static opt_pk_arena_chunk_t * opt_pk_arena_chunk_alloc(size_t size)
+{
+  opt_pk_arena_chunk_t * chunk = (opt_pk_arena_chunk_t *)malloc(OPT_PK_ARENA_HEADER + size);
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->top = 0;
+  return chunk;
+}
+
+opt_pk_arena_t * opt_pk_arena_alloc_arena(size_t size)
+{
+  opt_pk_arena_t * arena = (opt_pk_arena_t *)malloc(sizeof(opt_pk_arena_t));
+  arena->head = opt_pk_arena_chunk_alloc(size);
+  arena->cur = arena->head;
+  return arena;
+}
+
+void opt_pk_arena_free_arena(opt_pk_arena_t * arena)
+{
+  opt_pk_arena_chunk_t * chunk = arena->head;
+  while(chunk){
+    opt_pk_arena_chunk_t * next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(arena);
+}
+
+void * opt_pk_arena_alloc(opt_pk_arena_t * arena, size_t size)
+{
+  opt_pk_arena_chunk_t * cur = arena->cur;
+  size = (size + OPT_PK_ARENA_ALIGN - 1) & ~(size_t)(OPT_PK_ARENA_ALIGN - 1);
+  if(cur->top + size > cur->size){
+    /* the chunks after cur are free, reuse the next one if it is large
+       enough, otherwise insert a bigger one */
+    opt_pk_arena_chunk_t * next = cur->next;
+    if(!next || next->size < size){
+      size_t nsize = 2*cur->size;
+      if(nsize < size){
+	nsize = size;
+      }
+      opt_pk_arena_chunk_t * chunk = opt_pk_arena_chunk_alloc(nsize);
+      chunk->next = next;
+      cur->next = chunk;
+      next = chunk;
+    }
+    next->top = 0;
+    arena->cur = next;
+    cur = next;
+  }
+  void * res = (char *)cur + OPT_PK_ARENA_HEADER + cur->top;
+  cur->top += size;
+  return res;
+}
+
+void * opt_pk_arena_calloc(opt_pk_arena_t * arena, size_t nmemb, size_t size)
+{
+  void * res = opt_pk_arena_alloc(arena,nmemb*size);
+  memset(res,0,nmemb*size);
+  return res;
+}
+
+opt_pk_arena_mark_t opt_pk_arena_mark(opt_pk_arena_t * arena)
+{
+  opt_pk_arena_mark_t mark;
+  mark.chunk = arena->cur;
+  mark.top = arena->cur->top;
+  return mark;
+}
+
+void opt_pk_arena_release(opt_pk_arena_t * arena, opt_pk_arena_mark_t mark)
+{
+  arena->cur = mark.chunk;
+  arena->cur->top = mark.top;
+}
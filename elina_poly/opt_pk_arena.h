@@ -0,0 +1,73 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ********************************************************************** */
+/* opt_pk_arena.h: operation-scoped scratch memory */
+/* ********************************************************************** */
+
+/* Bump allocator owned by the manager for the temporary arrays of an
+   operation (maps, counters, index arrays).  Memory is never freed
+   individually: an operation takes a mark on entry and releases it on
+   exit, which makes all the memory allocated in between available again.
+   Marks nest, so an operation may call another one.  Anything that
+   outlives the operation must be allocated on the heap. */
+
+#ifndef __OPT_PK_ARENA_H__
+#define __OPT_PK_ARENA_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct opt_pk_arena_chunk_t {
+  struct opt_pk_arena_chunk_t * next;
+  size_t size;
+  size_t top;
+} opt_pk_arena_chunk_t;
+
+typedef struct opt_pk_arena_t {
+  opt_pk_arena_chunk_t * head;
+  opt_pk_arena_chunk_t * cur;
+} opt_pk_arena_t;
+
+typedef struct opt_pk_arena_mark_t {
+  opt_pk_arena_chunk_t * chunk;
+  size_t top;
+} opt_pk_arena_mark_t;
+
+opt_pk_arena_t * opt_pk_arena_alloc_arena(size_t size);
+void opt_pk_arena_free_arena(opt_pk_arena_t * arena);
+
+/* Uninitialized and zeroed allocations, valid until the enclosing mark is
+   released */
+void * opt_pk_arena_alloc(opt_pk_arena_t * arena, size_t size);
+void * opt_pk_arena_calloc(opt_pk_arena_t * arena, size_t nmemb, size_t size);
+
+opt_pk_arena_mark_t opt_pk_arena_mark(opt_pk_arena_t * arena);
+void opt_pk_arena_release(opt_pk_arena_t * arena, opt_pk_arena_mark_t mark);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -201,14 +201,14 @@ opt_pk_array_t* opt_poly_asssub_linexpr_det(bool assign, elina_manager_t* man,
   comp_list_t * cla = acla->head;
   //elina_lincons0_array_t arr1 = opt_pk_to_lincons_array(man,op);
   //elina_lincons0_array_fprint(stdout,&arr1,NULL);
-  unsigned short int * rmapa = (unsigned short int *)calloc(num_compa, sizeof(unsigned short int));
-  size_t * num_vertex_a = (size_t *)calloc(num_compa,sizeof(size_t));
+  unsigned short int * rmapa = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compa, sizeof(unsigned short int));
+  size_t * num_vertex_a = (size_t *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(size_t));
   size_t  nbvertex = 0;
   size_t  nbline = 0;
   size_t  nbcons = 0;
   size_t  nbeq = 0;
-  char * disjoint_map = (char *)calloc(num_compa,sizeof(char));
-  char * line_map = (char *)calloc(comp_size, sizeof(char));
+  char * disjoint_map = (char *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(char));
+  char * line_map = (char *)opt_pk_arena_calloc(opk->arena,comp_size, sizeof(char));
   opt_pk_t ** poly_a = oa->poly;
   // whether to use generators or constraints
   bool flag1 = !sgn && assign;
@@ -268,7 +268,7 @@ opt_pk_array_t* opt_poly_asssub_linexpr_det(bool assign, elina_manager_t* man,
   }
  
   cl = acl->head;
-  char * exc_map = (char *)calloc(num_comp,sizeof(char));
+  char * exc_map = (char *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(char));
   for(k=0; k < num_comp; k++){
 	unsigned short int comp_size = cl->size;
 	poly[k] = opt_poly_alloc(comp_size,0);
@@ -385,88 +385,104 @@ opt_pk_array_t* opt_poly_asssub_linexpr_det(bool assign, elina_manager_t* man,
 				tdim[0] = nvar;
 				opt_poly_projectforget_array(false,
 						  man,poly[res],poly[res],tdim,1,true);
-			    	size_t nbcons = poly[res]->C->nbrows;
-			    	opt_matrix_resize_rows(poly[res]->C,nbcons+1);
-				opt_numint_t * ov = opk->poly_numintp;
-				opt_numint_t * dpi = poly[res]->C->p[nbcons];
-				opt_vector_copy(dpi,ov,matC->nbcolumns);
-				dpi[0] = 0;
-				dpi[nvar+opk->dec] = -ov[0]; 
-				poly[res]->nbeq++;			
-				poly[res]->is_minimized = false;
-				if(!opk->exn){
-					//if( need_refine){
-                    if(0){
-						comp_list_t * clv = find(acl,var);
+				if(opk->exn){
+					/* Fourier-Motzkin overflowed: recompute C from F instead */
+					opk->exn = ELINA_EXC_NONE;
+					if(poly[res]->C){
+						opt_matrix_free(poly[res]->C);
+						poly[res]->C = NULL;
+					}
+					poly[res]->nbeq = 0;
+					opt_poly_chernikova(man,poly[res],"non invertible assign");
+					if(opk->exn){
+						opk->exn = ELINA_EXC_NONE;
+						exc_map[res] = 1;
+					}
+				}
+				else {
+				    	size_t nbcons = poly[res]->C->nbrows;
+				    	opt_matrix_resize_rows(poly[res]->C,nbcons+1);
+					opt_numint_t * ov = opk->poly_numintp;
+					opt_numint_t * dpi = poly[res]->C->p[nbcons];
+					opt_vector_copy(dpi,ov,matC->nbcolumns);
+					dpi[0] = 0;
+					dpi[nvar+opk->dec] = -ov[0]; 
+					poly[res]->nbeq++;			
+					poly[res]->is_minimized = false;
+					if(!opk->exn){
+						//if( need_refine){
+	                    if(0){
+							comp_list_t * clv = find(acl,var);
 					
 						
-						comp_t * ci = cli_copy->head;
-						while(ci!=NULL){
-							remove_comp(clv,ci->num);
-							ci = ci->next;
-						}
-						unsigned short int *ca1 = to_sorted_array(clv,maxcols);
-						unsigned short int *ca2 = to_sorted_array(cli_copy,maxcols);
-						unsigned short int * ind_map_a = map_index(ca1,ca,clv->size);
-						unsigned short int * ind_map_b = map_index(ca2,ca,cli_copy->size);
-						opt_pk_t * tmp = poly[res];
-						opt_matrix_t * F = tmp->F;
-						opt_matrix_t * C = tmp->C;
-						bool is_pos = false;
-						poly[res] = opt_poly_alloc(clv->size,0);
-						poly[res]->C = opt_matrix_alloc(C->nbrows+1,clv->size+opk->dec,false);
-						poly[res]->F = opt_matrix_alloc(F->nbrows,clv->size+opk->dec,false);
-						poly[res]->nbeq = split_matrix(opk,poly[res]->C,C,ind_map_a,clv->size, &is_pos);
-						//if(!is_pos){
-						//	size_t nbrows = poly[res]->C->nbrows;
-						//	poly[res]->C->p[nbrows][0] = 1;
-						//	poly[res]->C->p[nbrows][1] = 1;
-						//	poly[res]->C->nbrows++;
-						//}
-						poly[res]->nbline = split_matrix(opk,poly[res]->F,F,ind_map_a,clv->size,&is_pos); 
+							comp_t * ci = cli_copy->head;
+							while(ci!=NULL){
+								remove_comp(clv,ci->num);
+								ci = ci->next;
+							}
+							unsigned short int *ca1 = to_sorted_array(clv,maxcols);
+							unsigned short int *ca2 = to_sorted_array(cli_copy,maxcols);
+							unsigned short int * ind_map_a = map_index(ca1,ca,clv->size);
+							unsigned short int * ind_map_b = map_index(ca2,ca,cli_copy->size);
+							opt_pk_t * tmp = poly[res];
+							opt_matrix_t * F = tmp->F;
+							opt_matrix_t * C = tmp->C;
+							bool is_pos = false;
+							poly[res] = opt_poly_alloc(clv->size,0);
+							poly[res]->C = opt_matrix_alloc(C->nbrows+1,clv->size+opk->dec,false);
+							poly[res]->F = opt_matrix_alloc(F->nbrows,clv->size+opk->dec,false);
+							poly[res]->nbeq = split_matrix(opk,poly[res]->C,C,ind_map_a,clv->size, &is_pos);
+							//if(!is_pos){
+							//	size_t nbrows = poly[res]->C->nbrows;
+							//	poly[res]->C->p[nbrows][0] = 1;
+							//	poly[res]->C->p[nbrows][1] = 1;
+							//	poly[res]->C->nbrows++;
+							//}
+							poly[res]->nbline = split_matrix(opk,poly[res]->F,F,ind_map_a,clv->size,&is_pos); 
 
-						is_pos = false;
-						poly[num_comp] = opt_poly_alloc(cli_copy->size,0);
-						poly[num_comp]->C = opt_matrix_alloc(C->nbrows+1,cli_copy->size+opk->dec,false);
-						poly[num_comp]->F = opt_matrix_alloc(F->nbrows,cli_copy->size+opk->dec,false); 
-						poly[num_comp]->nbeq = split_matrix(opk,poly[num_comp]->C,C,ind_map_b,cli_copy->size, &is_pos);
-						//if(!is_pos){
-						//	size_t nbrows = poly[num_comp]->C->nbrows;
-						//	poly[num_comp]->C->p[nbrows][0] = 1;
-						//	poly[num_comp]->C->p[nbrows][1] = 1;
-						//	poly[num_comp]->C->nbrows++;
-						//}
-						poly[num_comp]->nbline = split_matrix(opk,poly[num_comp]->F,F,ind_map_b,cli_copy->size, &is_pos); 
+							is_pos = false;
+							poly[num_comp] = opt_poly_alloc(cli_copy->size,0);
+							poly[num_comp]->C = opt_matrix_alloc(C->nbrows+1,cli_copy->size+opk->dec,false);
+							poly[num_comp]->F = opt_matrix_alloc(F->nbrows,cli_copy->size+opk->dec,false); 
+							poly[num_comp]->nbeq = split_matrix(opk,poly[num_comp]->C,C,ind_map_b,cli_copy->size, &is_pos);
+							//if(!is_pos){
+							//	size_t nbrows = poly[num_comp]->C->nbrows;
+							//	poly[num_comp]->C->p[nbrows][0] = 1;
+							//	poly[num_comp]->C->p[nbrows][1] = 1;
+							//	poly[num_comp]->C->nbrows++;
+							//}
+							poly[num_comp]->nbline = split_matrix(opk,poly[num_comp]->F,F,ind_map_b,cli_copy->size, &is_pos); 
 					
 					
-						poly[res]->satC = opt_satmat_alloc(poly[res]->F->nbrows,opt_bitindex_size(poly[res]->C->nbrows));
-						combine_satmat(opk,poly[res],clv->size,poly[res]->C->nbrows,true);
-						poly[num_comp]->satC = opt_satmat_alloc(poly[num_comp]->F->nbrows,opt_bitindex_size(poly[num_comp]->C->nbrows));
-						combine_satmat(opk,poly[num_comp],cli_copy->size,poly[num_comp]->C->nbrows,true);
+							poly[res]->satC = opt_satmat_alloc(poly[res]->F->nbrows,opt_bitindex_size(poly[res]->C->nbrows));
+							combine_satmat(opk,poly[res],clv->size,poly[res]->C->nbrows,true);
+							poly[num_comp]->satC = opt_satmat_alloc(poly[num_comp]->F->nbrows,opt_bitindex_size(poly[num_comp]->C->nbrows));
+							combine_satmat(opk,poly[num_comp],cli_copy->size,poly[num_comp]->C->nbrows,true);
 
 						 
-						insert_comp_list_tail(acl,cli_copy);
+							insert_comp_list_tail(acl,cli_copy);
 						 
 					
-						free(ca1);
-						free(ca2);
-						free(ind_map_a);
-						free(ind_map_b);
+							free(ca1);
+							free(ca2);
+							free(ind_map_a);
+							free(ind_map_b);
 					
-						opt_matrix_free(C);
-						opt_matrix_free(F);
-						free(tmp);
+							opt_matrix_free(C);
+							opt_matrix_free(F);
+							free(tmp);
 					
+						}
+						else {
+							poly[res]->satC = opt_satmat_alloc(poly[res]->F->nbrows,opt_bitindex_size(poly[res]->C->nbrows));
+							combine_satmat(opk,poly[res],matC->nbcolumns - opk->dec,poly[res]->C->nbrows,true);
+						}
 					}
-					else {
-						poly[res]->satC = opt_satmat_alloc(poly[res]->F->nbrows,opt_bitindex_size(poly[res]->C->nbrows));
-						combine_satmat(opk,poly[res],matC->nbcolumns - opk->dec,poly[res]->C->nbrows,true);
+					else{
+						opk->exn = ELINA_EXC_NONE;
+						exc_map[res] = 1;
 					}
 				}
-				else{
-					opk->exn = ELINA_EXC_NONE;
-					exc_map[res] = 1;
-				}
 				opt_matrix_free(matF);
 				free(tdim);
 			}
@@ -519,7 +535,9 @@ opt_pk_array_t* opt_poly_asssub_linexpr_det(bool assign, elina_manager_t* man,
 			//poly[res]->nbeq = nbeqmapa[res];
 			//poly[res]->is_minimized = true;
 			
-			opt_poly_chernikova(man,poly[res],"gen to cons");
+			if(!opk->lazy || !assign){
+				opt_poly_chernikova(man,poly[res],"gen to cons");
+			}
 			if(opk->exn){
 				opk->exn = ELINA_EXC_NONE;
 				exc_map[res] = 1;
@@ -567,11 +585,7 @@ opt_pk_array_t* opt_poly_asssub_linexpr_det(bool assign, elina_manager_t* man,
 		free_array_comp_list(acla);
 		free(poly_a);	 
 	    }
-    free(num_vertex_a);
-    free(rmapa);
-    free(disjoint_map);
     free(ca);
-    free(line_map);
     elina_linexpr0_free(dst);
     free_array_comp_list(aclb);
     k=0;
@@ -596,7 +610,6 @@ opt_pk_array_t* opt_poly_asssub_linexpr_det(bool assign, elina_manager_t* man,
     }
     op->poly = poly;
     op->acl = acl;
-    free(exc_map);
       //printf("ASSIGN OUTPUT\n");
 	//print_array_comp_list(acl,op->maxcols);
 	//elina_lincons0_array_t arr1 = opt_pk_to_lincons_array(man,op);
@@ -634,11 +647,18 @@ opt_pk_array_t* opt_poly_asssub_linexpr(bool assign, bool lazy,
   unsigned short int num_compa = acla->size;
   unsigned short int k;
   opt_pk_t ** poly_a = oa->poly;
+  /* With lazy double description, invertible assignments are done on the
+     constraints only; everything else needs the generators */
+  bool cons_only = false;
+  if (opk->lazy && assign && elina_linexpr0_is_linear(linexpr)){
+    elina_coeff_t * coeff = elina_linexpr0_coeffref(linexpr,dim);
+    cons_only = coeff && !elina_coeff_zero(coeff);
+  }
   /* Minimize the argument if option say so */
-  if (!lazy){
+  if (!lazy || opk->lazy){
     for(k=0; k < num_compa;k++){
 	opt_pk_t * oak = poly_a[k];
-	if(!lazy){
+	if(!cons_only){
 	   opt_poly_chernikova(man,oak,"of the argument");
 	}
 	else{
@@ -751,7 +771,7 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
   //nbcols = oa->maxcols;
   
   array_comp_list_t * aclb = create_array_comp_list();
-  comp_list_t ** clb_arr = (comp_list_t **)malloc(size*sizeof(comp_list_t *));
+  comp_list_t ** clb_arr = (comp_list_t **)opt_pk_arena_alloc(opk->arena,size*sizeof(comp_list_t *));
   for (i=0; i<size; i++){
     
     comp_list_t *clb = linexpr0_to_comp_list(opk,texpr[i]);
@@ -767,8 +787,8 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
   **********************************/
   array_comp_list_t *acl = union_array_comp_list(acla,aclb,maxcols);
   unsigned short int num_comp = acl->size;
-  unsigned short int ** ca_arr = (unsigned short int **)malloc(num_comp*sizeof(unsigned short int *));
-  unsigned short int * comp_size_map = (unsigned short int *)calloc(num_comp,sizeof(unsigned short int));
+  unsigned short int ** ca_arr = (unsigned short int **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(unsigned short int *));
+  unsigned short int * comp_size_map = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(unsigned short int));
   comp_list_t * cl = acl->head;
   for(k=0; k < num_comp; k++){
 	unsigned short int comp_size = cl->size; 
@@ -780,9 +800,9 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
 	Factor assignment statement according to LUB
   ***********************************/
 
-  unsigned short int * rmapb = (unsigned short int *)calloc(size, sizeof(unsigned short int));
-  size_t * nbmapb = (size_t *)calloc(num_comp,sizeof(size_t));
-  elina_linexpr0_t ** expr_array = (elina_linexpr0_t **)malloc(size*sizeof(elina_linexpr0_t *));
+  unsigned short int * rmapb = (unsigned short int *)opt_pk_arena_calloc(opk->arena,size, sizeof(unsigned short int));
+  size_t * nbmapb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  elina_linexpr0_t ** expr_array = (elina_linexpr0_t **)opt_pk_arena_alloc(opk->arena,size*sizeof(elina_linexpr0_t *));
   for(i=0;i < size; i++){
 	unsigned short int ind = is_comp_list_included(acl,clb_arr[i],maxcols);
 	rmapb[i] = ind;
@@ -794,12 +814,12 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
   /*********************************
 	Factor A according to LUB
   **********************************/
-  unsigned short int * rmapa = (unsigned short int *)calloc(num_compa, sizeof(unsigned short int));
-  char * disjoint_map = (char *)calloc(num_compa,sizeof(char));
-  size_t * nbgenmapa = (size_t *)calloc(num_comp,sizeof(size_t));
-  size_t * nblinemapa = (size_t *)calloc(num_comp,sizeof(size_t));
-  size_t * num_vertex_a = (size_t *)calloc(num_compa,sizeof(size_t));
-  size_t * num_vertex = (size_t *)calloc(num_comp,sizeof(size_t));
+  unsigned short int * rmapa = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compa, sizeof(unsigned short int));
+  char * disjoint_map = (char *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(char));
+  size_t * nbgenmapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  size_t * nblinemapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  size_t * num_vertex_a = (size_t *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(size_t));
+  size_t * num_vertex = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
   unsigned short int * array_map_a = create_array_map(acla,maxcols);
   comp_list_t * cla = acla->head;
   for(k=0; k < num_compa; k++){
@@ -828,8 +848,8 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
   }
   
   opt_pk_t ** poly = (opt_pk_t **)malloc(num_comp*sizeof(opt_pk_t *));
-  size_t * counterF = (size_t *)calloc(num_comp,sizeof(size_t));
-  char * pos_con_map = (char *)calloc(num_comp,sizeof(char));
+  size_t * counterF = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  char * pos_con_map = (char *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(char));
   cl = acl->head;
   for(k=0; k < num_comp; k++){
 	unsigned short int comp_size = cl->size;
@@ -931,18 +951,18 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
 	            }
   		}
   }
-  char * exc_map = (char *)calloc(num_comp,sizeof(char));
+  char * exc_map = (char *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(char));
   /* Copy tdim because of sorting */
   for(k=0; k < num_comp; k++){
         if(nbmapb[k]){
-		tvec = (opt_numint_t **)malloc(nbmapb[k]*sizeof(opt_numint_t *));
-		tdim2 = (elina_dim_t*)malloc(nbmapb[k]*sizeof(elina_dim_t));
+		tvec = (opt_numint_t **)opt_pk_arena_alloc(opk->arena,nbmapb[k]*sizeof(opt_numint_t *));
+		tdim2 = (elina_dim_t*)opt_pk_arena_alloc(opk->arena,nbmapb[k]*sizeof(elina_dim_t));
 		unsigned short int l = 0;
 		unsigned short int comp_size = comp_size_map[k];
 		unsigned short int * ca = ca_arr[k];
 		for(i=0; i <size; i++){
 			if(rmapb[i]==k){
-				tvec[l] = opt_vector_alloc(comp_size+2);
+				tvec[l] = (opt_numint_t *)opt_pk_arena_calloc(opk->arena,comp_size+2,sizeof(opt_numint_t));
 				opt_vector_set_elina_linexpr0(opk,tvec[l],expr_array[i],comp_size,1);
 				unsigned short int k1 = 0;
 				unsigned short int var = tdim[i] + opk->dec;
@@ -973,12 +993,6 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
 			}
 		}
 		opt_matrix_free(tmp);
-	  	/* Free allocated stuff */
-		for(i=0; i < nbmapb[k]; i++){
-			opt_vector_free(tvec[i],comp_size+2);
-		}
-		free(tvec);
-		free(tdim2);
 	}
 	free(ca_arr[k]);
   }
@@ -1000,21 +1014,7 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
     free(poly_a);
     //opt_poly_array_clear(opk,op);
   }
-  free(clb_arr);
-  free(rmapb);
-  free(nbmapb);
-  free(rmapa);
-  free(disjoint_map);
-  free(nbgenmapa);
-  free(nblinemapa);
-  free(num_vertex_a);
-  free(num_vertex);
-  free(expr_array);
   free_array_comp_list(aclb);
-  free(comp_size_map);
-  free(ca_arr);
-  free(pos_con_map);
-  free(counterF);
   op = destructive ? oa : opt_pk_array_alloc(NULL,NULL,maxcols);
   
   unsigned short int k1=0;
@@ -1040,7 +1040,6 @@ opt_pk_array_t* opt_poly_asssub_linexpr_array_det(bool assign, elina_manager_t*
   }
   op->poly = poly;
   op->acl = acl;
-  free(exc_map);
   //op->status = 0;
   return op;
 }
@@ -1282,9 +1281,11 @@ opt_pk_array_t* opt_pk_assign_linexpr_array(elina_manager_t* man,
  	 start_timing();
   #endif
 
+  opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
   op = size==1 ? opt_poly_asssub_linexpr(true, opk->funopt->algorithm<=0, man,destructive,oa,tdim[0],texpr[0],ob) :
        		 opt_poly_asssub_linexpr_array(true, opk->funopt->algorithm<=0,
 			      man,destructive,oa,tdim,texpr,size,ob);
+  opt_pk_arena_release(opk->arena,mark);
   //assert(poly_check(pk,po));
   #if defined(TIMING)
  	 	record_timing(assign_linexpr_time);
@@ -1304,6 +1305,7 @@ opt_pk_array_t* opt_pk_substitute_linexpr_array(elina_manager_t* man,
   #if defined(TIMING)
  	 start_timing();
   #endif
+  opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
   op =
     size==1 ?
     opt_poly_asssub_linexpr(false,
@@ -1313,6 +1315,7 @@ opt_pk_array_t* opt_pk_substitute_linexpr_array(elina_manager_t* man,
     opt_poly_asssub_linexpr_array(false,
 			      opk->funopt->algorithm<=0,
 			      man,destructive,oa,tdim,texpr,size,ob);
+  opt_pk_arena_release(opk->arena,mark);
   #if defined(TIMING)
  	 	record_timing(substitute_linexpr_time);
   #endif
@@ -1334,9 +1337,11 @@ opt_pk_array_t* opt_pk_assign_texpr_array(elina_manager_t* man,
   #if defined(TIMING)
  	 start_timing();
   #endif
+  opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
   op = opt_poly_asssub_texpr_array(true,
 			       opk->funopt->algorithm<=0,
 			       man,destructive,oa,tdim,texpr,size,dest);
+  opt_pk_arena_release(opk->arena,mark);
   #if defined(TIMING)
  	 	record_timing(assign_linexpr_time);
   #endif
@@ -31,6 +31,7 @@
 #include "opt_pk_meetjoin.h"
 #include "opt_pk_representation.h"
 #include "opt_pk_test.h"
+#include "opt_pk_lp.h"
 
 
 /* Bounding the value of a dimension in a matrix of generators. */
@@ -135,6 +136,9 @@ elina_interval_t* opt_pk_bound_linexpr(elina_manager_t* man,
     man->result.flag_exact = man->result.flag_best = true;
     return interval;
   }
+  if(opt_pk_bound_linexpr_lp(man,oa,expr,interval)){
+    return interval;
+  }
   
   unsigned short int num_compa = acla->size;
   opt_pk_t **poly_a = oa->poly;
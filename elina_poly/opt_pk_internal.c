@@ -104,6 +104,10 @@ opt_pk_internal_t* opt_pk_internal_alloc(bool strict)
   opk->dec = strict ? 3 : 2;
   opk->max_coeff_size = 0;
   opk->approximate_max_coeff_size = 2;
+  opk->lp_mode = OPT_PK_LP_AUTO;
+  opk->lazy = false;
+  opk->arena = opt_pk_arena_alloc_arena(1<<16);
+  opk->pool = NULL;
 
   opt_pk_internal_init(opk,10);
 
@@ -154,6 +158,8 @@ void opt_pk_internal_clear(opt_pk_internal_t* opk)
 void opt_pk_internal_free(opt_pk_internal_t* opk)
 {
   opt_pk_internal_clear(opk);
+  opt_pk_arena_free_arena(opk->arena);
+  opt_pk_thread_pool_free(opk->pool);
   free(opk);
 }
 
@@ -183,6 +189,14 @@ void opt_pk_set_approximate_max_coeff_size(opt_pk_internal_t* opk, size_t size){
   opk->approximate_max_coeff_size = size;
 }
 
+void opt_pk_set_lp_mode(opt_pk_internal_t* opk, opt_pk_lp_mode_t mode){
+  opk->lp_mode = mode;
+}
+
+void opt_pk_set_lazy(opt_pk_internal_t* opk, bool lazy){
+  opk->lazy = lazy;
+}
+
 
 /* ********************************************************************** */
 /* III. Initialization from manager */
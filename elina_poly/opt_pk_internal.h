@@ -30,6 +30,8 @@
 #include "opt_pk_config.h"
 #include "rdtsc.h"
 #include "opt_pk.h"
+#include "opt_pk_arena.h"
+#include "opt_pk_thread_pool.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -96,6 +98,11 @@ struct opt_pk_internal_t {
   size_t max_coeff_size; /* Used for overflow exception in vector_combine */
   size_t approximate_max_coeff_size;
 
+  opt_pk_lp_mode_t lp_mode; /* queries on constraint-only blocks */
+  bool lazy; /* delay the conversion to generators */
+  opt_pk_arena_t * arena; /* scratch memory of the current operation */
+  opt_pk_thread_pool_t * pool; /* workers of Fourier-Motzkin, allocated on first use */
+
   opt_numint_t * vector_numintp; /* of size maxcols */
 
   //mpq_t* vector_mpqp; /* of size maxdims+3 */
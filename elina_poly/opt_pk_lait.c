@@ -36,8 +36,18 @@
 #include "opt_pk_project.h"
 #include "opt_pk_cherni.h"
 #include "opt_pk_lait.h"
+#if defined(LAIT_PYTHON)
 #include "python3.6/Python.h"
 
+/* the lait function of opt_pk_lait.py, imported once by opt_pk_lait_init */
+static PyObject* opt_pk_lait_func = NULL;
+#else
+#include "elina_lait_gcn.h"
+
+/* the network loaded by opt_pk_lait_init */
+static elina_lait_gcn_t* opt_pk_lait_gcn = NULL;
+#endif
+
 
 bool constraint_removal(elina_manager_t* man, opt_pk_t* poly, int* rmap) {
 	opt_pk_internal_t* opk = opt_pk_init_from_manager(man, ELINA_FUNID_JOIN);
@@ -145,6 +155,7 @@ bool is_common_constraint(opt_pk_internal_t* opk, unsigned short int cons_maxcol
 	return false;
 }
 
+#if defined(LAIT_PYTHON)
 // python_path: the path contatining the python file opt_pk_lait.py
 // model_path: the path to opt_pk_lait_model.pt
 void opt_pk_lait_init(char* python_path, char* model_path) {
@@ -169,8 +180,71 @@ void opt_pk_lait_init(char* python_path, char* model_path) {
 	PyObject* pArgs = PyTuple_New(1);
 	PyTuple_SetItem(pArgs, 0, PyBytes_FromString(model_path));
 	PyObject* res = PyObject_CallObject(pFunc, pArgs);
+	opt_pk_lait_func = PyObject_GetAttrString(pModule, "lait");
 	PyGILState_Release(gstate);
 }
+#else
+// python_path: unused, kept for compatibility with the Python build
+// model_path: the path to opt_pk_lait.bin, exported from opt_pk_lait.pt
+//             by elina_auxiliary/elina_lait_export.py
+void opt_pk_lait_init(char* python_path, char* model_path) {
+	elina_lait_gcn_free(opt_pk_lait_gcn);
+	opt_pk_lait_gcn = elina_lait_gcn_load(model_path);
+}
+
+/* Same selection as lait() in opt_pk_lait.py: only blocks with at least 20
+   constraints are classified, and within them only constraints over more
+   than two variables; all other constraints are kept. */
+static void opt_pk_lait_predict(int num_blocks, int* block_lens, int num_cons, int* features, size_t num_edges, int* edges, int* remove) {
+	int num_features = 12;
+	if (opt_pk_lait_gcn == NULL || num_cons == 0) return;
+
+	int* index = (int*)malloc(num_cons*sizeof(int));
+	int* reverse_index = (int*)malloc(num_cons*sizeof(int));
+	int num_nodes = 0;
+	int i = 0;
+	for (int b=0; b<num_blocks; b++) {
+		for (int k=0; k<block_lens[b]; k++, i++) {
+			reverse_index[i] = -1;
+			if (block_lens[b] >= 20 && features[i*num_features+4] > 2) {
+				index[num_nodes] = i;
+				reverse_index[i] = num_nodes++;
+			}
+		}
+	}
+	if (num_nodes == 0) {
+		free(index);
+		free(reverse_index);
+		return;
+	}
+
+	int* node_features = (int*)malloc(num_nodes*num_features*sizeof(int));
+	for (int n=0; n<num_nodes; n++)
+		memcpy(node_features + n*num_features, features + index[n]*num_features, num_features*sizeof(int));
+	int* node_edges = (int*)malloc(3*(num_edges ? num_edges : 1)*sizeof(int));
+	size_t num_node_edges = 0;
+	for (size_t e=0; e<num_edges; e++) {
+		int src = reverse_index[edges[3*e]];
+		int dst = reverse_index[edges[3*e+1]];
+		if (src == -1 || dst == -1) continue;
+		node_edges[3*num_node_edges] = src;
+		node_edges[3*num_node_edges+1] = dst;
+		node_edges[3*num_node_edges+2] = edges[3*e+2];
+		++num_node_edges;
+	}
+
+	int* y = (int*)malloc(num_nodes*sizeof(int));
+	elina_lait_gcn_predict(opt_pk_lait_gcn, num_nodes, node_features, num_node_edges, node_edges, y);
+	for (int n=0; n<num_nodes; n++)
+		remove[index[n]] = y[n];
+
+	free(y);
+	free(node_edges);
+	free(node_features);
+	free(reverse_index);
+	free(index);
+}
+#endif
 
 // oa: the first join input
 // ob: the second join input
@@ -336,14 +410,9 @@ opt_pk_array_t* opt_pk_lait(elina_manager_t* man, bool destructive, opt_pk_array
 		cl = cl->next;
 	}
 
-	PyGILState_STATE gstate = PyGILState_Ensure();
-
-	PyObject* pName = PyUnicode_DecodeFSDefault("opt_pk_lait");
-	PyObject* pModule = PyImport_Import(pName);
-	PyObject* pFunc = PyObject_GetAttrString(pModule, "lait");
-	PyObject* pArgs = PyTuple_New(3);
-
-	PyObject* pBlockLens = PyList_New(0);
+	int num_blocks = 0;
+	int block_lens[num_comp];
+	size_t max_edges = 0;
 	for (int i=0; i<num_comp; i++) {
 		opt_matrix_t* C = poly[i]->C;
 		if (C) {
@@ -351,21 +420,15 @@ opt_pk_array_t* opt_pk_lait(elina_manager_t* man, bool destructive, opt_pk_array
 			for (size_t j=0; j<C->nbrows; j++)
 				if (!opt_vector_is_positivity_constraint(opk, C->p[j], C->nbcolumns))
 					++num;
-			PyList_Append(pBlockLens, PyLong_FromLong(num));
+			block_lens[num_blocks++] = num;
+			max_edges += (size_t)num*num;
 		}
 	}
-	PyTuple_SetItem(pArgs, 0, pBlockLens);
-
-	PyObject* pFeatures = PyList_New(num_cons);
-	for (int i=0; i<num_cons; i++) {
-		PyObject* pFeature = PyList_New(num_features);
-		for (int j=0; j<num_features; j++)
-			PyList_SetItem(pFeature, j, PyLong_FromLong(features[i][j]));
-		PyList_SetItem(pFeatures, i, pFeature);
-	}
-	PyTuple_SetItem(pArgs, 1, pFeatures);
 
-	PyObject* pEdges = PyList_New(0);
+	/* two constraints are adjacent if they share a variable, the edge
+	   weight is the number of shared variables */
+	int* edges = (int*)malloc(3*(max_edges ? max_edges : 1)*sizeof(int));
+	size_t num_edges = 0;
 	index_cons = 0;
 	for (int i=0; i<num_comp; i++) {
 		opt_matrix_t* C = poly[i]->C;
@@ -397,19 +460,54 @@ opt_pk_array_t* opt_pk_lait(elina_manager_t* man, bool destructive, opt_pk_array
 						if (vars_in_cons[j][l] && vars_in_cons[k][l])
 							++edge_type;
 					if (edge_type > 0) {
-						PyObject* pEdge = PyList_New(3);
-						PyList_SetItem(pEdge, 0, PyLong_FromLong(indices[j]));
-						PyList_SetItem(pEdge, 1, PyLong_FromLong(indices[k]));
-						PyList_SetItem(pEdge, 2, PyLong_FromLong(edge_type));
-						PyList_Append(pEdges, pEdge);
+						edges[3*num_edges] = indices[j];
+						edges[3*num_edges+1] = indices[k];
+						edges[3*num_edges+2] = edge_type;
+						++num_edges;
 					}
 				}
 			}
 		}
 	}
+
+	int* remove = (int*)calloc(num_cons ? num_cons : 1, sizeof(int));
+#if defined(LAIT_PYTHON)
+	PyGILState_STATE gstate = PyGILState_Ensure();
+
+	PyObject* pArgs = PyTuple_New(3);
+
+	PyObject* pBlockLens = PyList_New(num_blocks);
+	for (int i=0; i<num_blocks; i++)
+		PyList_SetItem(pBlockLens, i, PyLong_FromLong(block_lens[i]));
+	PyTuple_SetItem(pArgs, 0, pBlockLens);
+
+	PyObject* pFeatures = PyList_New(num_cons);
+	for (int i=0; i<num_cons; i++) {
+		PyObject* pFeature = PyList_New(num_features);
+		for (int j=0; j<num_features; j++)
+			PyList_SetItem(pFeature, j, PyLong_FromLong(features[i][j]));
+		PyList_SetItem(pFeatures, i, pFeature);
+	}
+	PyTuple_SetItem(pArgs, 1, pFeatures);
+
+	PyObject* pEdges = PyList_New(num_edges);
+	for (size_t i=0; i<num_edges; i++) {
+		PyObject* pEdge = PyList_New(3);
+		for (int j=0; j<3; j++)
+			PyList_SetItem(pEdge, j, PyLong_FromLong(edges[3*i+j]));
+		PyList_SetItem(pEdges, i, pEdge);
+	}
 	PyTuple_SetItem(pArgs, 2, pEdges);
 
-    PyObject* pRemove = PyObject_CallObject(pFunc, pArgs);
+	PyObject* pRemove = PyObject_CallObject(opt_pk_lait_func, pArgs);
+	for (int i=0; i<num_cons; i++)
+		remove[i] = PyLong_AsLong(PyList_GetItem(pRemove, i));
+
+	PyGILState_Release(gstate);
+#else
+	opt_pk_lait_predict(num_blocks, block_lens, num_cons, &features[0][0], num_edges, edges, remove);
+#endif
+	free(edges);
 
 	index_cons = 0;
 	cl = acl->head;
@@ -424,7 +522,7 @@ opt_pk_array_t* opt_pk_lait(elina_manager_t* man, bool destructive, opt_pk_array
 					continue;
 				}
 
-				rmap[j] = PyLong_AsLong(PyList_GetItem(pRemove, index_cons));
+				rmap[j] = remove[index_cons];
 				index_cons++;
 			}
 
@@ -461,8 +559,7 @@ opt_pk_array_t* opt_pk_lait(elina_manager_t* man, bool destructive, opt_pk_array
 
 		cl = cl->next;
 	}
-
-	PyGILState_Release(gstate);
+	free(remove);
 
 	return res;
 }
\ No newline at end of file
@@ -0,0 +1,755 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ********************************************************************** */
+/* opt_pk_lp.c: linear programming on the constraint representation */
+/* ********************************************************************** */
+
+#include "opt_pk_config.h"
+#include "opt_pk_vector.h"
+#include "opt_pk_matrix.h"
+#include "opt_pk.h"
+#include "opt_pk_user.h"
+#include "opt_pk_representation.h"
+#include "opt_pk_meetjoin.h"
+#include "opt_pk_lp.h"
+
+/* ********************************************************************** */
+/* I. Simplex */
+/* ********************************************************************** */
+
+/* A block with d variables and m non trivial rows is encoded in standard
+   form with 2d variables x+ and x- (x = x+ - x-), one slack per inequality
+   and one artificial variable per row.  Bland's rule is used for choosing
+   the entering and leaving variables, so that the algorithm terminates. */
+
+static mpq_t ** opt_pk_lp_tableau_alloc(size_t nbrows, size_t nbcols){
+	mpq_t ** T = (mpq_t **)malloc(nbrows*sizeof(mpq_t *));
+	size_t i,j;
+	for(i=0; i < nbrows; i++){
+		T[i] = (mpq_t *)malloc(nbcols*sizeof(mpq_t));
+		for(j=0; j < nbcols; j++){
+			mpq_init(T[i][j]);
+		}
+	}
+	return T;
+}
+
+static void opt_pk_lp_tableau_free(mpq_t ** T, size_t nbrows, size_t nbcols){
+	size_t i,j;
+	for(i=0; i < nbrows; i++){
+		for(j=0; j < nbcols; j++){
+			mpq_clear(T[i][j]);
+		}
+		free(T[i]);
+	}
+	free(T);
+}
+
+static bool opt_pk_lp_is_trivial(opt_pk_internal_t *opk, opt_numint_t *ci, unsigned short int nbcolumns){
+	unsigned short int j;
+	for(j=opk->dec; j < nbcolumns; j++){
+		if(ci[j]){
+			return false;
+		}
+	}
+	return true;
+}
+
+/* pivots T (and the objective row) on the element (r,c) */
+static void opt_pk_lp_pivot(mpq_t ** T, size_t * basis, mpq_t * obj, size_t nbrows, size_t nbcols,
+			    size_t r, size_t c, mpq_t tmp){
+	size_t i,j;
+	mpq_t * Tr = T[r];
+	mpq_t * piv = &Tr[c];
+	mpq_t inv;
+	mpq_init(inv);
+	mpq_inv(inv,*piv);
+	for(j=0; j <= nbcols; j++){
+		if(j!=c && mpq_sgn(Tr[j])){
+			mpq_mul(Tr[j],Tr[j],inv);
+		}
+	}
+	mpq_set_ui(Tr[c],1,1);
+	for(i=0; i <= nbrows; i++){
+		mpq_t * Ti = (i==nbrows) ? obj : T[i];
+		if(i==r || !mpq_sgn(Ti[c])){
+			continue;
+		}
+		mpq_t f;
+		mpq_init(f);
+		mpq_set(f,Ti[c]);
+		for(j=0; j <= nbcols; j++){
+			if(mpq_sgn(Tr[j])){
+				mpq_mul(tmp,f,Tr[j]);
+				mpq_sub(Ti[j],Ti[j],tmp);
+			}
+		}
+		mpq_clear(f);
+	}
+	basis[r] = c;
+	mpq_clear(inv);
+}
+
+/* maximizes the objective row, only the first nbcand columns may enter the basis */
+static opt_pk_lp_status_t opt_pk_lp_simplex(mpq_t ** T, size_t * basis, mpq_t * obj,
+					    size_t nbrows, size_t nbcols, size_t nbcand){
+	size_t i,j;
+	mpq_t tmp, lhs, rhs;
+	opt_pk_lp_status_t res = OPT_PK_LP_OPTIMAL;
+	mpq_init(tmp);
+	mpq_init(lhs);
+	mpq_init(rhs);
+	while(true){
+		size_t c = nbcand;
+		for(j=0; j < nbcand; j++){
+			if(mpq_sgn(obj[j])>0){
+				c = j;
+				break;
+			}
+		}
+		if(c==nbcand){
+			break;
+		}
+		size_t r = nbrows;
+		for(i=0; i < nbrows; i++){
+			if(mpq_sgn(T[i][c])<=0){
+				continue;
+			}
+			if(r==nbrows){
+				r = i;
+				continue;
+			}
+			/* compare T[i][rhs]/T[i][c] with T[r][rhs]/T[r][c] */
+			mpq_mul(lhs,T[i][nbcols],T[r][c]);
+			mpq_mul(rhs,T[r][nbcols],T[i][c]);
+			int cmp = mpq_cmp(lhs,rhs);
+			if(cmp < 0 || (cmp==0 && basis[i] < basis[r])){
+				r = i;
+			}
+		}
+		if(r==nbrows){
+			res = OPT_PK_LP_UNBOUNDED;
+			break;
+		}
+		opt_pk_lp_pivot(T,basis,obj,nbrows,nbcols,r,c,tmp);
+	}
+	mpq_clear(tmp);
+	mpq_clear(lhs);
+	mpq_clear(rhs);
+	return res;
+}
+
+opt_pk_lp_t * opt_pk_lp_alloc(opt_pk_internal_t *opk, opt_matrix_t *C, char *ignore){
+	size_t i,j,r;
+	unsigned short int nbcolumns = C->nbcolumns;
+	size_t dim = nbcolumns - opk->dec;
+	size_t nbrows = 0, nbslack = 0;
+	opt_pk_lp_t * lp = (opt_pk_lp_t *)malloc(sizeof(opt_pk_lp_t));
+	lp->dim = dim;
+	lp->infeasible = false;
+	for(i=0; i < C->nbrows; i++){
+		opt_numint_t * ci = C->p[i];
+		if(ignore && ignore[i]){
+			continue;
+		}
+		if(opt_pk_lp_is_trivial(opk,ci,nbcolumns)){
+			/* 0 = c or 0 <= c, the epsilon column is ignored */
+			if(ci[0] ? ci[opt_polka_cst] < 0 : ci[opt_polka_cst]!=0){
+				lp->infeasible = true;
+			}
+			continue;
+		}
+		nbrows++;
+		if(ci[0]){
+			nbslack++;
+		}
+	}
+	size_t art = 2*dim + nbslack;
+	size_t nbcols = art + nbrows;
+	lp->_maxrows = nbrows;
+	lp->_maxcols = nbcols+1;
+	lp->nbrows = nbrows;
+	lp->nbcols = nbcols;
+	lp->T = opt_pk_lp_tableau_alloc(nbrows,nbcols+1);
+	lp->obj = (mpq_t *)malloc((nbcols+1)*sizeof(mpq_t));
+	for(j=0; j <= nbcols; j++){
+		mpq_init(lp->obj[j]);
+	}
+	lp->basis = (size_t *)malloc(nbrows*sizeof(size_t));
+	if(lp->infeasible){
+		return lp;
+	}
+	/* a.x + b >= 0 becomes a.x+ - a.x- - s = -b and a.x + b = 0 becomes a.x+ - a.x- = -b */
+	size_t s = 2*dim;
+	r = 0;
+	for(i=0; i < C->nbrows; i++){
+		opt_numint_t * ci = C->p[i];
+		if((ignore && ignore[i]) || opt_pk_lp_is_trivial(opk,ci,nbcolumns)){
+			continue;
+		}
+		mpq_t * Tr = lp->T[r];
+		int sgn = ci[opt_polka_cst] > 0 ? -1 : 1;
+		for(j=0; j < dim; j++){
+			opt_numint_t a = ci[opk->dec+j];
+			if(a){
+				mpq_set_si(Tr[j],sgn*a,1);
+				mpq_set_si(Tr[dim+j],-sgn*a,1);
+			}
+		}
+		if(ci[0]){
+			mpq_set_si(Tr[s],-sgn,1);
+			s++;
+		}
+		mpq_set_si(Tr[nbcols],-sgn*ci[opt_polka_cst],1);
+		mpq_set_ui(Tr[art+r],1,1);
+		lp->basis[r] = art+r;
+		r++;
+	}
+	/* first phase: maximize the opposite of the sum of artificial variables */
+	mpq_t * obj = lp->obj;
+	for(r=0; r < nbrows; r++){
+		for(j=0; j < art; j++){
+			mpq_add(obj[j],obj[j],lp->T[r][j]);
+		}
+		mpq_add(obj[nbcols],obj[nbcols],lp->T[r][nbcols]);
+	}
+	opt_pk_lp_simplex(lp->T,lp->basis,obj,nbrows,nbcols,nbcols);
+	if(mpq_sgn(obj[nbcols])){
+		lp->infeasible = true;
+		return lp;
+	}
+	/* drive the remaining (null) artificial variables out of the basis */
+	mpq_t tmp;
+	mpq_init(tmp);
+	r = 0;
+	while(r < lp->nbrows){
+		if(lp->basis[r] < art){
+			r++;
+			continue;
+		}
+		for(j=0; j < art; j++){
+			if(mpq_sgn(lp->T[r][j])){
+				break;
+			}
+		}
+		if(j < art){
+			opt_pk_lp_pivot(lp->T,lp->basis,obj,lp->nbrows,nbcols,r,j,tmp);
+			r++;
+		}
+		else{
+			/* linearly dependent row */
+			lp->nbrows--;
+			mpq_t * Tr = lp->T[r];
+			lp->T[r] = lp->T[lp->nbrows];
+			lp->T[lp->nbrows] = Tr;
+			lp->basis[r] = lp->basis[lp->nbrows];
+		}
+	}
+	mpq_clear(tmp);
+	/* drop the artificial columns */
+	for(r=0; r < lp->nbrows; r++){
+		mpq_set(lp->T[r][art],lp->T[r][nbcols]);
+	}
+	lp->nbcols = art;
+	return lp;
+}
+
+void opt_pk_lp_free(opt_pk_lp_t *lp){
+	size_t j;
+	opt_pk_lp_tableau_free(lp->T,lp->_maxrows,lp->_maxcols);
+	for(j=0; j < lp->_maxcols; j++){
+		mpq_clear(lp->obj[j]);
+	}
+	free(lp->obj);
+	free(lp->basis);
+	free(lp);
+}
+
+opt_pk_lp_status_t opt_pk_lp_optimize(opt_pk_internal_t *opk, opt_pk_lp_t *lp,
+				      opt_numint_t *obj, bool maximize, mpq_t res){
+	size_t i,j;
+	if(lp->infeasible){
+		return OPT_PK_LP_INFEASIBLE;
+	}
+	size_t nbrows = lp->nbrows, nbcols = lp->nbcols, dim = lp->dim;
+	mpq_t ** T = lp->T;
+	mpq_t * row = lp->obj;
+	/* cost of x+ and x-, the other variables have a null cost */
+	long int sgn = maximize ? 1 : -1;
+	for(j=0; j <= nbcols; j++){
+		mpq_set_ui(row[j],0,1);
+	}
+	for(j=0; j < dim; j++){
+		opt_numint_t c = obj[opk->dec+j];
+		if(c){
+			mpq_set_si(row[j],sgn*c,1);
+			mpq_set_si(row[dim+j],-sgn*c,1);
+		}
+	}
+	mpq_t cb, tmp;
+	mpq_init(cb);
+	mpq_init(tmp);
+	for(i=0; i < nbrows; i++){
+		size_t b = lp->basis[i];
+		if(b >= 2*dim || !mpq_sgn(row[b])){
+			continue;
+		}
+		mpq_set(cb,row[b]);
+		for(j=0; j <= nbcols; j++){
+			if(mpq_sgn(T[i][j])){
+				mpq_mul(tmp,cb,T[i][j]);
+				mpq_sub(row[j],row[j],tmp);
+			}
+		}
+	}
+	opt_pk_lp_status_t status = opt_pk_lp_simplex(T,lp->basis,row,nbrows,nbcols,nbcols);
+	if(status==OPT_PK_LP_OPTIMAL){
+		/* the objective row holds -z */
+		if(maximize){
+			mpq_neg(res,row[nbcols]);
+		}
+		else{
+			mpq_set(res,row[nbcols]);
+		}
+		mpq_set_si(tmp,obj[opt_polka_cst],1);
+		mpq_add(res,res,tmp);
+	}
+	mpq_clear(cb);
+	mpq_clear(tmp);
+	return status;
+}
+
+/* ********************************************************************** */
+/* II. Cost heuristic */
+/* ********************************************************************** */
+
+/* The conversion of m constraints in dimension d roughly costs m^2*d
+   operations per intermediate generator set, whose size grows exponentially
+   with d in the worst case. A simplex on the same constraints costs about
+   m*(m+d)*(m+2d) rational operations, which are a few times more expensive
+   than the machine integer arithmetic of Chernikova's algorithm. */
+bool opt_pk_lp_is_preferable(opt_pk_internal_t *opk, opt_pk_t *o, size_t nbqueries){
+	if(!o->C || opk->lp_mode==OPT_PK_LP_NEVER){
+		return false;
+	}
+	if(opk->lp_mode==OPT_PK_LP_ALWAYS){
+		return true;
+	}
+	if(o->F){
+		return false;
+	}
+	double m = o->C->nbrows;
+	double d = o->C->nbcolumns - opk->dec;
+	double conv = m*m*d*ldexp(1.0,(int)(d < 40 ? d/2 : 20));
+	double lp = 4.0*nbqueries*m*(m+d)*(m+2*d);
+	return lp < conv;
+}
+
+/* ********************************************************************** */
+/* III. Redundancy removal */
+/* ********************************************************************** */
+
+/* An inequality is redundant iff its minimum under the other constraints is
+   non negative. */
+bool opt_poly_lp_remove_redundant(opt_pk_internal_t *opk, opt_pk_t *o){
+	opt_matrix_t * C = o->C;
+	size_t i, nbrows = C->nbrows;
+	unsigned short int nbcolumns = C->nbcolumns;
+	opt_pk_lp_t * lp = opt_pk_lp_alloc(opk,C,NULL);
+	bool infeasible = lp->infeasible;
+	opt_pk_lp_free(lp);
+	if(infeasible){
+		return false;
+	}
+	char * ignore = (char *)calloc(nbrows,sizeof(char));
+	mpq_t res;
+	mpq_init(res);
+	for(i=0; i < nbrows; i++){
+		opt_numint_t * ci = C->p[i];
+		if(!ci[0] || opt_pk_lp_is_trivial(opk,ci,nbcolumns)){
+			continue;
+		}
+		/* a strict inequality is only removed if it is strictly entailed */
+		bool strict = opk->strict && ci[opt_polka_eps] < 0;
+		ignore[i] = 1;
+		lp = opt_pk_lp_alloc(opk,C,ignore);
+		opt_pk_lp_status_t status = opt_pk_lp_optimize(opk,lp,ci,false,res);
+		opt_pk_lp_free(lp);
+		if(status!=OPT_PK_LP_OPTIMAL || mpq_sgn(res) < (strict ? 1 : 0)){
+			ignore[i] = 0;
+		}
+	}
+	mpq_clear(res);
+	size_t nb = nbrows;
+	i = 0;
+	while(i < nb){
+		if(ignore[i]){
+			nb--;
+			opt_matrix_exch_rows(C,i,nb);
+			ignore[i] = ignore[nb];
+		}
+		else{
+			i++;
+		}
+	}
+	free(ignore);
+	if(nb < nbrows){
+		C->nbrows = nb;
+		C->_sorted = false;
+		if(o->satC){
+			opt_satmat_free(o->satC);
+			o->satC = NULL;
+		}
+		if(o->satF){
+			opt_satmat_free(o->satF);
+			o->satF = NULL;
+		}
+	}
+	return true;
+}
+
+/* ********************************************************************** */
+/* IV. Queries */
+/* ********************************************************************** */
+
+/* Decides whether the queries on oa should be answered by linear programming.
+   All blocks need their constraints, and the blocks which have no generators
+   must be cheaper to solve than to convert. */
+static bool opt_pk_lp_use(opt_pk_internal_t *opk, opt_pk_array_t *oa, size_t nbqueries){
+	if(opk->lp_mode==OPT_PK_LP_NEVER){
+		return false;
+	}
+	array_comp_list_t * acla = oa->acl;
+	unsigned short int k, num_compa = acla->size;
+	bool need = false;
+	for(k=0; k < num_compa; k++){
+		opt_pk_t * oak = oa->poly[k];
+		if(!oak->C){
+			return false;
+		}
+		if(!oak->F){
+			if(!opt_pk_lp_is_preferable(opk,oak,nbqueries)){
+				return false;
+			}
+			need = true;
+		}
+	}
+	return need || opk->lp_mode==OPT_PK_LP_ALWAYS;
+}
+
+/* Builds the linear programs of all the blocks. Returns NULL and sets
+   *empty if one of the blocks is found infeasible. */
+static opt_pk_lp_t ** opt_pk_lp_array_alloc(opt_pk_internal_t *opk, opt_pk_array_t *oa, bool *empty){
+	unsigned short int k, k1, num_compa = oa->acl->size;
+	opt_pk_lp_t ** lp_arr = (opt_pk_lp_t **)malloc(num_compa*sizeof(opt_pk_lp_t *));
+	*empty = false;
+	for(k=0; k < num_compa; k++){
+		lp_arr[k] = opt_pk_lp_alloc(opk,oa->poly[k]->C,NULL);
+		if(lp_arr[k]->infeasible){
+			for(k1=0; k1 <= k; k1++){
+				opt_pk_lp_free(lp_arr[k1]);
+			}
+			free(lp_arr);
+			*empty = true;
+			return NULL;
+		}
+	}
+	return lp_arr;
+}
+
+static void opt_pk_lp_array_free(opt_pk_lp_t ** lp_arr, unsigned short int num_comp){
+	unsigned short int k;
+	for(k=0; k < num_comp; k++){
+		opt_pk_lp_free(lp_arr[k]);
+	}
+	free(lp_arr);
+}
+
+/* Bounds vec[opt_polka_cst] + sum vec[i]*x_i, where vec is indexed by the
+   columns of oa. Infinite bounds are signaled by *inf_infty, *sup_infty.
+   Only the bounds asked for by need_inf and need_sup are computed, the
+   other one is reported as infinite. */
+static void opt_pk_lp_bound_vector(opt_pk_internal_t *opk, opt_pk_array_t *oa,
+				   opt_pk_lp_t ** lp_arr, unsigned short int ** ca_arr,
+				   opt_numint_t * vec, opt_numint_t * ov,
+				   bool need_inf, mpq_t inf, bool *inf_infty,
+				   bool need_sup, mpq_t sup, bool *sup_infty){
+	unsigned short int k, j, maxcols = oa->maxcols;
+	unsigned short int num_compa = oa->acl->size;
+	comp_list_t * cla = oa->acl->head;
+	char * covered = (char *)calloc(maxcols,sizeof(char));
+	mpq_t res;
+	mpq_init(res);
+	mpq_set_si(inf,vec[opt_polka_cst],1);
+	mpq_set_si(sup,vec[opt_polka_cst],1);
+	*inf_infty = !need_inf;
+	*sup_infty = !need_sup;
+	for(k=0; k < num_compa && !(*inf_infty && *sup_infty); k++){
+		unsigned short int comp_size = cla->size;
+		unsigned short int * ca = ca_arr[k];
+		bool flag = false;
+		ov[0] = 0;
+		ov[opt_polka_cst] = 0;
+		for(j=0; j < comp_size; j++){
+			ov[opk->dec+j] = vec[ca[j]];
+			covered[ca[j]] = 1;
+			if(vec[ca[j]]){
+				flag = true;
+			}
+		}
+		cla = cla->next;
+		if(!flag){
+			continue;
+		}
+		if(!*inf_infty){
+			if(opt_pk_lp_optimize(opk,lp_arr[k],ov,false,res)==OPT_PK_LP_OPTIMAL){
+				mpq_add(inf,inf,res);
+			}
+			else{
+				*inf_infty = true;
+			}
+		}
+		if(!*sup_infty){
+			if(opt_pk_lp_optimize(opk,lp_arr[k],ov,true,res)==OPT_PK_LP_OPTIMAL){
+				mpq_add(sup,sup,res);
+			}
+			else{
+				*sup_infty = true;
+			}
+		}
+	}
+	/* variables which are not constrained by oa */
+	for(j=opk->dec; j < maxcols; j++){
+		if(!covered[j] && vec[j]){
+			*inf_infty = *sup_infty = true;
+			break;
+		}
+	}
+	mpq_clear(res);
+	free(covered);
+}
+
+static unsigned short int ** opt_pk_lp_sorted_arrays(opt_pk_array_t *oa){
+	unsigned short int k, num_compa = oa->acl->size;
+	unsigned short int ** ca_arr = (unsigned short int **)malloc(num_compa*sizeof(unsigned short int *));
+	comp_list_t * cla = oa->acl->head;
+	for(k=0; k < num_compa; k++){
+		ca_arr[k] = to_sorted_array(cla,oa->maxcols);
+		cla = cla->next;
+	}
+	return ca_arr;
+}
+
+static void opt_pk_lp_sorted_arrays_free(unsigned short int ** ca_arr, unsigned short int num_comp){
+	unsigned short int k;
+	for(k=0; k < num_comp; k++){
+		free(ca_arr[k]);
+	}
+	free(ca_arr);
+}
+
+bool opt_pk_bound_linexpr_lp(elina_manager_t *man, opt_pk_array_t *oa,
+			     elina_linexpr0_t *expr, elina_interval_t *interval){
+	opt_pk_internal_t * opk = (opt_pk_internal_t *)man->internal;
+	if(!elina_linexpr0_is_linear(expr) || !opt_pk_lp_use(opk,oa,2)){
+		return false;
+	}
+	unsigned short int maxcols = oa->maxcols;
+	unsigned short int num_compa = oa->acl->size;
+	bool empty;
+	opt_pk_lp_t ** lp_arr = opt_pk_lp_array_alloc(opk,oa,&empty);
+	if(empty){
+		elina_interval_set_bottom(interval);
+		man->result.flag_exact = man->result.flag_best = !opk->strict;
+		return true;
+	}
+	unsigned short int ** ca_arr = opt_pk_lp_sorted_arrays(oa);
+	opt_numint_t * vec = opt_vector_alloc(maxcols);
+	opt_numint_t * ov = opt_vector_alloc(maxcols);
+	opt_vector_set_elina_linexpr0(opk,vec,expr,maxcols-opk->dec,1);
+	mpq_t inf, sup, den;
+	bool inf_infty, sup_infty;
+	mpq_init(inf);
+	mpq_init(sup);
+	mpq_init(den);
+	opt_pk_lp_bound_vector(opk,oa,lp_arr,ca_arr,vec,ov,true,inf,&inf_infty,true,sup,&sup_infty);
+	mpq_set_si(den,vec[0],1);
+	if(inf_infty){
+		elina_scalar_set_infty(interval->inf,-1);
+	}
+	else{
+		mpq_div(inf,inf,den);
+		elina_scalar_set_mpq(interval->inf,inf);
+	}
+	if(sup_infty){
+		elina_scalar_set_infty(interval->sup,1);
+	}
+	else{
+		mpq_div(sup,sup,den);
+		elina_scalar_set_mpq(interval->sup,sup);
+	}
+	/* the bounds of the closure are exact unless there are strict constraints */
+	man->result.flag_exact = man->result.flag_best = !opk->strict &&
+		elina_linexpr0_is_real(expr,maxcols-opk->dec);
+	mpq_clear(inf);
+	mpq_clear(sup);
+	mpq_clear(den);
+	opt_vector_free(vec,maxcols);
+	opt_vector_free(ov,maxcols);
+	opt_pk_lp_sorted_arrays_free(ca_arr,num_compa);
+	opt_pk_lp_array_free(lp_arr,num_compa);
+	return true;
+}
+
+/* Checks whether the constraint vec (equality if vec[0]==0, strict if
+   strict) is entailed by oa, using the bounds of its linear form. An
+   inequality only needs the lower bound, the upper bound of an equality
+   is only computed if its lower bound is null. */
+static bool opt_pk_lp_entails(opt_pk_internal_t *opk, opt_pk_array_t *oa,
+			      opt_pk_lp_t ** lp_arr, unsigned short int ** ca_arr,
+			      opt_numint_t * vec, opt_numint_t * ov, bool strict){
+	mpq_t inf, sup;
+	bool inf_infty, sup_infty, sat;
+	mpq_init(inf);
+	mpq_init(sup);
+	opt_pk_lp_bound_vector(opk,oa,lp_arr,ca_arr,vec,ov,true,inf,&inf_infty,false,sup,&sup_infty);
+	if(inf_infty){
+		sat = false;
+	}
+	else if(vec[0]){
+		sat = mpq_sgn(inf) >= (strict ? 1 : 0);
+	}
+	else if(mpq_sgn(inf)){
+		sat = false;
+	}
+	else{
+		opt_pk_lp_bound_vector(opk,oa,lp_arr,ca_arr,vec,ov,false,inf,&inf_infty,true,sup,&sup_infty);
+		sat = !sup_infty && !mpq_sgn(sup);
+	}
+	mpq_clear(inf);
+	mpq_clear(sup);
+	return sat;
+}
+
+bool opt_pk_sat_lincons_lp(elina_manager_t *man, opt_pk_array_t *oa,
+			   elina_lincons0_t *lincons0, bool *sat){
+	opt_pk_internal_t * opk = (opt_pk_internal_t *)man->internal;
+	elina_constyp_t constyp = lincons0->constyp;
+	if((constyp!=ELINA_CONS_EQ && constyp!=ELINA_CONS_SUPEQ && constyp!=ELINA_CONS_SUP) ||
+	   !elina_linexpr0_is_linear(lincons0->linexpr0) ||
+	   !opt_pk_lp_use(opk,oa,constyp==ELINA_CONS_EQ ? 2 : 1)){
+		return false;
+	}
+	unsigned short int maxcols = oa->maxcols;
+	unsigned short int num_compa = oa->acl->size;
+	bool empty;
+	opt_pk_lp_t ** lp_arr = opt_pk_lp_array_alloc(opk,oa,&empty);
+	if(empty){
+		*sat = true;
+		man->result.flag_exact = man->result.flag_best = !opk->strict;
+		return true;
+	}
+	unsigned short int ** ca_arr = opt_pk_lp_sorted_arrays(oa);
+	opt_numint_t * vec = opt_vector_alloc(maxcols);
+	opt_numint_t * ov = opt_vector_alloc(maxcols);
+	opt_vector_set_elina_linexpr0(opk,vec,lincons0->linexpr0,maxcols-opk->dec,1);
+	/* vec[0] holds the denominator, which is positive */
+	vec[0] = (constyp==ELINA_CONS_EQ) ? 0 : 1;
+	*sat = opt_pk_lp_entails(opk,oa,lp_arr,ca_arr,vec,ov,constyp==ELINA_CONS_SUP);
+	man->result.flag_exact = man->result.flag_best = *sat ? true :
+		(!opk->strict && elina_linexpr0_is_real(lincons0->linexpr0,maxcols-opk->dec));
+	opt_vector_free(vec,maxcols);
+	opt_vector_free(ov,maxcols);
+	opt_pk_lp_sorted_arrays_free(ca_arr,num_compa);
+	opt_pk_lp_array_free(lp_arr,num_compa);
+	return true;
+}
+
+bool opt_pk_is_leq_lp(elina_manager_t *man, opt_pk_array_t *oa,
+		      opt_pk_array_t *ob, bool *res){
+	opt_pk_internal_t * opk = (opt_pk_internal_t *)man->internal;
+	array_comp_list_t * aclb = ob->acl;
+	unsigned short int kb, num_compb = aclb->size;
+	size_t i, nbqueries = 0;
+	for(kb=0; kb < num_compb; kb++){
+		opt_pk_t * obk = ob->poly[kb];
+		if(obk->C){
+			nbqueries += obk->C->nbrows;
+		}
+	}
+	if(!opt_pk_lp_use(opk,oa,nbqueries)){
+		return false;
+	}
+	unsigned short int maxcols = oa->maxcols;
+	unsigned short int num_compa = oa->acl->size;
+	bool empty;
+	opt_pk_lp_t ** lp_arr = opt_pk_lp_array_alloc(opk,oa,&empty);
+	if(empty){
+		*res = true;
+		man->result.flag_exact = man->result.flag_best = !opk->strict;
+		return true;
+	}
+	unsigned short int ** ca_arr = opt_pk_lp_sorted_arrays(oa);
+	opt_numint_t * vec = opt_vector_alloc(maxcols);
+	opt_numint_t * ov = opt_vector_alloc(maxcols);
+	comp_list_t * clb = aclb->head;
+	*res = true;
+	for(kb=0; kb < num_compb && *res; kb++){
+		opt_pk_t * obk = ob->poly[kb];
+		opt_poly_obtain_C(man,obk,"is leq second argument");
+		if(opk->exn){
+			opk->exn = ELINA_EXC_NONE;
+			*res = false;
+			break;
+		}
+		if(!obk->C){
+			/* ob is empty and oa is not */
+			*res = false;
+			break;
+		}
+		unsigned short int * ca_b = to_sorted_array(clb,maxcols);
+		opt_matrix_t * C = obk->C;
+		for(i=0; i < C->nbrows; i++){
+			opt_numint_t * ci = C->p[i];
+			unsigned short int j;
+			opt_vector_clear(vec,maxcols);
+			vec[0] = ci[0];
+			vec[opt_polka_cst] = ci[opt_polka_cst];
+			for(j=0; j < clb->size; j++){
+				vec[ca_b[j]] = ci[opk->dec+j];
+			}
+			bool strict = opk->strict && ci[opt_polka_eps] < 0;
+			if(!opt_pk_lp_entails(opk,oa,lp_arr,ca_arr,vec,ov,strict)){
+				*res = false;
+				break;
+			}
+		}
+		free(ca_b);
+		clb = clb->next;
+	}
+	man->result.flag_exact = man->result.flag_best = *res || !opk->strict;
+	opt_vector_free(vec,maxcols);
+	opt_vector_free(ov,maxcols);
+	opt_pk_lp_sorted_arrays_free(ca_arr,num_compa);
+	opt_pk_lp_array_free(lp_arr,num_compa);
+	return true;
+}
@@ -0,0 +1,96 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ********************************************************************** */
+/* opt_pk_lp.h: linear programming on the constraint representation */
+/* ********************************************************************** */
+
+/* Exact (rational) two-phase simplex working directly on the matrix of
+   constraints of a block.  It allows bound queries, entailment checks and
+   redundancy removal without computing the generators of the block.  Strict
+   constraints are handled by working on the topological closure, which is
+   sound for all the queries below (but may be incomplete in strict mode). */
+
+#ifndef __OPT_PK_LP_H__
+#define __OPT_PK_LP_H__
+
+#include "opt_pk_config.h"
+#include "opt_pk_internal.h"
+#include "opt_pk_matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum opt_pk_lp_status_t {
+  OPT_PK_LP_OPTIMAL,
+  OPT_PK_LP_UNBOUNDED,
+  OPT_PK_LP_INFEASIBLE
+} opt_pk_lp_status_t;
+
+typedef struct opt_pk_lp_t {
+  mpq_t ** T;          /* feasible tableau, the last column is the right hand side */
+  mpq_t * obj;         /* objective row */
+  size_t * basis;      /* basic variable of each row */
+  size_t nbrows;
+  size_t nbcols;       /* number of variables, without the right hand side */
+  size_t dim;          /* number of (free) variables of the block */
+  size_t _maxrows;
+  size_t _maxcols;
+  bool infeasible;
+} opt_pk_lp_t;
+
+/* Builds the linear program associated to the rows of C not marked in
+   ignore (which may be NULL) and runs the first phase of the simplex */
+opt_pk_lp_t * opt_pk_lp_alloc(opt_pk_internal_t *opk, opt_matrix_t *C, char *ignore);
+void opt_pk_lp_free(opt_pk_lp_t *lp);
+
+/* Optimizes obj[opt_polka_cst] + sum_i obj[opk->dec+i]*x_i, the value is
+   stored in res when the status is OPT_PK_LP_OPTIMAL. The second phase
+   pivots T in place: every basis it reaches stays feasible, so the next
+   optimization starts from the basis of the previous one. */
+opt_pk_lp_status_t opt_pk_lp_optimize(opt_pk_internal_t *opk, opt_pk_lp_t *lp,
+				      opt_numint_t *obj, bool maximize, mpq_t res);
+
+/* Cost heuristic: returns true if nbqueries linear programs on the block are
+   expected to be cheaper than the conversion to generators */
+bool opt_pk_lp_is_preferable(opt_pk_internal_t *opk, opt_pk_t *o, size_t nbqueries);
+
+/* Removes the redundant inequalities of o->C, returns false if o is empty */
+bool opt_poly_lp_remove_redundant(opt_pk_internal_t *opk, opt_pk_t *o);
+
+/* Constraint-only versions of the queries. They return false if the manager
+   decides that the conversion to generators should be used instead, in that
+   case the result is not set. */
+bool opt_pk_bound_linexpr_lp(elina_manager_t *man, opt_pk_array_t *oa,
+			     elina_linexpr0_t *expr, elina_interval_t *interval);
+
+bool opt_pk_sat_lincons_lp(elina_manager_t *man, opt_pk_array_t *oa,
+			   elina_lincons0_t *lincons0, bool *sat);
+
+bool opt_pk_is_leq_lp(elina_manager_t *man, opt_pk_array_t *oa,
+		      opt_pk_array_t *ob, bool *res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
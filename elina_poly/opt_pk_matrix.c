@@ -73,6 +73,26 @@ opt_matrix_t* opt_matrix_alloc(size_t nbrows, unsigned short int nbcols, bool s)
   return mat;
 }
 
+/* Allocation of a zeroed matrix in the scratch memory of the current
+   operation.  It may be modified in place but neither resized nor freed; a
+   matrix that outlives the operation is promoted with opt_matrix_copy. */
+opt_matrix_t* opt_matrix_alloc_arena(opt_pk_arena_t* arena, size_t nbrows, unsigned short int nbcols, bool s)
+{
+  size_t i;
+
+  assert(nbcols>0 || nbrows==0);
+
+  opt_matrix_t* mat = (opt_matrix_t*)opt_pk_arena_alloc(arena,sizeof(opt_matrix_t));
+  mat->nbrows = mat->_maxrows = nbrows;
+  mat->nbcolumns = nbcols;
+  mat->_sorted = s;
+  mat->p = (opt_numint_t**)opt_pk_arena_alloc(arena,nbrows * sizeof(opt_numint_t*));
+  for (i=0;i<nbrows;i++){
+    mat->p[i] = (opt_numint_t*)opt_pk_arena_calloc(arena,nbcols,sizeof(opt_numint_t));
+  }
+  return mat;
+}
+
 /* Reallocation function, to scale up or to downsize a matrix */
 void opt_matrix_resize_rows(opt_matrix_t* mat, size_t nbrows)
 {
@@ -544,7 +564,7 @@ void opt_matrix_merge_sort_with(opt_pk_internal_t* opk,
   opt_matrix_resize_rows_lazy(oma, nbrowsa + omb->nbrows);
   
   /* one adds the coefficients of omb to oma */
-  for (i=0; i<oma->nbrows; i++){
+  for (i=0; i<omb->nbrows; i++){
       opt_vector_copy(oma->p[nbrowsa + i], omb->p[i], nbcols);
   }
   /* now we fill pp, which will contain the unsorted rows */
@@ -69,6 +69,7 @@ static inline bool opt_matrix_is_sorted(opt_matrix_t* mat)
 
 /* Basic Operations */
 opt_matrix_t* opt_matrix_alloc(size_t nbrows, unsigned short int nbcols, bool s);
+opt_matrix_t* opt_matrix_alloc_arena(opt_pk_arena_t* arena, size_t nbrows, unsigned short int nbcols, bool s);
 void      opt_matrix_resize_rows(opt_matrix_t* mat, size_t nbrows);
 void      opt_matrix_resize_rows_lazy(opt_matrix_t* mat, size_t nbrows);
 //void      matrix_minimize(matrix_t* mat);
@@ -135,6 +135,12 @@ bool opt_poly_meet_elina_lincons_array(bool lazy,
   quasilinear = elina_lincons0_array_is_quasilinear(array);
   /* quasilinearize if needed */
   if (!quasilinear){
+	if(!oa->F){
+		opt_poly_chernikova(man,oa,"quasilinearize");
+		if(opk->exn || !oa->F){
+			return !oa->C;
+		}
+	}
     	elina_interval_t ** env = opt_generator_to_box(opk,oa->F);
     	quasilinearize_elina_lincons0_array(array,env,true,ELINA_SCALAR_MPQ);
 	
@@ -363,7 +369,10 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
   for(k=0; k < num_compa; k++){
       opt_pk_t * oak = poly_a[k];
 	
-      if(opk->funopt->algorithm>=0){
+      if(opk->lazy){
+	 opt_poly_obtain_C(man,oak,"meet lincons input");
+      }
+      else if(opk->funopt->algorithm>=0){
 	 opt_poly_chernikova(man,oak,"meet lincons input");
       }
       else{
@@ -384,7 +393,7 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
       }
   }
   bool is_bottom = false;
-  char * is_trivial = (char *)calloc(size, sizeof(char));
+  char * is_trivial = (char *)opt_pk_arena_calloc(opk->arena,size, sizeof(char));
   /*****************************************
 	Handle Trivial constraints
   *****************************************/
@@ -458,8 +467,8 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
   array_comp_list_t * acl = union_array_comp_list(acla,aclb,maxcols);
   unsigned short int num_comp = acl->size;
  
-  unsigned short int ** ca_arr = (unsigned short int **)malloc(num_comp*sizeof(unsigned short int *));
-  unsigned short int * comp_size_map = (unsigned short int *)calloc(num_comp,sizeof(unsigned short int));
+  unsigned short int ** ca_arr = (unsigned short int **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(unsigned short int *));
+  unsigned short int * comp_size_map = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(unsigned short int));
   comp_list_t * cl = acl->head;
   for(k=0; k < num_comp; k++){
 	unsigned short int comp_size = cl->size; 
@@ -471,9 +480,9 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
   /**********************************
 	Factor linear constraints according to union
   ***********************************/
-  elina_lincons0_array_t * arr = (elina_lincons0_array_t *)malloc(num_comp*sizeof(elina_lincons0_array_t ));
-  unsigned short int * rmapb = (unsigned short int *)calloc(size, sizeof(unsigned short int));
-  size_t * nbmapb = (size_t *)calloc(num_comp,sizeof(size_t));
+  elina_lincons0_array_t * arr = (elina_lincons0_array_t *)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(elina_lincons0_array_t ));
+  unsigned short int * rmapb = (unsigned short int *)opt_pk_arena_calloc(opk->arena,size, sizeof(unsigned short int));
+  size_t * nbmapb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
   for(i=0; i < size; i++){
 	if(is_trivial[i]){
 		continue;
@@ -490,7 +499,7 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
 	arr[k] = elina_lincons0_array_make(nbmapb[k]);
   }
  
-  size_t * counter = (size_t *)calloc(num_comp,sizeof(size_t));
+  size_t * counter = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
   for(i =0; i < size; i++){
 	if(is_trivial[i]){
 		continue;
@@ -509,14 +518,14 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
 	Factor A according to union
   **********************************/
   
-  unsigned short int * rmapa = (unsigned short int *)calloc(num_compa, sizeof(unsigned short int));
-  size_t * nbmapa = (size_t *)calloc(num_comp,sizeof(size_t));
-  size_t * nbeqmapa = (size_t *)calloc(num_comp,sizeof(size_t));
-  char * disjoint_map = (char *)calloc(num_compa,sizeof(char));
-  size_t * nbgenmapa = (size_t *)calloc(num_comp,sizeof(size_t));
-  size_t * nblinemapa = (size_t *)calloc(num_comp,sizeof(size_t));
-  size_t * num_vertex_a = (size_t *)calloc(num_compa,sizeof(size_t));
-  size_t * num_vertex = (size_t *)calloc(num_comp,sizeof(size_t));
+  unsigned short int * rmapa = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compa, sizeof(unsigned short int));
+  size_t * nbmapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  size_t * nbeqmapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  char * disjoint_map = (char *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(char));
+  size_t * nbgenmapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  size_t * nblinemapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  size_t * num_vertex_a = (size_t *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(size_t));
+  size_t * num_vertex = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
   unsigned short int * array_map_a = create_array_map(acla,maxcols);
   comp_list_t * cla = acla->head;
   //unsigned short int * array_map_b = create_array_map(aclb,maxcols);
@@ -526,6 +535,10 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
 	rmapa[k] = res;
 	nbmapa[res] = nbmapa[res] + oak->C->nbrows;
 	nbeqmapa[res] = nbeqmapa[res] + oak->nbeq;
+	if(opk->lazy){
+		cla = cla->next;
+		continue;
+	}
 	opt_poly_obtain_satF(oak);
 	num_vertex_a[k] = opt_generator_rearrange(oak->F,oak->satF);
 	if(num_vertex_a[k]){
@@ -542,9 +555,9 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
   }
   
   opt_pk_t ** poly = (opt_pk_t **)malloc(num_comp*sizeof(opt_pk_t *));
-  size_t * counterC = (size_t *)calloc(num_comp,sizeof(size_t));
-  char * pos_con_map = (char *)calloc(num_comp,sizeof(char));
-  size_t * counterF = (size_t *)calloc(num_comp,sizeof(size_t));
+  size_t * counterC = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+  char * pos_con_map = (char *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(char));
+  size_t * counterF = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
   cl = acl->head;
   for(k=0; k < num_comp; k++){
 	unsigned short int comp_size = cl->size;
@@ -585,6 +598,11 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
 		unsigned short int comp_size = comp_size_map[k];
 		poly[k]->C = opt_matrix_alloc(nbmapa[k]+1, comp_size+2,false);
 		poly[k]->nbeq = nbeqmapa[k];		
+		if(opk->lazy){
+			/* the generators are recomputed on demand */
+			cl = cl->next;
+			continue;
+		}
 		unsigned short int k1;
 		unsigned short int nblines = 0;
 		unsigned short int * ca = ca_arr[k];
@@ -632,17 +650,21 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
 	}
   }	
 	
-  // cartesian product of vertices
-  cartesian_product_vertices_with_map(oa, poly, rmapa, ca_arr, num_vertex_a, num_vertex, counterF, disjoint_map);
+  if(!opk->lazy){
+	// cartesian product of vertices
+	cartesian_product_vertices_with_map(oa, poly, rmapa, ca_arr, num_vertex_a, num_vertex, counterF, disjoint_map);
 
-  // meet of rays
-  meet_rays_with_map(oa, poly, rmapa, ca_arr, num_vertex_a, counterF, disjoint_map);
-  char * exc_map = (char *)calloc(num_comp,sizeof(char));
+	// meet of rays
+	meet_rays_with_map(oa, poly, rmapa, ca_arr, num_vertex_a, counterF, disjoint_map);
+  }
+  char * exc_map = (char *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(char));
   is_bottom = false;	
   for(k=0; k < num_comp; k++){
 	if(nbmapb[k] && !is_bottom){
-		poly[k]->satC = opt_satmat_alloc(poly[k]->F->nbrows,opt_bitindex_size(poly[k]->C->nbrows));
-		is_bottom = opt_poly_meet_elina_lincons_array(opk->funopt->algorithm<0,
+		if(!opk->lazy){
+			poly[k]->satC = opt_satmat_alloc(poly[k]->F->nbrows,opt_bitindex_size(poly[k]->C->nbrows));
+		}
+		is_bottom = opt_poly_meet_elina_lincons_array(opk->lazy || opk->funopt->algorithm<0,
 				      man,poly[k],poly[k],arr+k);
 		if(opk->exn){
 			opk->exn = ELINA_EXC_NONE;
@@ -713,25 +735,6 @@ opt_pk_array_t* opt_pk_meet_lincons_array_cons(elina_manager_t* man, bool destru
 	op->is_bottom = true;
 	
   }
-  free(comp_size_map);
-  free(rmapa);
-  free(rmapb);
-  free(nbmapa);
-  free(nbmapb);
-  free(nbeqmapa);
-  free(counter);
-  free(counterC);
-  free(counterF);
-  free(ca_arr);
-  free(arr);
-  free(pos_con_map);
-  free(is_trivial);
-  free(disjoint_map);
-  free(num_vertex);
-  free(num_vertex_a);
-  free(nbgenmapa);
-  free(nblinemapa);
-  free(exc_map);
   free_array_comp_list(aclb);
   //for(k=0; k<num_comp; k++){
 //	opt_matrix_fprint(stdout,poly[k]->F);
@@ -748,7 +751,10 @@ opt_pk_array_t* opt_pk_meet_lincons_array(elina_manager_t* man, bool destructive
 	#if defined(TIMING)
 		start_timing();
 	#endif
+	opt_pk_internal_t* opk = (opt_pk_internal_t*)man->internal;
+	opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
 	opt_pk_array_t * op = opt_pk_meet_lincons_array_cons(man,destructive,oa,array);
+	opt_pk_arena_release(opk->arena,mark);
 	#if defined(TIMING)
 		record_timing(meet_lincons_time);
 	#endif
@@ -891,6 +897,11 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	array_comp_list_t * acla = oa->acl;
 	array_comp_list_t * aclb = ob->acl;
 	opt_pk_array_t *op = destructive ? oa : opt_pk_array_alloc(NULL,NULL,maxcols);
+	if(opk->lazy){
+		/* blocks kept in constraint form may turn out to be empty */
+		opt_pk_convert(man,oa,"join input");
+		opt_pk_convert(man,ob,"join input");
+	}
 	if(oa->is_bottom || !acla){
 		if(destructive){
 			opt_poly_array_clear(opk,op);
@@ -917,7 +928,7 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	}
 	unsigned short int * map_a = create_array_map(acla,maxcols);
         unsigned short int * map_b = create_array_map(aclb,maxcols);
-	elina_dim_t * tdim_a = (elina_dim_t *)calloc(maxcols,sizeof(elina_dim_t));
+	elina_dim_t * tdim_a = (elina_dim_t *)opt_pk_arena_calloc(opk->arena,maxcols,sizeof(elina_dim_t));
 	size_t size_a = 0;
 	comp_list_t *cla = acla->head;
 	while(cla!=NULL){
@@ -948,7 +959,7 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	}	
 	
 	
-	elina_dim_t * tdim_b = (elina_dim_t *)calloc(maxcols,sizeof(elina_dim_t));
+	elina_dim_t * tdim_b = (elina_dim_t *)opt_pk_arena_calloc(opk->arena,maxcols,sizeof(elina_dim_t));
 	size_t size_b = 0;
 	comp_list_t *clb = aclb->head;
 	while(clb!=NULL){
@@ -974,8 +985,6 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	}
 	free(map_b);
 	free(map_a);
-	free(tdim_a);	
-	free(tdim_b);
 
 	/***********************
 			Minimize A and compute components that could be connected by sigmas
@@ -984,7 +993,7 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	acla = tmp_a->acl;
 	unsigned short int num_compa = acla->size;
 	cla = acla->head;
-	size_t * num_vertex_a = (size_t *)calloc(num_compa,sizeof(size_t));
+	size_t * num_vertex_a = (size_t *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(size_t));
 	for(k=0; k < num_compa; k++){
 		opt_pk_t * oak = poly_a[k];
 		
@@ -1042,7 +1051,7 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	aclb = tmp_b->acl;
 	unsigned short int num_compb = aclb->size;
 	clb = aclb->head;
-	size_t * num_vertex_b = (size_t *)calloc(num_compb,sizeof(size_t));
+	size_t * num_vertex_b = (size_t *)opt_pk_arena_calloc(opk->arena,num_compb,sizeof(size_t));
 	for(k=0; k < num_compb; k++){
 		opt_pk_t * obk = poly_b[k];
 		if(opk->funopt->algorithm >=0){
@@ -1076,33 +1085,33 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	***************************/
 	array_comp_list_t * acl = union_array_comp_list(acla,aclb,maxcols);
 	unsigned short int num_comp = acl->size;
-	char ** var_map_a = (char **)malloc(num_comp*sizeof(char*));
-	char ** var_map_b = (char **)malloc(num_comp*sizeof(char*));
-	opt_pk_t ** poly1 = (opt_pk_t **)malloc(num_comp*sizeof(opt_pk_t *));
- 	opt_pk_t ** poly2 = (opt_pk_t **)malloc(num_comp*sizeof(opt_pk_t *));
-	size_t * num_vertex1 = (size_t *)calloc(num_comp,sizeof(size_t));
-	size_t * num_vertex2 = (size_t *)calloc(num_comp,sizeof(size_t));	
-	size_t * nbmapCa = (size_t *)calloc(num_comp,sizeof(size_t));
-	size_t * nblinemapa = (size_t *)calloc(num_comp,sizeof(size_t));
-	size_t * nbeqmapa = (size_t *)calloc(num_comp,sizeof(size_t));
-	size_t * nbmapCb = (size_t *)calloc(num_comp,sizeof(size_t));
-	size_t * nblinemapb = (size_t *)calloc(num_comp,sizeof(size_t));
-	size_t * nbeqmapb = (size_t *)calloc(num_comp,sizeof(size_t));		
-	unsigned short int ** ca_arr = (unsigned short int **)malloc(num_comp*sizeof(unsigned short int *));
+	char ** var_map_a = (char **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(char*));
+	char ** var_map_b = (char **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(char*));
+	opt_pk_t ** poly1 = (opt_pk_t **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(opt_pk_t *));
+ 	opt_pk_t ** poly2 = (opt_pk_t **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(opt_pk_t *));
+	size_t * num_vertex1 = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+	size_t * num_vertex2 = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));	
+	size_t * nbmapCa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+	size_t * nblinemapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+	size_t * nbeqmapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+	size_t * nbmapCb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+	size_t * nblinemapb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
+	size_t * nbeqmapb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));		
+	unsigned short int ** ca_arr = (unsigned short int **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(unsigned short int *));
 
 
 	comp_list_t * cl = acl->head;
         for(k=0; k < num_comp; k++){
-		var_map_a[k] = (char *)calloc(cl->size, sizeof(char)); 
-		var_map_b[k] = (char *)calloc(cl->size, sizeof(char)); 
+		var_map_a[k] = (char *)opt_pk_arena_calloc(opk->arena,cl->size, sizeof(char));
+		var_map_b[k] = (char *)opt_pk_arena_calloc(opk->arena,cl->size, sizeof(char));
 		ca_arr[k] = to_sorted_array(cl,maxcols);
 		cl = cl->next;
 	}
 	/**************************
 		Partition A according to union 
 	***************************/
-	unsigned short int * rmapa = (unsigned short int *)calloc(num_compa,sizeof(unsigned short int));
-	size_t * nbmapFa = (size_t *)calloc(num_comp,sizeof(size_t));
+	unsigned short int * rmapa = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compa,sizeof(unsigned short int));
+	size_t * nbmapFa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
 	
 	cla = acla->head;
 	for(k=0; k < num_compa; k++){
@@ -1137,9 +1146,9 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	/**************************
 		Partition B according to union
 	***************************/
-	unsigned short int * rmapb = (unsigned short int *)calloc(num_compb,sizeof(unsigned short int));
+	unsigned short int * rmapb = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compb,sizeof(unsigned short int));
 	
-	size_t * nbmapFb = (size_t *)calloc(num_comp,sizeof(size_t));
+	size_t * nbmapFb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
 	clb = aclb->head;
 	for(k=0; k < num_compb; k++){
 		opt_pk_t * obk = poly_b[k];
@@ -1177,10 +1186,10 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	}
 	
 	cl = acl->head;
-	size_t * counterFa = (size_t *)calloc(num_comp, sizeof(size_t));
-	size_t * counterFb = (size_t *)calloc(num_comp, sizeof(size_t));
-	size_t * counterCa = (size_t *)calloc(num_comp, sizeof(size_t));
-	size_t * counterCb = (size_t *)calloc(num_comp, sizeof(size_t));
+	size_t * counterFa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp, sizeof(size_t));
+	size_t * counterFb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp, sizeof(size_t));
+	size_t * counterCa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp, sizeof(size_t));
+	size_t * counterCb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp, sizeof(size_t));
 	//char ** vertex_map = (char **)malloc(num_comp*sizeof(char *));
 	for(k = 0; k < num_comp; k++){
 		
@@ -1203,8 +1212,10 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 			}
 			gen_size = nbmapFa[k] + 2*num_vertex1[k] + nblines;
 		}
-		poly1[k]->F = opt_matrix_alloc(gen_size,comp_size+2,false);
-		poly1[k]->C = opt_matrix_alloc(nbmapCa[k]+1+nbeq,comp_size+2,false);
+		/* the operand of A is only ever scratch, the one of B becomes
+		   the result component when B includes A and stays on the heap */
+		poly1[k]->F = opt_matrix_alloc_arena(opk->arena,gen_size,comp_size+2,false);
+		poly1[k]->C = opt_matrix_alloc_arena(opk->arena,nbmapCa[k]+1+nbeq,comp_size+2,false);
 		poly1[k]->nbline = nblinemapa[k]+nblines;
 		poly1[k]->nbeq = nbeqmapa[k]+nbeq;
 		
@@ -1253,7 +1264,7 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	/***********************
 		Meet constraints of A
 	************************/
-	char * pos_con_map = (char *)calloc(num_comp, sizeof(char)); 
+	char * pos_con_map = (char *)opt_pk_arena_calloc(opk->arena,num_comp, sizeof(char)); 
 	for(k=0; k < num_comp; k++){
 		pos_con_map[k] = 1;
 	}
@@ -1379,7 +1390,7 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	unsigned short int k1 = 0;
 	comp_list_t * clp = create_comp_list();
 	array_comp_list_t * res = create_array_comp_list();
-	char * clp_map = (char *)calloc(maxcols, sizeof(char));
+	char * clp_map = (char *)opt_pk_arena_calloc(opk->arena,maxcols, sizeof(char));
 	size_t num_vertex1a = 0, num_vertex2b=0;
 	size_t nbF = 0, nbC = 0, nbeq = 0, nbline = 0, nblinea = 0;
 	cl = acl->head;
@@ -1388,8 +1399,9 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 		unsigned short int comp_size = cl->size;
 		if(pos_con_map[k]==1){	
 			poly[k2] = opt_poly_alloc(comp_size,0);		
-			poly[k2]->C = poly1[k]->C;
-			poly[k2]->F = poly1[k]->F;
+			/* not taken at the moment, A lives in the scratch memory */
+			poly[k2]->C = opt_matrix_copy(poly1[k]->C);
+			poly[k2]->F = opt_matrix_copy(poly1[k]->F);
 			poly[k2]->nbeq = poly1[k]->nbeq;
 			poly[k2]->nbline = poly1[k]->nbline;
 			poly[k2]->satF = opt_satmat_alloc(poly[k2]->C->nbrows,opt_bitindex_size(poly[k2]->F->nbrows));
@@ -1403,6 +1415,8 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 			poly[k2] = opt_poly_alloc(comp_size,0);
 			poly[k2]->C = poly2[k]->C;
 			poly[k2]->F = poly2[k]->F;
+			poly2[k]->C = NULL;
+			poly2[k]->F = NULL;
 			opt_matrix_sort_rows(opk,poly[k2]->F);
 			poly[k2]->nbeq = poly2[k]->nbeq;
 			poly[k2]->nbline = poly2[k]->nbline;
@@ -1440,7 +1454,6 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 		cl = cl->next;
 	}
 	
-	free(clp_map);
 	if(flag){
 		
 		unsigned short int comp_size = clp->size;
@@ -1568,47 +1581,15 @@ opt_pk_array_t * opt_poly_join_gen(elina_manager_t *man, opt_pk_array_t *oa, opt
 	//unsigned short int k2;
 	//unsigned short int nc = num_comp;
 	for(k=0; k< num_comp; k++){
-		if(pos_con_map[k]==1){
-			opt_poly_clear(poly2[k]);
-		}
-		else if(pos_con_map[k]==2){
-			opt_poly_clear(poly1[k]);
-		}
-		else{
-			opt_poly_clear(poly1[k]);
-			opt_poly_clear(poly2[k]);
-			
+		/* the matrices of A are released with the scratch memory */
+		if(poly2[k]->C){
+			opt_matrix_free(poly2[k]->C);
+			opt_matrix_free(poly2[k]->F);
 		}
 		free(poly1[k]);
 		free(poly2[k]);
 		free(ca_arr[k]);
-		free(var_map_a[k]);
-		free(var_map_b[k]);
-	}
-	free(rmapa);
-	free(rmapb);
-	free(counterFa);
-	free(counterFb);
-	free(counterCa);
-	free(counterCb);
-	free(nbmapCa);
-	free(nbmapCb);
-	free(nbmapFa);
-	free(nbmapFb);
-	free(nbeqmapa);
-	free(nbeqmapb);
-	free(nblinemapa);
-	free(nblinemapb);
-	free(var_map_a);
-	free(var_map_b);
-	free(ca_arr);
-	free(poly1);
-	free(poly2);
-	free(num_vertex1);
-	free(num_vertex2);
-	free(num_vertex_a);
-	free(num_vertex_b);
-	free(pos_con_map);
+	}
 	free_array_comp_list(acl);
 	//opt_matrix_fprint(stdout,poly[0]->C);
 	//opt_matrix_fprint(stdout,poly[0]->F);
@@ -1745,7 +1726,10 @@ opt_pk_array_t* opt_pk_join(elina_manager_t* man, bool destructive, opt_pk_array
   #if defined (TIMING)
 	start_timing();
   #endif
+  opt_pk_internal_t* opk = (opt_pk_internal_t*)man->internal;
+  opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
   res = opt_poly_join_gen(man,oa,ob,destructive);
+  opt_pk_arena_release(opk->arena,mark);
   #if defined (TIMING)
 	record_timing(join_time);
   #endif
@@ -1770,13 +1754,13 @@ void opt_poly_meet(bool meet,
 	array_comp_list_t *acl = union_array_comp_list(acla, aclb, maxcols);
 	unsigned short int num_comp = acl->size;
 	opt_pk_t **poly = (opt_pk_t **)malloc(num_comp*sizeof(opt_pk_t *));
-	size_t * nbeqmap = (size_t *)calloc(num_comp,sizeof(size_t));
+	size_t * nbeqmap = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
 	/*****************************
 		Factor A according to union
 	*****************************/	
 	opt_pk_t ** poly_a = oa->poly;	
-	unsigned short int * rmapa = (unsigned short int *)calloc(num_compa, sizeof(unsigned short int));
-	size_t * nbmapa = (size_t *)calloc(num_comp,sizeof(size_t));
+	unsigned short int * rmapa = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compa, sizeof(unsigned short int));
+	size_t * nbmapa = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
 	comp_list_t * cla = acla->head;
 	size_t i;
 	unsigned short int k,j;
@@ -1794,8 +1778,8 @@ void opt_poly_meet(bool meet,
 		Factor B according to union
 	*****************************/		
 	opt_pk_t ** poly_b = ob->poly;
-	unsigned short int * rmapb = (unsigned short int *)calloc(num_compb, sizeof(unsigned short int));
-	size_t * nbmapb = (size_t *)calloc(num_comp,sizeof(size_t));
+	unsigned short int * rmapb = (unsigned short int *)opt_pk_arena_calloc(opk->arena,num_compb, sizeof(unsigned short int));
+	size_t * nbmapb = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp,sizeof(size_t));
 	comp_list_t * clb = aclb->head;
 	for(k = 0; k < num_compb; k++){
 		opt_pk_t * obk = poly_b[k];
@@ -1809,8 +1793,8 @@ void opt_poly_meet(bool meet,
 	}
 
 	comp_list_t * cl = acl->head;
-	size_t * counterC = (size_t *)calloc(num_comp, sizeof(size_t));
-	unsigned short int ** ca_arr = (unsigned short int **)malloc(num_comp*sizeof(unsigned short int *));
+	size_t * counterC = (size_t *)opt_pk_arena_calloc(opk->arena,num_comp, sizeof(size_t));
+	unsigned short int ** ca_arr = (unsigned short int **)opt_pk_arena_alloc(opk->arena,num_comp*sizeof(unsigned short int *));
 	for(k = 0; k < num_comp; k++){
 		unsigned short int comp_size = cl->size;
 		poly[k] = opt_poly_alloc(comp_size,0);
@@ -1932,13 +1916,6 @@ void opt_poly_meet(bool meet,
 		free(ca_arr[k]);
 	}
 	
-	free(rmapa);
-	free(rmapb);
-	free(nbmapa);
-	free(nbmapb);
-	free(nbeqmap);
-	free(ca_arr);
-	free(counterC);
 	//#if defined (CONVERT)
 	//	free(nbgenmap);
 	//	free(nblinemap);
@@ -2050,7 +2027,10 @@ opt_pk_array_t* opt_pk_meet(elina_manager_t* man, bool destructive, opt_pk_array
 	#if defined (TIMING)
 		start_timing();
 	#endif
+	opt_pk_internal_t* opk = (opt_pk_internal_t*)man->internal;
+	opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
 	opt_pk_array_t *op = opt_pk_meet_cons(man,destructive,oa,ob);
+	opt_pk_arena_release(opk->arena,mark);
 	#if defined (TIMING)
 		record_timing(meet_time);
 	#endif
@@ -26,6 +26,8 @@
 #include "opt_pk_representation.h"
 #include "opt_pk_constructor.h"
 #include "opt_pk_meetjoin.h"
+#include "opt_pk_satmat.h"
+#include "opt_mf_qsort.h"
 
 int select_variable_gauss(opt_pk_internal_t *opk, opt_matrix_t *oc,  opt_numint_t *cons, size_t nbeq, elina_dim_t *tdim, size_t size, char *rmap){
 	int res = -1;
@@ -206,36 +208,147 @@ bool gauss_project(opt_pk_internal_t *opk, opt_pk_t *o, elina_dim_t *tdim, size_
 
 
 
-void select_variable(opt_pk_internal_t * opk, elina_dim_t *tdim, size_t size, opt_matrix_t * oc,  int *nbadd, int *maxadd){
-	//printf("Start %d %d\n",oc->nbrows,oc->nbcolumns);
-	//opt_matrix_fprint(stdout,oc);
-	//fflush(stdout);
-	size_t i, j, k;
+/* Below this number of coefficient updates, the combination step of the
+   Fourier-Motzkin elimination runs in the calling thread */
+#define OPT_FM_PARALLEL_THRESHOLD 65536
+
+/* The lazy forget falls back to the generators when Fourier-Motzkin
+   returns more than this many times the number of input constraints */
+#define OPT_FM_LAZY_GROWTH 2
+
+/* Outcome of combining a pair of inequalities */
+#define OPT_FM_DROP 0
+#define OPT_FM_KEEP 1
+#define OPT_FM_POSITIVITY 2
+#define OPT_FM_BOTTOM 3
+#define OPT_FM_OVERFLOW 4
+
+/************************************
+	History of the rows during Fourier-Motzkin: hist records the input
+	inequalities a row was derived from, vars the projected variables
+	occurring in those inputs and elim the variables eliminated so far.
+	hist and vars are kept aligned with the rows of the matrix.
+***********************************/
+typedef struct opt_fm_history_t {
+	opt_satmat_t *hist;
+	opt_satmat_t *vars;
+	opt_bitstring_t *elim;
+	int *vidx; /* column -> index in vars, -1 if not projected */
+} opt_fm_history_t;
+
+typedef struct opt_fm_job_t {
+	size_t dec;
+	opt_matrix_t *oc;
+	opt_fm_history_t *fh;
+	size_t *ocm;
+	size_t *ocp;
+	size_t nbp;
+	size_t nbcons;
+	size_t dim;
+	char *status;
+} opt_fm_job_t;
+
+static inline size_t opt_fm_popcount_or(opt_bitstring_t *a, opt_bitstring_t *b, opt_bitstring_t *mask, size_t size){
+	size_t k, res = 0;
+	for(k=0; k < size; k++){
+		opt_bitstring_t w = a[k] | b[k];
+		if(mask){
+			w = w & mask[k];
+		}
+		res += __builtin_popcount(w);
+	}
+	return res;
+}
+
+static void opt_fm_history_init(opt_fm_history_t *fh, opt_pk_internal_t *opk, opt_matrix_t *oc, elina_dim_t *tdim, size_t size){
+	size_t nbcons = oc->nbrows;
+	size_t nbcolumns = oc->nbcolumns;
+	size_t i,j;
+	fh->hist = opt_satmat_alloc(oc->_maxrows, opt_bitindex_size(nbcons > 0 ? nbcons : 1));
+	fh->vars = opt_satmat_alloc(oc->_maxrows, opt_bitindex_size(size > 0 ? size : 1));
+	fh->elim = opt_bitstring_alloc(fh->vars->nbcolumns);
+	opt_bitstring_clear(fh->elim, fh->vars->nbcolumns);
+	fh->vidx = (int *)malloc(nbcolumns*sizeof(int));
+	for(j=0; j < nbcolumns; j++){
+		fh->vidx[j] = -1;
+	}
+	for(j=0; j < size; j++){
+		fh->vidx[opk->dec + tdim[j]] = j;
+	}
+	for(i=0; i < nbcons; i++){
+		opt_numint_t *pi = oc->p[i];
+		if(!pi[0]){
+			continue;
+		}
+		opt_satmat_set(fh->hist, i, opt_bitindex_init(i));
+		for(j=0; j < size; j++){
+			if(pi[opk->dec + tdim[j]]){
+				opt_satmat_set(fh->vars, i, opt_bitindex_init(j));
+			}
+		}
+	}
+}
+
+static void opt_fm_history_free(opt_fm_history_t *fh){
+	opt_satmat_free(fh->hist);
+	opt_satmat_free(fh->vars);
+	opt_bitstring_free(fh->elim);
+	free(fh->vidx);
+}
+
+static void opt_fm_history_resize(opt_fm_history_t *fh, size_t nbrows){
+	if(fh->hist->nbrows < nbrows){
+		opt_satmat_resize_rows(fh->hist, nbrows);
+		opt_satmat_resize_rows(fh->vars, nbrows);
+	}
+}
+
+static inline void opt_fm_exch_rows(opt_matrix_t *oc, opt_fm_history_t *fh, size_t l1, size_t l2){
+	if(l1!=l2){
+		opt_matrix_exch_rows(oc, l1, l2);
+		opt_satmat_exch_rows(fh->hist, l1, l2);
+		opt_satmat_exch_rows(fh->vars, l1, l2);
+	}
+}
+
+/************************************
+	Greedy elimination order: pick the variable producing the fewest
+	new inequalities, p*m - p - m, and break ties by the number of
+	other projected variables it co-occurs with, so as to limit
+	fill-in. The chosen variable is put at the last position of tdim.
+***********************************/
+void select_variable(opt_pk_internal_t * opk, elina_dim_t *tdim, size_t size, opt_matrix_t * oc,  long *nbadd, long *maxadd){
+	size_t i, j;
 	size_t * p = (size_t *)calloc(size,sizeof(size_t));
 	size_t * m = (size_t *)calloc(size,sizeof(size_t));
+	size_t * fill = (size_t *)calloc(size,sizeof(size_t));
 	size_t nbcons = oc->nbrows;
 	for(i = 0; i < nbcons; i++){
 		opt_numint_t *pi = oc->p[i];
+		size_t nz = 0;
 		for(j = 0; j < size; j++){
 			opt_numint_t pj = pi[opk->dec + tdim[j]];
 			if(pj > 0){
 				p[j]++;
+				nz++;
 			}
 			else if(pj < 0){
 				m[j]++;
+				nz++;
+			}
+		}
+		if(nz > 1){
+			for(j = 0; j < size; j++){
+				if(pi[opk->dec + tdim[j]]){
+					fill[j] += nz - 1;
+				}
 			}
 		}
-		//for(j=0; j < size; j++)
-		//printf("%d %d %d\n",j,p[j],m[j]);
 	}
-	//printf("AA\n");
-	//fflush(stdout);
 	size_t ind = 0;
-	*nbadd = nbcons*nbcons;
-	*maxadd = nbcons*nbcons;
 	for(i = 0; i < size; i++){
-		int tmp = p[i]*m[i] - p[i] - m[i];
-		if(tmp < *nbadd){
+		long tmp = (long)(p[i]*m[i]) - (long)p[i] - (long)m[i];
+		if(i==0 || tmp < *nbadd || (tmp==*nbadd && fill[i] < fill[ind])){
 			*maxadd = p[i]*m[i];
 			*nbadd = tmp;
 			ind = i;
@@ -250,102 +363,272 @@ void select_variable(opt_pk_internal_t * opk, elina_dim_t *tdim, size_t size, op
 	tdim[ind] = tmp;
 	free(p);
 	free(m);
-	
+	free(fill);
+}
+
+/************************************
+	Combine pi (negative coefficient for dim) with pj (positive
+	coefficient for dim) into dst, which must not alias the inputs.
+	Uses no shared scratch space so that it can run in several threads.
+***********************************/
+static char opt_fm_combine(size_t dec, opt_numint_t *dst, opt_numint_t *pi, opt_numint_t *pj, size_t dim, size_t nbcolumns){
+	opt_numint_t fi = -pi[dim];
+	opt_numint_t fj = pj[dim];
+	opt_numint_t gcd = opt_numint_gcd(fi,fj);
+	size_t k;
+	fi = fi/gcd;
+	fj = fj/gcd;
+	opt_numint_t xi1 = INT64_MAX/fi, xi2 = INT64_MIN/fi;
+	opt_numint_t xj1 = INT64_MAX/fj, xj2 = INT64_MIN/fj;
+	bool flag = false;
+	gcd = 0;
+	dst[0] = pi[0];
+	for(k=1; k < nbcolumns && !flag; k++){
+		opt_numint_t ti, tj;
+		flag = opt_int64_mult(pi[k],fj,xj1,xj2,&ti) ||
+		       opt_int64_mult(pj[k],fi,xi1,xi2,&tj) ||
+		       opt_int64_add(ti,tj,&dst[k]);
+		if(dst[k]){
+			gcd = opt_numint_gcd(gcd,dst[k]);
+		}
+	}
+	if(flag){
+		return OPT_FM_OVERFLOW;
+	}
+	dst[dim] = 0;
+	if(gcd > 1){
+		for(k=1; k < nbcolumns; k++){
+			dst[k] = dst[k]/gcd;
+		}
+	}
+	for(k=dec; k < nbcolumns; k++){
+		if(dst[k]){
+			return OPT_FM_KEEP;
+		}
+	}
+	if(dst[1] < 0){
+		return OPT_FM_BOTTOM;
+	}
+	return dst[1] > 0 ? OPT_FM_POSITIVITY : OPT_FM_DROP;
 }
 
-bool fourier_motzkin(opt_pk_internal_t *opk, elina_dim_t dim, opt_matrix_t * oc){
+/************************************
+	Combine every row ocm[i], start <= i < end, with every row ocp[j].
+	The result for the pair (i,j) goes into row nbcons + i*nbp + j.
+	Pairs whose combined history is larger than one plus the number of
+	eliminated variables occurring in it are redundant (Chernikov's
+	criterion with Kohler's count of implicitly eliminated variables)
+	and are not generated.
+***********************************/
+static void opt_fm_combine_range(void *args, size_t start, size_t end){
+	opt_fm_job_t *data = (opt_fm_job_t *)args;
+	opt_matrix_t *oc = data->oc;
+	opt_fm_history_t *fh = data->fh;
+	size_t hsize = fh->hist->nbcolumns;
+	size_t vsize = fh->vars->nbcolumns;
+	size_t nbcolumns = oc->nbcolumns;
+	size_t i,j,k;
+	for(i=start; i < end; i++){
+		size_t mind = data->ocm[i];
+		opt_numint_t *pi = oc->p[mind];
+		opt_bitstring_t *hi = fh->hist->p[mind];
+		opt_bitstring_t *vi = fh->vars->p[mind];
+		for(j=0; j < data->nbp; j++){
+			size_t pind = data->ocp[j];
+			size_t slot = i*data->nbp + j;
+			size_t row = data->nbcons + slot;
+			opt_bitstring_t *hj = fh->hist->p[pind];
+			opt_bitstring_t *vj = fh->vars->p[pind];
+			size_t nbh = opt_fm_popcount_or(hi,hj,NULL,hsize);
+			size_t nbv = opt_fm_popcount_or(vi,vj,fh->elim,vsize);
+			if(nbh > nbv + 1){
+				data->status[slot] = OPT_FM_DROP;
+				continue;
+			}
+			data->status[slot] = opt_fm_combine(data->dec, oc->p[row], pi, oc->p[pind], data->dim, nbcolumns);
+			if(data->status[slot]==OPT_FM_KEEP || data->status[slot]==OPT_FM_POSITIVITY){
+				for(k=0; k < hsize; k++){
+					fh->hist->p[row][k] = hi[k] | hj[k];
+				}
+				for(k=0; k < vsize; k++){
+					fh->vars->p[row][k] = vi[k] | vj[k];
+				}
+			}
+		}
+	}
+}
+
+bool fourier_motzkin(opt_pk_internal_t *opk, elina_dim_t dim, opt_matrix_t * oc, opt_fm_history_t *fh){
 	size_t nbcons = oc->nbrows;
 	size_t nbcolumns = oc->nbcolumns;	
 	size_t *ocm = (size_t*)calloc(nbcons,sizeof(size_t));	
 	size_t *ocp = (size_t *)calloc(nbcons, sizeof(size_t));
-	size_t *ocn = (size_t *)calloc(nbcons, sizeof(size_t));
-	size_t nbcons1 = 0, nbcons2 = 0, nbcons3 = 0;
-	/****
-		Result matrix will add at most nbadd inequalities
-	*****/
-	//opt_matrix_t *ocn = opt_matrix_alloc(nbcons + nbadd, nbcolumns, false);
-	size_t i, j;
+	size_t nbm = 0, nbp = 0;
+	size_t i, s;
 	for(i= 0; i < nbcons; i++){
 		opt_numint_t * pi = oc->p[i];
 		if(pi[dim] > 0){
-			ocp[nbcons2] = i;
-			nbcons2++;
+			ocp[nbp] = i;
+			nbp++;
 		}
 		else if(pi[dim] < 0){
-			ocm[nbcons1] = i;
-			nbcons1++;
+			ocm[nbm] = i;
+			nbm++;
+		}
+	}
+	opt_bitstring_set(fh->elim, opt_bitindex_init(fh->vidx[dim]));
+	/****
+		Result matrix will add at most nbpairs inequalities
+	*****/
+	size_t nbpairs = nbm*nbp;
+	char *status = NULL;
+	if(nbpairs){
+		opt_matrix_resize_rows_lazy(oc, nbcons + nbpairs);
+		oc->nbrows = nbcons;
+		opt_fm_history_resize(fh, oc->_maxrows);
+		status = (char *)malloc(nbpairs*sizeof(char));
+		opt_fm_job_t job;
+		job.dec = opk->dec;
+		job.oc = oc;
+		job.fh = fh;
+		job.ocm = ocm;
+		job.ocp = ocp;
+		job.nbp = nbp;
+		job.nbcons = nbcons;
+		job.dim = dim;
+		job.status = status;
+		/* rows of ocm are handed out one at a time, the pairs they
+		   generate differ a lot in cost because of the pruning */
+		if(nbpairs*nbcolumns < OPT_FM_PARALLEL_THRESHOLD){
+			opt_fm_combine_range(&job,0,nbm);
 		}
 		else{
-			ocn[nbcons3] = i;
-			nbcons3++;
+			if(!opk->pool){
+				opk->pool = opt_pk_thread_pool_alloc(0);
+			}
+			opt_pk_thread_pool_run(opk->pool,nbm,1,opt_fm_combine_range,&job);
 		}
 	}
-	size_t s = 0;
-	bool flag = false;
-	for(i = 0; i < nbcons1; i++){
-	   size_t mind = ocm[i];
-	   opt_numint_t * pi = oc->p[mind];
-	   opt_numint_t fi = -pi[dim];
-	   for(j = 0; j < nbcons2; j++){
-		size_t pind = ocp[j];
-		opt_numint_t * pj = oc->p[pind];
-		opt_numint_t fj = pj[dim];
-		opt_numint_t * tmp1, *tmp2;
-		//printf("start\n");
-		//opt_vector_print(pi,nbcolumns);
-		//opt_vector_print(pj,nbcolumns);
-		if(opt_numint_abs(fi)!=opt_numint_abs(fj)){
-		   tmp1 = opt_vector_scalar_product(opk, pi,fj, nbcolumns);
-		   tmp2 = opt_vector_scalar_product(opk, pj,fi, nbcolumns);
-		}else{
-		   tmp1 = opt_vector_alloc(nbcolumns);
-		   tmp2 = opt_vector_alloc(nbcolumns);
-		   opt_vector_copy(tmp1,pi,nbcolumns);
-		   opt_vector_copy(tmp2,pj,nbcolumns);
-		}
-		opt_vector_sum(opk, tmp1, tmp2, nbcolumns);
-		//opt_vector_print(tmp1,nbcolumns);
-		opt_vector_simplify(opk, tmp1, nbcolumns);
-		//opt_vector_print(tmp1,nbcolumns);
-		if(!opt_vector_is_null_expr(opk,tmp1,nbcolumns)){
-			opt_numint_t * dst = oc->p[s+nbcons];
-			opt_vector_copy(dst,tmp1,nbcolumns);
-			s++;
-		}
-		else if(!flag && opt_vector_is_positivity_constraint(opk,tmp1,nbcolumns)){
-			opt_numint_t * dst = oc->p[s+nbcons];
-			opt_vector_copy(dst,tmp1,nbcolumns);
-			flag = true;
+	/****
+		Keep the rows not involving dim followed by the new rows
+	*****/
+	s = 0;
+	for(i=0; i < nbcons; i++){
+		if(!oc->p[i][dim]){
+			opt_fm_exch_rows(oc,fh,s,i);
 			s++;
 		}
-		else if(tmp1[1] < 0){
-			//printf("bottom here\n");
-			//opt_vector_print(tmp1,nbcolumns);
-			free(tmp1);
-			free(tmp2);
+	}
+	bool flag = false;
+	for(i=0; i < nbpairs; i++){
+		char st = status[i];
+		if(st==OPT_FM_BOTTOM){
+			free(status);
 			free(ocm);
 			free(ocp);
-			free(ocn);
 			return false;
 		}
-		free(tmp1);
-		free(tmp2);
-	   }
-	}
-	for(i=0; i <nbcons3; i++){
-		size_t nind = ocn[i];
-		opt_matrix_exch_rows(oc,i,nind);
-	}
-	for(i=0; i < s; i++ ){
-		opt_matrix_exch_rows(oc,nbcons3+i,nbcons+i);
+		/* dropping an overflowing combination over-approximates the
+		   projection, the caller has to recover from the exception */
+		if(st==OPT_FM_OVERFLOW){
+			opk->exn = ELINA_EXC_OVERFLOW;
+			continue;
+		}
+		if(st==OPT_FM_DROP || (st==OPT_FM_POSITIVITY && flag)){
+			continue;
+		}
+		if(st==OPT_FM_POSITIVITY){
+			flag = true;
+		}
+		opt_fm_exch_rows(oc,fh,s,nbcons+i);
+		s++;
 	}
-	oc->nbrows = s + nbcons3;
+	oc->nbrows = s;
+	free(status);
 	free(ocm);
 	free(ocp);
-	free(ocn);
 	return true;	
 }
 
+typedef struct opt_fm_sort_t {
+	opt_matrix_t *oc;
+	opt_satmat_t *hist;
+} opt_fm_sort_t;
+
+/* Orders rows by type and coefficients, then by constant and history size */
+static int opt_fm_row_cmp(void *arg, const void *a, const void *b){
+	opt_fm_sort_t *ctx = (opt_fm_sort_t *)arg;
+	size_t ia = *(const size_t *)a;
+	size_t ib = *(const size_t *)b;
+	opt_numint_t *pa = ctx->oc->p[ia];
+	opt_numint_t *pb = ctx->oc->p[ib];
+	size_t k, nbcolumns = ctx->oc->nbcolumns;
+	if(pa[0]!=pb[0]){
+		return pa[0] < pb[0] ? -1 : 1;
+	}
+	for(k=2; k < nbcolumns; k++){
+		if(pa[k]!=pb[k]){
+			return pa[k] < pb[k] ? -1 : 1;
+		}
+	}
+	if(pa[1]!=pb[1]){
+		return pa[1] < pb[1] ? -1 : 1;
+	}
+	size_t hsize = ctx->hist->nbcolumns;
+	size_t na = opt_fm_popcount_or(ctx->hist->p[ia],ctx->hist->p[ia],NULL,hsize);
+	size_t nb = opt_fm_popcount_or(ctx->hist->p[ib],ctx->hist->p[ib],NULL,hsize);
+	return na < nb ? -1 : (na > nb ? 1 : 0);
+}
+
+/************************************
+	Remove inequalities that only differ from another one by a weaker
+	constant, keeping the rows aligned with their histories. Runs in
+	O(n log n) instead of quasi_removal's O(n^2).
+***********************************/
+static void opt_fm_remove_duplicates(opt_matrix_t *oc, size_t nbeq, opt_fm_history_t *fh){
+	size_t nbcons = oc->nbrows;
+	size_t nbcolumns = oc->nbcolumns;
+	if(nbcons <= nbeq + 1){
+		return;
+	}
+	size_t nb = nbcons - nbeq;
+	size_t *ind = (size_t *)malloc(nb*sizeof(size_t));
+	char *rmap = (char *)calloc(nbcons,sizeof(char));
+	size_t i,k,s;
+	for(i=0; i < nb; i++){
+		ind[i] = nbeq + i;
+	}
+	opt_fm_sort_t ctx;
+	ctx.oc = oc;
+	ctx.hist = fh->hist;
+	opt_qsort2(ind, nb, sizeof(size_t), opt_fm_row_cmp, &ctx);
+	size_t last = ind[0];
+	for(i=1; i < nb; i++){
+		opt_numint_t *pl = oc->p[last];
+		opt_numint_t *pi = oc->p[ind[i]];
+		bool same = (pl[0]==pi[0]);
+		for(k=2; same && k < nbcolumns; k++){
+			same = (pl[k]==pi[k]);
+		}
+		if(same){
+			rmap[ind[i]] = 1;
+		}
+		else{
+			last = ind[i];
+		}
+	}
+	s = nbeq;
+	for(i=nbeq; i < nbcons; i++){
+		if(!rmap[i]){
+			opt_fm_exch_rows(oc,fh,s,i);
+			s++;
+		}
+	}
+	oc->nbrows = s;
+	free(ind);
+	free(rmap);
+}
+
 
 
 void opt_poly_projectforget_array(bool project,
@@ -364,63 +647,47 @@ void opt_poly_projectforget_array(bool project,
 	for(i=0; i < psize; i++){
 		pdim[i] = tdim[i];
 	}
-	size_t nbcons;// = ocp->nbrows;
+	size_t nbcons;
 	size_t nbcolumns = ocp->nbcolumns;
 	opt_matrix_rearrange(ocp,op->nbeq);
 	size_t proj=0;
 	bool res = gauss_project(opk,op,tdim,&size,&proj);
-	//printf("After Gauss\n");
 	
 	if(!res){
       		man->result.flag_best = man->result.flag_exact = true;
-      		free(op->C);
+      		opt_matrix_free(op->C);
 		op->C=NULL;
+		free(pdim);
       		return;
 	}
-	//quasi_removal(opk,op);
-	nbcons = ocp->nbrows;
-	size_t limit = nbcons;	
-	int  nbadd;
-	int maxadd;
+	long nbadd;
+	long maxadd;
+	opt_fm_history_t fh;
+	opt_fm_history_init(&fh,opk,ocp,tdim,size);
 	while(size > 0){
-
 		select_variable(opk,tdim,size,ocp, &nbadd, &maxadd);
 		size_t dim = tdim[size-1] + opk->dec;
-		nbcons = ocp->nbrows; 
-		//printf("nbcons: %d nbadd: %d dim: %d size: %d maxrows: %d maxadd: %d\n",nbcons,nbadd,dim,size,ocp->_maxrows,maxadd);
-		opt_matrix_resize_rows(ocp,ocp->nbrows + maxadd);
-		ocp->nbrows = nbcons;
-		res = fourier_motzkin(opk,dim,ocp);
+		res = fourier_motzkin(opk,dim,ocp,&fh);
 		if(!res){
-			opt_matrix_fprint(stdout,op->C);
 			man->result.flag_best = man->result.flag_exact = true;
-    			free(op->C);
+    			opt_matrix_free(op->C);
 			op->C = NULL;
+			opt_fm_history_free(&fh);
+			free(pdim);
 			return;
 		}
-		quasi_removal(opk,op);
-		nbcons = ocp->nbrows; 
 		size--;
 		if(size>0){
-			select_variable(opk,tdim,size,ocp, &nbadd, &maxadd);
-			if(nbcons+nbadd > limit){
-				//opt_matrix_fprint(stdout,op->C);
-				//remove_redundancy(opk,op);
-				if(op->C==NULL){
-					return;
-				}
-				limit = ocp->nbrows;
-				//printf("select variable %d %d %d\n",ocp->_maxrows,ocp->nbrows,nbadd);
-				//fflush(stdout);
-				//select_variable(opk,tdim,size,ocp, &nbadd, &maxadd);
-			}
+			opt_fm_remove_duplicates(ocp,op->nbeq,&fh);
 		}
 	}
+	opt_fm_history_free(&fh);
+	quasi_removal(opk,op);
 	
 	if(project){
 		ocp = op->C;
 		nbcons = ocp->nbrows;
-		opt_matrix_resize_rows(ocp,nbcons + psize);
+		opt_matrix_resize_rows_lazy(ocp,nbcons + psize);
 		/**************************
 			for each projected variable xi, add xi=0 to the projection
 		***************************/
@@ -442,6 +709,132 @@ void opt_poly_projectforget_array(bool project,
 	return;
 }
 
+/************************************
+	Lazy forget of a block given by constraints only: eliminate the
+	dim_size variables tdimk by Gauss and Fourier-Motzkin and return a
+	constraint-only block over the ncomp_size remaining variables nca,
+	with no constraints if the block is empty. Returns NULL if a
+	combination overflowed or the result grew too large, the block then
+	has to be forgotten on its generators.
+***********************************/
+static opt_pk_t * opt_poly_forget_cons(elina_manager_t *man, opt_pk_t *src,
+				       elina_dim_t *tdimk, unsigned short int dim_size,
+				       unsigned short int *ca, unsigned short int *nca,
+				       unsigned short int ncomp_size){
+	opt_pk_internal_t* opk = opt_pk_init_from_manager(man,ELINA_FUNID_FORGET_ARRAY);
+	opt_pk_t *tmp = opt_poly_alloc(src->intdim,src->realdim);
+	opt_pk_t *dst = opt_poly_alloc(ncomp_size,0);
+	elina_dim_t *tdim = (elina_dim_t *)malloc(dim_size*sizeof(elina_dim_t));
+	size_t i,j;
+	for(i=0; i < dim_size; i++){
+		tdim[i] = tdimk[i];
+	}
+	tmp->C = opt_matrix_copy(src->C);
+	/* the equalities of a block that was never minimized are not counted */
+	tmp->nbeq = 0;
+	for(i=0; i < tmp->C->nbrows; i++){
+		if(!tmp->C->p[i][0]){
+			tmp->nbeq++;
+		}
+	}
+	opt_poly_projectforget_array(false,man,tmp,tmp,tdim,dim_size,true);
+	free(tdim);
+	if(opk->exn){
+		opk->exn = ELINA_EXC_NONE;
+		/* an empty result is exact even if some combination overflowed */
+		if(tmp->C){
+			opt_poly_clear(tmp);
+			free(tmp);
+			free(dst);
+			return NULL;
+		}
+	}
+	/* a result much larger than the input is mostly redundant rows with
+	   large coefficients, which are slower to convert than the generators
+	   and make the conversion overflow */
+	if(tmp->C && tmp->C->nbrows > OPT_FM_LAZY_GROWTH*src->C->nbrows){
+		opt_poly_clear(tmp);
+		free(tmp);
+		free(dst);
+		return NULL;
+	}
+	if(tmp->C){
+		opt_matrix_t *src_mat = tmp->C;
+		size_t nbcons = src_mat->nbrows;
+		opt_matrix_t *dst_mat = opt_matrix_alloc(nbcons,ncomp_size+opk->dec,false);
+		for(i=0; i < nbcons; i++){
+			opt_numint_t * tpi = src_mat->p[i];
+			opt_numint_t * dpi = dst_mat->p[i];
+			for(j=0; j < opk->dec; j++){
+				dpi[j] = tpi[j];
+			}
+			unsigned short int l = 0;
+			for(j=0; j < ncomp_size; j++){
+				unsigned short int var = nca[j];
+				while(ca[l]!=var){
+					l++;
+				}
+				dpi[j+opk->dec] = tpi[l+opk->dec];
+				l++;
+			}
+		}
+		dst->C = dst_mat;
+		dst->nbeq = tmp->nbeq;
+	}
+	dst->status = 0;
+	dst->is_minimized = false;
+	opt_poly_clear(tmp);
+	free(tmp);
+	return dst;
+}
+
+/************************************
+	Lazy forget of the variables tdim occurring in the constraint-only
+	block src with variables cl, some of which are kept. NULL if the
+	block has to be forgotten on its generators instead.
+***********************************/
+static opt_pk_t * opt_poly_forget_block_cons(elina_manager_t *man, opt_pk_t *src, comp_list_t *cl,
+					     unsigned short int maxcols, elina_dim_t *tdim, size_t size){
+	opt_pk_internal_t* opk = (opt_pk_internal_t*)man->internal;
+	unsigned short int comp_size = cl->size;
+	unsigned short int * ca = to_sorted_array(cl,maxcols);
+	unsigned short int * nca = (unsigned short int *)malloc(comp_size*sizeof(unsigned short int));
+	elina_dim_t * tdimk = (elina_dim_t *)malloc(comp_size*sizeof(elina_dim_t));
+	unsigned short int l, dim_size = 0, ncomp_size = 0;
+	size_t i;
+	for(l=0; l < comp_size; l++){
+		bool keep = true;
+		for(i=0; i < size; i++){
+			if(tdim[i] + opk->dec==ca[l]){
+				keep = false;
+				break;
+			}
+		}
+		if(keep){
+			nca[ncomp_size++] = ca[l];
+		}
+		else{
+			tdimk[dim_size++] = l;
+		}
+	}
+	opt_pk_t * dst = opt_poly_forget_cons(man,src,tdimk,dim_size,ca,nca,ncomp_size);
+	free(ca);
+	free(nca);
+	free(tdimk);
+	return dst;
+}
+
+static void opt_poly_forget_block_free(opt_pk_t ** fm, unsigned short int num_comp){
+	unsigned short int k;
+	for(k=0; k < num_comp; k++){
+		if(fm[k]){
+			opt_poly_clear(fm[k]);
+			free(fm[k]);
+		}
+	}
+	free(fm);
+}
+
 opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_pk_array_t* oa,
 		      elina_dim_t* tdim, size_t size,
 		      bool project){
@@ -471,7 +864,32 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 	unsigned short int j, k;
 	
 	opt_pk_t ** poly_a = oa->poly;
+	comp_list_t * cla = acla->head;
+	/* results of the lazy forget, NULL for the blocks handled on generators */
+	opt_pk_t ** fm = (opt_pk_t **)calloc(num_compa,sizeof(opt_pk_t *));
 	for(k=0; k < num_compa; k++){
+	    /* in lazy mode, blocks keeping some variable are handled on constraints */
+	    if(opk->lazy && !project && poly_a[k]->C && !poly_a[k]->F){
+		unsigned short int nbforget = 0;
+		for(i=0; i < size; i++){
+		    if(contains_comp(cla,tdim[i]+opk->dec)){
+			nbforget++;
+		    }
+		}
+		if(nbforget==0){
+		    cla = cla->next;
+		    continue;
+		}
+		if(nbforget < cla->size){
+		    fm[k] = opt_poly_forget_block_cons(man,poly_a[k],cla,maxcols,tdim,size);
+		    if(fm[k]){
+			cla = cla->next;
+			continue;
+		    }
+		    /* Fourier-Motzkin gave up, convert the block instead */
+		}
+	    }
+	    cla = cla->next;
 	    if(opk->funopt->algorithm>=0){
 	       opt_poly_chernikova(man,poly_a[k],"cons to gen");
 	    }
@@ -482,6 +900,7 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 		opk->exn = ELINA_EXC_NONE;
 		if (!poly_a[k]->F){
 		     man->result.flag_best = man->result.flag_exact = false;
+		     opt_poly_forget_block_free(fm,num_compa);
 		     if(destructive){
 			opt_poly_set_top(opk,oa);
 			return oa;  
@@ -494,6 +913,7 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 	   /* if empty, return empty */
 	   if(!poly_a[k]->F){
 	       man->result.flag_best = man->result.flag_exact = true;
+	       opt_poly_forget_block_free(fm,num_compa);
 	       if(destructive){
 		  opt_poly_set_bottom(opk,oa);
 		  return oa;
@@ -503,7 +923,8 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 	       }
 	   }
 	}			
-	comp_list_t * cla = acla->head;
+	bool is_bottom = false;
+	cla = acla->head;
 	/********************************
 		Handle the destructive case
 	*********************************/
@@ -548,12 +969,21 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 				unsigned short int k1;
 				for(k1=k; k1 < num_compa - 1; k1++){
 					poly_a[k1] = poly_a[k1+1];
+					fm[k1] = fm[k1+1];
 				}
 				opt_poly_clear(tpoly);
 				free(tpoly);
 				num_compa--;
 				continue;
 			}
+			else if(fm[k]){
+				poly_a[k] = fm[k];
+				fm[k] = NULL;
+				is_bottom = is_bottom || !poly_a[k]->C;
+				man->result.flag_best = man->result.flag_exact = src->intdim==0;
+				opt_poly_clear(src);
+				free(src);
+			}
 			else if(dim_size){
 				/**************************
 					Project the blocks
@@ -661,9 +1091,16 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 				poly_a[k]->F = dst_mat;
 				opt_poly_chernikova(man,poly_a[k],"forget destructive");
 			}
+			free(ca);
+			free(tdimk);
 			cla = cla->next;
 			k++;
 		}
+		free(fm);
+		if(is_bottom){
+			man->result.flag_best = man->result.flag_exact = true;
+			opt_poly_set_bottom(opk,oa);
+		}
 		#if defined(TIMING)
  	 		record_timing(forget_array_time);
    		#endif
@@ -707,7 +1144,13 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 			}
 			if(cl->size){
 				insert_comp_list(acl,cl);
-				if(dim_size){
+				if(fm[k]){
+					poly[k1] = fm[k];
+					fm[k] = NULL;
+					is_bottom = is_bottom || !poly[k1]->C;
+					man->result.flag_best = man->result.flag_exact = src->intdim==0;
+				}
+				else if(dim_size){
 					/**************************
 						Project the blocks
 					**************************/
@@ -822,10 +1265,14 @@ opt_pk_array_t* opt_pk_forget_array(elina_manager_t* man, bool destructive, opt_
 			free(tdimk);
 			cla = cla->next;
 		}
+		free(fm);
 		array_comp_list_t * res = copy_array_comp_list(acl);
 		free_array_comp_list(acl);
 		poly = (opt_pk_t **)realloc(poly,k1*sizeof(opt_pk_t*));
 		opt_pk_array_t * op = opt_pk_array_alloc(poly,res,maxcols);
+		if(is_bottom){
+			opt_poly_set_bottom(opk,op);
+		}
 		 #if defined(TIMING)
  	 		record_timing(forget_array_time);
    		#endif
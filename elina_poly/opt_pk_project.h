@@ -34,6 +34,9 @@ void opt_poly_projectforget_array(bool project,
 			      elina_manager_t* man,	
 			      opt_pk_t* op, opt_pk_t* oa, 
 			      elina_dim_t* tdim, size_t size, bool destructive);
+  /* Eliminates the variables tdim from the constraints of oa by Gauss and
+     Fourier-Motzkin. If a combination overflows, opk->exn is set to
+     ELINA_EXC_OVERFLOW and op->C may be weaker than the exact result. */
 
 opt_matrix_t * extreme_projection(opt_pk_internal_t *opk, 
 				  opt_matrix_t *oc, 
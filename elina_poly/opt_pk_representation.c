@@ -24,6 +24,8 @@
 #include "opt_pk.h"
 #include "opt_pk_test.h"
 #include "opt_pk_representation.h"
+#include "opt_pk_constructor.h"
+#include "opt_pk_lp.h"
 
 
 opt_pk_array_t * opt_pk_array_alloc(opt_pk_t ** poly, array_comp_list_t *acl, unsigned short int maxcols){
@@ -87,8 +89,9 @@ void opt_poly_array_clear(opt_pk_internal_t *opk, opt_pk_array_t * op){
 		}
 	}
 	free(poly);
-	poly=NULL;
 	free_array_comp_list(acl);
+	op->poly = NULL;
+	op->acl = NULL;
   }
 }
 
@@ -239,6 +242,10 @@ void opt_pk_convert(elina_manager_t *man, opt_pk_array_t * op, char *msg){
 	for(k=0; k < num_comp; k++){
 		opt_pk_t * ok = poly[k];
 		opt_poly_chernikova(man,ok,msg);
+		if(!ok->C && !ok->F){
+			op->is_bottom = true;
+			return;
+		}
 	}
 }
 
@@ -301,14 +308,22 @@ void quasi_removal(opt_pk_internal_t *opk, opt_pk_t * o){
 	nbcolumns = oc->nbcolumns;
 	size_t nb = nbcons;
 	size_t nbeq = o->nbeq;
-        size_t *rmap = (size_t *)calloc(nbcons,sizeof(size_t));
+	opt_pk_arena_mark_t mark = opt_pk_arena_mark(opk->arena);
+	size_t *rmap = (size_t *)opt_pk_arena_calloc(opk->arena,nbcons,sizeof(size_t));
+	/* zeroed as by opt_vector_neg, which leaves npj[1] at 0 when opk->dec is 3 */
+	opt_numint_t *npj = (opt_numint_t *)opt_pk_arena_calloc(opk->arena,nbcolumns,sizeof(opt_numint_t));
 	int i,j;
+	size_t k;
 	//opt_matrix_fprint(stdout,oc);
 	for(i = 0; i < (int)nbcons; i++){
 		opt_numint_t *pi = oc->p[i];
 		for(j = i+1; j < (int)nbcons; j++){
 			opt_numint_t* pj = oc->p[j];
 			if((pi[0]==pj[0]) && (!opt_vector_compare_coeff(opk,pi,pj,nbcolumns))){
+				if(!pi[0] && pi[1]!=pj[1]){
+					/* contradictory equalities, left to the conversion */
+					continue;
+				}
 				if(!pi[0]){
 					nbeq--;
 				}
@@ -325,14 +340,16 @@ void quasi_removal(opt_pk_internal_t *opk, opt_pk_t * o){
 				//opt_vector_print(pj,nbcolumns);
 			}
 			else if(!pi[0]){
-				opt_numint_t *npj = opt_vector_neg(opk,pj,nbcolumns);
+				npj[0] = pj[0];
+				for(k = opk->dec - 1; k < nbcolumns; k++){
+					npj[k] = -pj[k];
+				}
 				if(!opt_vector_compare(opk,pi,npj,nbcolumns)){
 					if(pi[1]==npj[1]){
 						rmap[j] = 1;
 						nbeq--;
 					}
 				}
-				free(npj);
 			}
 		}
 	}
@@ -350,7 +367,7 @@ void quasi_removal(opt_pk_internal_t *opk, opt_pk_t * o){
 	    j--;
         }
     }
-    free(rmap);
+    opt_pk_arena_release(opk->arena,mark);
    //opt_matrix_fprint(stdout,oc);
    oc->nbrows = nbcons;
    o->nbeq = nbeq;	
@@ -1176,10 +1193,38 @@ void opt_poly_minimize(elina_manager_t* man, opt_pk_t* op){
         //fflush(stdout);
 }
 
-/* Not implemented */
+/* Blocks with constraints only are minimized by linear programming when it
+   is cheaper than computing their generators */
 void opt_pk_minimize(elina_manager_t* man, opt_pk_array_t* op)
 {
-    
+  opt_pk_internal_t *opk = opt_pk_init_from_manager(man,ELINA_FUNID_MINIMIZE);
+  array_comp_list_t *acl = op->acl;
+  if(op->is_bottom || !acl){
+	return;
+  }
+  unsigned short int num_comp = acl->size;
+  opt_pk_t ** poly = op->poly;
+  unsigned short int k;
+  for(k=0; k < num_comp; k++){
+	opt_pk_t * ok = poly[k];
+	if(ok->C && !ok->F && opt_pk_lp_is_preferable(opk,ok,ok->C->nbrows)){
+		if(!opt_poly_lp_remove_redundant(opk,ok)){
+			opt_poly_set_bottom(opk,op);
+			return;
+		}
+	}
+	else{
+		opt_poly_chernikova(man,ok,"minimize");
+		if(opk->exn){
+			opk->exn = ELINA_EXC_NONE;
+			return;
+		}
+		if(!ok->C && !ok->F){
+			opt_poly_set_bottom(opk,op);
+			return;
+		}
+	}
+  }
 }
 
 void opt_poly_obtain_sorted_C(opt_pk_internal_t* opk, opt_pk_t* op)
@@ -70,7 +70,7 @@ opt_pk_array_t* opt_pk_add_dimensions_cons(elina_manager_t* man,
 		Minimized the input
   *************************************/
   opt_pk_t ** poly_a = oa->poly;
-  if(opk->funopt->algorithm>0){
+  if(!opk->lazy && opk->funopt->algorithm>0){
 	for(k=0; k < num_compa; k++){
 	     opt_pk_t * oak = poly_a[k];
 	     opt_poly_chernikova(man,oak,"add dimensions");
@@ -177,7 +177,9 @@ opt_pk_array_t* opt_pk_add_dimensions_cons(elina_manager_t* man,
 		comp_list_t * cl = create_comp_list();
 		insert_comp(cl,ncmap[i]);
 		insert_comp_list_tail(acl,cl);
-		opt_poly_chernikova(man,poly[i1],"convert to gen");
+		if(!opk->lazy){
+			opt_poly_chernikova(man,poly[i1],"convert to gen");
+		}
 	}
   }
   free(cmap);
@@ -555,7 +557,7 @@ opt_pk_array_t* opt_pk_permute_dimensions(elina_manager_t* man,
   /***************************************
 	Minimize the input
   ***************************************/
-  if(opk->funopt->algorithm>0){
+  if(!opk->lazy && opk->funopt->algorithm>0){
 	for(k=0; k < num_comp; k++){
 	    if (opk->funopt->algorithm>0){
     		/* Minimize the argument */
@@ -28,6 +28,7 @@
 #include "opt_pk_constructor.h"
 #include "opt_pk_widening.h"
 #include "opt_pk_meetjoin.h"
+#include "opt_pk_lp.h"
 
 
 /* ====================================================================== */
@@ -63,7 +64,7 @@ bool opt_pk_is_bottom(elina_manager_t* man, opt_pk_array_t* op)
 		continue;
 	}
 	else{
-	     if (opk->funopt->algorithm>=0){
+	     if (opk->lazy || opk->funopt->algorithm>=0){
      			opt_poly_chernikova(man,op_k,NULL);
 			if (opk->exn){
 				man->result.flag_exact = man->result.flag_best = false;
@@ -319,6 +320,10 @@ bool opt_pk_is_leq_gen(elina_manager_t * man, opt_pk_array_t *oa, opt_pk_array_t
   opt_pk_internal_t* opk = opt_pk_init_from_manager(man,ELINA_FUNID_IS_LEQ);
   
   man->result.flag_exact = man->result.flag_best = false;
+  bool res;
+  if(opt_pk_is_leq_lp(man,oa,ob,&res)){
+    return res;
+  }
   unsigned short int k, ka,kb;
   array_comp_list_t *acla = oa->acl;
   unsigned short int maxcols = oa->maxcols;
@@ -579,6 +584,11 @@ bool opt_pk_is_leq(elina_manager_t *man, opt_pk_array_t *oa, opt_pk_array_t *ob)
 	#if defined(TIMING)
 		start_timing();
      	 #endif
+	opt_pk_internal_t *opk = (opt_pk_internal_t *)man->internal;
+	if(opk->lazy){
+		/* a block kept in constraint form may be empty without oa being flagged */
+		opt_pk_is_bottom(man,oa);
+	}
 	array_comp_list_t * acla = oa->acl;
 	if(oa->is_bottom || !acla){
 		#if defined(TIMING)
@@ -614,6 +624,13 @@ bool opt_pk_is_leq(elina_manager_t *man, opt_pk_array_t *oa, opt_pk_array_t *ob)
 ******************************************************/
 bool opt_pk_is_eq(elina_manager_t* man, opt_pk_array_t* oa, opt_pk_array_t* ob)
 {
+  opt_pk_internal_t *opk = (opt_pk_internal_t *)man->internal;
+  if(opk->lazy){
+	/* convert constraint-only blocks: detects emptiness and minimizes both
+	   sides before their equalities are counted */
+	opt_pk_is_bottom(man,oa);
+	opt_pk_is_bottom(man,ob);
+  }
   array_comp_list_t * acla = oa->acl;
   array_comp_list_t * aclb = ob->acl;
   if(oa->is_bottom || !acla){
@@ -890,6 +907,9 @@ bool opt_pk_sat_lincons(elina_manager_t* man, opt_pk_array_t* oa, elina_lincons0
 	man->result.flag_exact = man->result.flag_best = true;
 	return true;
   }
+  if(opt_pk_sat_lincons_lp(man,oa,lincons0,&sat)){
+	return sat;
+  }
  
   array_comp_list_t * acla = oa->acl;
   opt_pk_t ** poly_a = oa->poly;
@@ -0,0 +1,150 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+/* ********************************************************************** */
+/* opt_pk_thread_pool.c: worker threads of the manager */
+/* ********************************************************************** */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "opt_pk_thread_pool.h"
+
+static void opt_pk_thread_pool_work(opt_pk_thread_pool_t * pool)
+{
+  size_t start;
+  while ((start = __sync_fetch_and_add(&pool->next, pool->chunk)) < pool->size){
+    size_t end = start + pool->chunk;
+    if (end > pool->size){
+      end = pool->size;
+    }
+    pool->fn(pool->args, start, end);
+  }
+}
+
+static void * opt_pk_thread_pool_worker(void * args)
+{
+  opt_pk_thread_pool_t * pool = (opt_pk_thread_pool_t *)args;
+  size_t generation = 0;
+  pthread_mutex_lock(&pool->mutex);
+  while (true){
+    while (!pool->stop && pool->generation==generation){
+      pthread_cond_wait(&pool->work_cond, &pool->mutex);
+    }
+    if (pool->stop){
+      break;
+    }
+    generation = pool->generation;
+    pthread_mutex_unlock(&pool->mutex);
+    opt_pk_thread_pool_work(pool);
+    pthread_mutex_lock(&pool->mutex);
+    pool->num_active--;
+    if (pool->num_active==0){
+      pthread_cond_signal(&pool->done_cond);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+opt_pk_thread_pool_t * opt_pk_thread_pool_alloc(size_t num_threads)
+{
+  opt_pk_thread_pool_t * pool = (opt_pk_thread_pool_t *)malloc(sizeof(opt_pk_thread_pool_t));
+  size_t i;
+  if (num_threads==0){
+    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = nprocs > 0 ? (size_t)nprocs : 1;
+  }
+  pool->num_threads = num_threads;
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->work_cond, NULL);
+  pthread_cond_init(&pool->done_cond, NULL);
+  pool->generation = 0;
+  pool->num_active = 0;
+  pool->busy = false;
+  pool->stop = false;
+  pool->fn = NULL;
+  pool->args = NULL;
+  pool->size = 0;
+  pool->chunk = 1;
+  pool->next = 0;
+  pool->threads = (pthread_t *)malloc((num_threads-1)*sizeof(pthread_t));
+  for (i=0; i < num_threads-1; i++){
+    pthread_create(&pool->threads[i], NULL, opt_pk_thread_pool_worker, (void *)pool);
+  }
+  return pool;
+}
+
+void opt_pk_thread_pool_free(opt_pk_thread_pool_t * pool)
+{
+  size_t i;
+  if (pool==NULL){
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->work_cond);
+  pthread_mutex_unlock(&pool->mutex);
+  for (i=0; i < pool->num_threads-1; i++){
+    pthread_join(pool->threads[i], NULL);
+  }
+  free(pool->threads);
+  pthread_mutex_destroy(&pool->mutex);
+  pthread_cond_destroy(&pool->work_cond);
+  pthread_cond_destroy(&pool->done_cond);
+  free(pool);
+}
+
+void opt_pk_thread_pool_run(opt_pk_thread_pool_t * pool, size_t size, size_t chunk,
+			    opt_pk_thread_pool_fn_t fn, void * args)
+{
+  size_t start;
+  if (chunk==0){
+    chunk = 1;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  if (pool->busy || pool->num_threads==1 || size <= chunk){
+    pthread_mutex_unlock(&pool->mutex);
+    for (start=0; start < size; start+=chunk){
+      fn(args, start, start + chunk < size ? start + chunk : size);
+    }
+    return;
+  }
+  pool->busy = true;
+  pool->fn = fn;
+  pool->args = args;
+  pool->size = size;
+  pool->chunk = chunk;
+  pool->next = 0;
+  pool->num_active = pool->num_threads-1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->work_cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  opt_pk_thread_pool_work(pool);
+
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->num_active > 0){
+    pthread_cond_wait(&pool->done_cond, &pool->mutex);
+  }
+  pool->busy = false;
+  pthread_mutex_unlock(&pool->mutex);
+}
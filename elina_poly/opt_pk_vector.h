@@ -71,6 +71,10 @@ int opt_vector_compare(opt_pk_internal_t* opk,
 		   opt_numint_t * ov1, opt_numint_t * ov2, unsigned short int size);
 
 /* Combination and Algebraic Operations */
+/* Return true on overflow, in which case *result is 0 */
+bool opt_int64_add(opt_numint_t x, opt_numint_t y, opt_numint_t * result);
+/* x1 and x2 are INT64_MAX/y and INT64_MIN/y */
+bool opt_int64_mult(opt_numint_t x, opt_numint_t y, opt_numint_t x1, opt_numint_t x2, opt_numint_t * result);
 void opt_vector_combine(opt_pk_internal_t* opk,
 		    opt_numint_t* ov1, opt_numint_t* ov2,
 		    opt_numint_t* ov3, size_t k, unsigned short intsize, bool add);
@@ -91,6 +91,12 @@ typedef struct _zonotope_t zonotope_t;
 
 /* Other functions */
 /*******************/
+/* elina_manager_zonotope_compact_nsym, also run by zonotope_free once the
+ * number of noise symbols has doubled, only looks at the affine forms of
+ * live zonotopes: it frees every noise symbol none of them uses and
+ * renumbers the others. Callers must not keep an affine form or a noise
+ * symbol outside a live zonotope, and noise symbol indices are only valid
+ * until the next zonotope_free. */
 #include "zonotope_otherops.h"
 
 #ifdef __cplusplus
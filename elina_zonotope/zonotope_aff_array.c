@@ -0,0 +1,517 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+#include "zonotope_aff_array.h"
+
+/*
+ * Vector versions of the coefficient loops, built when the library is configured with vector
+ * support (-DVECTOR, -march=native). They run under the same upward rounding mode as the list
+ * operations and compute the same bounds for every coefficient, only the sums over all the
+ * coefficients are taken in a different order, which keeps them upper bounds.
+ */
+#if defined(VECTOR) && defined(__AVX2__)
+#include <immintrin.h>
+#define ZONOTOPE_SIMD
+#define vabs(x) _mm256_andnot_pd(_mm256_set1_pd(-0.0), x)
+/* lanes where [-x, y] is not [0, 0] */
+#define vnonzero(x,y) _mm256_or_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_NEQ_UQ), _mm256_cmp_pd(y, _mm256_setzero_pd(), _CMP_NEQ_UQ))
+
+static inline double vsum(__m256d x){
+	double tmp[4];
+	_mm256_storeu_pd(tmp, x);
+	return tmp[0] + tmp[1] + tmp[2] + tmp[3];
+}
+#endif
+
+/* number of noise symbols in a block of the matrix product, and number of forms of dst that
+ * are updated together with the coefficients of a form of src in the block */
+#define ZONOTOPE_GEMM_COLS 128
+#define ZONOTOPE_GEMM_ROWS 4
+
+zonotope_aff_array_t* zonotope_aff_array_alloc_dense(zonotope_internal_t* pr)
+{
+    zonotope_aff_array_t* res = (zonotope_aff_array_t*)malloc(sizeof(zonotope_aff_array_t));
+    res->c_inf = 0.0;
+    res->c_sup = 0.0;
+    res->size = pr->dim;
+    res->capacity = pr->dim;
+    res->inf = (double*)calloc(res->size + 1, sizeof(double));
+    res->sup = (double*)calloc(res->size + 1, sizeof(double));
+    res->index = NULL;
+    res->begin = res->size;
+    res->end = 0;
+    res->itv_inf = 0.0;
+    res->itv_sup = 0.0;
+    return res;
+}
+
+zonotope_aff_array_t* zonotope_aff_array_alloc_sparse(void)
+{
+    zonotope_aff_array_t* res = (zonotope_aff_array_t*)malloc(sizeof(zonotope_aff_array_t));
+    res->c_inf = 0.0;
+    res->c_sup = 0.0;
+    res->size = 0;
+    res->capacity = 0;
+    res->inf = (double*)calloc(1, sizeof(double));
+    res->sup = (double*)calloc(1, sizeof(double));
+    res->index = (uint_t*)calloc(1, sizeof(uint_t));
+    res->begin = 0;
+    res->end = 0;
+    res->itv_inf = 0.0;
+    res->itv_sup = 0.0;
+    return res;
+}
+
+void zonotope_aff_array_set_support(zonotope_aff_array_t* a, uint_t* index, uint_t size)
+{
+    if (size > a->capacity) {
+	free(a->inf);
+	free(a->sup);
+	free(a->index);
+	a->inf = (double*)calloc(size + 1, sizeof(double));
+	a->sup = (double*)calloc(size + 1, sizeof(double));
+	a->index = (uint_t*)malloc((size + 1)*sizeof(uint_t));
+	a->capacity = size;
+    }
+    memcpy(a->index, index, size*sizeof(uint_t));
+    a->size = size;
+    a->begin = size;
+    a->end = 0;
+}
+
+zonotope_aff_array_t* zonotope_aff_array_from_aff(zonotope_internal_t* pr, zonotope_aff_t* a)
+{
+    zonotope_aff_array_t* res = (zonotope_aff_array_t*)malloc(sizeof(zonotope_aff_array_t));
+    zonotope_aaterm_t* p;
+    uint_t k = 0;
+    for (p=a->q; p; p=p->n) k++;
+    res->c_inf = a->c_inf;
+    res->c_sup = a->c_sup;
+    res->size = k;
+    res->capacity = k;
+    res->inf = (double*)malloc((k + 1)*sizeof(double));
+    res->sup = (double*)malloc((k + 1)*sizeof(double));
+    res->index = (uint_t*)malloc((k + 1)*sizeof(uint_t));
+    k = 0;
+    for (p=a->q; p; p=p->n) {
+	res->index[k] = p->pnsym->index;
+	res->inf[k] = p->inf;
+	res->sup[k] = p->sup;
+	k++;
+    }
+    res->begin = 0;
+    res->end = k;
+    res->itv_inf = a->itv_inf;
+    res->itv_sup = a->itv_sup;
+    return res;
+}
+
+void zonotope_aff_array_free(zonotope_aff_array_t* a)
+{
+    if (a) {
+	free(a->inf);
+	free(a->sup);
+	free(a->index);
+	free(a);
+    }
+}
+
+/* adds b to a coefficient a, with the rounding error of zonotope_aff_add if both are nonzero */
+static inline void zonotope_aff_array_add_term(zonotope_internal_t* pr, double *a_inf, double *a_sup, double b_inf, double b_sup)
+{
+    if ((*a_inf || *a_sup) && (b_inf || b_sup)) {
+	double maxA = fmax(fabs(*a_inf),fabs(*a_sup));
+	double maxB = fmax(fabs(b_inf),fabs(b_sup));
+	*a_inf = *a_inf + b_inf + (maxA + maxB)*pr->ulp;
+	*a_sup = *a_sup + b_sup + (maxA + maxB)*pr->ulp;
+    } else {
+	/* one of the two is zero and the sum is exact */
+	*a_inf = *a_inf + b_inf;
+	*a_sup = *a_sup + b_sup;
+    }
+}
+
+#if defined(ZONOTOPE_SIMD)
+/* vector version of zonotope_aff_array_add_term */
+static inline void vadd_term(__m256d vulp, double *a_inf, double *a_sup, __m256d b_inf, __m256d b_sup)
+{
+    __m256d va_inf = _mm256_loadu_pd(a_inf);
+    __m256d va_sup = _mm256_loadu_pd(a_sup);
+    __m256d both = _mm256_and_pd(vnonzero(va_inf, va_sup), vnonzero(b_inf, b_sup));
+    __m256d maxAB = _mm256_add_pd(_mm256_max_pd(vabs(va_inf), vabs(va_sup)), _mm256_max_pd(vabs(b_inf), vabs(b_sup)));
+    __m256d add_err = _mm256_and_pd(both, _mm256_mul_pd(maxAB, vulp));
+    _mm256_storeu_pd(a_inf, _mm256_add_pd(_mm256_add_pd(va_inf, b_inf), add_err));
+    _mm256_storeu_pd(a_sup, _mm256_add_pd(_mm256_add_pd(va_sup, b_sup), add_err));
+}
+#endif
+
+/* adds lambda*[-x, y] to a coefficient for mu = |lambda| and the bounds x, y of the
+ * coefficient of src swapped if lambda < 0, with the rounding error m = max(|x|,|y|)*ulp
+ * of the coefficient; returns the rounding error of the product */
+static inline double zonotope_aff_array_add_mul_term(zonotope_internal_t* pr, double *dst_inf, double *dst_sup, double mu, double x, double y, double m)
+{
+    double err = mu*m;
+    zonotope_aff_array_add_term(pr, dst_inf, dst_sup, mu*x + err, mu*y + err);
+    return err;
+}
+
+/* true if lambda*src has coefficients, as in zonotope_aff_mul_weight */
+static inline bool zonotope_aff_array_mul_has_terms(zonotope_aff_array_t* src, double lambda)
+{
+    return (lambda!=0) && (src->itv_inf || src->itv_sup) && isfinite(lambda) && src->size;
+}
+
+/* adds the center and the interval of lambda*src to dst, where err is the rounding error of the coefficients of lambda*src */
+static void zonotope_aff_array_add_mul_center(zonotope_internal_t* pr, zonotope_aff_array_t* dst, zonotope_aff_array_t* src, double lambda, double err)
+{
+    double c_inf, c_sup, itv_inf, itv_sup;
+    if ((lambda==0) || ((!src->itv_inf) && (!src->itv_sup))) {
+	c_inf = c_sup = itv_inf = itv_sup = 0.0;
+    } else if (!src->size && (-src->c_inf>src->c_sup) && (-src->itv_inf>src->itv_sup)) {
+	/* bottom */
+	c_inf = c_sup = itv_inf = itv_sup = -1;
+    } else if ((!src->size && (src->c_inf==INFINITY) && (src->c_sup==INFINITY) && (src->itv_inf==INFINITY) && (src->itv_sup==INFINITY)) || !isfinite(lambda)) {
+	/* top */
+	c_inf = c_sup = itv_inf = itv_sup = INFINITY;
+    } else {
+	double tmp1, tmp2;
+	elina_double_interval_mul(&c_inf, &c_sup, -lambda, lambda, src->c_inf, src->c_sup);
+	double maxA = fmax(fabs(src->c_inf),fabs(src->c_sup));
+	elina_double_interval_mul(&tmp1, &tmp2, -lambda, lambda, maxA*pr->ulp, maxA*pr->ulp);
+	double fp_err_inf = tmp1 + pr->min_denormal;
+	double fp_err_sup = tmp2 + pr->min_denormal;
+	c_inf += tmp1 + pr->min_denormal;
+	c_sup += tmp2 + pr->min_denormal;
+	fp_err_inf += err;
+	fp_err_sup += err;
+	elina_double_interval_mul(&itv_inf, &itv_sup, -lambda, lambda, src->itv_inf, src->itv_sup);
+	itv_inf += fp_err_inf;
+	itv_sup += fp_err_sup;
+    }
+
+    double maxA = fmax(fabs(dst->c_inf),fabs(dst->c_sup));
+    double maxB = fmax(fabs(c_inf),fabs(c_sup));
+    dst->c_inf = dst->c_inf + c_inf + (maxA + maxB)*pr->ulp + pr->min_denormal;
+    dst->c_sup = dst->c_sup + c_sup + (maxA + maxB)*pr->ulp + pr->min_denormal;
+    dst->itv_inf = dst->itv_inf + itv_inf;
+    dst->itv_sup = dst->itv_sup + itv_sup;
+}
+
+/* extends the nonzero positions of dst to [begin, end) */
+static inline void zonotope_aff_array_extend(zonotope_aff_array_t* dst, uint_t begin, uint_t end)
+{
+    if (begin < dst->begin) dst->begin = begin;
+    if (end > dst->end) dst->end = end;
+}
+
+void zonotope_aff_array_add_mul_weight(zonotope_internal_t* pr, zonotope_aff_array_t* dst, zonotope_aff_array_t* src, double lambda)
+{
+    double err = 0.0;
+    if (zonotope_aff_array_mul_has_terms(src, lambda)) {
+	double mu = fabs(lambda);
+	double *x = lambda > 0 ? src->inf : src->sup;
+	double *y = lambda > 0 ? src->sup : src->inf;
+	double *inf = dst->inf;
+	double *sup = dst->sup;
+	uint_t *index = src->index;
+	uint_t size = src->size;
+	uint_t k = 0;
+
+#if defined(ZONOTOPE_SIMD)
+	__m256d vmu = _mm256_set1_pd(mu);
+	__m256d vulp = _mm256_set1_pd(pr->ulp);
+	__m256d verr = _mm256_setzero_pd();
+	while (k + 4 <= size) {
+	    uint_t i = index[k];
+	    if (index[k+3] != index[k] + 3) {
+		/* the indices are increasing, so four of them are consecutive iff the last is 3 more than the first */
+		err += zonotope_aff_array_add_mul_term(pr, inf + i, sup + i, mu, x[k], y[k], fmax(fabs(x[k]),fabs(y[k]))*pr->ulp);
+		k++;
+		continue;
+	    }
+	    __m256d vx = _mm256_loadu_pd(x + k);
+	    __m256d vy = _mm256_loadu_pd(y + k);
+	    __m256d ve = _mm256_mul_pd(vmu, _mm256_mul_pd(_mm256_max_pd(vabs(vx), vabs(vy)), vulp));
+	    vadd_term(vulp, inf + i, sup + i, _mm256_add_pd(_mm256_mul_pd(vmu, vx), ve), _mm256_add_pd(_mm256_mul_pd(vmu, vy), ve));
+	    verr = _mm256_add_pd(verr, ve);
+	    k += 4;
+	}
+	err += vsum(verr);
+#endif
+	for (; k < size; k++) {
+	    uint_t i = index[k];
+	    err += zonotope_aff_array_add_mul_term(pr, inf + i, sup + i, mu, x[k], y[k], fmax(fabs(x[k]),fabs(y[k]))*pr->ulp);
+	}
+	zonotope_aff_array_extend(dst, index[0], index[size-1] + 1);
+    }
+    zonotope_aff_array_add_mul_center(pr, dst, src, lambda, err);
+}
+
+uint_t* zonotope_aff_array_support(zonotope_aff_array_t** src, size_t num_src, uint_t* size)
+{
+    size_t i;
+    uint_t k, lo = UINT_MAX, hi = 0;
+    uint_t *res;
+    char *mark;
+    *size = 0;
+    for (i=0; i<num_src; i++) {
+	if (!src[i]->size) continue;
+	if (src[i]->index[0] < lo) lo = src[i]->index[0];
+	if (src[i]->index[src[i]->size-1] + 1 > hi) hi = src[i]->index[src[i]->size-1] + 1;
+    }
+    if (lo >= hi) {
+	return (uint_t*)malloc(sizeof(uint_t));
+    }
+    mark = (char*)calloc(hi - lo, sizeof(char));
+    for (i=0; i<num_src; i++) {
+	for (k=0; k<src[i]->size; k++) {
+	    mark[src[i]->index[k] - lo] = 1;
+	}
+    }
+    for (k=0; k<hi-lo; k++) {
+	if (mark[k]) (*size)++;
+    }
+    res = (uint_t*)malloc((*size + 1)*sizeof(uint_t));
+    *size = 0;
+    for (k=0; k<hi-lo; k++) {
+	if (mark[k]) res[(*size)++] = lo + k;
+    }
+    free(mark);
+    return res;
+}
+
+/* dst[r] += lambda_r*[-x[r], y[r]] over len positions for the forms r < num, as zonotope_aff_array_add_mul_term */
+static inline void zonotope_aff_array_gemm_kernel(zonotope_internal_t* pr, size_t num, double *mu, double **x, double **y, double *m, double **dst_inf, double **dst_sup, uint_t len)
+{
+    size_t r;
+    uint_t s = 0;
+#if defined(ZONOTOPE_SIMD)
+    __m256d vulp = _mm256_set1_pd(pr->ulp);
+    __m256d vmu[ZONOTOPE_GEMM_ROWS];
+    for (r=0; r<num; r++) {
+	vmu[r] = _mm256_set1_pd(mu[r]);
+    }
+    for (; s + 4 <= len; s += 4) {
+	__m256d vm = _mm256_loadu_pd(m + s);
+	for (r=0; r<num; r++) {
+	    __m256d ve = _mm256_mul_pd(vmu[r], vm);
+	    __m256d b_inf = _mm256_add_pd(_mm256_mul_pd(vmu[r], _mm256_loadu_pd(x[r] + s)), ve);
+	    __m256d b_sup = _mm256_add_pd(_mm256_mul_pd(vmu[r], _mm256_loadu_pd(y[r] + s)), ve);
+	    vadd_term(vulp, dst_inf[r] + s, dst_sup[r] + s, b_inf, b_sup);
+	}
+    }
+#endif
+    for (; s < len; s++) {
+	for (r=0; r<num; r++) {
+	    zonotope_aff_array_add_mul_term(pr, dst_inf[r] + s, dst_sup[r] + s, mu[r], x[r][s], y[r][s], m[s]);
+	}
+    }
+}
+
+void zonotope_aff_array_gemm(zonotope_internal_t* pr, zonotope_aff_array_t** dst, size_t num_dst, zonotope_aff_array_t** src, size_t num_src, double** weights)
+{
+    size_t i, o, r, num;
+    uint_t k, c0;
+    uint_t *support = num_dst ? dst[0]->index : NULL;
+    uint_t width = num_dst ? dst[0]->size : 0;
+    uint_t lo = width ? support[0] : 0;
+    double mu[ZONOTOPE_GEMM_ROWS];
+    double *x[ZONOTOPE_GEMM_ROWS], *y[ZONOTOPE_GEMM_ROWS];
+    double *dst_inf[ZONOTOPE_GEMM_ROWS], *dst_sup[ZONOTOPE_GEMM_ROWS];
+    /* rounding errors max(|x|,|y|)*ulp of the coefficients of src, and their sums */
+    double *err = (double*)malloc((num_src + 1)*sizeof(double));
+    /* position in the support of dst of the noise symbol of index lo+j */
+    uint_t *pos = (uint_t*)malloc(((width ? support[width-1] + 1 - lo : 0) + 1)*sizeof(uint_t));
+    /* the block of the coefficients of src at the positions [c0, c0+ZONOTOPE_GEMM_COLS) of the support */
+    double *g_inf = (double*)malloc((num_src*ZONOTOPE_GEMM_COLS + 1)*sizeof(double));
+    double *g_sup = (double*)malloc((num_src*ZONOTOPE_GEMM_COLS + 1)*sizeof(double));
+    double *g_m = (double*)malloc((num_src*ZONOTOPE_GEMM_COLS + 1)*sizeof(double));
+    /* position of the first coefficient of src[i] after the block, or the size if there are none */
+    uint_t *next = (uint_t*)calloc(num_src + 1, sizeof(uint_t));
+    /* the coefficients of src[i] in the block are at the positions [span_begin[i], span_end[i]) of the block */
+    uint_t *span_begin = (uint_t*)malloc((num_src + 1)*sizeof(uint_t));
+    uint_t *span_end = (uint_t*)malloc((num_src + 1)*sizeof(uint_t));
+
+    for (k=0; k<width; k++) {
+	pos[support[k] - lo] = k;
+    }
+    for (i=0; i<num_src; i++) {
+	err[i] = 0.0;
+	for (k=0; k<src[i]->size; k++) {
+	    err[i] = err[i] + fmax(fabs(src[i]->inf[k]),fabs(src[i]->sup[k]))*pr->ulp;
+	}
+    }
+
+    for (c0=0; c0<width; c0+=ZONOTOPE_GEMM_COLS) {
+	uint_t len = width - c0 < ZONOTOPE_GEMM_COLS ? width - c0 : ZONOTOPE_GEMM_COLS;
+	for (i=0; i<num_src; i++) {
+	    zonotope_aff_array_t* a = src[i];
+	    double *row_inf = g_inf + i*ZONOTOPE_GEMM_COLS;
+	    double *row_sup = g_sup + i*ZONOTOPE_GEMM_COLS;
+	    double *row_m = g_m + i*ZONOTOPE_GEMM_COLS;
+	    uint_t first, last;
+	    k = next[i];
+	    span_begin[i] = span_end[i] = 0;
+	    if ((k == a->size) || (pos[a->index[k] - lo] >= c0 + len)) continue;
+	    /* the positions of the coefficients are increasing, only the span between the first and the last is filled */
+	    first = k;
+	    while ((k < a->size) && (pos[a->index[k] - lo] < c0 + len)) k++;
+	    last = k - 1;
+	    span_begin[i] = pos[a->index[first] - lo] - c0;
+	    span_end[i] = pos[a->index[last] - lo] - c0 + 1;
+	    memset(row_inf + span_begin[i], 0, (span_end[i] - span_begin[i])*sizeof(double));
+	    memset(row_sup + span_begin[i], 0, (span_end[i] - span_begin[i])*sizeof(double));
+	    memset(row_m + span_begin[i], 0, (span_end[i] - span_begin[i])*sizeof(double));
+	    for (k=first; k<=last; k++) {
+		uint_t s = pos[a->index[k] - lo] - c0;
+		row_inf[s] = a->inf[k];
+		row_sup[s] = a->sup[k];
+		row_m[s] = fmax(fabs(a->inf[k]),fabs(a->sup[k]))*pr->ulp;
+	    }
+	    next[i] = last + 1;
+	}
+
+	for (o=0; o<num_dst; o+=ZONOTOPE_GEMM_ROWS) {
+	    size_t rows = num_dst - o < ZONOTOPE_GEMM_ROWS ? num_dst - o : ZONOTOPE_GEMM_ROWS;
+	    /* the sums over i are kept in the order of the successive additions */
+	    for (i=0; i<num_src; i++) {
+		uint_t sb = span_begin[i];
+		if (sb == span_end[i]) continue;
+		num = 0;
+		for (r=0; r<rows; r++) {
+		    double lambda = weights[o+r][i];
+		    if (!zonotope_aff_array_mul_has_terms(src[i], lambda)) continue;
+		    mu[num] = fabs(lambda);
+		    x[num] = (lambda > 0 ? g_inf : g_sup) + i*ZONOTOPE_GEMM_COLS + sb;
+		    y[num] = (lambda > 0 ? g_sup : g_inf) + i*ZONOTOPE_GEMM_COLS + sb;
+		    dst_inf[num] = dst[o+r]->inf + c0 + sb;
+		    dst_sup[num] = dst[o+r]->sup + c0 + sb;
+		    num++;
+		}
+		zonotope_aff_array_gemm_kernel(pr, num, mu, x, y, g_m + i*ZONOTOPE_GEMM_COLS + sb, dst_inf, dst_sup, span_end[i] - sb);
+	    }
+	}
+    }
+
+    for (o=0; o<num_dst; o++) {
+	for (i=0; i<num_src; i++) {
+	    double lambda = weights[o][i];
+	    if (zonotope_aff_array_mul_has_terms(src[i], lambda)) {
+		zonotope_aff_array_extend(dst[o], pos[src[i]->index[0] - lo], pos[src[i]->index[src[i]->size-1] - lo] + 1);
+		zonotope_aff_array_add_mul_center(pr, dst[o], src[i], lambda, fabs(lambda)*err[i]);
+	    } else {
+		zonotope_aff_array_add_mul_center(pr, dst[o], src[i], lambda, 0.0);
+	    }
+	}
+    }
+
+    free(err);
+    free(pos);
+    free(g_inf);
+    free(g_sup);
+    free(g_m);
+    free(next);
+    free(span_begin);
+    free(span_end);
+}
+
+void zonotope_aff_array_bound(zonotope_internal_t* pr, double *res_inf, double *res_sup, zonotope_aff_array_t* a, zonotope_t* z)
+{
+    uint_t k = a->begin;
+    uint_t end = a->end;
+    *res_inf = a->c_inf;
+    *res_sup = a->c_sup;
+    if (z->hypercube) {
+	/* a coefficient times [-1,1] is [-m,m] for the largest absolute value m of its bounds */
+	double sum = 0.0;
+#if defined(ZONOTOPE_SIMD)
+	__m256d vsum_m = _mm256_setzero_pd();
+	for (; k + 4 <= end; k += 4) {
+	    vsum_m = _mm256_add_pd(vsum_m, _mm256_max_pd(vabs(_mm256_loadu_pd(a->inf + k)), vabs(_mm256_loadu_pd(a->sup + k))));
+	}
+	sum = vsum(vsum_m);
+#endif
+	for (; k < end; k++) {
+	    sum = sum + fmax(fabs(a->inf[k]),fabs(a->sup[k]));
+	}
+	*res_inf = *res_inf + sum;
+	*res_sup = *res_sup + sum;
+    } else {
+	double gamma_inf = 0.0;
+	double gamma_sup = 0.0;
+	double inf = 0.0;
+	double sup = 0.0;
+	for (; k < end; k++) {
+	    if (!a->inf[k] && !a->sup[k]) continue;
+	    zonotope_noise_symbol_cons_get_gamma(pr, &gamma_inf, &gamma_sup, a->index ? a->index[k] : k, z);
+	    elina_double_interval_mul(&inf, &sup, gamma_inf, gamma_sup, a->inf[k], a->sup[k]);
+	    *res_inf = *res_inf + inf;
+	    *res_sup = *res_sup + sup;
+	}
+    }
+}
+
+zonotope_aff_t* zonotope_aff_from_array(zonotope_internal_t* pr, zonotope_aff_array_t* a, zonotope_t* z)
+{
+    zonotope_aff_t* res = zonotope_aff_alloc_init(pr);
+    zonotope_aaterm_t* ptr;
+    double box_inf = 0.0;
+    double box_sup = 0.0;
+    uint_t i = a->begin;
+    zonotope_aff_array_bound(pr, &box_inf, &box_sup, a, z);
+    res->c_inf = a->c_inf;
+    res->c_sup = a->c_sup;
+    while (i < a->end) {
+#if defined(ZONOTOPE_SIMD)
+	/* skip the blocks of zero coefficients */
+	if (i + 4 <= a->end && !_mm256_movemask_pd(vnonzero(_mm256_loadu_pd(a->inf + i), _mm256_loadu_pd(a->sup + i)))) {
+	    i += 4;
+	    continue;
+	}
+#endif
+	if (a->inf[i] || a->sup[i]) {
+	    ptr = zonotope_aaterm_alloc_init();
+	    ptr->inf = a->inf[i];
+	    ptr->sup = a->sup[i];
+	    ptr->pnsym = pr->epsilon[a->index ? a->index[i] : i];
+	    if (res->end) res->end->n = ptr;
+	    else res->q = ptr;
+	    res->end = ptr;
+	    res->l++;
+	}
+	i++;
+    }
+    res->itv_inf = fmin(a->itv_inf, box_inf);
+    res->itv_sup = fmin(a->itv_sup, box_sup);
+
+    /* reset to zero for the next form */
+    if (a->begin < a->end) {
+	memset(a->inf + a->begin, 0, (a->end - a->begin)*sizeof(double));
+	memset(a->sup + a->begin, 0, (a->end - a->begin)*sizeof(double));
+    }
+    a->c_inf = 0.0;
+    a->c_sup = 0.0;
+    a->itv_inf = 0.0;
+    a->itv_sup = 0.0;
+    a->begin = a->size;
+    a->end = 0;
+    return res;
+}
@@ -0,0 +1,92 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+#ifndef _ZONOTOPE_AFF_ARRAY_H_
+#define _ZONOTOPE_AFF_ARRAY_H_
+
+#include "zonotope_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Affine forms with array coefficients */
+/**************************************************************************************************/
+
+/* The coefficients are stored as two arrays of bounds (inf negated as in zonotope_aaterm_t).
+ * A dense form stores the coefficient of the noise symbol of index i at position i and the
+ * missing noise symbols as [0,0], a sparse form stores the coefficients of a set of noise symbols
+ * in increasing order of index together with these indices, possibly with some [0,0]. */
+typedef struct zonotope_aff_array_t {
+    double c_inf;	/* center */
+    double c_sup;
+    double *inf;	/* coefficients */
+    double *sup;
+    uint_t *index;	/* noise symbol indices of a sparse form, NULL for a dense form */
+    uint_t size;	/* number of positions */
+    uint_t capacity;	/* allocated length of the arrays */
+    uint_t begin;	/* the coefficients outside the positions [begin, end) are zero */
+    uint_t end;
+    double itv_inf;	/* interval concretisation */
+    double itv_sup;
+} zonotope_aff_array_t;
+
+/* dense form of zero over the noise symbols that currently exist */
+zonotope_aff_array_t* zonotope_aff_array_alloc_dense(zonotope_internal_t* pr);
+
+/* sparse form of zero without noise symbols */
+zonotope_aff_array_t* zonotope_aff_array_alloc_sparse(void);
+
+/* makes a sparse form of zero store the size noise symbols of the increasing indices index */
+void zonotope_aff_array_set_support(zonotope_aff_array_t* a, uint_t* index, uint_t size);
+
+/* sparse form of an affine form */
+zonotope_aff_array_t* zonotope_aff_array_from_aff(zonotope_internal_t* pr, zonotope_aff_t* a);
+
+void zonotope_aff_array_free(zonotope_aff_array_t* a);
+
+/* dst += lambda*src for a dense dst and a sparse src, with the rounding of
+ * zonotope_aff_add(pr, dst, zonotope_aff_mul_weight(pr, src, lambda), z) */
+void zonotope_aff_array_add_mul_weight(zonotope_internal_t* pr, zonotope_aff_array_t* dst, zonotope_aff_array_t* src, double lambda);
+
+/* increasing indices of the noise symbols of the sparse forms, their number is stored in size;
+ * the array is allocated with malloc */
+uint_t* zonotope_aff_array_support(zonotope_aff_array_t** src, size_t num_src, uint_t* size);
+
+/* dst[o] += sum_i weights[o][i]*src[i] for sparse forms dst[o] whose noise symbols are all
+ * set to the support of the sparse forms src[i]. The result is the one of num_src successive calls to
+ * zonotope_aff_array_add_mul_weight, except for the rounding error added to the intervals, but
+ * it is computed as a matrix product blocked over the noise symbols and the forms of dst. */
+void zonotope_aff_array_gemm(zonotope_internal_t* pr, zonotope_aff_array_t** dst, size_t num_dst, zonotope_aff_array_t** src, size_t num_src, double** weights);
+
+/* box concretisation of a dense or sparse form in z */
+void zonotope_aff_array_bound(zonotope_internal_t* pr, double *res_inf, double *res_sup, zonotope_aff_array_t* a, zonotope_t* z);
+
+/* affine form of a dense or sparse form, whose interval is also bounded by the box
+ * concretisation in z; the form is reset to zero */
+zonotope_aff_t* zonotope_aff_from_array(zonotope_internal_t* pr, zonotope_aff_array_t* a, zonotope_t* z);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
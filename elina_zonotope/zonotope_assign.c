@@ -47,6 +47,7 @@ zonotope_t* zonotope_assign_linexpr_array(elina_manager_t* man,
 	//zonotope_fprint(stdout,man,res,NULL);
 	//fflush(stdout);
     }
+    if (destructive) zonotope_free(man, z);
     man->result.flag_best = false;
     man->result.flag_exact = false;
 	//printf("assign output %d\n",res->size);
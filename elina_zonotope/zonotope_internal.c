@@ -54,6 +54,10 @@ double zonotope_of_box_time=0;
 double zonotope_is_top_time=0;
 double zonotope_is_bottom_time=0;
 double zonotope_assign_linexpr_time=0;
+double zonotope_reduce_order_time=0;
+/* sum of the magnitudes of the coefficients moved to fresh noise symbols by the order reduction */
+double zonotope_reduce_order_overhead=0;
+double zonotope_compact_time=0;
 
 elina_manager_t* zonotope_manager_alloc(void)
 {
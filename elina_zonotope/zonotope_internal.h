@@ -72,6 +72,9 @@ counter += cycles
     //extern double fold_time;
     //extern double sat_lincons_time;
     extern double zonotope_assign_linexpr_time;
+    extern double zonotope_reduce_order_time;
+    extern double zonotope_reduce_order_overhead;
+    extern double zonotope_compact_time;
     //extern double substitute_linexpr_time;
     //extern double bound_dimension_time;
     //extern double opt_conversion_time;
@@ -158,6 +161,11 @@ typedef struct _zonotope_internal_t {
     uint_t* inputns;
     uint_t epssize;
     uint_t it;
+    size_t max_nsym;	/* bound on the number of noise symbols of the result of a join or a ReLU layer, 0 for no bound */
+    struct _zonotope_t** live;	/* zonotopes allocated and not yet freed, whose noise symbols are kept by a compaction */
+    uint_t live_size;
+    uint_t live_capacity;
+    uint_t sweep_dim;	/* number of noise symbols kept by the last compaction */
     double min_denormal;
     double ulp;
 } zonotope_internal_t;
@@ -178,6 +186,7 @@ typedef struct _zonotope_t {
     bool		hypercube;	/* true if no constrained nsym */
     //elina_interval_t**	g;	/* array of the generators of the zonotope - a oublier */
     uint_t		gn;		/* size of generators - a oublier */
+    uint_t		live;		/* position in pr->live */
 } zonotope_t;
 
 /* special object to store and compute meet with lincons */
@@ -257,6 +266,29 @@ static inline zonotope_noise_symbol_t* zonotope_noise_symbol_add(zonotope_intern
     return res;
 }
 
+/* the noise symbols are compacted once their number reaches twice the number kept by the last
+ * compaction plus this slack */
+#define ZONOTOPE_NSYM_SWEEP_MIN 4096
+
+/* registers a zonotope allocated with the manager of pr */
+static inline void zonotope_live_insert(zonotope_internal_t *pr, zonotope_t *z)
+{
+    if (pr->live_size == pr->live_capacity) {
+	pr->live_capacity = pr->live_capacity ? 2*pr->live_capacity : 64;
+	pr->live = (zonotope_t**)realloc(pr->live, pr->live_capacity*sizeof(zonotope_t*));
+    }
+    z->live = pr->live_size;
+    pr->live[pr->live_size++] = z;
+}
+
+/* unregisters a zonotope before it is freed */
+static inline void zonotope_live_remove(zonotope_internal_t *pr, zonotope_t *z)
+{
+    zonotope_t *last = pr->live[--pr->live_size];
+    pr->live[z->live] = last;
+    last->live = z->live;
+}
+
     
     static inline void zonotope_noise_symbol_fprint(FILE* stream, zonotope_noise_symbol_t *eps)
     {
@@ -324,6 +356,27 @@ elina_manager_t* zonotope_manager_alloc(void);
 
 zonotope_aff_t * zonotope_aff_from_linexpr0(zonotope_internal_t* pr, elina_linexpr0_t * expr, zonotope_t *z);
 
+/* order reduction of the affine forms of the dimensions [offset, offset+num_dim) of z: if they
+ * have more than max_nsym noise symbols, the unconstrained ones whose generators are the closest
+ * to their box (Girard's criterion |g|_1 - |g|_oo) are replaced in these forms by one fresh noise
+ * symbol per form, whose coefficient bounds their sum. As few noise symbols as possible are merged
+ * for the forms to have at most max_nsym noise symbols, or as few as the number of forms allows.
+ * Returns the number of noise symbols removed from the forms. */
+size_t zonotope_noise_symbol_reduce(zonotope_internal_t* pr, zonotope_t* z, elina_dim_t offset, size_t num_dim, size_t max_nsym);
+
+/* frees the noise symbols that no affine form and no constraint of a zonotope of pr->live refers
+ * to, and renumbers the other ones in increasing order of index from 0, which keeps the terms
+ * of the affine forms and the nsymcons arrays sorted. The affine forms are updated through the
+ * shared noise symbols. It must only be called when all the affine forms in use belong to a
+ * zonotope of pr->live. Returns the number of noise symbols freed. */
+size_t zonotope_noise_symbol_compact(zonotope_internal_t* pr);
+
+/* zonotope_noise_symbol_compact if the number of noise symbols has doubled since the last compaction */
+static inline void zonotope_noise_symbol_check_compact(zonotope_internal_t* pr)
+{
+    if (pr->dim >= 2*pr->sweep_dim + ZONOTOPE_NSYM_SWEEP_MIN) zonotope_noise_symbol_compact(pr);
+}
+
 /* Free memory used by one aaterm */
 static inline void zonotope_aaterm_free(zonotope_internal_t* pr, zonotope_aaterm_t* term)
 {
@@ -1569,6 +1622,7 @@ static inline void zonotope_internal_free(zonotope_internal_t* pr)
 	pr->dimchange = NULL;
 	pr->it = 0;
 	free(pr->inputns);
+	free(pr->live);
 	free(pr);
     }
 }
@@ -1615,6 +1669,11 @@ static inline zonotope_internal_t* zonotope_internal_alloc(elina_manager_t* manN
     pr->inputns = (uint_t*)calloc(1024, sizeof(uint_t));	/* starts with a limit of 1024 noise symbols */
     pr->epssize = 0;
     pr->it = 0;
+    pr->max_nsym = 0;
+    pr->live = NULL;
+    pr->live_size = 0;
+    pr->live_capacity = 0;
+    pr->sweep_dim = 0;
     pr->min_denormal = ldexpl(1.0,-1074);
     pr->ulp = ldexpl(1.0,-52);
     return pr;
@@ -229,7 +229,6 @@ zonotope_t* zonotope_meet_lincons_array(elina_manager_t* man, bool destructive,
 /************************************************/
 
 zonotope_t* zonotope_join(elina_manager_t* man, bool destructive, zonotope_t* z1, zonotope_t* z2)
-    /* TODO destructive not used  */
 {
     start_timing();
     size_t i = 0;
@@ -262,7 +261,7 @@ zonotope_t* zonotope_join(elina_manager_t* man, bool destructive, zonotope_t* z1
 	if (destructive) res = z1;
 	else res = zonotope_copy(man,z1);
     } else {
-	/* TODO: destructive not yet supported */
+	/* the affine forms of z1 that res shares are kept by res when z1 is freed */
 	elina_interval_t *tmp = elina_interval_alloc();
 	res = zonotope_alloc(man, intdim, realdim);
 	/* update res->box */
@@ -405,6 +404,8 @@ zonotope_t* zonotope_join(elina_manager_t* man, bool destructive, zonotope_t* z1
 	man->result.flag_best = true;
 	man->result.flag_exact = false;
 	elina_interval_free(tmp);
+	if (pr->max_nsym) zonotope_noise_symbol_reduce(pr, res, 0, res->dims, pr->max_nsym);
+	if (destructive) zonotope_free(man, z1);
     }
     man->result.flag_best = true;
     man->result.flag_exact = true;
@@ -62,3 +62,300 @@ zonotope_t* zonotope_forget_array(elina_manager_t* man,
     //not_implemented();
 }
 
+
+int elina_manager_zonotope_get_nsym(elina_manager_t* man)
+{
+    zonotope_internal_t* pr = (zonotope_internal_t*)man->internal;
+    return (int)pr->dim;
+}
+
+void elina_manager_zonotope_set_max_nsym(elina_manager_t* man, size_t max_nsym)
+{
+    zonotope_internal_t* pr = (zonotope_internal_t*)man->internal;
+    pr->max_nsym = max_nsym;
+}
+
+size_t elina_manager_zonotope_compact_nsym(elina_manager_t* man)
+{
+    zonotope_internal_t* pr = (zonotope_internal_t*)man->internal;
+    return zonotope_noise_symbol_compact(pr);
+}
+
+/* state of a noise symbol during the order reduction */
+#define ZONOTOPE_NSYM_UNUSED 0
+#define ZONOTOPE_NSYM_USED 1
+#define ZONOTOPE_NSYM_CONSTRAINED 2
+#define ZONOTOPE_NSYM_MERGED 3
+
+typedef struct zonotope_generator_t {
+    double score;
+    uint_t index;
+} zonotope_generator_t;
+
+static int zonotope_generator_cmp(const void* a, const void* b)
+{
+    const zonotope_generator_t* ga = (const zonotope_generator_t*)a;
+    const zonotope_generator_t* gb = (const zonotope_generator_t*)b;
+    if (ga->score != gb->score) return ga->score < gb->score ? -1 : 1;
+    return ga->index < gb->index ? -1 : (ga->index > gb->index);
+}
+
+typedef struct zonotope_paf_dim_t {
+    uintptr_t paf;
+    elina_dim_t dim;
+} zonotope_paf_dim_t;
+
+/* orders the dimensions by affine form, then by dimension */
+static int zonotope_paf_dim_cmp(const void* a, const void* b)
+{
+    const zonotope_paf_dim_t* pa = (const zonotope_paf_dim_t*)a;
+    const zonotope_paf_dim_t* pb = (const zonotope_paf_dim_t*)b;
+    if (pa->paf != pb->paf) return pa->paf < pb->paf ? -1 : 1;
+    return pa->dim < pb->dim ? -1 : (pa->dim > pb->dim);
+}
+
+/* copy of a in which the merged noise symbols are replaced by one fresh noise symbol, whose
+ * coefficient is the sum of the magnitudes of their coefficients */
+static zonotope_aff_t* zonotope_aff_merge_noise_symbols(zonotope_internal_t* pr, zonotope_aff_t* a, char* state, double* moved)
+{
+    zonotope_aff_t* res = zonotope_aff_alloc_init(pr);
+    zonotope_aaterm_t *p, *ptr;
+    double sum = 0.0;
+    res->c_inf = a->c_inf;
+    res->c_sup = a->c_sup;
+    res->itv_inf = a->itv_inf;
+    res->itv_sup = a->itv_sup;
+    for (p=a->q; p; p=p->n) {
+	if (state[p->pnsym->index] == ZONOTOPE_NSYM_MERGED) {
+	    /* [-m,m]*eps with m = max(|inf|,|sup|) contains the coefficient times eps */
+	    sum = sum + fmax(fabs(p->inf),fabs(p->sup));
+	    continue;
+	}
+	ptr = zonotope_aaterm_alloc_init();
+	ptr->inf = p->inf;
+	ptr->sup = p->sup;
+	ptr->pnsym = p->pnsym;
+	if (res->end) res->end->n = ptr;
+	else res->q = ptr;
+	res->end = ptr;
+	res->l++;
+    }
+    if (sum > 0) {
+	/* the fresh noise symbol has the largest index, the terms stay sorted */
+	ptr = zonotope_aaterm_alloc_init();
+	ptr->inf = -sum;
+	ptr->sup = sum;
+	ptr->pnsym = zonotope_noise_symbol_add(pr, IN);
+	if (res->end) res->end->n = ptr;
+	else res->q = ptr;
+	res->end = ptr;
+	res->l++;
+	*moved = *moved + sum;
+    }
+    return res;
+}
+
+size_t zonotope_noise_symbol_reduce(zonotope_internal_t* pr, zonotope_t* z, elina_dim_t offset, size_t num_dim, size_t max_nsym)
+{
+    start_timing();
+    uint_t nsym = pr->dim;
+    size_t i, j, k, num_used = 0, num_cand = 0, num_merge = 0;
+    zonotope_aaterm_t* p;
+    double moved = 0.0;
+    char* state = (char*)calloc(nsym + 1, sizeof(char));
+    double* norm1 = (double*)calloc(nsym + 1, sizeof(double));
+    double* norminf = (double*)calloc(nsym + 1, sizeof(double));
+
+    /* the generator of a noise symbol is the vector of its coefficients in the affine forms */
+    for (i=offset; i<offset+num_dim; i++) {
+	for (p=z->paf[i]->q; p; p=p->n) {
+	    uint_t s = p->pnsym->index;
+	    double m = fmax(fabs(p->inf),fabs(p->sup));
+	    if (state[s] == ZONOTOPE_NSYM_UNUSED) {
+		state[s] = ZONOTOPE_NSYM_USED;
+		num_used++;
+	    }
+	    norm1[s] = norm1[s] + m;
+	    norminf[s] = fmax(norminf[s], m);
+	}
+    }
+    if (num_used <= max_nsym) {
+	free(state);
+	free(norm1);
+	free(norminf);
+	record_timing(zonotope_reduce_order_time);
+	return 0;
+    }
+
+    /* the constraints of the constrained noise symbols would be lost */
+    if (!z->hypercube) {
+	size_t size = zonotope_noise_symbol_cons_get_dimension(pr, z);
+	for (k=0; k<size; k++) {
+	    if (state[z->nsymcons[k]] == ZONOTOPE_NSYM_USED) state[z->nsymcons[k]] = ZONOTOPE_NSYM_CONSTRAINED;
+	}
+    }
+    zonotope_generator_t* cand = (zonotope_generator_t*)malloc((num_used + 1)*sizeof(zonotope_generator_t));
+    for (k=0; k<nsym; k++) {
+	if (state[k] != ZONOTOPE_NSYM_USED) continue;
+	cand[num_cand].score = norm1[k] - norminf[k];
+	cand[num_cand].index = (uint_t)k;
+	num_cand++;
+    }
+    qsort(cand, num_cand, sizeof(zonotope_generator_t), zonotope_generator_cmp);
+
+    /* the dimensions that share an affine form share the reduced form, which is built for the first of them */
+    zonotope_paf_dim_t* order = (zonotope_paf_dim_t*)malloc((num_dim + 1)*sizeof(zonotope_paf_dim_t));
+    elina_dim_t* first = (elina_dim_t*)malloc((num_dim + 1)*sizeof(elina_dim_t));
+    for (i=0; i<num_dim; i++) {
+	order[i].paf = (uintptr_t)z->paf[offset+i];
+	order[i].dim = (elina_dim_t)i;
+    }
+    qsort(order, num_dim, sizeof(zonotope_paf_dim_t), zonotope_paf_dim_cmp);
+    for (i=0; i<num_dim; i++) {
+	first[order[i].dim] = (i > 0 && order[i].paf == order[i-1].paf) ? first[order[i-1].dim] : order[i].dim;
+    }
+
+    /* the affine forms in which each candidate appears, indexed by the first of their dimensions relative to offset */
+    uint_t* forms_begin = (uint_t*)calloc(nsym + 2, sizeof(uint_t));
+    for (i=0; i<num_dim; i++) {
+	if (first[i] != i) continue;
+	for (p=z->paf[offset+i]->q; p; p=p->n) forms_begin[p->pnsym->index + 1]++;
+    }
+    for (k=0; k<nsym; k++) forms_begin[k+1] += forms_begin[k];
+    elina_dim_t* forms = (elina_dim_t*)malloc((forms_begin[nsym] + 1)*sizeof(elina_dim_t));
+    uint_t* pos = (uint_t*)malloc((nsym + 1)*sizeof(uint_t));
+    memcpy(pos, forms_begin, nsym*sizeof(uint_t));
+    for (i=0; i<num_dim; i++) {
+	if (first[i] != i) continue;
+	for (p=z->paf[offset+i]->q; p; p=p->n) forms[pos[p->pnsym->index]++] = (elina_dim_t)i;
+    }
+
+    /* the candidates are merged in this order until the remaining noise symbols and the fresh
+     * ones, one per affine form that contains a merged noise symbol, fit in the budget */
+    char* touched = (char*)calloc(num_dim + 1, sizeof(char));
+    size_t num_fresh = 0, best = num_used;
+    for (k=0; k<num_cand; k++) {
+	uint_t s = cand[k].index;
+	for (j=forms_begin[s]; j<forms_begin[s+1]; j++) {
+	    if (!touched[forms[j]]) {
+		touched[forms[j]] = 1;
+		num_fresh++;
+	    }
+	}
+	if (num_used - (k + 1) + num_fresh < best) {
+	    best = num_used - (k + 1) + num_fresh;
+	    num_merge = k + 1;
+	}
+	if (best <= max_nsym) break;
+    }
+    for (k=0; k<num_merge; k++) {
+	state[cand[k].index] = ZONOTOPE_NSYM_MERGED;
+    }
+
+    if (num_merge) {
+	for (i=0; i<num_dim; i++) {
+	    zonotope_aff_t* a = z->paf[offset+i];
+	    zonotope_aff_t* res;
+	    if (!a->q) continue;
+	    res = first[i] == i ? zonotope_aff_merge_noise_symbols(pr, a, state, &moved) : z->paf[offset+first[i]];
+	    zonotope_aff_check_free(pr, a);
+	    z->paf[offset+i] = res;
+	    z->paf[offset+i]->pby++;
+	}
+    }
+    zonotope_reduce_order_overhead += moved;
+
+    free(state);
+    free(norm1);
+    free(norminf);
+    free(cand);
+    free(order);
+    free(first);
+    free(forms_begin);
+    free(forms);
+    free(pos);
+    free(touched);
+    record_timing(zonotope_reduce_order_time);
+    return num_used - best;
+}
+
+zonotope_t* zonotope_reduce_order(elina_manager_t* man,
+		bool destructive, zonotope_t* z,
+		size_t max_nsym)
+{
+    zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_UNKNOWN);
+    zonotope_t* res = destructive ? z : zonotope_copy(man,z);
+    man->result.flag_best = false;
+    man->result.flag_exact = false;
+    zonotope_noise_symbol_reduce(pr, res, 0, res->dims, max_nsym);
+    return res;
+}
+
+static int zonotope_uintptr_cmp(const void* a, const void* b)
+{
+    uintptr_t x = *(const uintptr_t*)a;
+    uintptr_t y = *(const uintptr_t*)b;
+    return (x > y) - (x < y);
+}
+
+size_t zonotope_noise_symbol_compact(zonotope_internal_t* pr)
+{
+    start_timing();
+    uint_t nsym = pr->dim;
+    uint_t num_kept = 0;
+    size_t i, j, k, num_forms = 0;
+    zonotope_aaterm_t* p;
+    char* used = (char*)calloc(nsym + 1, sizeof(char));
+
+    /* the affine forms shared by several dimensions or zonotopes are visited once */
+    for (k=0; k<pr->live_size; k++) num_forms += pr->live[k]->dims;
+    uintptr_t* forms = (uintptr_t*)malloc((num_forms + 1)*sizeof(uintptr_t));
+    num_forms = 0;
+    for (k=0; k<pr->live_size; k++) {
+	zonotope_t* z = pr->live[k];
+	size_t size = zonotope_noise_symbol_cons_get_dimension(pr, z);
+	for (i=0; i<z->dims; i++) {
+	    if (z->paf[i]) forms[num_forms++] = (uintptr_t)z->paf[i];
+	}
+	for (j=0; j<size; j++) used[z->nsymcons[j]] = 1;
+    }
+    qsort(forms, num_forms, sizeof(uintptr_t), zonotope_uintptr_cmp);
+    for (i=0; i<num_forms; i++) {
+	if (i > 0 && forms[i] == forms[i-1]) continue;
+	for (p=((zonotope_aff_t*)forms[i])->q; p; p=p->n) used[p->pnsym->index] = 1;
+    }
+
+    /* the terms point to the noise symbols, so renumbering these renumbers the affine forms */
+    uint_t* index = (uint_t*)malloc((nsym + 1)*sizeof(uint_t));
+    for (k=0; k<nsym; k++) {
+	if (used[k]) {
+	    index[k] = num_kept;
+	    pr->epsilon[num_kept] = pr->epsilon[k];
+	    pr->epsilon[num_kept]->index = num_kept;
+	    num_kept++;
+	} else {
+	    free(pr->epsilon[k]);
+	}
+    }
+    for (k=0; k<pr->live_size; k++) {
+	zonotope_t* z = pr->live[k];
+	size_t size = zonotope_noise_symbol_cons_get_dimension(pr, z);
+	for (j=0; j<size; j++) z->nsymcons[j] = index[z->nsymcons[j]];
+    }
+    pr->epssize = 0;
+    for (k=0; k<num_kept; k++) {
+	if (pr->epsilon[k]->type == IN) pr->inputns[pr->epssize++] = (uint_t)k;
+    }
+
+    /* zonotope_noise_symbol_add grows the arrays by blocks of 1024 */
+    pr->epsilon = (zonotope_noise_symbol_t**)realloc(pr->epsilon, (num_kept - num_kept%1024 + 1024)*sizeof(zonotope_noise_symbol_t*));
+    pr->inputns = (uint_t*)realloc(pr->inputns, (pr->epssize - pr->epssize%1024 + 1024)*sizeof(uint_t));
+    pr->dim = num_kept;
+    pr->sweep_dim = num_kept;
+
+    free(used);
+    free(forms);
+    free(index);
+    record_timing(zonotope_compact_time);
+    return nsym - num_kept;
+}
@@ -35,6 +35,21 @@ extern "C" {
 /*******************/
 
 int elina_manager_zonotope_get_nsym(elina_manager_t* man);
+
+/* bounds by max_nsym the number of noise symbols of the result of zonotope_join and of the
+ * outputs of the ReLU layers of zonoml, with zonotope_noise_symbol_reduce; 0 for no bound */
+void elina_manager_zonotope_set_max_nsym(elina_manager_t* man, size_t max_nsym);
+
+/* frees the noise symbols that no zonotope of the manager uses any more and renumbers the other
+ * ones, see zonotope_noise_symbol_compact; returns the number of noise symbols freed. This is also
+ * done by zonotope_free once the number of noise symbols has doubled, so the indices of noise
+ * symbols read from the affine forms are only valid until the next zonotope_free. */
+size_t elina_manager_zonotope_compact_nsym(elina_manager_t* man);
+
+/* order reduction of z to max_nsym noise symbols, see zonotope_noise_symbol_reduce */
+zonotope_t* zonotope_reduce_order(elina_manager_t* man,
+		bool destructive, zonotope_t* z,
+		size_t max_nsym);
  
 //void elina_abstract1_aff_build(elina_manager_t* man, elina_abstract1_t * abstract, elina_var_t var, unsigned int index, elina_interval_t *itv, bool isunion);
 //void elina_abstract1_ns_meet_lincons_array(elina_manager_t* man, elina_abstract1_t* abstract1, elina_lincons0_array_t* lincons);
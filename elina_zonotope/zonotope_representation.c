@@ -38,7 +38,8 @@ zonotope_t* zonotope_alloc(elina_manager_t* man, size_t intdim, size_t realdim)
     res->box_sup = (double*)malloc((intdim+realdim)*sizeof(double));
     res->gn = 0;
    // res->g = NULL;
-    res->paf = (zonotope_aff_t**)malloc(res->dims*sizeof(zonotope_aff_t*));
+    res->paf = (zonotope_aff_t**)calloc(res->dims, sizeof(zonotope_aff_t*));
+    zonotope_live_insert(pr, res);
     return res;
 }
 
@@ -146,7 +147,9 @@ void zonotope_free(elina_manager_t* man, zonotope_t* z)
     z->size = 0;
     z->dims = 0;
     z->intdim = 0;
+    zonotope_live_remove(pr, z);
     free(z);
+    zonotope_noise_symbol_check_compact(pr);
     //printf("start4\n");
     //fflush(stdout);
     man->result.flag_best = true;
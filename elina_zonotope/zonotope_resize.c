@@ -124,10 +124,10 @@ zonotope_t* zonotope_remove_dimensions(elina_manager_t* man, bool destructive, z
     res->box_sup = (double*)malloc(res->dims*sizeof(double));
     res->gn = 0;
     //res->g = NULL;
-    res->paf = (zonotope_aff_t**)malloc(res->dims*sizeof(zonotope_aff_t*));
+    res->paf = (zonotope_aff_t**)calloc(res->dims, sizeof(zonotope_aff_t*));
+    zonotope_live_insert(pr, res);
     for (i=0; i< num_rem; i++) {
         j = var_rem[i];
-        res->paf[i] = zonotope_aff_alloc_init(pr);
         //printf("coming here: %d %d %d %d %p %d\n",i,j,num_rem,num_remove,res->paf[i],res->dims);
         //fflush(stdout);
         //res->paf[i] = (zonotope_aff_t *)malloc(sizeof(zonotope_aff_t*));
@@ -139,7 +139,6 @@ zonotope_t* zonotope_remove_dimensions(elina_manager_t* man, bool destructive, z
         //  res->paf[j] = res->paf[j+1];
 	res->box_inf[i] = z->box_inf[j];
 	res->box_sup[i] = z->box_sup[j];
-        if(!destructive)
         res->paf[i]->pby++;
         //}
     }
@@ -163,31 +162,9 @@ zonotope_t* zonotope_remove_dimensions(elina_manager_t* man, bool destructive, z
     //zonotope_fprint(stdout,man,res,NULL);
     //fflush(stdout);
     
-    zonotope_t * tmp = z;
+    /* the affine forms of the removed dimensions are released, the kept ones are shared with res */
     if(destructive){
-        //z = res;
-        //zonotope_free(man,tmp);
-        //return z;
-        
-        //for(i=0; i < z->dims; z++){
-          //  if(map[i]){
-            //    zonotope_aff_check_free(pr,z->paf[i]);
-            //}
-        //}
-        //free(z->paf);
-        //z->paf=NULL;
-       
-        //for (i=0; i<nsymcons_size; i++) {
-          //  if (z->gamma[i]) {
-            //    if (z->gamma[i] != pr->ap_muu) elina_interval_free(z->gamma[i]);
-            //}
-        //}
-        //free(z->gamma);
-        //z->gamma = NULL;
-        //free(z->nsymcons);
-        //z->nsymcons = NULL;
-        //elina_abstract0_free(pr->manNS, z->abs);
-        //free(z);
+        zonotope_free(man,z);
     }
     free(map);
     free(var_rem);
@@ -222,23 +199,22 @@ zonotope_t* zonotope_permute_dimensions(elina_manager_t* man, bool destructive,
     res->box_sup = (double*)malloc(res->dims*sizeof(double));
     res->gn = 0;
     //res->g = NULL;
-    res->paf = (zonotope_aff_t**)malloc(res->dims*sizeof(zonotope_aff_t*));
+    res->paf = (zonotope_aff_t**)calloc(res->dims, sizeof(zonotope_aff_t*));
+    zonotope_live_insert(pr, res);
     size_t i = 0;
     size_t j = 0;
     for (i=0; i< permutation->size; i++) {
         j = permutation->dim[i];
-        res->paf[j] = zonotope_aff_alloc_init(pr);
         //printf("coming here: %d %d %d %d %p %d\n",i,j,num_rem,num_remove,res->paf[i],res->dims);
         //fflush(stdout);
-        memcpy((void *)res->paf[j], (void *)z->paf[i], sizeof(zonotope_aff_t));
+        res->paf[j] = z->paf[i];
         //zonotope_aff_check_free(pr,res->paf[dimchange->dim[i]]);
         //res->paf[dimchange->dim[i]] = NULL;
         //for (j=dimchange->dim[i];j<-1+res->dims;j++) {
         //  res->paf[j] = res->paf[j+1];
 	res->box_inf[j] = z->box_inf[i];
         res->box_sup[j] = z->box_sup[i];
-        if(!destructive)
-        res->paf[i]->pby++;
+        res->paf[j]->pby++;
         //}
     }
     
@@ -252,11 +228,10 @@ zonotope_t* zonotope_permute_dimensions(elina_manager_t* man, bool destructive,
 	    fprintf(stderr,"zonotope_permute, unconsistent gamma for Zonotope abstract object\n");
         }
     }
-    //if(destructive){
-      //  z = res;
-        //zonotope_free(man,tmp);
-        //return z;
-    //}
+    /* the affine forms are shared with res */
+    if(destructive){
+        zonotope_free(man,z);
+    }
     
     //char *map = (char *)calloc(permutation->size,sizeof(char));
     //for (i=0; i<permutation->size; i++) {
@@ -15,8 +15,8 @@ void lift_to_relu_y_branch(const int xi, PDD& pdd_dual, const Polarity polarity)
     pdd_dual.dim++;
 
     // Intentionally swapped because PDD here is given in the dual view.
-    vector<double*>& V = pdd_dual.H;
-    vector<double*>& H = pdd_dual.V;
+    FpMat& V = pdd_dual.H;
+    FpMat& H = pdd_dual.V;
 
     if (V.empty()) {
         // There are no vertices - the further convex hull with an empty vertex set
@@ -26,30 +26,29 @@ void lift_to_relu_y_branch(const int xi, PDD& pdd_dual, const Polarity polarity)
     }
     vector<set_t>& incidence = pdd_dual.incidence;
 
-    for (size_t i = 0; i < V.size(); i++) {
-        V[i] = fp_arr_resize(dim + 1, dim, V[i]);
-        if (polarity == PLUS) {
+    V.resize_cols(dim + 1);
+    if (polarity == PLUS) {
+        for (int i = 0; i < V.rows(); i++) {
             V[i][dim] = V[i][xi + 1];
         }
     }
-    for (size_t i = 0; i < H.size(); i++) {
-        H[i] = fp_arr_resize(dim + 1, dim, H[i]);
-    }
-    H.resize(H.size() + 2);
-    H[H.size() - 2] = fp_arr_create(dim + 1);
-    H[H.size() - 1] = fp_arr_create(dim + 1);
+    H.resize_cols(dim + 1);
+    H.push_row();
+    H.push_row();
+    double* h_lb = H[H.rows() - 2];
+    double* h_ub = H[H.rows() - 1];
 
-    H[H.size() - 2][dim] = 1;
-    H[H.size() - 1][dim] = -1;
+    h_lb[dim] = 1;
+    h_ub[dim] = -1;
     if (polarity == PLUS) {
-        H[H.size() - 2][xi + 1] = -1;
-        H[H.size() - 1][xi + 1] = 1;
+        h_lb[xi + 1] = -1;
+        h_ub[xi + 1] = 1;
     }
 
     // Incidence size equals previous size of H which is now increased by 2.
-    incidence.resize(H.size());
-    incidence[incidence.size() - 2] = set_create(V.size());
-    incidence[incidence.size() - 1] = set_create(V.size());
+    incidence.resize(H.rows());
+    incidence[incidence.size() - 2] = set_create(V.rows());
+    incidence[incidence.size() - 1] = set_create(V.rows());
     set_enable_all(incidence[incidence.size() - 2]);
     set_enable_all(incidence[incidence.size() - 1]);
 }
@@ -64,8 +63,8 @@ void lift_to_tasi_y_branch(const int xi,
     pdd_dual.dim++;
 
     // Intentionally swapped because PDD here is given in the dual view.
-    vector<double*>& V = pdd_dual.H;
-    vector<double*>& H = pdd_dual.V;
+    FpMat& V = pdd_dual.H;
+    FpMat& H = pdd_dual.V;
 
     if (V.empty()) {
         // There are no vertices - the further convex hull with an empty vertex set
@@ -80,13 +79,14 @@ void lift_to_tasi_y_branch(const int xi,
     compute_S_curve_bounds(x_lb, x_ub,
                            activation==Sigm, &k_lb, &b_lb, &k_ub, &b_ub);
 
-    vector<double*> V_new;
-    V_new.reserve(V.size() * 2);
-    vector<int> map_lb(V.size());
-    vector<int> map_ub(V.size());
+    FpMat V_new(0, dim + 1);
+    V_new.reserve(V.rows() * 2);
+    vector<int> map_lb(V.rows());
+    vector<int> map_ub(V.rows());
 
-    for (size_t i = 0; i < V.size(); i++) {
-        double* v_lb = fp_arr_resize(dim + 1, dim, V[i]);
+    for (int i = 0; i < V.rows(); i++) {
+        double* v_lb = V_new.push_row();
+        fp_arr_set(dim, v_lb, V[i]);
         double x_cur = v_lb[xi + 1];
         fesetround(FE_DOWNWARD);
         double lb = k_lb * x_cur + b_lb;
@@ -95,27 +95,23 @@ void lift_to_tasi_y_branch(const int xi,
         fesetround(FE_TONEAREST);
         ASRTF(lb <= ub, "Unsoundness detected.");
         v_lb[dim] = lb;
-        map_lb[i] = V_new.size();
-        V_new.push_back(v_lb);
+        map_lb[i] = V_new.rows() - 1;
         if (lb == ub) {
             map_ub[i] = map_lb[i];
         } else {
-            double* v_ub = fp_arr_copy(dim + 1, v_lb);
+            double* v_ub = V_new.push_row();
+            fp_arr_set(dim + 1, v_ub, V_new[map_lb[i]]);
             v_ub[dim] = ub;
-            map_ub[i] = V_new.size();
-            V_new.push_back(v_ub);
+            map_ub[i] = V_new.rows() - 1;
         }
     }
 
-    for (size_t i = 0; i < H.size(); i++) {
-        H[i] = fp_arr_resize(dim + 1, dim, H[i]);
-    }
-    H.resize(H.size() + 2);
-    H[H.size() - 2] = fp_arr_create(dim + 1);
-    H[H.size() - 1] = fp_arr_create(dim + 1);
+    H.resize_cols(dim + 1);
+    H.push_row();
+    H.push_row();
 
-    double* h_lb = H[H.size() - 2];
-    double* h_ub = H[H.size() - 1];
+    double* h_lb = H[H.rows() - 2];
+    double* h_ub = H[H.rows() - 1];
 
     // In the minus branch:
     // y >= k * x + b equivalent -b - k * x + y >= 0
@@ -128,12 +124,12 @@ void lift_to_tasi_y_branch(const int xi,
     h_ub[xi + 1] = k_ub;
     h_ub[dim] = -1;
 
-    vector<set_t> incidence_new = set_arr_create(H.size(), V_new.size());
+    vector<set_t> incidence_new = set_arr_create(H.rows(), V_new.rows());
 
-    for (size_t h = 0; h < H.size() - 2; h++) {
+    for (int h = 0; h < H.rows() - 2; h++) {
         set_t inc = incidence[h];
         set_t inc_new = incidence_new[h];
-        for (size_t v = 0; v < V.size(); v++) {
+        for (int v = 0; v < V.rows(); v++) {
             if (set_test_bit(inc, v)) {
                 // Note that they can map to the same vertex, but it's okay.
                 set_enable_bit(inc_new, map_lb[v]);
@@ -142,8 +138,8 @@ void lift_to_tasi_y_branch(const int xi,
         }
     }
 
-    set_t inc_lb = incidence_new[H.size() - 2];
-    set_t inc_ub = incidence_new[H.size() - 1];
+    set_t inc_lb = incidence_new[H.rows() - 2];
+    set_t inc_ub = incidence_new[H.rows() - 1];
 
     for (int v : map_lb) {
         set_enable_bit(inc_lb, v);
@@ -152,7 +148,7 @@ void lift_to_tasi_y_branch(const int xi,
         set_enable_bit(inc_ub, v);
     }
 
-    pdd_dual.H = V_new;
+    pdd_dual.H = move(V_new);
     // Since incidence is reference it is important
     // that I free it _before_ I update incidence in pdd.
     set_arr_free(incidence);
@@ -160,14 +156,14 @@ void lift_to_tasi_y_branch(const int xi,
 
 }
 
-PDD decomposition_recursive(Quadrant& quadrant, const map<Quadrant, PDD>& quadrant2pdd,
+PDD decomposition_recursive(Quadrant& quadrant, map<Quadrant, PDD>& quadrant2pdd,
                             const int K, Activation activation,
                             const vector<double>& x_lb,
                             const vector<double>& x_ub,
                             const vector<double>& orthants) {
     const int xi = (int) quadrant.size();
     if (xi == K) {
-        PDD pdd = quadrant2pdd.at(quadrant);
+        PDD pdd = move(quadrant2pdd.at(quadrant));
         PDD_debug_consistency_check(pdd);
         return pdd;
     } else {
@@ -197,7 +193,7 @@ PDD decomposition_recursive(Quadrant& quadrant, const map<Quadrant, PDD>& quadra
 }
 
 // TODO[gleb] Add support for multiple passes.
-vector<double*> decomposition(const int K, const map<Quadrant, PDD>& quadrant2pdd,
+vector<double*> decomposition(const int K, map<Quadrant, PDD>& quadrant2pdd,
                               Activation activation,
                               const vector<double>& x_lb, const vector<double>& x_ub,
                               const vector<double>& orthants) {
@@ -208,14 +204,14 @@ vector<double*> decomposition(const int K, const map<Quadrant, PDD>& quadrant2pd
     Quadrant quadrant {};
     quadrant.reserve(K);
     PDD res = decomposition_recursive(quadrant, quadrant2pdd, K, activation, x_lb, x_ub, orthants);
-    vector<double*>& H = res.V;
-    vector<double*>& V = res.H;
+    FpMat& H = res.V;
+    const FpMat& V = res.H;
 
     PDD_adjust_H_for_soundness_finite_polytope(2 * K + 1, H, V);
 
     // H is given in order (1, x1, ..., xk, yk, ..., y1) thus last k cols have to be reversed.
     // The desired order is (1, x1, ..., xk, y1, ..., yk).
-    for (size_t hi = 0; hi < H.size(); hi++) {
+    for (int hi = 0; hi < H.rows(); hi++) {
         int first = K + 1;
         int last = 2 * K;
         double* h = H[hi];
@@ -226,8 +222,7 @@ vector<double*> decomposition(const int K, const map<Quadrant, PDD>& quadrant2pd
         }
     }
 
-    fp_mat_free(V);
     set_arr_free(res.incidence);
 
-    return H;
+    return H.to_rows();
 }
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <iostream>
 #include <cassert>
+#include <immintrin.h>
 #include "dynamic_bitset.h"
 #include "setoper.h"
 
@@ -15,31 +16,74 @@ constexpr block_t ONE = 1;
 constexpr block_t ALL_SET = -1;
 constexpr int BITS_IN_BLOCK = sizeof(block_t) * CHAR_BIT;
 
-constexpr char BYTE2COUNT[256] = {
-        0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,1,2,2,3,2,3,3,4,2,3,3,4,3,4,4,5,
-        1,2,2,3,2,3,3,4,2,3,3,4,3,4,4,5,2,3,3,4,3,4,4,5,3,4,4,5,4,5,5,6,
-        1,2,2,3,2,3,3,4,2,3,3,4,3,4,4,5,2,3,3,4,3,4,4,5,3,4,4,5,4,5,5,6,
-        2,3,3,4,3,4,4,5,3,4,4,5,4,5,5,6,3,4,4,5,4,5,5,6,4,5,5,6,5,6,6,7,
-        1,2,2,3,2,3,3,4,2,3,3,4,3,4,4,5,2,3,3,4,3,4,4,5,3,4,4,5,4,5,5,6,
-        2,3,3,4,3,4,4,5,3,4,4,5,4,5,5,6,3,4,4,5,4,5,5,6,4,5,5,6,5,6,6,7,
-        2,3,3,4,3,4,4,5,3,4,4,5,4,5,5,6,3,4,4,5,4,5,5,6,4,5,5,6,5,6,6,7,
-        3,4,4,5,4,5,5,6,4,5,5,6,5,6,6,7,4,5,5,6,5,6,6,7,5,6,6,7,6,7,7,8
-};
-
 inline int set_number_of_blocks(const int num_bits) {
     assert(num_bits >= 0 && "Expected a non-negative num_bits.");
     return num_bits == 0 ? 1 : (num_bits - 1) / BITS_IN_BLOCK + 2;
 }
 
+// Sets of up to SET_INLINE_BITS bits all get the same fixed-size slot, so growing them
+// within that range never moves them. Larger sets get a power of two number of blocks.
+constexpr int INLINE_BLOCKS = SET_INLINE_BITS / BITS_IN_BLOCK + 1;
+// Upper bound on the number of free slots a pool keeps per size class.
+constexpr size_t POOL_MAX_FREE = 1 << 14;
+
+inline int set_capacity_class(const int num_blocks) {
+    if (num_blocks <= INLINE_BLOCKS) {
+        return 0;
+    }
+    return 64 - __builtin_clzl((unsigned long) num_blocks - 1);
+}
+
+inline int set_capacity_of_class(const int capacity_class) {
+    return capacity_class == 0 ? INLINE_BLOCKS : 1 << capacity_class;
+}
+
+// Free slots are recycled per thread, so the sets created and destroyed over and over
+// by the double description method don't go to the allocator. A slot freed by another
+// thread than the one that created it simply moves to that thread's pool.
+struct SetPool {
+    vector<set_t> free_slots[64];
+
+    ~SetPool() {
+        for (auto& slots : free_slots) {
+            for (set_t slot : slots) {
+                free(slot);
+            }
+        }
+    }
+};
+
+thread_local SetPool set_pool;
+
+inline set_t set_pool_acquire(const int num_blocks) {
+    const int capacity_class = set_capacity_class(num_blocks);
+    vector<set_t>& slots = set_pool.free_slots[capacity_class];
+    if (!slots.empty()) {
+        set_t slot = slots.back();
+        slots.pop_back();
+        return slot;
+    }
+    set_t slot = (set_t) malloc(set_capacity_of_class(capacity_class) * sizeof(block_t));
+    ASRTF(slot != nullptr, "Failed to allocate a set.");
+    return slot;
+}
+
+inline void set_pool_release(const set_t set, const int num_blocks) {
+    vector<set_t>& slots = set_pool.free_slots[set_capacity_class(num_blocks)];
+    if (slots.size() >= POOL_MAX_FREE) {
+        free(set);
+        return;
+    }
+    slots.push_back(set);
+}
+
 set_t set_create(const int num_bits)
 {
     assert(num_bits >= 0 && "Expected a non-negative num_bits.");
     int num_blocks = set_number_of_blocks(num_bits);
-    set_t set = (block_t*) calloc(num_blocks, sizeof(block_t));
+    set_t set = set_pool_acquire(num_blocks);
     set[0] = (block_t) num_bits;
-    for (int i = 1; i < num_blocks; i++) {
-        set[i] = 0;
-    }
+    memset(set + 1, 0, (num_blocks - 1) * sizeof(block_t));
     return set;
 }
 
@@ -48,17 +92,18 @@ set_t set_resize(set_t set, const int num_bits) {
     if (num_bits == old_num_bits) {
         return set;
     }
-    // Update number of bits.
-    set[0] = num_bits;
     const int old_blocks = set_number_of_blocks(old_num_bits);
     const int blocks = set_number_of_blocks(num_bits);
-    if (old_blocks == blocks) {
-        // Same amount of memory allocated - no need to reallocate.
-        return set;
+    if (set_capacity_class(old_blocks) != set_capacity_class(blocks)) {
+        set_t moved = set_pool_acquire(blocks);
+        memcpy(moved, set, min(old_blocks, blocks) * sizeof(block_t));
+        set_pool_release(set, old_blocks);
+        set = moved;
     }
-    set = (set_t) realloc(set, blocks * sizeof(block_t));
+    // Update number of bits.
+    set[0] = num_bits;
     for (int i = old_blocks; i < blocks; i++) {
-        // If any new blocks were allocated - set them to zero.
+        // If any new blocks were added - set them to zero.
         set[i] = 0;
     }
     return set;
@@ -66,12 +111,12 @@ set_t set_resize(set_t set, const int num_bits) {
 
 void set_free(const set_t set)
 {
-    free(set);
+    set_pool_release(set, set_number_of_blocks(set[0]));
 }
 
 set_t set_copy(const set_t set) {
     int num_blocks = set_number_of_blocks(set[0]);
-    set_t set_copy = (block_t*) calloc(num_blocks, sizeof(block_t));
+    set_t set_copy = set_pool_acquire(num_blocks);
     memcpy(set_copy, set, num_blocks * sizeof(block_t));
     return set_copy;
 }
@@ -106,12 +151,33 @@ void set_enable_all(const set_t set) {
     set[num_blocks - 1] = ALL_SET >> (BITS_IN_BLOCK - bits_left);
 }
 
+void set_enable_bits(const set_t set, const int n, const block_t block) {
+    assert(0 <= n && n < (int) set[0] && "Enabled bits should be within range of set.");
+    int block_i = n / BITS_IN_BLOCK + 1;
+    int bit_i = n % BITS_IN_BLOCK;
+    set[block_i] |= block << bit_i;
+    if (bit_i != 0 && (block >> (BITS_IN_BLOCK - bit_i)) != 0) {
+        assert(block_i + 1 < set_number_of_blocks(set[0]) && "Enabled bits should be within range of set.");
+        set[block_i + 1] |= block >> (BITS_IN_BLOCK - bit_i);
+    }
+}
+
 bool set_intersect_by_any(const set_t first, const set_t second)
 {
     assert(first[0] == second[0] && "Sets expected to be of the same size.");
 
     int num_blocks = set_number_of_blocks(first[0]);
-    for (int i = 1; i < num_blocks; i++) {
+    int i = 1;
+#ifdef __AVX2__
+    for (; i + 4 <= num_blocks; i += 4) {
+        __m256i f = _mm256_loadu_si256((const __m256i*) (first + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (second + i));
+        if (!_mm256_testz_si256(f, s)) {
+            return true;
+        }
+    }
+#endif
+    for (; i < num_blocks; i++) {
         if (first[i] & second[i]) {
             return true;
         }
@@ -123,10 +189,18 @@ set_t set_intersect(const set_t first, const set_t second) {
     assert(first[0] == second[0] && "Sets expected to be of the same size.");
 
     int num_blocks = set_number_of_blocks(first[0]);
-    set_t res = (block_t*) calloc(num_blocks, sizeof(block_t));
+    set_t res = set_pool_acquire(num_blocks);
     res[0] = first[0];
 
-    for (int i = 1; i < num_blocks; i++) {
+    int i = 1;
+#ifdef __AVX2__
+    for (; i + 4 <= num_blocks; i += 4) {
+        __m256i f = _mm256_loadu_si256((const __m256i*) (first + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (second + i));
+        _mm256_storeu_si256((__m256i*) (res + i), _mm256_and_si256(f, s));
+    }
+#endif
+    for (; i < num_blocks; i++) {
         res[i] = first[i] & second[i];
     }
 
@@ -137,7 +211,18 @@ bool set_equal(const set_t first, const set_t second) {
     assert(first[0] == second[0] && "Sets expected to be of the same size.");
 
     int num_blocks = set_number_of_blocks(first[0]);
-    for (int i = 1; i < num_blocks; i++) {
+    int i = 1;
+#ifdef __AVX2__
+    for (; i + 4 <= num_blocks; i += 4) {
+        __m256i f = _mm256_loadu_si256((const __m256i*) (first + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (second + i));
+        __m256i diff = _mm256_xor_si256(f, s);
+        if (!_mm256_testz_si256(diff, diff)) {
+            return false;
+        }
+    }
+#endif
+    for (; i < num_blocks; i++) {
         if (first[i] != second[i]) {
             return false;
         }
@@ -150,7 +235,18 @@ bool set_is_subset_of(const set_t potential_subset, const set_t potential_supers
     assert(potential_superset[0] == potential_subset[0] && "Sets expected to be of the same size.");
 
     int num_blocks = set_number_of_blocks(potential_superset[0]);
-    for (int i = 1; i < num_blocks; i++) {
+    int i = 1;
+#ifdef __AVX2__
+    for (; i + 4 <= num_blocks; i += 4) {
+        __m256i sub = _mm256_loadu_si256((const __m256i*) (potential_subset + i));
+        __m256i super = _mm256_loadu_si256((const __m256i*) (potential_superset + i));
+        // testc checks that every bit of sub is also set in super.
+        if (!_mm256_testc_si256(super, sub)) {
+            return false;
+        }
+    }
+#endif
+    for (; i < num_blocks; i++) {
         if ((potential_superset[i] | potential_subset[i]) != potential_superset[i]) {
             return false;
         }
@@ -161,12 +257,10 @@ bool set_is_subset_of(const set_t potential_subset, const set_t potential_supers
 
 int set_count(const set_t set)
 {
-    unsigned char* byte_p = (unsigned char*) (&set[1]);
-    int num_bytes = (set_number_of_blocks(set[0]) - 1) * sizeof(block_t);
+    int num_blocks = set_number_of_blocks(set[0]);
     int count = 0;
-    for (int i = 0; i < num_bytes; i++) {
-        count += BYTE2COUNT[*byte_p];
-        byte_p++;
+    for (int i = 1; i < num_blocks; i++) {
+        count += __builtin_popcountl(set[i]);
     }
     return count;
 }
@@ -197,7 +291,7 @@ vector<set_t> set_arr_create(const int num_sets, const int num_bits) {
 
 void set_arr_free(const vector<set_t>& sets) {
     for (auto set : sets) {
-        free(set);
+        set_free(set);
     }
 }
 
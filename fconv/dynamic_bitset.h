@@ -1,3 +1,5 @@
+#pragma once
+
 /*
  * Disclaimer: most of the design and implementation of dynamic_bitset is guided
  * by cddlib's and Boost's implementation of bitset.
@@ -15,6 +17,11 @@ using namespace std;
 using block_t = unsigned long;
 using set_t = block_t*;
 
+// Sets are allocated from a per-thread pool. Sets of up to SET_INLINE_BITS bits share one
+// fixed slot size, which covers the incidences of the relaxations for K <= 5, so
+// resizing them is done in place.
+constexpr int SET_INLINE_BITS = 512;
+
 set_t set_create(int num_bits);
 
 set_t set_resize(set_t set, int num_bits);
@@ -29,6 +36,9 @@ void set_enable_bit(set_t set, int n);
 
 void set_enable_all(set_t set);
 
+// Enables the bits n + i for every bit i that is set in block.
+void set_enable_bits(set_t set, int n, block_t block);
+
 bool set_intersect_by_any(set_t first, set_t second);
 
 set_t set_intersect(set_t first, set_t second);
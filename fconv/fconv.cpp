@@ -1,4 +1,7 @@
 #include <string.h>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include "utils.h"
 #include "fconv.h"
 #include "relaxation.h"
@@ -23,53 +26,140 @@ void free_MatInt(MatInt cmat) {
     free((int *) cmat.data);
 }
 
+void free_MatDoubleBatch(MatDoubleBatch batch) {
+    free(batch.row_offsets);
+    free(batch.data);
+}
+
 enum Version {
     Fast,
     CDD,
     Orthant
 };
 
-MatDouble compute_relaxation(MatDouble input_hrep,
-                             Activation activation,
-                             Version version) {
-    dd_set_global_constants();
-    const int K = input_hrep.cols - 1;
-    vector<double*> A = mat_external_to_internal_format(input_hrep);
-
-    vector<double*> H;
+// Expects cdd's global constants to be set.
+vector<double*> compute_relaxation_H(const int K,
+                                     const vector<double*>& A,
+                                     Activation activation,
+                                     Version version) {
     if (version == Orthant) {
-        H = relaxation_orthant(K, A, activation);
+        return relaxation_orthant(K, A, activation);
     } else if (activation == Relu && version == Fast) {
-        H = fast_relaxation_through_decomposition(K, A, Relu);
+        return fast_relaxation_through_decomposition(K, A, Relu);
     } else if (activation == Relu && version == CDD) {
-        H = krelu_with_cdd(K, A);
+        return krelu_with_cdd(K, A);
     } else if (activation == Pool && version == Fast) {
-        H = fkpool(K, A);
+        return fkpool(K, A);
     } else if (activation == Pool && version == CDD) {
-        H = kpool_with_cdd(K, A);
+        return kpool_with_cdd(K, A);
     } else if (activation == Tanh && version == Fast) {
-        H = fast_relaxation_through_decomposition(K, A, activation);
+        return fast_relaxation_through_decomposition(K, A, activation);
     } else if (activation == Tanh && version == CDD) {
-        H = ktasi_with_cdd(K, A, activation);
+        return ktasi_with_cdd(K, A, activation);
     } else if (activation == Sigm && version == Fast) {
-        H = fast_relaxation_through_decomposition(K, A, activation);
+        return fast_relaxation_through_decomposition(K, A, activation);
     } else if (activation == Sigm && version == CDD) {
-        H = ktasi_with_cdd(K, A, activation);
-    }
-    else {
-        throw runtime_error("Unknown activation function and version.");
+        return ktasi_with_cdd(K, A, activation);
     }
+    throw runtime_error("Unknown activation function and version.");
+}
 
-    MatDouble out = (activation == Pool) ?
-            mat_internal_to_external_format(K + 2, H) :
-            mat_internal_to_external_format(2 * K + 1, H);
+int relaxation_cols(const int K, Activation activation) {
+    return (activation == Pool) ? K + 2 : 2 * K + 1;
+}
+
+MatDouble compute_relaxation(MatDouble input_hrep,
+                             Activation activation,
+                             Version version) {
+    cdd_global_constants_acquire();
+    const int K = input_hrep.cols - 1;
+    vector<double*> A = mat_external_to_internal_format(input_hrep);
+
+    vector<double*> H = compute_relaxation_H(K, A, activation, version);
+
+    MatDouble out = mat_internal_to_external_format(relaxation_cols(K, activation), H);
 
     fp_mat_free(A);
     fp_mat_free(H);
-    dd_free_global_constants();
+    cdd_global_constants_release();
     return out;
 }
 
+// Inputs are handed out one at a time from a shared counter since their cost varies a lot.
+// Each thread copies its inputs into one reusable buffer instead of allocating rows per call,
+// and flattens every relaxation itself, so that its rows go back to the thread's own pool
+// for the next input. The relaxations are gathered into a single buffer once all threads are done.
+MatDoubleBatch compute_relaxation_batch(MatDoubleBatch input_hreps,
+                                        Activation activation,
+                                        int num_threads) {
+    const int K = input_hreps.cols - 1;
+    const int num_mats = input_hreps.num_mats;
+    const int cols = relaxation_cols(K, activation);
+    ASRTF(K >= 1, "Only cols > 1 is allowed");
+    if (num_threads <= 0) {
+        num_threads = max(1, (int) thread::hardware_concurrency());
+    }
+    num_threads = max(1, min(num_threads, num_mats));
+
+    cdd_global_constants_acquire();
+    vector<vector<double>> results(num_mats);
+    atomic<int> next(0);
+    exception_ptr error = nullptr;
+    atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        vector<double> scratch;
+        vector<double*> A;
+        try {
+            for (int i = next++; i < num_mats && !failed; i = next++) {
+                const int start = input_hreps.row_offsets[i];
+                const int rows = input_hreps.row_offsets[i + 1] - start;
+                scratch.assign(input_hreps.data + (size_t) start * input_hreps.cols,
+                               input_hreps.data + (size_t) (start + rows) * input_hreps.cols);
+                A.resize(rows);
+                for (int r = 0; r < rows; r++) {
+                    A[r] = &scratch[(size_t) r * input_hreps.cols];
+                }
+                vector<double*> H = compute_relaxation_H(K, A, activation, Fast);
+                results[i].resize(H.size() * cols);
+                for (size_t r = 0; r < H.size(); r++) {
+                    memcpy(&results[i][r * cols], H[r], cols * sizeof(double));
+                }
+                fp_mat_free(H);
+            }
+        } catch (...) {
+            if (!failed.exchange(true)) {
+                error = current_exception();
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (int t = 1; t < num_threads; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+    cdd_global_constants_release();
+
+    if (error) {
+        rethrow_exception(error);
+    }
+
+    auto row_offsets = (int *) malloc((num_mats + 1) * sizeof(int));
+    row_offsets[0] = 0;
+    for (int i = 0; i < num_mats; i++) {
+        row_offsets[i + 1] = row_offsets[i] + (int) (results[i].size() / cols);
+    }
+    auto data = (double *) malloc(max((size_t) row_offsets[num_mats] * cols, (size_t) 1) * sizeof(double));
+    for (int i = 0; i < num_mats; i++) {
+        copy(results[i].begin(), results[i].end(), &data[(size_t) row_offsets[i] * cols]);
+    }
+    return {num_mats, cols, row_offsets, data};
+}
+
 MatDouble fkrelu(MatDouble input_hrep) {
     return compute_relaxation(input_hrep, Relu, Fast);
 }
@@ -110,6 +200,26 @@ MatDouble fsigm_orthant(MatDouble input_hrep) {
     return compute_relaxation(input_hrep, Sigm, Orthant);
 }
 
+MatDoubleBatch fkrelu_batch(MatDoubleBatch input_hreps, int num_threads) {
+    return compute_relaxation_batch(input_hreps, Relu, num_threads);
+}
+
+MatDoubleBatch fkpool_batch(MatDoubleBatch input_hreps, int num_threads) {
+    return compute_relaxation_batch(input_hreps, Pool, num_threads);
+}
+
+MatDoubleBatch fktanh_batch(MatDoubleBatch input_hreps, int num_threads) {
+    return compute_relaxation_batch(input_hreps, Tanh, num_threads);
+}
+
+MatDoubleBatch fksigm_batch(MatDoubleBatch input_hreps, int num_threads) {
+    return compute_relaxation_batch(input_hreps, Sigm, num_threads);
+}
+
+void with_cdd_fallback_stats(int *num_calls, int *num_fallbacks) {
+    get_hull_fallback_stats(*num_calls, *num_fallbacks);
+}
+
 MatInt generate_sparse_cover(const int N, const int K) {
     vector<vector<int>> cover = sparse_cover(N, K);
     // I'm not sure how to combine std::vector and ctypes thus converting to plain array format.
@@ -13,6 +13,15 @@ typedef struct {
     int *data;
 } MatInt;
 
+// Many H-representations with the same number of columns stored back to back,
+// matrix i occupies rows [row_offsets[i], row_offsets[i + 1]) of data.
+typedef struct {
+    int num_mats;
+    int cols;
+    int *row_offsets;
+    double *data;
+} MatDoubleBatch;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,6 +35,8 @@ void free_MatDouble(MatDouble mat);
 
 void free_MatInt(MatInt mat);
 
+void free_MatDoubleBatch(MatDoubleBatch batch);
+
 MatDouble fkrelu(MatDouble input_hrep);
 
 MatDouble krelu_with_cdd(MatDouble input_hrep);
@@ -46,6 +57,20 @@ MatDouble ftanh_orthant(MatDouble input_hrep);
 
 MatDouble fsigm_orthant(MatDouble input_hrep);
 
+// Batched versions of the fast relaxations: every input of the batch is relaxed
+// independently on num_threads threads (all hardware threads if num_threads <= 0).
+MatDoubleBatch fkrelu_batch(MatDoubleBatch input_hreps, int num_threads);
+
+MatDoubleBatch fkpool_batch(MatDoubleBatch input_hreps, int num_threads);
+
+MatDoubleBatch fktanh_batch(MatDoubleBatch input_hreps, int num_threads);
+
+MatDoubleBatch fksigm_batch(MatDoubleBatch input_hreps, int num_threads);
+
+// The *_with_cdd relaxations compute their hull in fp first and fall back to exact arithmetic
+// only on degeneracies, this reports the number of hulls computed so far and of the fallbacks.
+void with_cdd_fallback_stats(int *num_calls, int *num_fallbacks);
+
 MatInt generate_sparse_cover(int N, int K);
 
 void S_curve_chord_bound(double* k, double* b, double x_lb, double x_ub, bool is_sigm);
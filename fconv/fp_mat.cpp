@@ -6,6 +6,8 @@
 #include <string.h>
 #include <limits>
 #include <iomanip>
+#include <cstdint>
+#include <cassert>
 #include "fp_mat.h"
 #include "asrt.h"
 #include "setoper.h"
@@ -13,12 +15,231 @@
 
 using namespace std;
 
+constexpr int FP_MAT_ALIGNMENT = 32;
+constexpr int FP_MAT_ROW_MULTIPLE = FP_MAT_ALIGNMENT / sizeof(double);
+
+inline int fp_mat_stride(const int cols) {
+    return (cols + FP_MAT_ROW_MULTIPLE - 1) / FP_MAT_ROW_MULTIPLE * FP_MAT_ROW_MULTIPLE;
+}
+
+FpMat::FpMat() : num_rows(0), num_cols(0), row_stride(0), capacity(0), data(nullptr), allocation(nullptr) {}
+
+FpMat::FpMat(const int rows, const int cols) : FpMat() {
+    assert(rows >= 0 && cols >= 0 && "Expected non-negative rows and cols.");
+    num_cols = cols;
+    row_stride = fp_mat_stride(cols);
+    reserve(rows);
+    resize_rows(rows);
+}
+
+FpMat::FpMat(const int cols, const vector<double*>& rows) : FpMat((int) rows.size(), cols) {
+    for (size_t i = 0; i < rows.size(); i++) {
+        memcpy((*this)[i], rows[i], cols * sizeof(double));
+    }
+}
+
+FpMat::FpMat(FpMat&& other) noexcept :
+        num_rows(other.num_rows), num_cols(other.num_cols), row_stride(other.row_stride),
+        capacity(other.capacity), data(other.data), allocation(other.allocation) {
+    other.num_rows = 0;
+    other.capacity = 0;
+    other.data = nullptr;
+    other.allocation = nullptr;
+}
+
+FpMat& FpMat::operator=(FpMat&& other) noexcept {
+    if (this != &other) {
+        free(allocation);
+        num_rows = other.num_rows;
+        num_cols = other.num_cols;
+        row_stride = other.row_stride;
+        capacity = other.capacity;
+        data = other.data;
+        allocation = other.allocation;
+        other.num_rows = 0;
+        other.capacity = 0;
+        other.data = nullptr;
+        other.allocation = nullptr;
+    }
+    return *this;
+}
+
+FpMat::~FpMat() {
+    free(allocation);
+}
+
+void FpMat::reallocate(const int new_capacity, const int new_stride) {
+    const size_t bytes = (size_t) new_capacity * new_stride * sizeof(double);
+    void* new_allocation = malloc(bytes + FP_MAT_ALIGNMENT);
+    if (new_allocation == nullptr) {
+        throw runtime_error("Failed to allocate the matrix.");
+    }
+    auto new_data = (double*) (((uintptr_t) new_allocation + FP_MAT_ALIGNMENT - 1) & ~((uintptr_t) FP_MAT_ALIGNMENT - 1));
+    if (num_rows > 0 && new_stride == row_stride) {
+        memcpy(new_data, data, (size_t) num_rows * row_stride * sizeof(double));
+    } else {
+        const int copied = min(row_stride, new_stride);
+        for (int i = 0; i < num_rows; i++) {
+            double* row = new_data + (size_t) i * new_stride;
+            memcpy(row, (*this)[i], copied * sizeof(double));
+            memset(row + copied, 0, (new_stride - copied) * sizeof(double));
+        }
+    }
+    free(allocation);
+    allocation = new_allocation;
+    data = new_data;
+    capacity = new_capacity;
+    row_stride = new_stride;
+}
+
+void FpMat::reserve(const int rows) {
+    if (rows > capacity) {
+        reallocate(rows, row_stride);
+    }
+}
+
+double* FpMat::push_row() {
+    if (num_rows == capacity) {
+        reallocate(max(2 * capacity, 4), row_stride);
+    }
+    double* row = (*this)[num_rows];
+    memset(row, 0, row_stride * sizeof(double));
+    num_rows++;
+    return row;
+}
+
+void FpMat::push_row(const double* row) {
+    memcpy(push_row(), row, num_cols * sizeof(double));
+}
+
+void FpMat::append_rows(const FpMat& other) {
+    assert(other.num_cols == num_cols && "Matrices should have the same number of columns.");
+    if (other.num_rows == 0) {
+        return;
+    }
+    if (num_rows + other.num_rows > capacity) {
+        reallocate(max(num_rows + other.num_rows, 2 * capacity), row_stride);
+    }
+    memcpy((*this)[num_rows], other.data, (size_t) other.num_rows * row_stride * sizeof(double));
+    num_rows += other.num_rows;
+}
+
+void FpMat::resize_rows(const int rows) {
+    assert(rows >= 0 && "Expected non-negative rows.");
+    reserve(rows);
+    if (rows > num_rows) {
+        memset((*this)[num_rows], 0, (size_t) (rows - num_rows) * row_stride * sizeof(double));
+    }
+    num_rows = rows;
+}
+
+void FpMat::resize_cols(const int cols) {
+    assert(cols >= 0 && "Expected non-negative cols.");
+    // Padding is kept at zero, thus only the dropped columns have to be cleared.
+    for (int i = 0; i < num_rows; i++) {
+        double* row = (*this)[i];
+        for (int j = cols; j < num_cols; j++) {
+            row[j] = 0;
+        }
+    }
+    const int new_stride = fp_mat_stride(cols);
+    if (new_stride != row_stride) {
+        if (capacity > 0) {
+            reallocate(capacity, new_stride);
+        } else {
+            row_stride = new_stride;
+        }
+    }
+    num_cols = cols;
+}
+
+FpMat FpMat::copy() const {
+    FpMat mat(num_rows, num_cols);
+    if (num_rows > 0) {
+        memcpy(mat.data, data, (size_t) num_rows * row_stride * sizeof(double));
+    }
+    return mat;
+}
+
+vector<double*> FpMat::to_rows() const {
+    vector<double*> mat(num_rows);
+    for (int i = 0; i < num_rows; i++) {
+        mat[i] = fp_arr_copy(num_cols, (double*) (*this)[i]);
+    }
+    return mat;
+}
+
+// Rows are recycled per thread in power of two capacity classes, like the sets of
+// dynamic_bitset, so the rows created and freed for every relaxation don't go to the
+// allocator. A row keeps its capacity class in a header in front of it, thus it can be
+// released without knowing its size. The header is two doubles long to keep the row as
+// aligned as malloc would.
+constexpr int FP_ROW_HEADER = 2;
+constexpr int FP_ROW_MIN_CLASS = 2;
+// Upper bound on the number of free rows a pool keeps per capacity class.
+constexpr size_t FP_ROW_POOL_MAX_FREE = 1 << 14;
+
+inline int fp_row_capacity_class(const int n) {
+    if (n <= (1 << FP_ROW_MIN_CLASS)) {
+        return FP_ROW_MIN_CLASS;
+    }
+    return 32 - __builtin_clz((unsigned) n - 1);
+}
+
+inline int fp_row_capacity(const double* row) {
+    return 1 << (int) row[-FP_ROW_HEADER];
+}
+
+struct FpRowPool {
+    vector<double*> free_rows[32];
+
+    ~FpRowPool() {
+        for (auto& rows : free_rows) {
+            for (double* row : rows) {
+                free(row - FP_ROW_HEADER);
+            }
+        }
+    }
+};
+
+thread_local FpRowPool fp_row_pool;
+
+// The returned row is not initialized.
+inline double* fp_row_acquire(const int n) {
+    assert(n >= 0 && "n should be non-negative.");
+    const int capacity_class = fp_row_capacity_class(n);
+    vector<double*>& rows = fp_row_pool.free_rows[capacity_class];
+    if (!rows.empty()) {
+        double* row = rows.back();
+        rows.pop_back();
+        return row;
+    }
+    auto block = (double*) malloc(((1 << capacity_class) + FP_ROW_HEADER) * sizeof(double));
+    ASRTF(block != nullptr, "Failed to allocate a row.");
+    block[0] = capacity_class;
+    return block + FP_ROW_HEADER;
+}
+
+inline void fp_row_release(double* row) {
+    if (row == nullptr) {
+        return;
+    }
+    vector<double*>& rows = fp_row_pool.free_rows[(int) row[-FP_ROW_HEADER]];
+    if (rows.size() >= FP_ROW_POOL_MAX_FREE) {
+        free(row - FP_ROW_HEADER);
+        return;
+    }
+    rows.push_back(row);
+}
+
 double* fp_arr_create(const int n) {
-    return (double*) calloc(n, sizeof(double));
+    double* arr = fp_row_acquire(n);
+    memset(arr, 0, n * sizeof(double));
+    return arr;
 }
 
 double* fp_arr_copy(const int n, double* src) {
-    auto arr = (double*) calloc(n, sizeof(double));
+    double* arr = fp_row_acquire(n);
     memcpy(arr, src, n * sizeof(double));
     return arr;
 }
@@ -31,17 +252,26 @@ double* fp_arr_resize(const int new_n, const int old_n, double* arr) {
     if (new_n == old_n) {
         return arr;
     }
-    arr = (double*) realloc(arr, new_n * sizeof(double));
+    if (new_n > fp_row_capacity(arr)) {
+        double* moved = fp_row_acquire(new_n);
+        memcpy(moved, arr, old_n * sizeof(double));
+        fp_row_release(arr);
+        arr = moved;
+    }
     for (int i = old_n; i < new_n; i++) {
         arr[i] = 0;
     }
     return arr;
 }
 
+void fp_arr_free(double* arr) {
+    fp_row_release(arr);
+}
+
 vector<double*> fp_mat_create(const int rows, const int cols) {
     vector<double*> mat(rows);
     for (int i = 0; i < rows; i++) {
-        mat[i] = (double*) calloc(cols, sizeof(double));
+        mat[i] = fp_arr_create(cols);
     }
     return mat;
 }
@@ -56,25 +286,34 @@ vector<double*> fp_mat_copy(const int cols, const vector<double*>& src) {
 
 void fp_mat_free(const vector<double*>& mat) {
     for (auto v : mat) {
-        free(v);
-    }
-}
-
-// This can be optimized if there will be a need for it.
-vector<double*> fp_mat_mul_with_transpose(const int n,
-                                         const vector<double*>& A,
-                                         const vector<double*>& B) {
-    vector<double*> Res = fp_mat_create(A.size(), B.size());
-    for (size_t i = 0; i < A.size(); i++) {
-        double* a = A[i];
-        double* res = Res[i];
-        for (size_t j = 0; j < B.size(); j++) {
-            double* b = B[j];
-            double accum = 0;
-            for (int d = 0; d < n; d++) {
-                accum += a[d] * b[d];
+        fp_row_release(v);
+    }
+}
+
+// B is transposed first, so that every row of the result is accumulated with
+// contiguous and aligned loads. Each entry is still summed in the order of the
+// columns, which gives the same result as the dot products one by one.
+FpMat fp_mat_mul_with_transpose(const FpMat& A, const FpMat& B) {
+    assert(A.cols() == B.cols() && "Matrices should have the same number of columns.");
+    const int n = A.cols();
+    FpMat B_t(n, B.rows());
+    for (int j = 0; j < B.rows(); j++) {
+        const double* b = B[j];
+        for (int d = 0; d < n; d++) {
+            B_t[d][j] = b[d];
+        }
+    }
+    FpMat Res(A.rows(), B.rows());
+    const int stride = Res.stride();
+    for (int i = 0; i < A.rows(); i++) {
+        const double* a = A[i];
+        auto res = (double*) __builtin_assume_aligned(Res[i], FP_MAT_ALIGNMENT);
+        for (int d = 0; d < n; d++) {
+            const double a_d = a[d];
+            auto b_t = (const double*) __builtin_assume_aligned(B_t[d], FP_MAT_ALIGNMENT);
+            for (int j = 0; j < stride; j++) {
+                res[j] += a_d * b_t[j];
             }
-            res[j] = accum;
         }
     }
     return Res;
@@ -88,7 +327,7 @@ vector<double*> fp_mat_read(const int cols, const string& path) {
     vector<double*> mat;
     while (getline(file, row_string)) {
         istringstream row_stream(row_string);
-        double* row = (double*) calloc(cols, sizeof(double));
+        double* row = fp_arr_create(cols);
         int i = 0;
         double number;
         while (row_stream >> number) {
@@ -6,6 +6,62 @@
 
 using namespace std;
 
+// Row-major matrix in a single 32-byte aligned allocation that owns its memory.
+// Rows are padded with zeros to a multiple of 4 doubles, so every row starts at
+// an aligned address and can be processed with full AVX2 registers.
+class FpMat {
+public:
+    FpMat();
+    FpMat(int rows, int cols);
+    FpMat(int cols, const vector<double*>& rows);
+    FpMat(FpMat&& other) noexcept;
+    FpMat& operator=(FpMat&& other) noexcept;
+    FpMat(const FpMat& other) = delete;
+    FpMat& operator=(const FpMat& other) = delete;
+    ~FpMat();
+
+    int rows() const { return num_rows; }
+    int cols() const { return num_cols; }
+    int stride() const { return row_stride; }
+    bool empty() const { return num_rows == 0; }
+
+    double* operator[](int i) { return data + (size_t) i * row_stride; }
+    const double* operator[](int i) const { return data + (size_t) i * row_stride; }
+
+    void reserve(int rows);
+
+    // Appends a row of zeros and returns a view of it.
+    double* push_row();
+
+    void push_row(const double* row);
+
+    void append_rows(const FpMat& other);
+
+    // Keeps the first rows, or appends rows of zeros.
+    void resize_rows(int rows);
+
+    // New columns are set to zero.
+    void resize_cols(int cols);
+
+    FpMat copy() const;
+
+    vector<double*> to_rows() const;
+
+private:
+    int num_rows;
+    int num_cols;
+    int row_stride;
+    int capacity;
+    double* data;
+    // posix_memalign is several times slower than malloc for small sizes,
+    // thus data is aligned within a slightly larger malloc'ed block.
+    void* allocation;
+
+    void reallocate(int new_capacity, int new_stride);
+};
+
+// Rows created by the fp_arr_* and fp_mat_* functions come from a per thread pool
+// and have to be freed with fp_arr_free or fp_mat_free rather than free.
 double* fp_arr_create(int n);
 
 double* fp_arr_copy(int n, double* src);
@@ -14,15 +70,15 @@ void fp_arr_set(int n, double* dst, double* src);
 
 double* fp_arr_resize(int new_n, int old_n, double* arr);
 
+void fp_arr_free(double* arr);
+
 vector<double*> fp_mat_create(int rows, int cols);
 
 vector<double*> fp_mat_copy(int cols, const vector<double*>& src);
 
 void fp_mat_free(const vector<double*>& mat);
 
-vector<double*> fp_mat_mul_with_transpose(int n,
-                                       const vector<double*>& mat1,
-                                       const vector<double*>& mat2);
+FpMat fp_mat_mul_with_transpose(const FpMat& mat1, const FpMat& mat2);
 
 vector<double*> fp_mat_read(int cols, const string& path);
 
@@ -1,5 +1,6 @@
 #include <cassert>
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #include "mpq.h"
 #include "asrt.h"
@@ -7,8 +8,40 @@
 
 using namespace std;
 
+// Rows of up to MPQ_POOL_MAX_N elements are recycled per thread and keep their
+// mpq_t initialized, so the vertices created and freed for every relaxation don't
+// allocate each element again. Rows are always used with their exact size, thus
+// they are pooled by size. A row freed by another thread than the one that created
+// it simply moves to that thread's pool.
+constexpr int MPQ_POOL_MAX_N = 32;
+// Upper bound on the number of free rows a pool keeps per size.
+constexpr size_t MPQ_POOL_MAX_FREE = 1 << 12;
+
+struct MpqRowPool {
+    vector<mpq_t*> free_rows[MPQ_POOL_MAX_N + 1];
+
+    ~MpqRowPool() {
+        for (int n = 0; n <= MPQ_POOL_MAX_N; n++) {
+            for (mpq_t* row : free_rows[n]) {
+                for (int i = 0; i < n; i++) {
+                    mpq_clear(row[i]);
+                }
+                free(row);
+            }
+        }
+    }
+};
+
+thread_local MpqRowPool mpq_row_pool;
+
 mpq_t* mpq_arr_create(const int n) {
     assert(n >= 0 && "n should be non-negative.");
+    if (n <= MPQ_POOL_MAX_N && !mpq_row_pool.free_rows[n].empty()) {
+        mpq_t* arr = mpq_row_pool.free_rows[n].back();
+        mpq_row_pool.free_rows[n].pop_back();
+        mpq_arr_set_zero(n, arr);
+        return arr;
+    }
     auto arr = (mpq_t*) calloc(n, sizeof(mpq_t));
     for (int i = 0; i < n; i++) {
         mpq_init(arr[i]);
@@ -44,20 +77,20 @@ mpq_t* mpq_arr_resize(const int new_n, const int old_n, mpq_t* arr) {
     if (new_n == old_n) {
         return arr;
     }
-    // If new_n is smaller than old_n, this will free all removed mpq_t.
-    for (int i = new_n; i < old_n; i++) {
-        mpq_clear(arr[i]);
-    }
-    mpq_t* new_arr = (mpq_t*) realloc(arr, new_n * sizeof(mpq_t));
-    // If new_n is greater than old_n, this will allocate all added mpq_t.
-    for (int i = old_n; i < new_n; i++) {
-        mpq_init(new_arr[i]);
+    mpq_t* new_arr = mpq_arr_create(new_n);
+    for (int i = 0; i < min(new_n, old_n); i++) {
+        mpq_swap(new_arr[i], arr[i]);
     }
+    mpq_arr_free(old_n, arr);
     return new_arr;
 }
 
 void mpq_arr_free(const int n, mpq_t* arr) {
     assert(n >= 0 && "n should be non-negative.");
+    if (n <= MPQ_POOL_MAX_N && mpq_row_pool.free_rows[n].size() < MPQ_POOL_MAX_FREE) {
+        mpq_row_pool.free_rows[n].push_back(arr);
+        return;
+    }
     for (int i = 0; i < n; i++) {
         mpq_clear(arr[i]);
     }
@@ -146,7 +179,7 @@ vector<mpq_t*> mpq_mat_mul_with_transpose(const int n,
 vector<double*> mpq_mat_to_fp(const int n, const vector<mpq_t*>& mpq_A) {
     vector<double*> A(mpq_A.size());
     for (size_t i = 0; i < mpq_A.size(); i++) {
-        double* row = (double*) calloc(n, sizeof(double));
+        double* row = fp_arr_create(n);
         A[i] = row;
         const mpq_t* mpq_row = mpq_A[i];
         for (int j = 0; j < n; j++) {
@@ -156,6 +189,18 @@ vector<double*> mpq_mat_to_fp(const int n, const vector<mpq_t*>& mpq_A) {
     return A;
 }
 
+FpMat mpq_mat_to_fp_mat(const int n, const vector<mpq_t*>& mpq_A) {
+    FpMat A(mpq_A.size(), n);
+    for (size_t i = 0; i < mpq_A.size(); i++) {
+        double* row = A[i];
+        const mpq_t* mpq_row = mpq_A[i];
+        for (int j = 0; j < n; j++) {
+            row[j] = mpq_get_d(mpq_row[j]);
+        }
+    }
+    return A;
+}
+
 vector<mpq_t*> mpq_mat_from_fp(const int n, const vector<double*>& A) {
     vector<mpq_t*> mpq_A(A.size());
     for (size_t i = 0; i < A.size(); i++) {
@@ -2,6 +2,7 @@
 
 #include <gmp.h>
 #include <vector>
+#include "fp_mat.h"
 
 using namespace std;
 
@@ -33,6 +34,8 @@ vector<mpq_t*> mpq_mat_mul_with_transpose(int n, const vector<mpq_t*>& A, const
 
 vector<double*> mpq_mat_to_fp(int n, const vector<mpq_t*>& mpq_A);
 
+FpMat mpq_mat_to_fp_mat(int n, const vector<mpq_t*>& mpq_A);
+
 vector<mpq_t*> mpq_mat_from_fp(int n, const vector<double*>& A);
 
 void mpq_mat_print(const int n, const vector<mpq_t*>& mat);
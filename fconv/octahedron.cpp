@@ -3,16 +3,13 @@
 #include <cassert>
 #include <algorithm>
 #include <math.h>
+#include <float.h>
 #include "octahedron.h"
 #include "utils.h"
 #include "mpq.h"
 #include "dynamic_bitset.h"
 #include "fp_mat.h"
 
-// The absolutely proper way would be to set it based on the size of the input constraints.
-// But I will just keep it fixed for now - I use this value to do partially solve problem in fp precision.
-constexpr double DOUBLE_PRECISION = 0.1;
-
 const vector<int> DIRECTION_2 = {1, 3};
 
 const vector<int> DIRECTION_3 = {1, 5, 17};
@@ -115,13 +112,15 @@ struct Vertex {
     int id{};
 };
 
-// TODO[gleb] Can also be used by comparing doubles before going to mpq - that can accelerate
-// the comparison function.
+// Orders vertices lexicographically by their exact coordinates. The doubles are obtained with mpq_get_d
+// that truncates, which is monotone, so different doubles already decide the order of the exact values.
 struct MpqCompareVertex {
     bool operator() (const Vertex& lhs, const Vertex& rhs) const {
-        // Can also compare with doubles and only then with
         const int K = (int) lhs.v_double.size();
         for (int i = 0; i < K; i++) {
+            if (lhs.v_double[i] != rhs.v_double[i]) {
+                return lhs.v_double[i] < rhs.v_double[i];
+            }
             int cmp = mpq_cmp(lhs.v[i + 1], rhs.v[i + 1]);
             if (cmp < 0) {
                 return true;
@@ -159,23 +158,128 @@ bool vertices_divided_by_orthant(const mpq_t* v1, const mpq_t* v2, const int K)
     return false;
 }
 
+vector<int> constraints_cross_product(const int K, const vector<vector<int>>& COEFS, const vector<int>& comb) {
+    if (K == 2) {
+        return cross_product_2(COEFS[comb[0]]);
+    } else if (K == 3) {
+        return cross_product_3(COEFS[comb[0]], COEFS[comb[1]]);
+    }
+    return cross_product_4(COEFS[comb[0]], COEFS[comb[1]], COEFS[comb[2]]);
+}
+
+// Components of the directions are within [-7, 7], so every component takes 4 bits.
+inline int pack_direction(const vector<int>& dir) {
+    int key = 0;
+    for (size_t i = 0; i < dir.size(); i++) {
+        key |= (dir[i] + 8) << (4 * i);
+    }
+    return key;
+}
+
+/*
+ * The edges of the octahedron can only go along the cross products of K - 1 constraints, and these
+ * only depend on the constraint coefficients and not on the offsets. Thus they are enumerated once per K,
+ * together with their scalar products with all the constraints.
+ */
+struct OctahedronDirections {
+    // Oriented to have a positive scalar product with the main direction and sorted lexicographically,
+    // so ordering the ids orders the directions.
+    vector<vector<int>> directions;
+
+    // products[dir_id * NUM_H + hi] is the scalar product of the direction dir_id with the constraint hi.
+    vector<int> products;
+
+    // Id of a packed direction, both orientations of a direction map to the same id.
+    vector<int> key2id;
+};
+
+OctahedronDirections compute_octahedron_directions(const int K) {
+    const int NUM_H = K2NUM_H[K];
+    const vector<vector<int>>& COEFS = K2OCTAHEDRON_COEFS[K];
+    const vector<int>& MAIN_DIRECTION = K2DIRECTION[K];
+
+    vector<int> all_hyperplanes(NUM_H);
+    for (int hi = 0; hi < NUM_H; hi++) {
+        all_hyperplanes[hi] = hi;
+    }
+
+    set<vector<int>> directions;
+    for (const auto& comb : generate_hyperplane_combinations(all_hyperplanes, K)) {
+        vector<int> dir = constraints_cross_product(K, COEFS, comb);
+        int product_with_main_direction = scalar_product(MAIN_DIRECTION, dir);
+        // The product with the main direction can't be zero, because I select main direction in such way that no
+        // combination of hyperplanes produces a direction orthogonal to it.
+        if (product_with_main_direction == 0) {
+            for (int i = 0; i < K; i++) {
+                ASRTF(dir[i] == 0, "Scalar product with the direction can't be zero.");
+            }
+            continue;
+        }
+        if (product_with_main_direction < 0) {
+            for (int i = 0; i < K; i++) {
+                dir[i] = -dir[i];
+            }
+        }
+        for (int i = 0; i < K; i++) {
+            ASRTF(-8 < dir[i] && dir[i] < 8, "Direction component doesn't fit the packing.");
+        }
+        directions.insert(dir);
+    }
+
+    OctahedronDirections res;
+    res.directions.assign(directions.begin(), directions.end());
+    res.products.resize(res.directions.size() * NUM_H);
+    res.key2id.assign(1 << (4 * K), -1);
+    for (int dir_id = 0; dir_id < (int) res.directions.size(); dir_id++) {
+        vector<int> dir = res.directions[dir_id];
+        for (int hi = 0; hi < NUM_H; hi++) {
+            res.products[dir_id * NUM_H + hi] = scalar_product(dir, COEFS[hi]);
+        }
+        res.key2id[pack_direction(dir)] = dir_id;
+        for (int i = 0; i < K; i++) {
+            dir[i] = -dir[i];
+        }
+        res.key2id[pack_direction(dir)] = dir_id;
+    }
+    return res;
+}
+
+const OctahedronDirections& get_octahedron_directions(const int K) {
+    // Function-local statics are initialized on first use and that is thread-safe.
+    if (K == 2) {
+        static const OctahedronDirections directions_2 = compute_octahedron_directions(2);
+        return directions_2;
+    } else if (K == 3) {
+        static const OctahedronDirections directions_3 = compute_octahedron_directions(3);
+        return directions_3;
+    }
+    ASRTF(K == 4, "K should be within allowed range.");
+    static const OctahedronDirections directions_4 = compute_octahedron_directions(4);
+    return directions_4;
+}
+
 struct OctahedronToV_Helper {
     const int K;
     const int NUM_H;
 
     const vector<vector<int>>& COEFS;
     const vector<int>& MAIN_DIRECTION;
+    const OctahedronDirections& DIRECTIONS;
     const int PRECOMP_FIRST_SIZE;
     const int PRECOMP_LAST_SIZE;
 
     mpq_t* constraints {};
     vector<double> constraints_double;
 
-    mpq_t* vertex_precomp_first {};
-    mpq_t* vertex_precomp_last {};
     vector<double> vertex_precomp_first_double;
     vector<double> vertex_precomp_last_double;
 
+    // Slacks of the constraints at the vertex that is being visited, computed in fp, with bounds on their errors.
+    vector<double> slack_double;
+    vector<double> slack_error;
+    vector<double> t_double;
+    vector<double> t_error;
+
     // Used to keep track of # of vertices processed so far. Is used to distribute ids to vertices.
     int vertex_count;
 
@@ -188,11 +292,16 @@ struct OctahedronToV_Helper {
         NUM_H(K2NUM_H[K]),
         COEFS(K2OCTAHEDRON_COEFS[K]),
         MAIN_DIRECTION(K2DIRECTION[K]),
+        DIRECTIONS(get_octahedron_directions(K)),
         PRECOMP_FIRST_SIZE(K2VERTEX_PRECOMP_FIRST[K]),
         PRECOMP_LAST_SIZE(K2VERTEX_PRECOMP_LAST[K]),
         constraints_double(NUM_H),
         vertex_precomp_first_double(PRECOMP_FIRST_SIZE),
         vertex_precomp_last_double(PRECOMP_LAST_SIZE),
+        slack_double(NUM_H),
+        slack_error(NUM_H),
+        t_double(NUM_H),
+        t_error(NUM_H),
         vertex_count(0)
     {
         constraints = mpq_arr_create(NUM_H);
@@ -200,20 +309,14 @@ struct OctahedronToV_Helper {
             mpq_set_d(constraints[i], A[i][0]);
             constraints_double[i] = A[i][0];
         }
-
-        vertex_precomp_first = mpq_arr_create(PRECOMP_FIRST_SIZE);
-        vertex_precomp_last = mpq_arr_create(PRECOMP_LAST_SIZE);
     }
 
     ~OctahedronToV_Helper() {
         // I don't free up dynamically allocated memory for vertices because these pointers are extracted and reused.
         mpq_arr_free(NUM_H, constraints);
-        mpq_arr_free(PRECOMP_FIRST_SIZE, vertex_precomp_first);
-        mpq_arr_free(PRECOMP_LAST_SIZE, vertex_precomp_last);
     }
 
     void do_precomputation_for_vertex(const Vertex& cur_vertex) {
-        const mpq_t* cur_v = cur_vertex.v;
         const vector<double>& cur_v_double = cur_vertex.v_double;
 
         if (PRECOMP_FIRST_SIZE == 4) {
@@ -221,11 +324,6 @@ struct OctahedronToV_Helper {
             vertex_precomp_first_double[1] = cur_v_double[0];
             vertex_precomp_first_double[2] = cur_v_double[0] - cur_v_double[1];
             vertex_precomp_first_double[3] = cur_v_double[1];
-
-            mpq_add(vertex_precomp_first[0], cur_v[1], cur_v[2]);
-            mpq_set(vertex_precomp_first[1], cur_v[1]);
-            mpq_sub(vertex_precomp_first[2], cur_v[1], cur_v[2]);
-            mpq_set(vertex_precomp_first[3], cur_v[2]);
         } else {
             vertex_precomp_first_double[0] = cur_v_double[0] + cur_v_double[1] + cur_v_double[2];
             vertex_precomp_first_double[1] = cur_v_double[0] + cur_v_double[1];
@@ -240,56 +338,37 @@ struct OctahedronToV_Helper {
             vertex_precomp_first_double[10] = cur_v_double[1];
             vertex_precomp_first_double[11] = cur_v_double[1] - cur_v_double[2];
             vertex_precomp_first_double[12] = cur_v_double[2];
-
-            // Slightly optimized version.
-            mpq_add(vertex_precomp_first[1], cur_v[1], cur_v[2]);
-            mpq_add(vertex_precomp_first[0], vertex_precomp_first[1], cur_v[3]);
-            mpq_sub(vertex_precomp_first[2], vertex_precomp_first[1], cur_v[3]);
-            mpq_add(vertex_precomp_first[3], cur_v[1], cur_v[3]);
-            mpq_set(vertex_precomp_first[4], cur_v[1]);
-            mpq_sub(vertex_precomp_first[5], cur_v[1], cur_v[3]);
-            mpq_sub(vertex_precomp_first[7], cur_v[1], cur_v[2]);
-            mpq_add(vertex_precomp_first[6], vertex_precomp_first[7], cur_v[3]);
-            mpq_sub(vertex_precomp_first[8], vertex_precomp_first[7], cur_v[3]);
-            mpq_add(vertex_precomp_first[9], cur_v[2], cur_v[3]);
-            mpq_set(vertex_precomp_first[10], cur_v[2]);
-            mpq_sub(vertex_precomp_first[11], cur_v[2], cur_v[3]);
-            mpq_set(vertex_precomp_first[12], cur_v[3]);
-
         }
 
         if (PRECOMP_LAST_SIZE == 1) {
             vertex_precomp_last_double[0] = cur_v_double[K-1];
-
-            mpq_set(vertex_precomp_last[0], cur_v[K]);
         } else if (PRECOMP_LAST_SIZE == 4) {
             vertex_precomp_last_double[0] = cur_v_double[K-2] + cur_v_double[K-1];
             vertex_precomp_last_double[1] = cur_v_double[K-2];
             vertex_precomp_last_double[2] = cur_v_double[K-2] - cur_v_double[K-1];
             vertex_precomp_last_double[3] = cur_v_double[K-1];
-
-            mpq_add(vertex_precomp_last[0], cur_v[K-1], cur_v[K]);
-            mpq_set(vertex_precomp_last[1], cur_v[K-1]);
-            mpq_sub(vertex_precomp_last[2], cur_v[K-1], cur_v[K]);
-            mpq_set(vertex_precomp_last[3], cur_v[K]);
         } else {
             ASRTF(PRECOMP_LAST_SIZE == 0, "Expected size 0.");
         }
     }
 
-    vector<vector<int>> generate_directions(const Vertex& vertex) {
+    // Returns the ids of the directions of the edges that go from the vertex along the main direction.
+    vector<int> generate_directions(const Vertex& vertex) {
         vector<vector<int>> hyperplane_combs = generate_hyperplane_combinations(vertex.incidence, K);
 
-        set<vector<int>> directions;
+        // For every direction we determine whether it's positive, negative or non-viable.
+        // There are 4 possible cases:
+        // (1) The direction is positive iff scalar products with all hyperplanes
+        //      give >= 0 and gives > 0 with at least 1 hyperplane.
+        // (2) The direction is negative iff -//- but with <= 0 and < 0.
+        // (3) The direction is non-viable iff there are hyperplanes with which scalar
+        //      product gives < 0 and hyperplanes with which scalar product gives > 0.
+        // (4) There is an error if for some direction scalar product with all hyperplanes is 0.
+        //      It means that the vertex was not extreme in the first place.
+        // The precomputed directions are oriented along the main direction, so I only keep the positive ones.
+        vector<int> selected_directions;
         for (const auto& comb : hyperplane_combs) {
-            vector<int> direction;
-            if (K == 2) {
-                direction = cross_product_2(COEFS[comb[0]]);
-            } else if (K == 3) {
-                direction = cross_product_3(COEFS[comb[0]], COEFS[comb[1]]);
-            } else {
-                direction = cross_product_4(COEFS[comb[0]], COEFS[comb[1]], COEFS[comb[2]]);
-            }
+            vector<int> direction = constraints_cross_product(K, COEFS, comb);
 
             // It is possible that a combination of hyperplanes is linearly dependent and doesn't create a
             // direction - in that case I will just skip it.
@@ -300,73 +379,50 @@ struct OctahedronToV_Helper {
                     break;
                 }
             }
-            if (at_least_one_not_zero) {
-                directions.insert(direction);
+            if (!at_least_one_not_zero) {
+                continue;
             }
-        }
-
-        // Now for every direction we determine whether it's positive, negative or non-viable.
-        // There are 4 possible cases:
-        // (1) The direction is positive iff scalar products with all hyperplanes
-        //      give >= 0 and gives > 0 with at least 1 hyperplane.
-        // (2) The direction is negative iff -//- but with <= 0 and < 0.
-        // (3) The direction is non-viable iff there are hyperplanes with which scalar
-        //      product gives < 0 and hyperplanes with which scalar product gives > 0.
-        // (4) There is an error if for some direction scalar product with all hyperplanes is 0.
-        //      It means that the vertex was not extreme in the first place.
+            const int dir_id = DIRECTIONS.key2id[pack_direction(direction)];
+            assert(dir_id != -1 && "All directions should be precomputed.");
+            const int* products = &DIRECTIONS.products[dir_id * NUM_H];
 
-        // It is important that it is a set - otherwise there is a chance that
-        // direction is negative, I will inverse it and will create a duplicate.
-        set<vector<int>> selected_directions;
-
-        // Intentionally making a copy so I can modify it.
-        for (auto dir : directions) {
             bool is_positive = false;
             bool is_negative = false;
-
             for (int hi : vertex.incidence) {
-                const vector<int>& h = COEFS[hi];
-
-                int product = scalar_product(dir, h);
+                int product = products[hi];
                 if (product > 0) {
                     is_positive = true;
-                    if (is_negative) {
-                        // when is_negative and is_positive the direction is non-viable, I can stop early.
-                        break;
-                    }
                 } else if (product < 0) {
                     is_negative = true;
-                    if (is_positive) {
-                        // when is_negative and is_positive the direction is non-viable, I can stop early.
-                        break;
-                    }
+                    // Either non-viable or going against the main direction, I can stop early.
+                    break;
                 }
             }
-
             ASRTF(is_positive || is_negative,
                   "Going in any direction doesn't violate any hyperplanes. The vertex is not extreme.");
-            if (is_positive && is_negative) {
-                // The direction is non-viable - going in any direction will violate at least one of the incident
-                // hyperplanes.
-                continue;
-            }
-            if (is_negative) {
-                // To keep code simple, I always want to go in positive direction relative to the main direction.
-                for (int i = 0; i < K; i++) {
-                    dir[i] = -dir[i];
-                }
-            }
-            int product_with_main_direction = scalar_product(MAIN_DIRECTION, dir);
-            // The product with the main direction can't be zero, because I select main direction in such way that no
-            // edge of the octahedra can be parallel to this edge. To prove it, I try all various combinations of
-            // hyperplanes to produce the edge and make sure that the scalar product is not zero.
-            ASRTF(product_with_main_direction != 0, "Scalar product with the direction can't be zero.");
-            if (product_with_main_direction > 0) {
-                selected_directions.insert(dir);
+            if (!is_negative) {
+                selected_directions.push_back(dir_id);
             }
         }
 
-        return vector<vector<int>>(selected_directions.begin(), selected_directions.end());
+        sort(selected_directions.begin(), selected_directions.end());
+        selected_directions.erase(
+                unique(selected_directions.begin(), selected_directions.end()),
+                selected_directions.end());
+        return selected_directions;
+    }
+
+    // Computes the slack of the hyperplane at the vertex in exact arithmetic.
+    void compute_slack(mpq_t slack, const Vertex& vertex, const int hi) {
+        const vector<int>& h = COEFS[hi];
+        mpq_set(slack, constraints[hi]);
+        for (int i = 0; i < K; i++) {
+            if (h[i] == 1) {
+                mpq_add(slack, slack, vertex.v[i + 1]);
+            } else if (h[i] == -1) {
+                mpq_sub(slack, slack, vertex.v[i + 1]);
+            }
+        }
     }
 
     void visit_vertex() {
@@ -377,12 +433,10 @@ struct OctahedronToV_Helper {
         to_visit.erase(vertex_iter);
         visited.insert(vertex);
 
-        vector<vector<int>> directions = generate_directions(vertex);
+        vector<int> directions = generate_directions(vertex);
 
         do_precomputation_for_vertex(vertex);
 
-        vector<int> denom_all(directions.size());
-        vector<double> closest_t_double_all(directions.size());
         mpq_t* closest_t_all = mpq_arr_create(directions.size());
         // The hyperplanes that will be incident to the vertex reached by new direction.
         vector<vector<int>> new_hyperplanes_all(directions.size());
@@ -394,12 +448,17 @@ struct OctahedronToV_Helper {
         for (int hi : vertex.incidence) {
             set_enable_bit(incident, hi);
         }
+
+        // The fp slacks are computed from the rounded coordinates of the vertex with at most K + 1 roundings,
+        // so their error is well within (K + 4) * DBL_EPSILON of the sum of the absolute values involved.
+        double v_abs = 0;
+        for (int i = 0; i < K; i++) {
+            v_abs += fabs(vertex.v_double[i]);
+        }
         for (int hi = 0; hi < NUM_H; hi++) {
             if (set_test_bit(incident, hi)) {
-                // If the vertex is incident to the current vertex then obviously t = 0.
                 continue;
             }
-            set_t skip_direction = set_create(directions.size());
             const vector<int>& h = COEFS[hi];
 
             int precomp_first_index = -1;
@@ -433,82 +492,53 @@ struct OctahedronToV_Helper {
                 }
             }
 
-            bool at_least_one_left_to_process = false;
-            for (int dir_i = 0; dir_i < (int) directions.size(); dir_i++) {
-                // I negate denominator because I have numerator in negated form.
-                int denom_int = -scalar_product(directions[dir_i], h);
-                if (denom_int == 0) {
-                    // The hyperplane is parallel to this direction.
-                    set_enable_bit(skip_direction, dir_i);
-                    continue;
-                }
-                double cur_t_double = numer_double / (double) denom_int;
-                if (cur_t_double < -DOUBLE_PRECISION) {
-                    // Rejecting the hyperplane early based on the floating point
-                    // arithmetic because hyperplane intersects in the negative direction.
-                    set_enable_bit(skip_direction, dir_i);
-                    continue;
-                }
-                if (!new_hyperplanes_all[dir_i].empty() &&
-                    cur_t_double > closest_t_double_all[dir_i] + DOUBLE_PRECISION) {
-                    // Rejecting hyperplane because cur_t_double is significantly
-                    // bigger than best result.
-                    set_enable_bit(skip_direction, dir_i);
-                    continue;
-                }
-                at_least_one_left_to_process = true;
-                denom_all[dir_i] = denom_int;
-            }
-
-            if (!at_least_one_left_to_process) {
-                // Based on floating point arithmetics this hyperplane can't give next
-                // vertex for any of the directions.
-                // Thus just moving forward to the next hyperplane.
-                continue;
-            }
+            slack_double[hi] = numer_double;
+            slack_error[hi] = (K + 4) * DBL_EPSILON * (fabs(constraints_double[hi]) + v_abs) + DBL_MIN;
+        }
 
-            mpq_set(numer, constraints[hi]);
+        for (int dir_i = 0; dir_i < (int) directions.size(); dir_i++) {
+            const int* products = &DIRECTIONS.products[directions[dir_i] * NUM_H];
 
-            if (precomp_first_index < PRECOMP_FIRST_SIZE) {
-                mpq_add(numer, numer, vertex_precomp_first[precomp_first_index]);
-            } else if (precomp_first_index > PRECOMP_FIRST_SIZE) {
-                mpq_sub(numer, numer, vertex_precomp_first[2 * PRECOMP_FIRST_SIZE - precomp_first_index]);
-            }
-
-            if (PRECOMP_LAST_SIZE != 0) {
-                if (precomp_last_index < PRECOMP_LAST_SIZE) {
-                    mpq_add(numer, numer, vertex_precomp_last[precomp_last_index]);
-                } else if (precomp_last_index > PRECOMP_LAST_SIZE) {
-                    mpq_sub(numer, numer, vertex_precomp_last[2 * PRECOMP_LAST_SIZE - precomp_last_index]);
+            // The vertex satisfies all hyperplanes, so the direction hits the hyperplane at t > 0 iff
+            // going in the direction decreases the slack. That never happens for the incident hyperplanes,
+            // because the direction is positive. First finding the smallest t that is certainly reached
+            // according to fp arithmetic.
+            double min_t_upper = INFINITY;
+            for (int hi = 0; hi < NUM_H; hi++) {
+                if (products[hi] >= 0) {
+                    continue;
                 }
+                const double denom_double = -products[hi];
+                t_double[hi] = slack_double[hi] / denom_double;
+                t_error[hi] = 2 * slack_error[hi] / denom_double + 2 * DBL_EPSILON * fabs(t_double[hi]) + DBL_MIN;
+                min_t_upper = min(min_t_upper, t_double[hi] + t_error[hi]);
             }
 
-            int sign = mpq_sgn(numer);
-            // Can be performance critical, so normal assert.
-            assert(sign != 0 &&
-                   "Sign can't be zero, because the hyperplanes incident to the current vertex were rejected earlier.");
-
-            for (int dir_i = 0; dir_i < (int) directions.size(); dir_i++) {
-                if (set_test_bit(skip_direction, dir_i)) {
-                    // This direction was rejected earlier based on floating point arithmetic.
+            // Only the hyperplanes that can't be rejected by fp arithmetic are compared exactly.
+            // Typically that is the single hyperplane that is hit, unless there are ties.
+            vector<int>& new_hyperplanes = new_hyperplanes_all[dir_i];
+            vector<int> candidates;
+            for (int hi = 0; hi < NUM_H; hi++) {
+                if (products[hi] >= 0) {
                     continue;
                 }
-
-                int denom_int = denom_all[dir_i];
-                if ((denom_int < 0 && sign > 0) || (denom_int > 0 && sign < 0)) {
-                    // cur_t will be < 0 - this means that this direction is of no interest
-                    // because I'm only looking at the positive directions.
-                    continue;
+                if (t_double[hi] - t_error[hi] <= min_t_upper) {
+                    candidates.push_back(hi);
                 }
+            }
+
+            for (int hi : candidates) {
+                compute_slack(numer, vertex, hi);
+                // Can be performance critical, so normal assert.
+                assert(mpq_sgn(numer) > 0 &&
+                       "Slack should be positive, because the hyperplanes incident to the current vertex were rejected earlier.");
 
-                mpq_set_si(denom, denom_int, 1);
+                mpq_set_si(denom, -products[hi], 1);
                 mpq_div(cur_t, numer, denom);
 
-                vector<int>& new_hyperplanes = new_hyperplanes_all[dir_i];
                 if (new_hyperplanes.empty()) {
                     new_hyperplanes.push_back(hi);
                     mpq_set(closest_t_all[dir_i], cur_t);
-                    closest_t_double_all[dir_i] = mpq_get_d(closest_t_all[dir_i]);
                     continue;
                 }
                 int comp = mpq_cmp(cur_t, closest_t_all[dir_i]);
@@ -517,10 +547,8 @@ struct OctahedronToV_Helper {
                 } else if (comp < 0) {
                     new_hyperplanes = {hi};
                     mpq_set(closest_t_all[dir_i], cur_t);
-                    closest_t_double_all[dir_i] = mpq_get_d(closest_t_all[dir_i]);
                 }
             }
-            set_free(skip_direction);
         }
 
         set_free(incident);
@@ -530,7 +558,7 @@ struct OctahedronToV_Helper {
         mpq_init(dir_elem);
 
         for (size_t dir_i = 0; dir_i < directions.size(); dir_i++) {
-            const vector<int>& dir = directions[dir_i];
+            const vector<int>& dir = DIRECTIONS.directions[directions[dir_i]];
             vector<int>& new_hyperplanes = new_hyperplanes_all[dir_i];
             ASRTF(!new_hyperplanes.empty(),
                   "At least one hyperplane should intersect direction. Otherwise octahedron is unbounded.");
@@ -585,10 +613,9 @@ struct OctahedronToV_Helper {
             // Hyperplanes that were incident to the current vertex and
             // parallel to the direction will also be incident to
             // new vertex.
+            const int* products = &DIRECTIONS.products[directions[dir_i] * NUM_H];
             for (int hi : vertex.incidence) {
-                int product = scalar_product(dir, COEFS[hi]);
-
-                if (product == 0) {
+                if (products[hi] == 0) {
                     new_vertex.incidence.push_back(hi);
                 }
             }
@@ -603,6 +630,7 @@ struct OctahedronToV_Helper {
     }
 
     Vertex get_first_vertex() {
+        unique_lock<mutex> cdd_lock(cdd_mutex);
         dd_MatrixPtr lp_mat = dd_CreateMatrix(NUM_H, K + 1);
         for (int hi = 0; hi < NUM_H; hi++) {
             mpq_t* row = lp_mat->matrix[hi];
@@ -647,6 +675,7 @@ struct OctahedronToV_Helper {
 
         dd_FreeMatrix(lp_mat);
         dd_FreeLPData(lp);
+        cdd_lock.unlock();
 
         vector<int> first_inc;
 
@@ -726,6 +755,7 @@ OctahedronV get_octahedron_V_cdd(const int K, const vector<double*>& A) {
     dd_MatrixPtr cdd_hrep = fp_mat_to_cdd(K + 1, A);
     cdd_hrep->representation = dd_Inequality;
 
+    lock_guard<mutex> cdd_lock(cdd_mutex);
     dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(cdd_hrep);
     dd_MatrixPtr cdd_vrep = dd_CopyGenerators(poly);
 
@@ -1,46 +1,89 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "pdd.h"
 #include "fp_mat.h"
 
+constexpr int BITS_IN_BLOCK = sizeof(block_t) * CHAR_BIT;
+
 struct PDD_VInc {
-    vector<double*> V;
+    FpMat V;
     vector<set_t> incidence;
 };
 
 /*
  * The function takes ownership of the input's memory.
  */
-PDD_VInc PDD_make_irredundant(const vector<double*>& V, const vector<set_t>& incidence) {
+PDD_VInc PDD_make_irredundant(FpMat& V, const vector<set_t>& incidence) {
     assert(
-            V.size() == incidence.size() &&
-            "V.size() should equal incidence.size()");
+            V.rows() == (int) incidence.size() &&
+            "V.rows() should equal incidence.size()");
     vector<int> maximal = compute_maximal_indexes(incidence);
-    vector<double*> V_res(maximal.size());
+    FpMat V_res(0, V.cols());
+    V_res.reserve(maximal.size());
     vector<set_t> incidence_res(maximal.size());
-    set_t is_maximal = set_create(V.size());
+    set_t is_maximal = set_create(V.rows());
     for (int i : maximal) {
         set_enable_bit(is_maximal, i);
     }
     size_t count = 0;
-    for (size_t i = 0; i < V.size(); i++) {
+    for (int i = 0; i < V.rows(); i++) {
         if (set_test_bit(is_maximal, i)) {
-            V_res[count] = V[i];
+            V_res.push_row(V[i]);
             incidence_res[count] = incidence[i];
             count++;
         } else {
-            free(V[i]);
             set_free(incidence[i]);
         }
     }
     assert(count == maximal.size() && "Consistency checking that count == maximal.size().");
     set_free(is_maximal);
+    V = FpMat();
 
     assert(
-            V_res.size() == incidence_res.size() &&
-            "V_res.size() should equal incidence_res.size()");
+            V_res.rows() == (int) incidence_res.size() &&
+            "V_res.rows() should equal incidence_res.size()");
 
-    return {V_res, incidence_res};
+    return {move(V_res), incidence_res};
+}
+
+/*
+ * Classifies up to BITS_IN_BLOCK products of a vertex with the new hyperplanes,
+ * the bits of vio are the violated hyperplanes and the bits of inc the incident ones.
+ * v_x_H has to be aligned and padded to a multiple of 4, as rows of FpMat are.
+ */
+inline void PDD_classify_block(const double* v_x_H, const int count, block_t& vio, block_t& inc) {
+    vio = 0;
+    inc = 0;
+#ifdef __AVX2__
+    const __m256d neg_eps = _mm256_set1_pd(-EPS);
+    const __m256d eps = _mm256_set1_pd(EPS);
+    for (int i = 0; i < count; i += 4) {
+        __m256d val = _mm256_load_pd(v_x_H + i);
+        auto lt = (block_t) _mm256_movemask_pd(_mm256_cmp_pd(val, neg_eps, _CMP_LT_OQ));
+        auto le = (block_t) _mm256_movemask_pd(_mm256_cmp_pd(val, eps, _CMP_LE_OQ));
+        vio |= lt << i;
+        inc |= (le & ~lt) << i;
+    }
+    if (count < BITS_IN_BLOCK) {
+        // The padding past count is zero and would otherwise be classified as incident.
+        const block_t mask = ((block_t) 1 << count) - 1;
+        vio &= mask;
+        inc &= mask;
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        double val = v_x_H[i];
+        if (val < -EPS) {
+            vio |= (block_t) 1 << i;
+        } else if (val <= EPS) {
+            inc |= (block_t) 1 << i;
+        }
+    }
+#endif
 }
 
 /*
@@ -48,20 +91,24 @@ PDD_VInc PDD_make_irredundant(const vector<double*>& V, const vector<set_t>& inc
  * pdd.V and pdd.incidence to PDD_VInc.
  * It leaves pdd in inconsistent state - and the function is only to be used internally.
  */
-PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
+PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const FpMat& H_new) {
     const int dim = pdd.dim;
+    const int num_H = pdd.H.rows();
+    const int num_H_new = H_new.rows();
 
     ASRTF(!H_new.empty(), "There should be non-empty number of new hyperplanes.");
 
     assert(
-            pdd.V.size() == pdd.incidence.size() &&
+            pdd.V.rows() == (int) pdd.incidence.size() &&
             "Consistency checking number of vertices and size of incidence.");
 
-    vector<double*> V_x_H = fp_mat_mul_with_transpose(dim, pdd.V, H_new);
+    FpMat V_x_H = fp_mat_mul_with_transpose(pdd.V, H_new);
 
     // Points that violate at least one of the constraints.
     vector<int> outs;
-    vector<vector<int>> outs_violation_vec;
+    // Violated hyperplanes of outs[i] are outs_violation_idx[outs_violation_start[i]...outs_violation_start[i + 1]].
+    vector<int> outs_violation_idx;
+    vector<int> outs_violation_start = {0};
     vector<set_t> outs_violation;
     vector<set_t> outs_incidence;
     // Points that don't violate any constraints.
@@ -69,32 +116,35 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
     vector<set_t> ins_incidence;
     vector<set_t> ins_incidence_new;
 
-    for (size_t vi = 0; vi < pdd.V.size(); vi++) {
-        vector<int> vio_vec;
-        set_t vio = set_create(H_new.size());
-        set_t inc_new = set_create(H_new.size());
+    for (int vi = 0; vi < pdd.V.rows(); vi++) {
+        const int num_vio_before = outs_violation_idx.size();
+        set_t vio = set_create(num_H_new);
+        set_t inc_new = set_create(num_H_new);
         set_t& inc = pdd.incidence[vi];
-        assert(set_size(inc) == (int) pdd.H.size() && "Sanity checking the size of incidence.");
-        inc = set_resize(inc, pdd.H.size() + H_new.size());
+        assert(set_size(inc) == num_H && "Sanity checking the size of incidence.");
+        inc = set_resize(inc, num_H + num_H_new);
         const double* v_x_H = V_x_H[vi];
 
-        for (size_t hi = 0; hi < H_new.size(); hi++) {
-            double val = v_x_H[hi];
-            if (val < -EPS) {
-                vio_vec.push_back(hi);
-                set_enable_bit(vio, hi);
-            } else if (val <= EPS) {
-                set_enable_bit(inc_new, hi);
-                set_enable_bit(inc, pdd.H.size() + hi);
+        for (int first = 0; first < num_H_new; first += BITS_IN_BLOCK) {
+            block_t vio_block, inc_block;
+            PDD_classify_block(v_x_H + first, min(BITS_IN_BLOCK, num_H_new - first), vio_block, inc_block);
+            if (vio_block) {
+                set_enable_bits(vio, first, vio_block);
+                for (block_t bits = vio_block; bits; bits &= bits - 1) {
+                    outs_violation_idx.push_back(first + __builtin_ctzl(bits));
+                }
+            }
+            if (inc_block) {
+                set_enable_bits(inc_new, first, inc_block);
+                set_enable_bits(inc, num_H + first, inc_block);
             }
         }
-        assert(
-                (int) vio_vec.size() == set_count(vio) &&
-                "Sanity check violation sizes should match.");
-        if (!vio_vec.empty()) {
+        const int num_vio = (int) outs_violation_idx.size() - num_vio_before;
+        assert(num_vio == set_count(vio) && "Sanity check violation sizes should match.");
+        if (num_vio > 0) {
             set_free(inc_new);
             outs.push_back(vi);
-            outs_violation_vec.push_back(vio_vec);
+            outs_violation_start.push_back(outs_violation_idx.size());
             outs_violation.push_back(vio);
             outs_incidence.push_back(inc);
         } else {
@@ -105,17 +155,17 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
         }
     }
 
-    size_t max_count = outs.size() * ins.size() + ins.size();
-    vector<double*> V_res(max_count);
-    vector<set_t> V_res_incidence(max_count);
+    FpMat V_res(0, dim);
+    V_res.reserve(outs.size() + ins.size());
+    vector<set_t> V_res_incidence;
 
-    size_t count = 0;
     for (size_t i_out = 0; i_out < outs.size(); i_out++) {
         const int out = outs[i_out];
         const double* out_x_H = V_x_H[out];
         const double* V_out = pdd.V[out];
 
-        const vector<int>& vio_vec = outs_violation_vec[i_out];
+        const int* vio_begin = outs_violation_idx.data() + outs_violation_start[i_out];
+        const int* vio_end = outs_violation_idx.data() + outs_violation_start[i_out + 1];
         const set_t vio = outs_violation[i_out];
         const set_t out_inc = outs_incidence[i_out];
 
@@ -136,7 +186,8 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
 
             int argmin_h = -1;
             double min_ratio_h = -1;
-            for (int hi : vio_vec) {
+            for (const int* hi_p = vio_begin; hi_p != vio_end; hi_p++) {
+                const int hi = *hi_p;
                 double cur_ratio_h = -in_x_H[hi] / out_x_H[hi];
                 assert(cur_ratio_h > 0 && "Sanity check that cur_ratio is positive.");
                 assert(in_x_H[hi] > 0 && "Sanity check in_x_H[hi] > 0");
@@ -148,7 +199,7 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
             }
             const double* V_in = pdd.V[in];
 
-            double* v = fp_arr_create(dim);
+            double* v = V_res.push_row();
             double abs_coef = 0;
             double out_coef = in_x_H[argmin_h];
             double in_coef = -out_x_H[argmin_h];
@@ -160,6 +211,7 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
             assert(abs_coef >= 0 && "abs_coef can't be negative.");
             if (abs_coef <= EPS) {
                 // I.e. got the null vector, that is possible. Just ignoring it.
+                V_res.resize_rows(V_res.rows() - 1);
                 continue;
             }
 
@@ -168,15 +220,14 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
                 v[i] /= abs_coef;
             }
 
-            V_res[count] = v;
-            V_res_incidence[count] = set_intersect(in_inc, out_inc);
+            set_t v_inc = set_intersect(in_inc, out_inc);
 
             // Note that theoretically ray-shooting might hit multiple hyperplanes at a time.
             // So the incidence potentially can be slightly bigger for this vertex, and it is very
             // easy to implement it in exact precision. However, with fp its more tricky and
             // since we are anyway approximating, I'm keeping it simple.
-            set_enable_bit(V_res_incidence[count], pdd.H.size() + argmin_h);
-            count++;
+            set_enable_bit(v_inc, num_H + argmin_h);
+            V_res_incidence.push_back(v_inc);
         }
     }
 
@@ -184,36 +235,26 @@ PDD_VInc PDD_batch_intersect_helper(PDD& pdd, const vector<double*>& H_new) {
     // But for now I have removed it since it didn't prove to be very useful for our problem.
 
     for (int in : ins) {
-        V_res[count] = pdd.V[in];
-        V_res_incidence[count] = pdd.incidence[in];
-        count++;
+        V_res.push_row(pdd.V[in]);
+        V_res_incidence.push_back(pdd.incidence[in]);
     }
 
-    assert(count <= max_count && "Sanity checking the count size.");
-    V_res.resize(count);
-    V_res_incidence.resize(count);
-
     set_arr_free(outs_violation);
     set_arr_free(ins_incidence_new);
 
     for (int out : outs) {
-        free(pdd.V[out]);
         set_free(pdd.incidence[out]);
     }
+    pdd.V = FpMat();
 
-    fp_mat_free(V_x_H);
-
-    return {V_res, V_res_incidence};
+    return {move(V_res), V_res_incidence};
 }
 
-void PDD_batch_intersect(PDD& pdd, vector<double*>& H_new) {
+void PDD_batch_intersect(PDD& pdd, const FpMat& H_new) {
     PDD_VInc VInc = PDD_batch_intersect_helper(pdd, H_new);
     VInc = PDD_make_irredundant(VInc.V, VInc.incidence);
-    pdd.H.reserve(pdd.H.size() + H_new.size());
-    for (auto h : H_new) {
-        pdd.H.push_back(h);
-    }
-    pdd.V = VInc.V;
+    pdd.H.append_rows(H_new);
+    pdd.V = move(VInc.V);
     pdd.incidence = VInc.incidence;
 }
 
@@ -223,31 +264,28 @@ PDD PDD_intersect_two_PDDs(PDD& pdd1, PDD& pdd2) {
     PDD_debug_consistency_check(pdd1);
     PDD_debug_consistency_check(pdd2);
 
-    const vector<double*>& H1 = pdd1.H;
-    const vector<double*>& H2 = pdd2.H;
+    const FpMat& H1 = pdd1.H;
+    const FpMat& H2 = pdd2.H;
 
     if (H1.empty()) {
         assert(pdd1.V.empty() && "Consistency checking that pdd1.V is empty.");
-        return pdd2;
+        return move(pdd2);
     } else if (H2.empty()) {
         assert(pdd2.V.empty() && "Consistency checking that pdd2.V is empty.");
-        return pdd1;
+        return move(pdd1);
     }
 
     PDD_VInc VInc1 = PDD_batch_intersect_helper(pdd1, H2);
     PDD_VInc VInc2 = PDD_batch_intersect_helper(pdd2, H1);
 
-    vector<double*>& V = VInc1.V;
-    V.reserve(V.size() + VInc2.V.size());
-    for (auto v : VInc2.V) {
-        V.push_back(v);
-    }
+    FpMat& V = VInc1.V;
+    V.append_rows(VInc2.V);
 
     vector<set_t>& V_incidence = VInc1.incidence;
-    V_incidence.reserve(V.size());
+    V_incidence.reserve(V.rows());
 
-    const size_t num_H1 = H1.size();
-    const size_t num_H2 = H2.size();
+    const size_t num_H1 = H1.rows();
+    const size_t num_H2 = H2.rows();
     // For this I should implement a specialized operation in dynamic bitset class.
     // It can be implemented efficiently with bit-wise operations.
     for (auto& inc_H2_H1 : VInc2.incidence) {
@@ -268,20 +306,17 @@ PDD PDD_intersect_two_PDDs(PDD& pdd1, PDD& pdd2) {
 
     PDD_VInc VInc = PDD_make_irredundant(V, V_incidence);
 
-    vector<double*>& H = pdd1.H;
-    H.reserve(H1.size() + H2.size());
-    for (auto h : H2) {
-        H.push_back(h);
-    }
+    FpMat& H = pdd1.H;
+    H.append_rows(H2);
 
-    return {pdd1.dim, H, VInc.V, VInc.incidence};
+    return {pdd1.dim, move(H), move(VInc.V), VInc.incidence};
 }
 
 
 PDD PDD_intersect_all(vector<PDD>& pdds) {
     ASRTF(!pdds.empty(), "Expected non-empty number of PDDs.");
     if (pdds.size() == 1) {
-        return pdds[0];
+        return move(pdds[0]);
     }
     vector<PDD> next_pdds;
     size_t i = 0;
@@ -290,7 +325,7 @@ PDD PDD_intersect_all(vector<PDD>& pdds) {
             next_pdds.push_back(PDD_intersect_two_PDDs(pdds[i], pdds[i + 1]));
             i += 2;
         } else {
-            next_pdds.push_back(pdds[i]);
+            next_pdds.push_back(move(pdds[i]));
             i++;
         }
     }
@@ -298,26 +333,42 @@ PDD PDD_intersect_all(vector<PDD>& pdds) {
 }
 
 
+// V is transposed first, so that the products of a hyperplane with all vertices
+// are accumulated with contiguous loads, in the same order as one by one.
 void PDD_adjust_H_for_soundness_finite_polytope(const int dim,
-                                                vector<double*>& H,
-                                                const vector<double*>& V) {
+                                                FpMat& H,
+                                                const FpMat& V) {
     ASRTF(dim >= 2, "Expected that dimension >= 2.");
-    for (auto v : V) {
+    FpMat V_t(dim, V.rows());
+    for (int vi = 0; vi < V.rows(); vi++) {
+        const double* v = V[vi];
         ASRTF(v[0] == 1, "The adjustment strategy only works with vertices, i.e. no rays allowed.");
+        for (int i = 0; i < dim; i++) {
+            V_t[i][vi] = v[i];
+        }
     }
-    for (size_t hi = 0; hi < H.size(); hi++) {
+    const int stride = V_t.stride();
+    FpMat accum(2, V.rows());
+    double* h_x_V = accum[0];
+    double* h_x_V_abs = accum[1];
+    for (int hi = 0; hi < H.rows(); hi++) {
         double* h = H[hi];
-        double min_adjustment = 0;
-        for (size_t vi = 0; vi < V.size(); vi++) {
-            double* v = V[vi];
-            double accum = 0;
-            double accum_abs = 0;
-            for (int i = 0; i < dim; i++) {
-                accum += h[i] * v[i];
-                accum_abs += fabs(h[i] * v[i]);
+        for (int vi = 0; vi < stride; vi++) {
+            h_x_V[vi] = 0;
+            h_x_V_abs[vi] = 0;
+        }
+        for (int i = 0; i < dim; i++) {
+            const double h_i = h[i];
+            const double* v_i = V_t[i];
+            for (int vi = 0; vi < stride; vi++) {
+                h_x_V[vi] += h_i * v_i[vi];
+                h_x_V_abs[vi] += fabs(h_i * v_i[vi]);
             }
+        }
+        double min_adjustment = 0;
+        for (int vi = 0; vi < V.rows(); vi++) {
             constexpr double REL_ERR = 8.8817842e-16; // 1 / 2^50.
-            double adjustment = accum - REL_ERR * accum_abs;
+            double adjustment = h_x_V[vi] - REL_ERR * h_x_V_abs[vi];
             min_adjustment = min(adjustment, min_adjustment);
         }
         h[0] -= min_adjustment;
@@ -327,14 +378,418 @@ void PDD_adjust_H_for_soundness_finite_polytope(const int dim,
 void PDD_debug_consistency_check(const PDD& pdd) {
 #ifndef NDEBUG
     assert(pdd.dim > 0 && "Dimension should be positive.");
-    assert(pdd.V.size() == pdd.incidence.size() && "V.size() should equal incidence.size().");
+    assert(pdd.V.rows() == (int) pdd.incidence.size() && "V.rows() should equal incidence.size().");
     if (pdd.H.empty()) {
         assert(pdd.V.empty() && "If no constraints - V should be empty.");
         return;
     }
     for (set_t inc : pdd.incidence) {
-        assert(set_size(inc) == (int) pdd.H.size() &&
+        assert(set_size(inc) == pdd.H.rows() &&
                 "The size of incidence should equal number of constraints.");
     }
 #endif
 }
+
+// Every ray in PDD_compute_hull is solved from the vertices it is incident to and is normalized to
+// max abs 1, HULL_ZERO_TOL bounds its relative error. Products of a vertex with a ray that are above
+// HULL_ZERO_TOL times the l1 norm of the vertex but below HULL_GUARD times that are too close to zero
+// to be classified.
+constexpr double HULL_ZERO_TOL = 1.0 / (1LL << 42);
+constexpr double HULL_GUARD = 1 << 6;
+
+/*
+ * Chooses dim linearly independent rows of V with complete pivoting and inverts them.
+ * Returns false if the rows are not full-rank up to a relative tolerance.
+ */
+bool PDD_hull_initial_basis(const FpMat& V, vector<int>& basis, FpMat& rays) {
+    const int dim = V.cols();
+    const int n = V.rows();
+    if (n < dim) {
+        return false;
+    }
+    FpMat M = V.copy();
+    double max_abs = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < dim; j++) {
+            max_abs = max(max_abs, fabs(M[i][j]));
+        }
+    }
+    vector<bool> row_used(n, false);
+    vector<bool> col_used(dim, false);
+    for (int step = 0; step < dim; step++) {
+        int pivot_row = -1;
+        int pivot_col = -1;
+        double pivot_abs = 0;
+        for (int i = 0; i < n; i++) {
+            if (row_used[i]) {
+                continue;
+            }
+            for (int j = 0; j < dim; j++) {
+                if (!col_used[j] && fabs(M[i][j]) > pivot_abs) {
+                    pivot_abs = fabs(M[i][j]);
+                    pivot_row = i;
+                    pivot_col = j;
+                }
+            }
+        }
+        if (pivot_abs <= 1e-9 * max_abs) {
+            return false;
+        }
+        row_used[pivot_row] = true;
+        col_used[pivot_col] = true;
+        basis.push_back(pivot_row);
+        const double* p = M[pivot_row];
+        for (int i = 0; i < n; i++) {
+            if (row_used[i]) {
+                continue;
+            }
+            double* row = M[i];
+            const double factor = row[pivot_col] / p[pivot_col];
+            for (int j = 0; j < dim; j++) {
+                row[j] -= factor * p[j];
+            }
+            row[pivot_col] = 0;
+        }
+    }
+
+    // Gauss-Jordan on [B | I] with partial pivoting, the columns of the inverse are the rays.
+    FpMat aug(dim, 2 * dim);
+    for (int i = 0; i < dim; i++) {
+        for (int j = 0; j < dim; j++) {
+            aug[i][j] = V[basis[i]][j];
+        }
+        aug[i][dim + i] = 1;
+    }
+    for (int j = 0; j < dim; j++) {
+        int pivot = j;
+        for (int i = j + 1; i < dim; i++) {
+            if (fabs(aug[i][j]) > fabs(aug[pivot][j])) {
+                pivot = i;
+            }
+        }
+        if (pivot != j) {
+            for (int c = 0; c < 2 * dim; c++) {
+                swap(aug[j][c], aug[pivot][c]);
+            }
+        }
+        const double diag = aug[j][j];
+        for (int c = 0; c < 2 * dim; c++) {
+            aug[j][c] /= diag;
+        }
+        for (int i = 0; i < dim; i++) {
+            if (i == j || aug[i][j] == 0) {
+                continue;
+            }
+            const double factor = aug[i][j];
+            for (int c = 0; c < 2 * dim; c++) {
+                aug[i][c] -= factor * aug[j][c];
+            }
+        }
+    }
+    rays = FpMat(dim, dim);
+    for (int r = 0; r < dim; r++) {
+        double abs_coef = 0;
+        for (int i = 0; i < dim; i++) {
+            rays[r][i] = aug[i][dim + r];
+            abs_coef = max(abs_coef, fabs(rays[r][i]));
+        }
+        for (int i = 0; i < dim; i++) {
+            rays[r][i] /= abs_coef;
+        }
+    }
+    return true;
+}
+
+/*
+ * Recomputes the ray as the null space of the vertices it is incident to, so that its error
+ * doesn't grow with the number of combinations it went through. Returns false if the incident
+ * vertices don't define the ray up to the tolerance, then the incidence can't be trusted.
+ */
+bool PDD_hull_refine_ray(const FpMat& V, const set_t incidence, FpMat& M, double* ray) {
+    const int dim = V.cols();
+    M.resize_rows(0);
+    for (int i = 0; i < V.rows(); i++) {
+        if (set_test_bit(incidence, i)) {
+            M.push_row(V[i]);
+        }
+    }
+    double max_abs = 0;
+    for (int i = 0; i < M.rows(); i++) {
+        for (int j = 0; j < dim; j++) {
+            max_abs = max(max_abs, fabs(M[i][j]));
+        }
+    }
+    vector<int> pivot_cols;
+    vector<bool> col_used(dim, false);
+    for (int step = 0; step < dim - 1; step++) {
+        int pivot_row = -1;
+        int pivot_col = -1;
+        double pivot_abs = 0;
+        for (int i = step; i < M.rows(); i++) {
+            for (int j = 0; j < dim; j++) {
+                if (!col_used[j] && fabs(M[i][j]) > pivot_abs) {
+                    pivot_abs = fabs(M[i][j]);
+                    pivot_row = i;
+                    pivot_col = j;
+                }
+            }
+        }
+        if (pivot_abs <= 1e-9 * max_abs) {
+            return false;
+        }
+        if (pivot_row != step) {
+            swap_ranges(M[step], M[step] + dim, M[pivot_row]);
+        }
+        col_used[pivot_col] = true;
+        pivot_cols.push_back(pivot_col);
+        const double* p = M[step];
+        for (int i = step + 1; i < M.rows(); i++) {
+            double* row = M[i];
+            const double factor = row[pivot_col] / p[pivot_col];
+            for (int j = 0; j < dim; j++) {
+                row[j] -= factor * p[j];
+            }
+            row[pivot_col] = 0;
+        }
+    }
+
+    vector<double> x(dim, 0);
+    x[find(col_used.begin(), col_used.end(), false) - col_used.begin()] = 1;
+    for (int step = dim - 2; step >= 0; step--) {
+        const int col = pivot_cols[step];
+        double sum = 0;
+        for (int j = 0; j < dim; j++) {
+            if (j != col) {
+                sum += M[step][j] * x[j];
+            }
+        }
+        x[col] = -sum / M[step][col];
+    }
+    double abs_coef = 0;
+    double dot = 0;
+    for (int i = 0; i < dim; i++) {
+        abs_coef = max(abs_coef, fabs(x[i]));
+        dot += x[i] * ray[i];
+    }
+    // The combined ray can be off by cancellation, it only has to be the same ray.
+    const double scale = dot < 0 ? -1 / abs_coef : 1 / abs_coef;
+    for (int i = 0; i < dim; i++) {
+        const double refined = x[i] * scale;
+        if (fabs(refined - ray[i]) > 1e-6) {
+            return false;
+        }
+        ray[i] = refined;
+    }
+
+    // All incident vertices, also those that were not used for the elimination, have to be on the ray.
+    for (int i = 0; i < V.rows(); i++) {
+        if (!set_test_bit(incidence, i)) {
+            continue;
+        }
+        double val = 0;
+        double p_abs = 0;
+        for (int j = 0; j < dim; j++) {
+            val += V[i][j] * ray[j];
+            p_abs += fabs(V[i][j]);
+        }
+        if (fabs(val) > HULL_ZERO_TOL * p_abs) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * The rays of the cone {h : V h >= 0} are the facets of the hull. The cone is built by adding the
+ * rows of V one by one to the cone of an initial basis, new rays are created from the adjacent pairs
+ * of a ray that satisfies the new row and a ray that violates it, adjacency is tested combinatorially.
+ */
+bool PDD_compute_hull(const FpMat& V_input, FpMat& H) {
+    const int dim = V_input.cols();
+    H = FpMat(0, dim);
+
+    // The vertices on the boundaries of the quadrants come repeated, they are only added once.
+    vector<int> sorted_rows(V_input.rows());
+    for (int i = 0; i < V_input.rows(); i++) {
+        sorted_rows[i] = i;
+    }
+    auto row_less = [&V_input, dim](int a, int b) {
+        return lexicographical_compare(V_input[a], V_input[a] + dim, V_input[b], V_input[b] + dim);
+    };
+    stable_sort(sorted_rows.begin(), sorted_rows.end(), row_less);
+    vector<bool> is_repeated(V_input.rows(), false);
+    for (size_t i = 1; i < sorted_rows.size(); i++) {
+        if (!row_less(sorted_rows[i - 1], sorted_rows[i])) {
+            is_repeated[sorted_rows[i]] = true;
+        }
+    }
+    FpMat V(0, dim);
+    for (int i = 0; i < V_input.rows(); i++) {
+        if (!is_repeated[i]) {
+            V.push_row(V_input[i]);
+        }
+    }
+    const int n = V.rows();
+
+    vector<int> basis;
+    FpMat rays;
+    if (!PDD_hull_initial_basis(V, basis, rays)) {
+        return false;
+    }
+    vector<set_t> incidence(dim);
+    vector<bool> in_basis(n, false);
+    for (int r = 0; r < dim; r++) {
+        incidence[r] = set_create(n);
+        for (int i = 0; i < dim; i++) {
+            if (i != r) {
+                set_enable_bit(incidence[r], basis[i]);
+            }
+        }
+        in_basis[basis[r]] = true;
+    }
+
+    bool is_certain = true;
+    vector<double> products;
+    vector<int> pos, neg;
+    vector<vector<int>> vertex_rays(n);
+    FpMat scratch(0, dim);
+    const int num_blocks = (n - 1) / BITS_IN_BLOCK + 1;
+    for (int k = 0; k < n && is_certain; k++) {
+        if (in_basis[k]) {
+            continue;
+        }
+        const double* p = V[k];
+        const int num_rays = rays.rows();
+        products.resize(num_rays);
+        pos.clear();
+        neg.clear();
+        double p_abs = 0;
+        for (int i = 0; i < dim; i++) {
+            p_abs += fabs(p[i]);
+        }
+        const double zero_bound = HULL_ZERO_TOL * p_abs;
+        for (int r = 0; r < num_rays; r++) {
+            const double* ray = rays[r];
+            double val = 0;
+            for (int i = 0; i < dim; i++) {
+                val += p[i] * ray[i];
+            }
+            if (fabs(val) > zero_bound && fabs(val) <= HULL_GUARD * zero_bound) {
+                is_certain = false;
+                break;
+            }
+            products[r] = val;
+            if (val > zero_bound) {
+                pos.push_back(r);
+            } else if (val < -zero_bound) {
+                neg.push_back(r);
+            } else {
+                products[r] = 0;
+                set_enable_bit(incidence[r], k);
+            }
+        }
+        if (!is_certain || neg.empty()) {
+            continue;
+        }
+
+        // The rays incident to each vertex, a ray that contains the common incidence of a pair
+        // has to be in the list of every vertex of it, so only the shortest list is scanned.
+        for (auto& list : vertex_rays) {
+            list.clear();
+        }
+        for (int r = 0; r < num_rays; r++) {
+            const set_t inc = incidence[r];
+            for (int block_i = 1; block_i <= num_blocks; block_i++) {
+                for (block_t bits = inc[block_i]; bits; bits &= bits - 1) {
+                    vertex_rays[(block_i - 1) * BITS_IN_BLOCK + __builtin_ctzl(bits)].push_back(r);
+                }
+            }
+        }
+
+        FpMat new_rays(0, dim);
+        vector<set_t> new_incidence;
+        for (size_t i_pos = 0; i_pos < pos.size() && is_certain; i_pos++) {
+            const int a = pos[i_pos];
+            for (int b : neg) {
+                // Two rays can only be adjacent if they share at least dim - 2 vertices.
+                const set_t inc_a = incidence[a];
+                const set_t inc_b = incidence[b];
+                int num_common = 0;
+                for (int block_i = 1; block_i <= num_blocks; block_i++) {
+                    num_common += __builtin_popcountl(inc_a[block_i] & inc_b[block_i]);
+                }
+                if (num_common < dim - 2) {
+                    continue;
+                }
+                set_t common = set_intersect(inc_a, inc_b);
+                bool is_adjacent = true;
+                const vector<int>* candidates = nullptr;
+                for (int block_i = 1; block_i <= num_blocks && is_adjacent; block_i++) {
+                    for (block_t bits = common[block_i]; bits; bits &= bits - 1) {
+                        const auto& list = vertex_rays[(block_i - 1) * BITS_IN_BLOCK + __builtin_ctzl(bits)];
+                        if (candidates == nullptr || list.size() < candidates->size()) {
+                            candidates = &list;
+                        }
+                    }
+                }
+                for (size_t i = 0; is_adjacent && candidates != nullptr && i < candidates->size(); i++) {
+                    const int c = (*candidates)[i];
+                    if (c != a && c != b && set_is_subset_of(common, incidence[c])) {
+                        is_adjacent = false;
+                    }
+                }
+                if (!is_adjacent) {
+                    set_free(common);
+                    continue;
+                }
+                const double* ray_a = rays[a];
+                const double* ray_b = rays[b];
+                double* ray = new_rays.push_row();
+                double abs_coef = 0;
+                for (int i = 0; i < dim; i++) {
+                    ray[i] = products[a] * ray_b[i] - products[b] * ray_a[i];
+                    abs_coef = max(abs_coef, fabs(ray[i]));
+                }
+                for (int i = 0; i < dim; i++) {
+                    ray[i] /= abs_coef;
+                }
+                set_enable_bit(common, k);
+                new_incidence.push_back(common);
+                if (!PDD_hull_refine_ray(V, common, scratch, ray)) {
+                    is_certain = false;
+                }
+            }
+        }
+
+        FpMat next_rays(0, dim);
+        next_rays.reserve(num_rays - neg.size() + new_rays.rows());
+        vector<set_t> next_incidence;
+        for (int r = 0; r < num_rays; r++) {
+            if (products[r] < 0) {
+                set_free(incidence[r]);
+                continue;
+            }
+            next_rays.push_row(rays[r]);
+            next_incidence.push_back(incidence[r]);
+        }
+        next_rays.append_rows(new_rays);
+        next_incidence.insert(next_incidence.end(), new_incidence.begin(), new_incidence.end());
+        rays = move(next_rays);
+        incidence = move(next_incidence);
+    }
+
+    // Every facet of a full-dimensional hull touches at least dim - 1 of the vertices.
+    for (size_t r = 0; r < incidence.size() && is_certain; r++) {
+        if (set_count(incidence[r]) < dim - 1) {
+            is_certain = false;
+        }
+    }
+    set_arr_free(incidence);
+    if (!is_certain) {
+        return false;
+    }
+
+    PDD_adjust_H_for_soundness_finite_polytope(dim, rays, V);
+    H = move(rays);
+    return true;
+}
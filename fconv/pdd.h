@@ -1,18 +1,19 @@
 #pragma once
 
 #include "utils.h"
+#include "fp_mat.h"
 
 using namespace std;
 
 struct PDD {
     int dim;
-    vector<double*> H;
-    vector<double*> V;
+    FpMat H;
+    FpMat V;
     vector<set_t> incidence; // V to H incidence.
 };
 
-/* Function transfers the memory ownership of H_new to pdd. */
-void PDD_batch_intersect(PDD& pdd, vector<double*>& H_new);
+/* Function appends the rows of H_new to pdd.H. */
+void PDD_batch_intersect(PDD& pdd, const FpMat& H_new);
 
 /* Function takes ownership of memory of both pdd1 and pdd2 - they cannot be used afterwards. */
 PDD PDD_intersect_two_PDDs(PDD& pdd1, PDD& pdd2);
@@ -21,7 +22,15 @@ PDD PDD_intersect_two_PDDs(PDD& pdd1, PDD& pdd2);
 PDD PDD_intersect_all(vector<PDD>& pdds);
 
 void PDD_adjust_H_for_soundness_finite_polytope(const int dim,
-                                                vector<double*>& H,
-                                                const vector<double*>& V);
+                                                FpMat& H,
+                                                const FpMat& V);
+
+/*
+ * Computes the facets of the convex hull of the vertices V with the double description
+ * method in fp and makes them sound with PDD_adjust_H_for_soundness_finite_polytope.
+ * Returns false if the vertices are not full-dimensional or if some incidence decision
+ * was too close to the tolerance to be trusted, then the hull has to be computed exactly.
+ */
+bool PDD_compute_hull(const FpMat& V, FpMat& H);
 
 void PDD_debug_consistency_check(const PDD& pdd);
@@ -39,6 +39,7 @@ map<Quadrant, VInc_mpq> get_quadrants_cdd(const int K, const vector<double*>& A)
                 mpq_set_si(row[xi + 1], 1, 1);
             }
         }
+        lock_guard<mutex> cdd_lock(cdd_mutex);
         dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(cdd_A);
 
         dd_MatrixPtr cdd_V = dd_CopyGenerators(poly);
@@ -98,6 +99,7 @@ map<Quadrant, VInc_mpq> get_quadrants_cdd_orthant(const int K,
                 mpq_set_si(row[xi + 1], 1, 1);
             }
         }
+        lock_guard<mutex> cdd_lock(cdd_mutex);
         dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(cdd_A);
 
         dd_MatrixPtr cdd_V = dd_CopyGenerators(poly);
@@ -152,6 +154,7 @@ vector<DD_mpq> get_pool_quadrants_cdd(const int K, const vector<double*>& A) {
             mpq_arr_set_d(K + 1, cdd_A->matrix[i], A_quadrant[i]);
         }
 
+        lock_guard<mutex> cdd_lock(cdd_mutex);
         dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(cdd_A);
         dd_MatrixPtr cdd_V = dd_CopyGenerators(poly);
         dd_SetFamilyPtr cdd_incidence = dd_CopyIncidence(poly);
@@ -312,6 +315,7 @@ map<Quadrant, vector<mpq_t*>> get_tasi_quadrants_cdd(
             mpq_set_si(row_ub[xi + 1 + K], -1, 1);
         }
 
+        lock_guard<mutex> cdd_lock(cdd_mutex);
         dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(cdd_A);
         dd_MatrixPtr cdd_V = dd_CopyGenerators(poly);
         const size_t num_v = cdd_V->rowsize;
@@ -369,6 +373,7 @@ map<Quadrant, vector<mpq_t*>> get_tasi_quadrants_cdd_lift(
                 mpq_set_si(row[xi + 1], 1, 1);
             }
         }
+        lock_guard<mutex> cdd_lock(cdd_mutex);
         dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(cdd_A);
 
         dd_MatrixPtr cdd_V = dd_CopyGenerators(poly);
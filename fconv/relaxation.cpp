@@ -1,4 +1,5 @@
 #include <map>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cmath>
@@ -81,6 +82,7 @@ void verify_that_octahedron_and_all_xi_split_zero(const int K, const vector<doub
 
 vector<double*> cdd_compute_inequalities_from_vertices(dd_MatrixPtr vertices) {
     vertices->representation = dd_Generator;
+    lock_guard<mutex> cdd_lock(cdd_mutex);
     dd_PolyhedraPtr poly = cdd_Matrix_to_Poly(vertices);
 
     dd_MatrixPtr inequalities = dd_CopyInequalities(poly);
@@ -123,6 +125,119 @@ vector<double*> cdd_compute_inequalities_from_vertices(dd_MatrixPtr vertices) {
     return H;
 }
 
+// Number of hulls computed for the *_with_cdd relaxations and how many of them fell back to cdd.
+atomic<int> hull_num_calls(0);
+atomic<int> hull_num_fallbacks(0);
+
+void get_hull_fallback_stats(int& num_calls, int& num_fallbacks) {
+    num_calls = hull_num_calls;
+    num_fallbacks = hull_num_fallbacks;
+}
+
+// With the check enabled every hull that is certified in fp is also computed with cdd and compared.
+atomic<bool> hull_check_with_cdd(false);
+atomic<int> hull_num_checked(0);
+atomic<int> hull_num_mismatches(0);
+
+void set_hull_check_with_cdd(bool enabled) {
+    hull_check_with_cdd = enabled;
+}
+
+void get_hull_check_stats(int& num_checked, int& num_mismatches) {
+    num_checked = hull_num_checked;
+    num_mismatches = hull_num_mismatches;
+}
+
+// Product of h with the vertex relative to the l1 norm of the vertex.
+double hull_rel_product(const int dim, const double* h, const double* v) {
+    double val = 0;
+    double v_abs = 0;
+    for (int i = 0; i < dim; i++) {
+        val += h[i] * v[i];
+        v_abs += fabs(v[i]);
+    }
+    return fabs(val) / v_abs;
+}
+
+/*
+ * Every facet found in fp has to be a facet found by cdd. The converse doesn't hold: the input is
+ * only nearly degenerate after rounding, so where the vertices are nearly coplanar cdd splits a facet
+ * into slivers. A cdd facet without a fp match is accepted if all the vertices it touches lie on one
+ * fp facet.
+ */
+bool hull_agrees_with_cdd(const FpMat& V, const FpMat& H, const vector<double*>& H_cdd) {
+    constexpr double COEF_TOL = 1e-7;
+    constexpr double TOUCH_TOL = 1e-12;
+    constexpr double ON_FACET_TOL = 1e-9;
+    const int dim = V.cols();
+    auto max_diff = [dim](const double* h1, const double* h2) {
+        double diff = 0;
+        for (int i = 0; i < dim; i++) {
+            diff = max(diff, fabs(h1[i] - h2[i]));
+        }
+        return diff;
+    };
+    for (int hi = 0; hi < H.rows(); hi++) {
+        bool is_matched = false;
+        for (size_t ci = 0; ci < H_cdd.size() && !is_matched; ci++) {
+            is_matched = max_diff(H[hi], H_cdd[ci]) <= COEF_TOL;
+        }
+        if (!is_matched) {
+            return false;
+        }
+    }
+    for (const double* h_cdd : H_cdd) {
+        bool is_matched = false;
+        for (int hi = 0; hi < H.rows() && !is_matched; hi++) {
+            is_matched = max_diff(H[hi], h_cdd) <= COEF_TOL;
+        }
+        if (is_matched) {
+            continue;
+        }
+        vector<const double*> touching;
+        for (int vi = 0; vi < V.rows(); vi++) {
+            if (hull_rel_product(dim, h_cdd, V[vi]) <= TOUCH_TOL) {
+                touching.push_back(V[vi]);
+            }
+        }
+        for (int hi = 0; hi < H.rows() && !is_matched; hi++) {
+            is_matched = true;
+            for (const double* v : touching) {
+                if (hull_rel_product(dim, H[hi], v) > ON_FACET_TOL) {
+                    is_matched = false;
+                    break;
+                }
+            }
+        }
+        if (!is_matched) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The vertices are exact, so the hull is first computed in fp and only recomputed
+// with cdd in exact arithmetic if the fp computation can't be trusted.
+vector<double*> compute_inequalities_from_vertices(dd_MatrixPtr vertices) {
+    vector<mpq_t*> V_mpq(vertices->matrix, vertices->matrix + vertices->rowsize);
+    FpMat V = mpq_mat_to_fp_mat(vertices->colsize, V_mpq);
+    FpMat H;
+    hull_num_calls++;
+    if (PDD_compute_hull(V, H)) {
+        if (hull_check_with_cdd) {
+            vector<double*> H_cdd = cdd_compute_inequalities_from_vertices(vertices);
+            hull_num_checked++;
+            if (!hull_agrees_with_cdd(V, H, H_cdd)) {
+                hull_num_mismatches++;
+            }
+            fp_mat_free(H_cdd);
+        }
+        return H.to_rows();
+    }
+    hull_num_fallbacks++;
+    return cdd_compute_inequalities_from_vertices(vertices);
+}
+
 vector<double*> fast_relaxation_through_decomposition(const int K,
                                                       const vector<double*>& A,
                                                       Activation activation) {
@@ -157,13 +272,13 @@ vector<double*> fast_relaxation_through_decomposition(const int K,
             continue;
         }
 
-        vector<double*> V = mpq_mat_to_fp(K + 1, V_mpq);
+        FpMat V = mpq_mat_to_fp_mat(K + 1, V_mpq);
         mpq_mat_free(K + 1, V_mpq);
 
         const vector<set_t>& incidence_V_to_H = entry.second.V_to_H_incidence;
         assert(
-                incidence_V_to_H.size() == V.size() &&
-                "Incidence_V_to_H.size() should equal V.size()");
+                (int) incidence_V_to_H.size() == V.rows() &&
+                "Incidence_V_to_H.size() should equal V.rows()");
         vector<set_t> incidence_H_to_V = set_arr_transpose(incidence_V_to_H);
         set_arr_free(incidence_V_to_H);
         assert(
@@ -175,7 +290,7 @@ vector<double*> fast_relaxation_through_decomposition(const int K,
             set_enable_bit(is_irredund, i);
         }
 
-        vector<double*> H_irredund = fp_mat_create(irredund_idx.size(), K + 1);
+        FpMat H_irredund(irredund_idx.size(), K + 1);
         vector<set_t> incidence_irredund(irredund_idx.size());
 
         size_t count = 0;
@@ -201,7 +316,7 @@ vector<double*> fast_relaxation_through_decomposition(const int K,
         }
         assert(count == irredund_idx.size() && "count should equal maximal_H.size()");
         set_free(is_irredund);
-        quadrant2pdd[quadrant] = {K + 1, V, H_irredund, incidence_irredund};
+        quadrant2pdd[quadrant] = {K + 1, move(V), move(H_irredund), incidence_irredund};
     }
 
     // Lower and upper bounds are needed for decomposition of tanh and sigmoid functions.
@@ -306,13 +421,13 @@ vector<double*> relaxation_orthant(const int K,
             continue;
         }
 
-        vector<double*> V = mpq_mat_to_fp(K + 1, V_mpq);
+        FpMat V = mpq_mat_to_fp_mat(K + 1, V_mpq);
         mpq_mat_free(K + 1, V_mpq);
 
         const vector<set_t>& incidence_V_to_H = entry.second.V_to_H_incidence;
         assert(
-                incidence_V_to_H.size() == V.size() &&
-                "Incidence_V_to_H.size() should equal V.size()");
+                (int) incidence_V_to_H.size() == V.rows() &&
+                "Incidence_V_to_H.size() should equal V.rows()");
         vector<set_t> incidence_H_to_V = set_arr_transpose(incidence_V_to_H);
         set_arr_free(incidence_V_to_H);
         assert(
@@ -324,7 +439,7 @@ vector<double*> relaxation_orthant(const int K,
             set_enable_bit(is_irredund, i);
         }
 
-        vector<double*> H_irredund = fp_mat_create(irredund_idx.size(), K + 1);
+        FpMat H_irredund(irredund_idx.size(), K + 1);
         vector<set_t> incidence_irredund(irredund_idx.size());
 
         size_t count = 0;
@@ -352,7 +467,7 @@ vector<double*> relaxation_orthant(const int K,
         }
         assert(count == irredund_idx.size() && "count should equal maximal_H.size()");
         set_free(is_irredund);
-        quadrant2pdd[quadrant] = {K + 1, V, H_irredund, incidence_irredund};
+        quadrant2pdd[quadrant] = {K + 1, move(V), move(H_irredund), incidence_irredund};
     }
 
     vector<double*> res = decomposition(K, quadrant2pdd, activation, x_lb, x_ub, orthants);
@@ -395,7 +510,7 @@ vector<double*> krelu_with_cdd(const int K, const vector<double*>& A) {
     }
     assert(counter == num_vertices && "Counter should equal the number of vertices.");
 
-    vector<double*> H = cdd_compute_inequalities_from_vertices(vertices);
+    vector<double*> H = compute_inequalities_from_vertices(vertices);
     dd_FreeMatrix(vertices);
 
     return H;
@@ -416,21 +531,22 @@ vector<double*> fkpool(const int K, const vector<double*>& A) {
         vector<double*>& H = quadrants[xi].H;
 
         if (V_mpq.empty()) {
+            fp_mat_free(H);
             quadrants_pdds.push_back({K + 2, {}, {}, {}});
             continue;
         }
 
-        vector<double*> V = mpq_mat_to_fp(K + 1, V_mpq);
+        FpMat V = mpq_mat_to_fp_mat(K + 1, V_mpq);
         mpq_mat_free(K + 1, V_mpq);
-        for (size_t i = 0; i < V.size(); i++) {
-            V[i] = fp_arr_resize(K + 2, K + 1, V[i]);
+        V.resize_cols(K + 2);
+        for (int i = 0; i < V.rows(); i++) {
             V[i][K + 1] = V[i][xi + 1];
         }
 
         const vector<set_t>& incidence_V_to_H = quadrants[xi].V_to_H_incidence;
         assert(
-                incidence_V_to_H.size() == V.size() &&
-                "Incidence_V_to_H.size() should equal V.size()");
+                (int) incidence_V_to_H.size() == V.rows() &&
+                "Incidence_V_to_H.size() should equal V.rows()");
         vector<set_t> incidence_H_to_V = set_arr_transpose(incidence_V_to_H);
         set_arr_free(incidence_V_to_H);
         assert(
@@ -444,52 +560,49 @@ vector<double*> fkpool(const int K, const vector<double*>& A) {
         }
 
         // irredund_idx.size() + 2 because there will also be new equality y = xi.
-        vector<double*> H_irredund(irredund_idx.size() + 2);
+        FpMat H_irredund(irredund_idx.size() + 2, K + 2);
         vector<set_t> incidence_irredund(irredund_idx.size() + 2);
 
         size_t count = 0;
         for (size_t i = 0; i < incidence_H_to_V.size(); i++) {
             if (!set_test_bit(is_irredund, i)) {
-                free(H[i]);
                 set_free(incidence_H_to_V[i]);
                 continue;
             }
-            H_irredund[count] = fp_arr_resize(K + 2, K + 1, H[i]);
+            fp_arr_set(K + 1, H_irredund[count], H[i]);
             incidence_irredund[count] = incidence_H_to_V[i];
             count++;
         }
         assert(count == irredund_idx.size() && "count should equal irredund_idx.size()");
         set_free(is_irredund);
+        fp_mat_free(H);
 
         // y = xi
-        double* h1 = fp_arr_create(K + 2);
-        double* h2 = fp_arr_create(K + 2);
+        double* h1 = H_irredund[count];
+        double* h2 = H_irredund[count + 1];
         h1[xi + 1] = 1;
         h1[K + 1] = -1;
         h2[xi + 1] = -1;
         h2[K + 1] = 1;
-        set_t inc1 = set_create(V.size());
-        set_t inc2 = set_create(V.size());
+        set_t inc1 = set_create(V.rows());
+        set_t inc2 = set_create(V.rows());
         set_enable_all(inc1);
         set_enable_all(inc2);
 
-        H_irredund[count] = h1;
-        H_irredund[count + 1] = h2;
         incidence_irredund[count] = inc1;
         incidence_irredund[count + 1] = inc2;
 
-        quadrants_pdds.push_back({K + 2, V, H_irredund, incidence_irredund});
+        quadrants_pdds.push_back({K + 2, move(V), move(H_irredund), incidence_irredund});
     }
 
     PDD res = PDD_intersect_all(quadrants_pdds);
-    vector<double*>& H = res.V;
-    vector<double*>& V = res.H;
+    FpMat& H = res.V;
+    const FpMat& V = res.H;
     PDD_adjust_H_for_soundness_finite_polytope(K + 2, H, V);
 
-    fp_mat_free(V);
     set_arr_free(res.incidence);
 
-    return H;
+    return H.to_rows();
 }
 
 vector<double*> kpool_with_cdd(const int K, const vector<double*>& A) {
@@ -520,7 +633,7 @@ vector<double*> kpool_with_cdd(const int K, const vector<double*>& A) {
     }
     assert(counter == num_vertices && "Counter should equal the number of vertices.");
 
-    vector<double*> H = cdd_compute_inequalities_from_vertices(vertices);
+    vector<double*> H = compute_inequalities_from_vertices(vertices);
     dd_FreeMatrix(vertices);
 
     return H;
@@ -549,7 +662,7 @@ vector<double*> ktasi_with_cdd(int K, const vector<double*>& A, Activation activ
     }
     assert(counter == num_vertices && "Counter should equal the number of vertices.");
 
-    vector<double*> H = cdd_compute_inequalities_from_vertices(vertices);
+    vector<double*> H = compute_inequalities_from_vertices(vertices);
     dd_FreeMatrix(vertices);
 
     return H;
@@ -17,6 +17,15 @@ vector<double*> kpool_with_cdd(int K, const vector<double*>& A);
 
 vector<double*> ktasi_with_cdd(int K, const vector<double*>& A, Activation activation);
 
+// Number of hulls computed by the *_with_cdd relaxations and how many of them
+// had to fall back from fp to exact arithmetic.
+void get_hull_fallback_stats(int& num_calls, int& num_fallbacks);
+
+// For testing: recompute every hull certified in fp with cdd and count the ones that don't agree.
+void set_hull_check_with_cdd(bool enabled);
+
+void get_hull_check_stats(int& num_checked, int& num_mismatches);
+
 vector<double*> relaxation_orthant(const int K,
                                    const vector<double*>& A,
                                    Activation activation);
@@ -1,142 +1,256 @@
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <thread>
 #include "sparse_cover.h"
 
 #include "asrt.h"
 
 using namespace std;
 
-bool intersects_too_much(const int K, const vector<int>& first, const vector<int>& second) {
-    int intersection_size = 0;
+// Subsets of up to 3 neurons are packed into 64 bits, 16 bits per neuron.
+constexpr int MAX_N = 1 << 16;
+constexpr uint64_t EMPTY_KEY = ~0ULL;
 
-    int i = 0;
-    int j = 0;
+// Number of prefixes that are checked in parallel before their results are merged.
+constexpr int ROUND_SIZE = 1 << 16;
 
-    while (i < K && j < K) {
-        if (first[i] == second[j]) {
-            i++;
-            j++;
-            intersection_size++;
-        } else if (first[i] < second[j]) {
-            i++;
-        } else {
-            j++;
+/*
+ * The (K - 1)-subsets that are used by the selected combinations, indexed by their
+ * (K - 2)-subsets: an open addressing hash map from a (K - 2)-subset to the bitset of the
+ * neurons that complete it to a used (K - 1)-subset. Only the (K - 2)-subsets of selected
+ * combinations get a bitset. It is only modified while no other thread reads it.
+ */
+class CompletionIndex {
+public:
+    explicit CompletionIndex(const int N) :
+            num_words((N + 63) / 64), keys(1 << 10, EMPTY_KEY), offsets(1 << 10), mask((1 << 10) - 1), size(0) {}
+
+    // The bitset of the completions of the subset, nullptr if there are none.
+    const uint64_t* find(const uint64_t key) const {
+        for (uint64_t i = hash(key) & mask; ; i = (i + 1) & mask) {
+            if (keys[i] == key) {
+                return words.data() + offsets[i];
+            }
+            if (keys[i] == EMPTY_KEY) {
+                return nullptr;
+            }
         }
     }
 
-    return intersection_size >= K - 1;
-}
-
-vector<vector<int>> sparse_cover(const int N, const int K) {
-    ASRTF(3 <= K && K <= 5, "K is not within allowed range.");
-    if (N < K) {
-        return {};
+    void add(const uint64_t key, const int elem) {
+        uint64_t* bitset = find_or_create(key);
+        bitset[elem / 64] |= 1ULL << (elem % 64);
     }
 
-    vector<vector<int>> all_selected_combs;
-    vector<bool> v(N);
-    fill(v.begin(), v.begin() + K, true);
-
-    // This heuristic has to run fast, the main bottleneck is iterating through
-    // the array of combinations to see if there is already a combination that has big
-    // intersection with combination that we are trying to add.
-    // The combinations are added in the alphabetical order, thus we can use indexing
-    // to first traverse the part of the array where we already no that first elements match -
-    // that area has a higher probability of rejecting new combination.
-    vector<int> indexing_on_first(N, -1);
-
-    // Improved heuristic that allows indexing based on second indexes.
-    vector<vector<int>> indexing_on_second_all(N, vector<int>(N, -1));
-
-    do {
-        vector<int> new_comb(K);
-
-        int cur_i = 0;
-        for (int i = 0; i < N; ++i) {
-            if (v[i]) {
-                new_comb[cur_i] = i;
-                cur_i++;
-            }
-        }
+    int get_num_words() const {
+        return num_words;
+    }
 
-        bool to_add = true;
+private:
+    const int num_words;
+    vector<uint64_t> keys;
+    vector<size_t> offsets;
+    vector<uint64_t> words;
+    uint64_t mask;
+    size_t size;
 
-        const int first_elem = new_comb[0];
-        if (indexing_on_first[first_elem] != -1) {
-            int selected_comb_i = indexing_on_first[first_elem];
-            while (selected_comb_i < (int) all_selected_combs.size()) {
-                const auto &selected_comb = all_selected_combs[selected_comb_i];
-                // We have left the promising region that allows to do fast rejection -
-                // now we have to do the full traversal.
-                if (selected_comb[0] != first_elem) {
-                    break;
-                }
+    static uint64_t hash(uint64_t key) {
+        key ^= key >> 31;
+        key *= 0x7fb5d329728ea185ULL;
+        key ^= key >> 27;
+        key *= 0x81dadef4bc2dd44dULL;
+        key ^= key >> 33;
+        return key;
+    }
 
-                if (intersects_too_much(K, new_comb, selected_comb)) {
-                    to_add = false;
-                    break;
-                }
+    uint64_t* find_or_create(const uint64_t key) {
+        if (2 * (size + 1) > keys.size()) {
+            grow();
+        }
+        uint64_t i = hash(key) & mask;
+        while (keys[i] != key && keys[i] != EMPTY_KEY) {
+            i = (i + 1) & mask;
+        }
+        if (keys[i] == EMPTY_KEY) {
+            keys[i] = key;
+            offsets[i] = words.size();
+            words.resize(words.size() + num_words, 0);
+            size++;
+        }
+        return words.data() + offsets[i];
+    }
 
-                selected_comb_i++;
+    void grow() {
+        vector<uint64_t> old_keys = move(keys);
+        vector<size_t> old_offsets = move(offsets);
+        keys.assign(2 * old_keys.size(), EMPTY_KEY);
+        offsets.assign(keys.size(), 0);
+        mask = keys.size() - 1;
+        for (size_t j = 0; j < old_keys.size(); j++) {
+            if (old_keys[j] == EMPTY_KEY) {
+                continue;
+            }
+            uint64_t i = hash(old_keys[j]) & mask;
+            while (keys[i] != EMPTY_KEY) {
+                i = (i + 1) & mask;
             }
+            keys[i] = old_keys[j];
+            offsets[i] = old_offsets[j];
         }
+    }
+};
 
-        // The combination was rejected based on first-element indexing heuristic.
-        if (!to_add) {
-            continue;
+// Key of the sorted elements of comb except those at positions skip1 and skip2.
+uint64_t subset_key(const int K, const int* comb, const int skip1, const int skip2) {
+    uint64_t key = 0;
+    for (int i = 0; i < K; i++) {
+        if (i != skip1 && i != skip2) {
+            key = (key << 16) | (uint64_t) comb[i];
         }
+    }
+    return key;
+}
 
-        const int second_elem = new_comb[1];
-        vector<int> &indexing_on_second = indexing_on_second_all[second_elem];
-        // Doing a copy here intentionally.
-        for (int selected_comb_i : indexing_on_second) {
-            if (selected_comb_i == -1) {
-                continue;
-            }
-            while (selected_comb_i < (int) all_selected_combs.size()) {
-                const auto &selected_comb = all_selected_combs[selected_comb_i];
-                // We have left the promising region that allows to do fast rejection -
-                // now we have to do the full traversal.
-                if (selected_comb[1] != second_elem) {
-                    break;
-                }
+/*
+ * Returns the smallest last element >= first that extends the prefix of K - 1 elements to a
+ * combination none of whose (K - 1)-subsets are used, or N if there is none or if the prefix
+ * itself is used. The (K - 1)-subsets with the last element are the prefix without one of its
+ * elements plus the last element, so the free last elements are the zeros of the union of
+ * the completions of the (K - 2)-subsets of the prefix.
+ */
+int find_last_elem(const int N, const int K, const CompletionIndex& index, const int* prefix, const int first) {
+    const int len = K - 1;
+    const uint64_t* completions[4];
+    int num_completions = 0;
+    for (int skip = 0; skip < len; skip++) {
+        const uint64_t* bitset = index.find(subset_key(len, prefix, skip, -1));
+        if (bitset == nullptr) {
+            continue;
+        }
+        // The prefix is used if its last element completes the rest of it.
+        const int prefix_last = prefix[len - 1];
+        if (skip == len - 1 && (bitset[prefix_last / 64] >> (prefix_last % 64)) & 1) {
+            return N;
+        }
+        completions[num_completions++] = bitset;
+    }
 
-                if (intersects_too_much(K, new_comb, selected_comb)) {
-                    to_add = false;
-                    break;
-                }
+    for (int word = first / 64; word < index.get_num_words(); word++) {
+        uint64_t taken = 0;
+        for (int j = 0; j < num_completions; j++) {
+            taken |= completions[j][word];
+        }
+        if (word == first / 64) {
+            taken |= (1ULL << (first % 64)) - 1;
+        }
+        if (~taken != 0) {
+            const int last = word * 64 + __builtin_ctzll(~taken);
+            return last < N ? last : N;
+        }
+    }
+    return N;
+}
 
-                selected_comb_i++;
+// Moves to the next prefix of K - 1 elements in lexicographic order that still has
+// room for a last element, returns false once all prefixes are enumerated.
+bool next_prefix(const int N, const int K, vector<int>& prefix) {
+    const int len = K - 1;
+    for (int i = len - 1; i >= 0; i--) {
+        // Positions after i need len - 1 - i more elements and the last element needs one.
+        if (prefix[i] < N - 1 - (len - 1 - i) - 1) {
+            prefix[i]++;
+            for (int j = i + 1; j < len; j++) {
+                prefix[j] = prefix[j - 1] + 1;
             }
+            return true;
         }
+    }
+    return false;
+}
 
-        // The combination was rejected based on second-element indexing heuristic.
-        if (!to_add) {
-            continue;
+/*
+ * The cover is selected greedily: the K-combinations are visited in lexicographic order and a
+ * combination is added if no (K - 1)-subset of it is already used by an added one. At most one
+ * combination is added per (K - 1)-prefix, so the prefixes are processed in rounds. Within a
+ * round the threads find for every prefix the first last element that is free with respect to
+ * the combinations of the previous rounds, this is only a lower bound because of the
+ * combinations that are added earlier in the same round. The merge goes through the prefixes
+ * in order and continues the search from that bound, so the cover doesn't depend on the
+ * number of threads and is the same as the one of the sequential greedy selection.
+ */
+vector<vector<int>> sparse_cover(const int N, const int K, int num_threads) {
+    ASRTF(3 <= K && K <= 5, "K is not within allowed range.");
+    ASRTF(N <= MAX_N, "N is not within allowed range.");
+    if (N < K) {
+        return {};
+    }
+    if (num_threads <= 0) {
+        num_threads = max(1, (int) thread::hardware_concurrency());
+    }
+
+    vector<vector<int>> all_selected_combs;
+    CompletionIndex index(N);
+
+    const int len = K - 1;
+    vector<int> prefix(len);
+    for (int i = 0; i < len; i++) {
+        prefix[i] = i;
+    }
+    vector<int> round_prefixes;
+    vector<int> round_last;
+    round_prefixes.reserve((size_t) ROUND_SIZE * len);
+    round_last.reserve(ROUND_SIZE);
+    bool has_prefix = true;
+
+    while (has_prefix) {
+        round_prefixes.clear();
+        while (has_prefix && (int) round_prefixes.size() < ROUND_SIZE * len) {
+            round_prefixes.insert(round_prefixes.end(), prefix.begin(), prefix.end());
+            has_prefix = next_prefix(N, K, prefix);
         }
+        const int num_prefixes = (int) round_prefixes.size() / len;
+        round_last.resize(num_prefixes);
 
-        // Doing full traversal.
-        for (const auto &selected_comb : all_selected_combs) {
-            // Both new_comb and selected_comb are sorted.
-            // Now I compute their intersection size.
-            if (intersects_too_much(K, new_comb, selected_comb)) {
-                to_add = false;
-                break;
+        auto worker = [&](int t, int round_threads) {
+            for (int p = t; p < num_prefixes; p += round_threads) {
+                const int* cur = round_prefixes.data() + (size_t) p * len;
+                round_last[p] = find_last_elem(N, K, index, cur, cur[len - 1] + 1);
             }
+        };
+        const int round_threads = min(num_threads, max(1, num_prefixes / 1024));
+        vector<thread> threads;
+        for (int t = 1; t < round_threads; t++) {
+            threads.emplace_back(worker, t, round_threads);
+        }
+        worker(0, round_threads);
+        for (auto& t : threads) {
+            t.join();
         }
 
-        if (to_add) {
-            if (indexing_on_first[first_elem] == -1) {
-                indexing_on_first[first_elem] = (int) all_selected_combs.size();
+        for (int p = 0; p < num_prefixes; p++) {
+            if (round_last[p] == N) {
+                continue;
             }
-            // Update indexing on second element.
-            // Note that having first_elem in the indexing is not a mistake.
-            if (indexing_on_second[first_elem] == -1) {
-                indexing_on_second[first_elem] = (int) all_selected_combs.size();
+            const int* cur = round_prefixes.data() + (size_t) p * len;
+            const int last = find_last_elem(N, K, index, cur, round_last[p]);
+            if (last == N) {
+                continue;
             }
-            all_selected_combs.push_back(new_comb);
+            vector<int> new_comb(cur, cur + len);
+            new_comb.push_back(last);
+            // Every (K - 1)-subset of the combination is the (K - 2)-subset without
+            // positions i and j completed by either of the two.
+            for (int i = 0; i < K; i++) {
+                for (int j = i + 1; j < K; j++) {
+                    const uint64_t key = subset_key(K, new_comb.data(), i, j);
+                    index.add(key, new_comb[i]);
+                    index.add(key, new_comb[j]);
+                }
+            }
+            all_selected_combs.push_back(move(new_comb));
         }
-    } while (prev_permutation(v.begin(), v.end()));
+    }
 
     return all_selected_combs;
 }
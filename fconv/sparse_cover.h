@@ -2,4 +2,6 @@
 
 #include <vector>
 
-std::vector<std::vector<int>> sparse_cover(int N, int K);
+// Selects K-combinations of the N neurons such that no two of them share K - 1 neurons.
+// num_threads <= 0 uses all hardware threads, the cover doesn't depend on it.
+std::vector<std::vector<int>> sparse_cover(int N, int K, int num_threads = 0);
@@ -5,6 +5,8 @@
 #include <map>
 #include <unistd.h>
 #include <random>
+#include <cstring>
+#include <thread>
 #include "fconv.h"
 #include "octahedron.h"
 #include "quadrants.h"
@@ -14,6 +16,7 @@
 #include "relaxation.h"
 #include "sparse_cover.h"
 #include "fp_mat.h"
+#include "pdd.h"
 
 // Temporary disabled the last test for k=4 before I add proper support
 // for inputs that split zero.
@@ -442,6 +445,332 @@ void run_relaxation_cdd_test(const int K, const string& path, Activation activat
     cout << "\tpassed" << endl;
 }
 
+// The hulls that the *_with_cdd relaxations certify in fp have to agree with the ones of cdd.
+void run_hull_cdd_agreement_test(const int K, const string& path, Activation activation) {
+    cout << "running " << activation2str[activation] << " hull agreement with cdd test: " << path << endl;
+
+    vector<double*> A = fp_mat_read(K + 1, path);
+    int num_checked_before, num_mismatches_before;
+    get_hull_check_stats(num_checked_before, num_mismatches_before);
+
+    vector<double*> H;
+    switch (activation) {
+        case Relu:
+            H = krelu_with_cdd(K, A);
+            break;
+        case Pool:
+            H = kpool_with_cdd(K, A);
+            break;
+        case Tanh:
+        case Sigm:
+            H = ktasi_with_cdd(K, A, activation);
+            break;
+        default:
+            throw runtime_error("Unknown activation.");
+    }
+
+    int num_checked, num_mismatches;
+    get_hull_check_stats(num_checked, num_mismatches);
+    ASRTF(num_mismatches == num_mismatches_before, "Hull computed in fp should agree with cdd.");
+    cout << "\t" << (num_checked > num_checked_before ? "compared" : "fell back to cdd") << endl;
+
+    fp_mat_free(A);
+    fp_mat_free(H);
+
+    cout << "\tpassed" << endl;
+}
+
+// Puts every test input for K repeat times into one batch, the inputs are appended to inputs.
+MatDoubleBatch read_batch(const int K, const int repeat, vector<MatDouble>& inputs) {
+    const size_t first = inputs.size();
+    for (int i = 1; i <= K2NUM_TESTS[K]; i++) {
+        vector<double*> A_int = fp_mat_read(K + 1, "octahedron_hrep/k" + to_string(K) + "/" + to_string(i) + ".txt");
+        inputs.push_back(mat_internal_to_external_format(K + 1, A_int));
+        fp_mat_free(A_int);
+    }
+    const int num_mats = K2NUM_TESTS[K] * repeat;
+
+    auto row_offsets = (int*) calloc(num_mats + 1, sizeof(int));
+    for (int i = 0; i < num_mats; i++) {
+        row_offsets[i + 1] = row_offsets[i] + inputs[first + i % K2NUM_TESTS[K]].rows;
+    }
+    auto data = (double*) calloc(row_offsets[num_mats] * (K + 1), sizeof(double));
+    for (int i = 0; i < num_mats; i++) {
+        const MatDouble& inp = inputs[first + i % K2NUM_TESTS[K]];
+        memcpy(&data[row_offsets[i] * (K + 1)], inp.data, inp.rows * inp.cols * sizeof(double));
+    }
+    return {num_mats, K + 1, row_offsets, data};
+}
+
+MatDoubleBatch relax_batch(MatDoubleBatch batch, Activation activation, const int num_threads) {
+    switch (activation) {
+        case Relu:
+            return fkrelu_batch(batch, num_threads);
+        case Pool:
+            return fkpool_batch(batch, num_threads);
+        case Tanh:
+            return fktanh_batch(batch, num_threads);
+        case Sigm:
+            return fksigm_batch(batch, num_threads);
+        default:
+            throw runtime_error("Unknown activation.");
+    }
+}
+
+void check_batch_equal(const MatDoubleBatch& expected, const MatDoubleBatch& actual) {
+    ASRTF(expected.num_mats == actual.num_mats, "Batches should have the same number of relaxations.");
+    ASRTF(expected.cols == actual.cols, "Batches should have the same number of columns.");
+    for (int i = 0; i <= expected.num_mats; i++) {
+        ASRTF(expected.row_offsets[i] == actual.row_offsets[i], "Batches should have the same number of rows.");
+    }
+    ASRTF(memcmp(expected.data, actual.data,
+                 (size_t) expected.row_offsets[expected.num_mats] * expected.cols * sizeof(double)) == 0,
+          "Batches should be identical.");
+}
+
+// Relaxes all inputs for K several times in one batch and checks that the
+// result is identical to relaxing them one by one.
+void run_batch_test(const int K, Activation activation) {
+    cout << "running " << activation2str[activation] << " batch test: K = " << K << endl;
+    constexpr int REPEAT = 8;
+
+    vector<MatDouble> inputs;
+    MatDoubleBatch batch = read_batch(K, REPEAT, inputs);
+    const int num_mats = batch.num_mats;
+
+    Timer t_batch;
+    MatDoubleBatch out_batch = relax_batch(batch, activation, 4);
+    int micros_batch = t_batch.micros();
+
+    Timer t_single;
+    for (int i = 0; i < num_mats; i++) {
+        const MatDouble& inp = inputs[i % K2NUM_TESTS[K]];
+        MatDouble out;
+        switch (activation) {
+            case Relu:
+                out = fkrelu(inp);
+                break;
+            case Pool:
+                out = fkpool(inp);
+                break;
+            case Tanh:
+                out = fktanh(inp);
+                break;
+            default:
+                out = fksigm(inp);
+                break;
+        }
+        const int rows = out_batch.row_offsets[i + 1] - out_batch.row_offsets[i];
+        ASRTF(out_batch.cols == out.cols, "Batch and single relaxation should have the same number of columns.");
+        ASRTF(rows == out.rows, "Batch and single relaxation should have the same number of rows.");
+        ASRTF(memcmp(&out_batch.data[out_batch.row_offsets[i] * out_batch.cols], out.data,
+                     out.rows * out.cols * sizeof(double)) == 0,
+              "Batch and single relaxation should be identical.");
+        free_MatDouble(out);
+    }
+    int micros_single = t_single.micros();
+
+    print_acceleration_info(micros_batch, micros_single);
+
+    for (auto& inp : inputs) {
+        free_MatDouble(inp);
+    }
+    free_MatDoubleBatch(batch);
+    free_MatDoubleBatch(out_batch);
+
+    cout << "\tpassed" << endl;
+}
+
+// Relaxes batches of all activations and K concurrently, each with many threads,
+// while cdd is used by the LP of the octahedron and the K = 1 tanh and sigmoid
+// relaxations. Every batch should be identical to the one computed with a single thread.
+void run_batch_threads_test() {
+    cout << "running batch threads test" << endl;
+    constexpr int REPEAT = 8;
+    constexpr int NUM_THREADS = 4;
+    constexpr int ROUNDS = 3;
+
+    struct BatchCase {
+        Activation activation;
+        MatDoubleBatch batch;
+        MatDoubleBatch expected;
+        MatDoubleBatch actual;
+    };
+    vector<BatchCase> cases;
+    vector<MatDouble> inputs;
+    for (Activation activation : {Relu, Pool, Tanh, Sigm}) {
+        // Like for the single relaxation tests, k=4 takes quite some time for tanh and sigmoid.
+        const int max_K = (activation == Relu || activation == Pool) ? 4 : 3;
+        for (int K = 1; K <= max_K; K++) {
+            MatDoubleBatch batch = read_batch(K, REPEAT, inputs);
+            cases.push_back({activation, batch, relax_batch(batch, activation, 1), {}});
+        }
+    }
+
+    Timer t;
+    for (int round = 0; round < ROUNDS; round++) {
+        vector<thread> threads;
+        for (auto& c : cases) {
+            threads.emplace_back([&c]() {
+                c.actual = relax_batch(c.batch, c.activation, NUM_THREADS);
+            });
+        }
+        for (auto& t_case : threads) {
+            t_case.join();
+        }
+        for (auto& c : cases) {
+            check_batch_equal(c.expected, c.actual);
+            free_MatDoubleBatch(c.actual);
+        }
+    }
+    cout << "\t" << ROUNDS << " rounds of " << cases.size() << " concurrent batches took "
+         << t.micros() / 1000 << " ms" << endl;
+
+    for (auto& c : cases) {
+        free_MatDoubleBatch(c.batch);
+        free_MatDoubleBatch(c.expected);
+    }
+    for (auto& inp : inputs) {
+        free_MatDouble(inp);
+    }
+
+    cout << "\tpassed" << endl;
+}
+
+void run_fp_mat_test(const int rows1, const int rows2, const int cols) {
+    cout << "running fp_mat test: rows1 = " << rows1 << " rows2 = " << rows2 << " cols = " << cols << endl;
+    mt19937 gen(rows1 * 1000 + rows2 * 10 + cols);
+    uniform_real_distribution<double> dist(-1, 1);
+
+    vector<double*> A = fp_mat_create(rows1, cols);
+    vector<double*> B = fp_mat_create(rows2, cols);
+    for (auto row : A) {
+        for (int j = 0; j < cols; j++) {
+            row[j] = dist(gen);
+        }
+    }
+    for (auto row : B) {
+        for (int j = 0; j < cols; j++) {
+            row[j] = dist(gen);
+        }
+    }
+
+    FpMat A_mat(cols, A);
+    FpMat B_mat(cols, B);
+    FpMat Res = fp_mat_mul_with_transpose(A_mat, B_mat);
+    ASRTF(Res.rows() == rows1 && Res.cols() == rows2, "Product should be of size rows1 x rows2.");
+    for (int i = 0; i < rows1; i++) {
+        ASRTF((size_t) Res[i] % 32 == 0, "Rows should be aligned.");
+        for (int j = 0; j < rows2; j++) {
+            double accum = 0;
+            for (int d = 0; d < cols; d++) {
+                accum += A[i][d] * B[j][d];
+            }
+            ASRTF(abs(accum - Res[i][j]) <= TOLERANCE, "Product should match the dot products.");
+        }
+    }
+
+    // Growing the columns keeps the entries and sets the new ones to zero,
+    // shrinking them back gives the original matrix.
+    A_mat.push_row(A[0]);
+    A_mat.resize_cols(cols + 5);
+    A_mat.resize_cols(cols);
+    ASRTF(A_mat.rows() == rows1 + 1, "A row should have been appended.");
+    vector<double*> A_rows = A_mat.to_rows();
+    for (int i = 0; i <= rows1; i++) {
+        for (int j = 0; j < cols; j++) {
+            ASRTF(A_rows[i][j] == A[i % rows1][j], "Entries should be preserved.");
+        }
+        for (int j = cols; j < A_mat.stride(); j++) {
+            ASRTF(A_mat[i][j] == 0, "Padding should be zero.");
+        }
+    }
+
+    fp_mat_free(A);
+    fp_mat_free(B);
+    fp_mat_free(A_rows);
+
+    cout << "\tpassed" << endl;
+}
+
+void run_bitset_test(const int num_bits) {
+    cout << "running bitset test: num_bits = " << num_bits << endl;
+    mt19937 gen(num_bits);
+    bernoulli_distribution dist(0.3);
+
+    vector<vector<bool>> ref(3, vector<bool>(num_bits));
+    vector<set_t> sets = set_arr_create(3, num_bits);
+    for (int s = 0; s < 3; s++) {
+        for (int i = 0; i < num_bits; i++) {
+            ref[s][i] = dist(gen);
+            if (ref[s][i]) {
+                set_enable_bit(sets[s], i);
+            }
+        }
+    }
+    // The third set is made a superset of the first one.
+    for (int i = 0; i < num_bits; i++) {
+        if (ref[0][i]) {
+            ref[2][i] = true;
+            set_enable_bit(sets[2], i);
+        }
+    }
+
+    int count = 0;
+    bool any = false;
+    bool subset = true;
+    for (int i = 0; i < num_bits; i++) {
+        count += ref[0][i];
+        any = any || (ref[0][i] && ref[1][i]);
+        subset = subset && (!ref[0][i] || ref[1][i]);
+    }
+    ASRTF(set_count(sets[0]) == count, "Count should match.");
+    ASRTF(set_intersect_by_any(sets[0], sets[1]) == any, "Intersect by any should match.");
+    ASRTF(set_is_subset_of(sets[0], sets[1]) == subset, "Subset check should match.");
+    ASRTF(set_is_subset_of(sets[0], sets[2]), "Should be a subset.");
+    ASRTF(set_equal(sets[0], sets[0]), "Set should be equal to itself.");
+
+    set_t inter = set_intersect(sets[0], sets[1]);
+    for (int i = 0; i < num_bits; i++) {
+        ASRTF(set_test_bit(inter, i) == (ref[0][i] && ref[1][i]), "Intersection should match.");
+    }
+    ASRTF(set_equal(inter, sets[0]) == subset, "Intersection equals the subset.");
+
+    // Growing keeps the bits and the new ones are not set.
+    set_t grown = set_resize(set_copy(sets[1]), 2 * num_bits + 3);
+    for (int i = 0; i < 2 * num_bits + 3; i++) {
+        ASRTF(set_test_bit(grown, i) == (i < num_bits && ref[1][i]), "Resize should keep the bits.");
+    }
+
+    set_free(inter);
+    set_free(grown);
+    set_arr_free(sets);
+
+    cout << "\tpassed" << endl;
+}
+
+// Average time of fkrelu over all inputs for K.
+void run_fkrelu_benchmark(const int K) {
+    constexpr int REPEAT = 10;
+    vector<MatDouble> inputs;
+    for (int i = 1; i <= K2NUM_TESTS[K]; i++) {
+        vector<double*> A_int = fp_mat_read(K + 1, "octahedron_hrep/k" + to_string(K) + "/" + to_string(i) + ".txt");
+        inputs.push_back(mat_internal_to_external_format(K + 1, A_int));
+        fp_mat_free(A_int);
+    }
+    Timer t;
+    for (int r = 0; r < REPEAT; r++) {
+        for (const auto& inp : inputs) {
+            free_MatDouble(fkrelu(inp));
+        }
+    }
+    int micros = t.micros();
+    cout << "\tK = " << K << " fkrelu takes " << (double) micros / (REPEAT * inputs.size()) / 1000 << " ms" << endl;
+    for (auto& inp : inputs) {
+        free_MatDouble(inp);
+    }
+}
+
 void run_1relu_test() {
     cout << "running 1-relu test:" << endl;
     double* inp_data = (double*) calloc(4, sizeof(double));
@@ -485,6 +814,37 @@ void run_1relu_test() {
     cout << "\tpassed" << endl;
 }
 
+// The greedy selection written directly: every combination is compared with all selected ones.
+vector<vector<int>> sparse_cover_reference(const int N, const int K) {
+    vector<vector<int>> selected;
+    if (N < K) {
+        return selected;
+    }
+    vector<bool> v(N);
+    fill(v.begin(), v.begin() + K, true);
+    do {
+        vector<int> comb;
+        for (int i = 0; i < N; i++) {
+            if (v[i]) {
+                comb.push_back(i);
+            }
+        }
+        bool to_add = true;
+        for (const auto& other : selected) {
+            vector<int> inter;
+            set_intersection(comb.begin(), comb.end(), other.begin(), other.end(), back_inserter(inter));
+            if ((int) inter.size() >= K - 1) {
+                to_add = false;
+                break;
+            }
+        }
+        if (to_add) {
+            selected.push_back(comb);
+        }
+    } while (prev_permutation(v.begin(), v.end()));
+    return selected;
+}
+
 void run_sparse_cover_test(const int N, const int K) {
     cout << "running sparse cover test: N " << N << " K " << K << endl;
 
@@ -506,9 +866,31 @@ void run_sparse_cover_test(const int N, const int K) {
         }
     }
 
+    vector<vector<int>> expected = sparse_cover_reference(N, K);
+    ASRTF(cover.rows == (int) expected.size(), "Number of combinations should match the reference.");
+    for (int i = 0; i < cover.rows; i++) {
+        for (int j = 0; j < K; j++) {
+            ASRTF(cover.data[i * K + j] == expected[i][j], "Combinations should match the reference.");
+        }
+    }
+    for (int num_threads = 1; num_threads <= 4; num_threads++) {
+        ASRTF(sparse_cover(N, K, num_threads) == expected, "Cover should not depend on the number of threads.");
+    }
+    free_MatInt(cover);
+
     cout << "\tpassed" << endl;
 }
 
+void run_sparse_cover_benchmark(const int N, const int K) {
+    cout << "running sparse cover benchmark: N " << N << " K " << K << endl;
+
+    Timer t;
+    vector<vector<int>> cover = sparse_cover(N, K);
+    int micros = t.micros();
+
+    cout << "\ttook " << micros / 1000 << " ms and generated " << cover.size() << " combinations" << endl;
+}
+
 void run_all_octahedron_tests() {
     cout << "Running all fast V octahedron tests" << endl;
     for (int k = 2; k <= 4; k++) {
@@ -590,6 +972,107 @@ void run_all_fktasi_tests(Activation activation) {
     }
 }
 
+// The hull of the cube [-1, 1]^d with every vertex given twice and random points inside of it.
+void run_hull_test(const int d) {
+    cout << "running hull test: d = " << d << endl;
+    mt19937 gen(d);
+    uniform_real_distribution<double> dist(-0.9, 0.9);
+
+    FpMat V(0, d + 1);
+    for (int rep = 0; rep < 2; rep++) {
+        for (int mask = 0; mask < (1 << d); mask++) {
+            double* v = V.push_row();
+            v[0] = 1;
+            for (int i = 0; i < d; i++) {
+                v[i + 1] = (mask >> i) & 1 ? 1 : -1;
+            }
+        }
+    }
+    for (int j = 0; j < 10 * d; j++) {
+        double* v = V.push_row();
+        v[0] = 1;
+        for (int i = 0; i < d; i++) {
+            v[i + 1] = dist(gen);
+        }
+    }
+
+    FpMat H;
+    ASRTF(PDD_compute_hull(V, H), "Hull of the cube should be certain.");
+    ASRTF(H.rows() == 2 * d, "Cube should have 2 * d facets.");
+    set<int> facets;
+    for (int r = 0; r < H.rows(); r++) {
+        int non_zero = -1;
+        for (int i = 1; i <= d; i++) {
+            if (H[r][i] != 0) {
+                ASRTF(non_zero == -1, "Facet should have a single non-zero coefficient.");
+                non_zero = i;
+            }
+        }
+        ASRTF(non_zero != -1 && abs(abs(H[r][non_zero]) - 1) < 1e-12, "Facet should be normalized.");
+        ASRTF(H[r][0] >= 1 && H[r][0] - 1 < 1e-12, "Facet should be shifted only by a tiny margin.");
+        facets.insert(H[r][non_zero] > 0 ? non_zero : -non_zero);
+        for (int v = 0; v < V.rows(); v++) {
+            double val = 0;
+            for (int i = 0; i <= d; i++) {
+                val += H[r][i] * V[v][i];
+            }
+            ASRTF(val >= 0, "Every vertex should satisfy every facet.");
+        }
+    }
+    ASRTF((int) facets.size() == 2 * d, "Facets should be distinct.");
+
+    // Vertices that are not full-dimensional are left to the exact computation.
+    FpMat flat = V.copy();
+    for (int r = 0; r < flat.rows(); r++) {
+        flat[r][d] = 0;
+    }
+    FpMat H_flat;
+    ASRTF(!PDD_compute_hull(flat, H_flat), "Flat vertices should not be certain.");
+}
+
+void run_all_hull_tests() {
+    cout << "Running all hull tests" << endl;
+    for (int d = 2; d <= 5; d++) {
+        run_hull_test(d);
+    }
+}
+
+void run_all_batch_tests() {
+    cout << "Running all batch tests" << endl;
+    for (int k = 2; k <= 4; k++) {
+        run_batch_test(k, Relu);
+        run_batch_test(k, Pool);
+    }
+    // Like for the single relaxation tests, k=4 takes quite some time for tanh and sigmoid.
+    for (int k = 2; k <= 3; k++) {
+        run_batch_test(k, Tanh);
+        run_batch_test(k, Sigm);
+    }
+    run_batch_threads_test();
+}
+
+void run_all_fp_mat_tests() {
+    cout << "Running all fp_mat tests" << endl;
+    run_fp_mat_test(1, 1, 1);
+    run_fp_mat_test(7, 5, 3);
+    run_fp_mat_test(40, 65, 9);
+    run_fp_mat_test(100, 3, 12);
+}
+
+void run_all_bitset_tests() {
+    cout << "Running all bitset tests" << endl;
+    for (int num_bits : {1, 63, 64, 65, 256, 300, 512, 513, 2000}) {
+        run_bitset_test(num_bits);
+    }
+}
+
+void run_all_fkrelu_benchmarks() {
+    cout << "Running fkrelu benchmarks" << endl;
+    for (int k = 2; k <= 4; k++) {
+        run_fkrelu_benchmark(k);
+    }
+}
+
 void run_all_relaxation_cdd_tests(Activation activation, int max_k) {
     cout << "Running all cdd tests for " << activation2str[activation] << endl;
     for (int k = 1; k <= max_k; k++) {
@@ -602,6 +1085,20 @@ void run_all_relaxation_cdd_tests(Activation activation, int max_k) {
     }
 }
 
+void run_all_hull_cdd_agreement_tests(Activation activation, int max_k) {
+    cout << "Running all hull agreement with cdd tests for " << activation2str[activation] << endl;
+    set_hull_check_with_cdd(true);
+    for (int k = 1; k <= max_k; k++) {
+        for (int i = 1; i <= K2NUM_TESTS[k]; i++) {
+            run_hull_cdd_agreement_test(
+                    k,
+                    "octahedron_hrep/k" + to_string(k) + "/" + to_string(i) + ".txt",
+                    activation);
+        }
+    }
+    set_hull_check_with_cdd(false);
+}
+
 void run_all_sparse_cover_tests() {
     cout << "Running all sparse cover tests" << endl;
     run_sparse_cover_test(50, 3);
@@ -614,6 +1111,15 @@ void run_all_sparse_cover_tests() {
     run_sparse_cover_test(0, 3);
 }
 
+void run_all_sparse_cover_benchmarks() {
+    cout << "Running all sparse cover benchmarks" << endl;
+    run_sparse_cover_benchmark(1000, 3);
+    run_sparse_cover_benchmark(3000, 3);
+    run_sparse_cover_benchmark(10000, 3);
+    run_sparse_cover_benchmark(200, 4);
+    run_sparse_cover_benchmark(100, 5);
+}
+
 void handler(int sig) {
     void *array[10];
     size_t size;
@@ -630,6 +1136,8 @@ void handler(int sig) {
 int main() {
     signal(SIGSEGV, handler);
 
+    run_all_fp_mat_tests();
+    run_all_bitset_tests();
     run_all_octahedron_tests();
     run_all_split_in_quadrants_tests();
     run_all_pool_quadrants_tests();
@@ -639,12 +1147,20 @@ int main() {
     run_all_fkpool_tests();
     run_all_fktasi_tests(Tanh);
     run_all_fktasi_tests(Sigm);
+    run_all_batch_tests();
+    run_all_hull_tests();
+    run_all_fkrelu_benchmarks();
     run_all_relaxation_cdd_tests(Relu, 3); // k=4 ~20 minutes
     run_all_relaxation_cdd_tests(Pool, 3); // k=4 1-2 minutes
     run_all_relaxation_cdd_tests(Tanh, 2); // k=3 1-2 minutes
     run_all_relaxation_cdd_tests(Sigm, 2); // k=3 1-2 minutes
+    run_all_hull_cdd_agreement_tests(Relu, 3);
+    run_all_hull_cdd_agreement_tests(Pool, 3);
+    run_all_hull_cdd_agreement_tests(Tanh, 2);
+    run_all_hull_cdd_agreement_tests(Sigm, 2);
     run_1relu_test();
     run_all_sparse_cover_tests();
+    run_all_sparse_cover_benchmarks();
 
     return 0;
 }
@@ -11,6 +11,24 @@
 
 using namespace std;
 
+mutex cdd_mutex;
+
+int cdd_global_constants_users = 0;
+
+void cdd_global_constants_acquire() {
+    lock_guard<mutex> cdd_lock(cdd_mutex);
+    if (cdd_global_constants_users++ == 0) {
+        dd_set_global_constants();
+    }
+}
+
+void cdd_global_constants_release() {
+    lock_guard<mutex> cdd_lock(cdd_mutex);
+    if (--cdd_global_constants_users == 0) {
+        dd_free_global_constants();
+    }
+}
+
 Timer::Timer() {
     start = chrono::high_resolution_clock::now();
 }
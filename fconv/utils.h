@@ -6,6 +6,7 @@
 #include <array>
 #include <chrono>
 #include <iostream>
+#include <mutex>
 #include "asrt.h"
 #include "dynamic_bitset.h"
 #include "fconv.h"
@@ -60,6 +61,17 @@ struct VInc_mpq {
 
 vector<int> compute_maximal_indexes(const vector<set_t>& incidence);
 
+// cddlib is not reentrant: the double description method and the LP solvers keep their
+// working storage in static variables. Creating and freeing matrices only allocates, but
+// any conversion or LP that may run concurrently has to hold this lock.
+extern mutex cdd_mutex;
+
+// The global constants of cddlib are shared by all threads, so they are set by the first
+// relaxation that starts and freed by the last one that finishes.
+void cdd_global_constants_acquire();
+
+void cdd_global_constants_release();
+
 dd_PolyhedraPtr cdd_Matrix_to_Poly(dd_MatrixPtr A);
 
 vector<double*> mat_external_to_internal_format(const MatDouble &cmat);
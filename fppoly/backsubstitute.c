@@ -1,83 +1,87 @@
 #include "backsubstitute.h"
 
-void * update_state_using_previous_layers(void *args){
+static void update_state_of_neuron(elina_manager_t *man, fppoly_internal_t *pr, fppoly_t *fp, size_t layerno, size_t i){
+	neuron_t *out_neuron = fp->layers[layerno]->neurons[i];
+	expr_t *lexpr = copy_neuron_expr(fp->layers[layerno], i, true);
+	expr_t *uexpr = copy_neuron_expr(fp->layers[layerno], i, false);
+	if(pr->backsub_early_stop){
+		/* once the lower bound is positive the upper bound cannot change the phase any more */
+		out_neuron->lb = get_lb_using_previous_layers_until(man, fp, lexpr, layerno, 0);
+		out_neuron->ub = get_ub_using_previous_layers_until(man, fp, uexpr, layerno, out_neuron->lb < 0 ? INFINITY : 0);
+	}
+	else{
+		out_neuron->lb = get_lb_using_previous_layers(man, fp, lexpr, layerno);
+		out_neuron->ub = get_ub_using_previous_layers(man, fp, uexpr, layerno);
+	}
+	free_expr(lexpr);
+	free_expr(uexpr);
+}
+
+
+void update_state_using_previous_layers(void *args, size_t idx_start, size_t idx_end){
 	nn_thread_t * data = (nn_thread_t *)args;
-	elina_manager_t * man = data->man;
-	fppoly_t *fp = data->fp;
-	fppoly_internal_t * pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
-	size_t layerno = data->layerno;
-	size_t idx_start = data->start;
-	size_t idx_end = data->end;
+	fppoly_internal_t * pr = fppoly_init_from_manager(data->man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t i;
+	for(i=idx_start; i < idx_end; i++){
+		update_state_of_neuron(data->man, pr, data->fp, data->layerno, i);
+	}
+}
+
+
+typedef struct neuron_subset_thread_t{
+	nn_thread_t nn;
+	size_t *neurons;
+}neuron_subset_thread_t;
+
+
+static void update_state_of_neuron_subset(void *args, size_t idx_start, size_t idx_end){
+	neuron_subset_thread_t * data = (neuron_subset_thread_t *)args;
+	fppoly_internal_t * pr = fppoly_init_from_manager(data->nn.man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	size_t i;
-	int k;
-	
-	neuron_t ** out_neurons = fp->layers[layerno]->neurons;
-	size_t num_out_neurons = fp->layers[layerno]->dims;
-	
 	for(i=idx_start; i < idx_end; i++){
-		bool already_computed= false;
-		expr_t *lexpr = copy_expr(out_neurons[i]->lexpr);
-		expr_t *uexpr = copy_expr(out_neurons[i]->uexpr);
-		out_neurons[i]->lb = get_lb_using_previous_layers(man, fp, lexpr, layerno);
-		out_neurons[i]->ub = get_ub_using_previous_layers(man, fp, uexpr, layerno);
-		free_expr(lexpr);
-		free_expr(uexpr);
-		
+		update_state_of_neuron(data->nn.man, pr, data->nn.fp, data->nn.layerno, data->neurons[i]);
 	}
-	return NULL;
+}
+
+void update_state_using_previous_layers_gemm(void *args, size_t idx_start, size_t idx_end){
+	nn_thread_t * data = (nn_thread_t *)args;
+	fppoly_internal_t * pr = fppoly_init_from_manager(data->man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	backsubstitute_gemm(pr, data->fp, data->layerno, idx_start, idx_end);
 }
 
 
 void update_state_using_previous_layers_parallel(elina_manager_t *man, fppoly_t *fp, size_t layerno){
-	//size_t NUM_THREADS = get_nprocs();
-  	size_t NUM_THREADS = sysconf(_SC_NPROCESSORS_ONLN);
-	nn_thread_t args[NUM_THREADS];
-	pthread_t threads[NUM_THREADS];
+	fppoly_internal_t * pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	size_t num_out_neurons = fp->layers[layerno]->dims;
-	size_t i;
-	if(num_out_neurons < NUM_THREADS){
-		for (i = 0; i < num_out_neurons; i++){
-	    		args[i].start = i; 
-	    		args[i].end = i+1;   
-			args[i].man = man;
-			args[i].fp = fp;
-			args[i].layerno = layerno;
-			args[i].linexpr0 = NULL;
-			args[i].res = NULL;
-	    		pthread_create(&threads[i], NULL,update_state_using_previous_layers, (void*)&args[i]);
-			
-	  	}
-		for (i = 0; i < num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+	nn_thread_t args;
+	args.man = man;
+	args.fp = fp;
+	args.layerno = layerno;
+	args.linexpr0 = NULL;
+	args.res = NULL;
+	/* neurons are handed out dynamically, expression sizes and hence costs vary a lot */
+	if(layer_is_gemm_backsubstitutable(fp, layerno)){
+		thread_pool_run(pr->pool, num_out_neurons, GEMM_PANEL_ROWS, update_state_using_previous_layers_gemm, (void*)&args);
 	}
 	else{
-		size_t idx_start = 0;
-		size_t idx_n = num_out_neurons / NUM_THREADS;
-		size_t idx_end = idx_start + idx_n;
-		
-		
-	  	for (i = 0; i < NUM_THREADS; i++){
-	    		args[i].start = idx_start; 
-	    		args[i].end = idx_end;   
-			args[i].man = man;
-			args[i].fp = fp;
-			args[i].layerno = layerno;
-			args[i].linexpr0 = NULL;
-			args[i].res = NULL;
-	    		pthread_create(&threads[i], NULL,update_state_using_previous_layers, (void*)&args[i]);
-			idx_start = idx_end;
-			idx_end = idx_start + idx_n;
-	    		if(idx_end>num_out_neurons){
-				idx_end = num_out_neurons;
-			}
-			if((i==NUM_THREADS-2)){
-				idx_end = num_out_neurons;
-				
-			}
-	  	}
-		for (i = 0; i < NUM_THREADS; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		thread_pool_run(pr->pool, num_out_neurons, 1, update_state_using_previous_layers, (void*)&args);
+	}
+}
+
+
+/* recomputes the bounds of the listed neurons of layer layerno only */
+void update_state_of_neurons_parallel(elina_manager_t *man, fppoly_t *fp, size_t layerno, size_t *neurons, size_t num_neurons){
+	fppoly_internal_t * pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	if(num_neurons==fp->layers[layerno]->dims){
+		update_state_using_previous_layers_parallel(man, fp, layerno);
+		return;
 	}
+	neuron_subset_thread_t args;
+	args.nn.man = man;
+	args.nn.fp = fp;
+	args.nn.layerno = layerno;
+	args.nn.linexpr0 = NULL;
+	args.nn.res = NULL;
+	args.neurons = neurons;
+	thread_pool_run(pr->pool, num_neurons, 1, update_state_of_neuron_subset, (void*)&args);
 }
@@ -30,6 +30,9 @@ extern "C" {
 #include "fppoly.h"
 #include "expr.h"
 #include "compute_bounds.h"
+#include "backsubstitute_gemm.h"
+#include "implicit_conv.h"
+#include "spatial_lp.h"
 #include "relu_approx.h"
 #include "s_curve_approx.h"
 #include "parabola_approx.h"
@@ -39,6 +42,8 @@ extern "C" {
 
 void update_state_using_previous_layers_parallel(elina_manager_t *man, fppoly_t *fp, size_t layerno);
 
+void update_state_of_neurons_parallel(elina_manager_t *man, fppoly_t *fp, size_t layerno, size_t *neurons, size_t num_neurons);
+
 #ifdef __cplusplus
  }
 #endif
@@ -0,0 +1,606 @@
+#include "backsubstitute_gemm.h"
+#include "interval_simd.h"
+
+/*
+ * One side (all lower or all upper expressions) of a panel of output neurons,
+ * stored row-major over the neurons of the layer reached so far. Intervals
+ * follow the expr_t convention: inf holds the negated lower bound.
+ */
+typedef struct gemm_side_t{
+	double *inf;
+	double *sup;
+	double *cst_inf;
+	double *cst_sup;
+	double *bound;
+	bool is_lower;
+}gemm_side_t;
+
+typedef struct gemm_workspace_t{
+	/* result of the current step, swapped with the side afterwards */
+	double *res_inf;
+	double *res_sup;
+	/* magnitude of the products summed into each result entry */
+	double *mag;
+	/* per (row, inner index): scaled endpoints of the coefficient and the rows of the layer matrix it multiplies */
+	double *x;
+	double *y;
+	double **b_inf;
+	double **b_sup;
+	/* bounds of the neurons of the layer reached so far */
+	double *lb;
+	double *ub;
+}gemm_workspace_t;
+
+
+static size_t gemm_layer_dims(fppoly_t *fp, int k){
+	return k < 0 ? fp->num_pixels : fp->layers[k]->dims;
+}
+
+static bool gemm_layer_has_single_predecessor(layer_t *layer){
+	return (layer->num_predecessors==1) && !layer->is_concat && (layer->h_t_inf==NULL);
+}
+
+static bool gemm_expr_is_supported(expr_t *expr, bool is_activation, size_t num_in_neurons){
+	size_t i;
+	if(expr==NULL){
+		return false;
+	}
+	if(is_activation){
+		return (expr->size>=1) && (expr->inf_coeff!=NULL) && (expr->sup_coeff!=NULL);
+	}
+	if(expr->size==0){
+		return true;
+	}
+	if(expr->inf_coeff==NULL || expr->sup_coeff==NULL){
+		return false;
+	}
+	if(expr->type==DENSE){
+		return expr->size==num_in_neurons;
+	}
+	for(i=0; i < expr->size; i++){
+		if(expr->dim[i] >= num_in_neurons){
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool layer_is_gemm_backsubstitutable(fppoly_t *fp, size_t layerno){
+	size_t i;
+	if((fp->input_lexpr!=NULL) || (fp->input_uexpr!=NULL)){
+		return false;
+	}
+	layer_t *layer = fp->layers[layerno];
+	if(layer->is_activation || !gemm_layer_has_single_predecessor(layer)){
+		return false;
+	}
+	int k = layer->predecessors[0]-1;
+	size_t num_in_neurons = gemm_layer_dims(fp,k);
+	for(i=0; i < layer->dims; i++){
+		expr_t *lexpr = layer->neurons[i]->lexpr;
+		expr_t *uexpr = layer->neurons[i]->uexpr;
+		if(lexpr==NULL || uexpr==NULL || lexpr->type!=DENSE || uexpr->type!=DENSE){
+			return false;
+		}
+		if(!gemm_expr_is_supported(lexpr,false,num_in_neurons) || !gemm_expr_is_supported(uexpr,false,num_in_neurons)){
+			return false;
+		}
+	}
+	if(num_in_neurons > GEMM_MAX_LAYER_DIMS){
+		return false;
+	}
+	while(k >= 0){
+		layer_t *aux = fp->layers[k];
+		if(!gemm_layer_has_single_predecessor(aux)){
+			return false;
+		}
+		int pred = aux->predecessors[0]-1;
+		num_in_neurons = gemm_layer_dims(fp,pred);
+		if(num_in_neurons > GEMM_MAX_LAYER_DIMS){
+			return false;
+		}
+		if(aux->is_activation && aux->dims!=num_in_neurons){
+			return false;
+		}
+		if(aux->conv!=NULL){
+			conv_layer_t *conv = aux->conv;
+			if(conv->input_size[0]*conv->input_size[1]*conv->input_size[2]!=num_in_neurons){
+				return false;
+			}
+			k = pred;
+			continue;
+		}
+		for(i=0; i < aux->dims; i++){
+			if(!gemm_expr_is_supported(aux->neurons[i]->lexpr,aux->is_activation,num_in_neurons) ||
+			   !gemm_expr_is_supported(aux->neurons[i]->uexpr,aux->is_activation,num_in_neurons)){
+				return false;
+			}
+		}
+		k = pred;
+	}
+	return true;
+}
+
+
+void gemm_axpy(double * restrict c_inf, double * restrict c_sup, double * restrict mag,
+	       double x, double y, double m, const double * restrict b_inf, const double * restrict b_sup, size_t w){
+	size_t c = 0;
+#ifdef FPPOLY_SIMD
+	/* vmax returns its second operand on a NaN product or a tie, as the scalar selection below */
+	vdouble vx = vset1(x);
+	vdouble vy = vset1(y);
+	vdouble vm = vset1(m);
+	for(; c + VLEN <= w; c+=VLEN){
+		vdouble bi = vload(b_inf + c);
+		vdouble bs = vload(b_sup + c);
+		vstore(c_inf + c, vadd(vload(c_inf + c), vmax(vmul(vx,bi), vmul(vy,bi))));
+		vstore(c_sup + c, vadd(vload(c_sup + c), vmax(vmul(vx,bs), vmul(vy,bs))));
+		vstore(mag + c, vadd(vload(mag + c), vmul(vm, vmax(vabs(bi), vabs(bs)))));
+	}
+#endif
+	for(; c < w; c++){
+		double p1 = x*b_inf[c];
+		double p2 = y*b_inf[c];
+		c_inf[c] += p1 > p2 ? p1 : p2;
+		p1 = x*b_sup[c];
+		p2 = y*b_sup[c];
+		c_sup[c] += p1 > p2 ? p1 : p2;
+		double q1 = fabs(b_inf[c]);
+		double q2 = fabs(b_sup[c]);
+		mag[c] += m*(q1 > q2 ? q1 : q2);
+	}
+}
+
+
+static void gemm_scatter(double *c_inf, double *c_sup, double *mag, double x, double y, double m,
+			 const double *b_inf, const double *b_sup, const size_t *dim, size_t size){
+	size_t i;
+	for(i=0; i < size; i++){
+		size_t c = dim[i];
+		double p1 = x*b_inf[i];
+		double p2 = y*b_inf[i];
+		c_inf[c] += p1 > p2 ? p1 : p2;
+		p1 = x*b_sup[i];
+		p2 = y*b_sup[i];
+		c_sup[c] += p1 > p2 ? p1 : p2;
+		mag[c] += m*fmax(fabs(b_inf[i]),fabs(b_sup[i]));
+	}
+}
+
+
+/*
+ * Blocked interval GEMM over the (row, inner index) pairs recorded by
+ * gemm_affine_step: the result is tiled by GEMM_TILE_COLS columns and the
+ * inner dimension by GEMM_TILE_INNER so that the block of the layer matrix
+ * stays in cache while it is applied to every row of the panel.
+ */
+static void gemm_kernel(gemm_workspace_t *ws, size_t rows, size_t num_neurons, size_t num_in_neurons){
+	size_t c0, j0, r, j;
+	for(c0=0; c0 < num_in_neurons; c0+=GEMM_TILE_COLS){
+		size_t w = num_in_neurons - c0 < GEMM_TILE_COLS ? num_in_neurons - c0 : GEMM_TILE_COLS;
+		for(j0=0; j0 < num_neurons; j0+=GEMM_TILE_INNER){
+			size_t j1 = num_neurons - j0 < GEMM_TILE_INNER ? num_neurons : j0 + GEMM_TILE_INNER;
+			for(r=0; r < rows; r++){
+				double *c_inf = ws->res_inf + r*num_in_neurons + c0;
+				double *c_sup = ws->res_sup + r*num_in_neurons + c0;
+				double *mag = ws->mag + r*num_in_neurons + c0;
+				for(j=j0; j < j1; j++){
+					size_t idx = r*num_neurons + j;
+					if(ws->b_inf[idx]==NULL){
+						continue;
+					}
+					double x = ws->x[idx];
+					double y = ws->y[idx];
+					gemm_axpy(c_inf,c_sup,mag,x,y,fmax(x,y),ws->b_inf[idx]+c0,ws->b_sup[idx]+c0,w);
+				}
+			}
+		}
+	}
+}
+
+
+/* replaces the neurons of an affine layer by their lower/upper expressions, as expr_replace_bounds_affine */
+static void gemm_affine_step(fppoly_internal_t *pr, gemm_side_t *side, gemm_workspace_t *ws, neuron_t **neurons,
+			     size_t rows, size_t num_neurons, size_t num_in_neurons){
+	size_t r, j;
+	size_t size = rows*num_in_neurons;
+	memset(ws->res_inf,0,size*sizeof(double));
+	memset(ws->res_sup,0,size*sizeof(double));
+	memset(ws->mag,0,size*sizeof(double));
+	for(r=0; r < rows; r++){
+		double *a_inf = side->inf + r*num_neurons;
+		double *a_sup = side->sup + r*num_neurons;
+		double cst_inf = 0.0, cst_sup = 0.0, cst_mag = 0.0;
+		size_t num_terms = 0;
+		for(j=0; j < num_neurons; j++){
+			size_t idx = r*num_neurons + j;
+			expr_t *mul_expr = NULL;
+			bool is_negative = false;
+			ws->b_inf[idx] = NULL;
+			if(a_sup[j] < 0){
+				mul_expr = side->is_lower ? neurons[j]->uexpr : neurons[j]->lexpr;
+				is_negative = true;
+			}
+			else if(a_inf[j] < 0){
+				mul_expr = side->is_lower ? neurons[j]->lexpr : neurons[j]->uexpr;
+			}
+			else if(a_inf[j]==0 && a_sup[j]==0){
+				continue;
+			}
+			double tmp1, tmp2;
+			num_terms++;
+			if(mul_expr==NULL){
+				elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,ws->lb[j],ws->ub[j],a_inf[j],a_sup[j]);
+				if(side->is_lower){
+					cst_inf = cst_inf + tmp1;
+					cst_sup = cst_sup - tmp1;
+				}
+				else{
+					cst_inf = cst_inf - tmp2;
+					cst_sup = cst_sup + tmp2;
+				}
+				cst_mag = cst_mag + fmax(fabs(tmp1),fabs(tmp2));
+				continue;
+			}
+			elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,a_inf[j],a_sup[j],mul_expr->inf_cst,mul_expr->sup_cst);
+			cst_inf = cst_inf + tmp1;
+			cst_sup = cst_sup + tmp2;
+			cst_mag = cst_mag + fmax(fabs(tmp1),fabs(tmp2));
+			if(mul_expr->size==0){
+				continue;
+			}
+			/* a >= 0 multiplies (b_inf, b_sup) by (l_a, u_a), a <= 0 multiplies (b_sup, b_inf) by (-l_a, -u_a) */
+			double x = is_negative ? a_inf[j] : -a_inf[j];
+			double y = is_negative ? -a_sup[j] : a_sup[j];
+			double *b_inf = is_negative ? mul_expr->sup_coeff : mul_expr->inf_coeff;
+			double *b_sup = is_negative ? mul_expr->inf_coeff : mul_expr->sup_coeff;
+			if(mul_expr->type==DENSE){
+				ws->x[idx] = x;
+				ws->y[idx] = y;
+				ws->b_inf[idx] = b_inf;
+				ws->b_sup[idx] = b_sup;
+			}
+			else{
+				size_t offset = r*num_in_neurons;
+				gemm_scatter(ws->res_inf+offset,ws->res_sup+offset,ws->mag+offset,x,y,fmax(x,y),b_inf,b_sup,mul_expr->dim,mul_expr->size);
+			}
+		}
+		/* rounding of the accumulated sums, as add_cst_expr does term by term */
+		double err = (num_terms+1)*cst_mag*pr->ulp + num_terms*pr->min_denormal;
+		side->cst_inf[r] = side->cst_inf[r] + cst_inf + err;
+		side->cst_sup[r] = side->cst_sup[r] + cst_sup + err;
+	}
+
+	gemm_kernel(ws,rows,num_neurons,num_in_neurons);
+
+	/* rounding of the products and of the accumulated sums, as multiply_expr and add_expr do term by term */
+	double scale = (num_neurons+1)*pr->ulp;
+	for(j=0; j < size; j++){
+		double err = scale*ws->mag[j];
+		ws->res_inf[j] += err;
+		ws->res_sup[j] += err;
+	}
+	double *tmp = side->inf;
+	side->inf = ws->res_inf;
+	ws->res_inf = tmp;
+	tmp = side->sup;
+	side->sup = ws->res_sup;
+	ws->res_sup = tmp;
+}
+
+
+/* replaces the neurons of a convolutional layer, a transposed convolution of every row of the panel */
+static void gemm_conv_step(fppoly_internal_t *pr, gemm_side_t *side, gemm_workspace_t *ws, layer_t *layer,
+			   size_t rows, size_t num_neurons, size_t num_in_neurons){
+	conv_layer_t *conv = layer->conv;
+	size_t r;
+	char *active = (char *)malloc(conv->output_size[0]*conv->output_size[1]*sizeof(char));
+	size_t box[4];
+	size_t out_box[4] = {0, conv->output_size[0], 0, conv->output_size[1]};
+	size_t full[4] = {0, conv->input_size[0], 0, conv->input_size[1]};
+	for(r=0; r < rows; r++){
+		double *a_inf = side->inf + r*num_neurons;
+		double *a_sup = side->sup + r*num_neurons;
+		double *c_inf = ws->res_inf + r*num_in_neurons;
+		double *c_sup = ws->res_sup + r*num_in_neurons;
+		if(conv_backsubstitute_cst(pr,conv,layer->neurons,side->is_lower,out_box,a_inf,a_sup,&side->cst_inf[r],&side->cst_sup[r],active,box)){
+			conv_transpose(pr,conv,out_box,a_inf,a_sup,active,full,c_inf,c_sup);
+		}
+		else{
+			memset(c_inf,0,num_in_neurons*sizeof(double));
+			memset(c_sup,0,num_in_neurons*sizeof(double));
+		}
+	}
+	free(active);
+	double *tmp = side->inf;
+	side->inf = ws->res_inf;
+	ws->res_inf = tmp;
+	tmp = side->sup;
+	side->sup = ws->res_sup;
+	ws->res_sup = tmp;
+}
+
+
+/* replaces the neurons of an activation layer by their relaxations, as expr_replace_bounds_activation */
+static void gemm_activation_step(fppoly_internal_t *pr, gemm_side_t *side, gemm_workspace_t *ws, neuron_t **neurons,
+				 size_t rows, size_t num_neurons){
+	size_t r, j;
+	for(r=0; r < rows; r++){
+		double *a_inf = side->inf + r*num_neurons;
+		double *a_sup = side->sup + r*num_neurons;
+		double cst_inf = side->cst_inf[r];
+		double cst_sup = side->cst_sup[r];
+		for(j=0; j < num_neurons; j++){
+			if(a_sup[j]==0 && a_inf[j]==0){
+				continue;
+			}
+			expr_t *mul_expr = NULL;
+			if(a_sup[j] < 0){
+				mul_expr = side->is_lower ? neurons[j]->uexpr : neurons[j]->lexpr;
+			}
+			else if(a_inf[j] < 0){
+				mul_expr = side->is_lower ? neurons[j]->lexpr : neurons[j]->uexpr;
+			}
+			double tmp1, tmp2;
+			if(mul_expr!=NULL){
+				elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,mul_expr->inf_cst,mul_expr->sup_cst,a_inf[j],a_sup[j]);
+				cst_inf = cst_inf + tmp1 + pr->min_denormal;
+				cst_sup = cst_sup + tmp2 + pr->min_denormal;
+				elina_double_interval_mul_expr_coeff(pr,&tmp1,&tmp2,mul_expr->inf_coeff[0],mul_expr->sup_coeff[0],a_inf[j],a_sup[j]);
+				a_inf[j] = tmp1;
+				a_sup[j] = tmp2;
+			}
+			else{
+				elina_double_interval_mul_expr_coeff(pr,&tmp1,&tmp2,ws->lb[j],ws->ub[j],a_inf[j],a_sup[j]);
+				if(side->is_lower){
+					cst_inf = cst_inf + tmp1;
+					cst_sup = cst_sup - tmp1;
+				}
+				else{
+					cst_inf = cst_inf - tmp2;
+					cst_sup = cst_sup + tmp2;
+				}
+				a_inf[j] = 0.0;
+				a_sup[j] = 0.0;
+			}
+		}
+		side->cst_inf[r] = cst_inf;
+		side->cst_sup[r] = cst_sup;
+	}
+}
+
+
+/* bound of every row over the box [-inf, sup], as compute_lb/ub_from_expr; keeps the tightest one seen */
+static void gemm_concretize(gemm_side_t *side, size_t rows, size_t num_neurons, double *inf, double *sup){
+	size_t r, j;
+	for(r=0; r < rows; r++){
+		double *a_inf = side->inf + r*num_neurons;
+		double *a_sup = side->sup + r*num_neurons;
+		double res = side->is_lower ? side->cst_inf[r] : side->cst_sup[r];
+		for(j=0; j < num_neurons; j++){
+			double tmp1, tmp2;
+			elina_double_interval_mul(&tmp1,&tmp2,a_inf[j],a_sup[j],inf[j],sup[j]);
+			res = res + (side->is_lower ? tmp1 : tmp2);
+		}
+		side->bound[r] = fmin(side->bound[r],res);
+	}
+}
+
+
+static void gemm_side_move_row(gemm_side_t *side, size_t to, size_t from, size_t num_neurons){
+	memcpy(side->inf + to*num_neurons,side->inf + from*num_neurons,num_neurons*sizeof(double));
+	memcpy(side->sup + to*num_neurons,side->sup + from*num_neurons,num_neurons*sizeof(double));
+	side->cst_inf[to] = side->cst_inf[from];
+	side->cst_sup[to] = side->cst_sup[from];
+	side->bound[to] = side->bound[from];
+}
+
+
+/*
+ * Stores the bounds of the rows that have used up the depth budget or, in
+ * early stop mode, whose bounds exclude 0, and moves the last rows into
+ * their place so that the remaining layers are only applied to the rest.
+ * ids maps panel rows to neurons. Returns the number of rows left.
+ */
+static size_t gemm_panel_retire(fppoly_internal_t *pr, fppoly_t *fp, gemm_side_t *lower, gemm_side_t *upper, size_t *ids,
+				size_t rows, size_t num_neurons, neuron_t **out_neurons, size_t depth, int k){
+	double threshold = pr->backsub_early_stop ? 0 : -INFINITY;
+	size_t r = rows;
+	while(r-- > 0){
+		if(!backsubstitution_can_stop(pr,lower->bound[r],threshold,depth) && !backsubstitution_can_stop(pr,upper->bound[r],threshold,depth)){
+			continue;
+		}
+		out_neurons[ids[r]]->lb = lower->bound[r];
+		out_neurons[ids[r]]->ub = upper->bound[r];
+		__sync_fetch_and_add(&fp->backsub_steps_saved, 2*backsubstitution_remaining_steps(fp,k));
+		rows--;
+		if(r!=rows){
+			gemm_side_move_row(lower,r,rows,num_neurons);
+			gemm_side_move_row(upper,r,rows,num_neurons);
+			ids[r] = ids[rows];
+		}
+	}
+	return rows;
+}
+
+
+static void gemm_side_init(gemm_side_t *side, size_t size, size_t rows, bool is_lower){
+	side->inf = (double *)malloc(size*sizeof(double));
+	side->sup = (double *)malloc(size*sizeof(double));
+	side->cst_inf = (double *)malloc(rows*sizeof(double));
+	side->cst_sup = (double *)malloc(rows*sizeof(double));
+	side->bound = (double *)malloc(rows*sizeof(double));
+	side->is_lower = is_lower;
+}
+
+static void gemm_side_free(gemm_side_t *side){
+	free(side->inf);
+	free(side->sup);
+	free(side->cst_inf);
+	free(side->cst_sup);
+	free(side->bound);
+}
+
+static void gemm_side_load(gemm_side_t *side, neuron_t **neurons, size_t rows, size_t num_neurons){
+	size_t r;
+	for(r=0; r < rows; r++){
+		expr_t *expr = side->is_lower ? neurons[r]->lexpr : neurons[r]->uexpr;
+		memcpy(side->inf + r*num_neurons,expr->inf_coeff,num_neurons*sizeof(double));
+		memcpy(side->sup + r*num_neurons,expr->sup_coeff,num_neurons*sizeof(double));
+		side->cst_inf[r] = expr->inf_cst;
+		side->cst_sup[r] = expr->sup_cst;
+		side->bound[r] = INFINITY;
+	}
+}
+
+
+/*
+ * Panel buffers of a thread. backsubstitute_gemm runs once per chunk of
+ * GEMM_PANEL_ROWS neurons, so the buffers are grown to the widest path seen
+ * and kept for the next chunks; the pool workers free theirs when they exit.
+ */
+typedef struct gemm_scratch_t{
+	size_t max_dims;
+	gemm_side_t lower;
+	gemm_side_t upper;
+	gemm_workspace_t ws;
+}gemm_scratch_t;
+
+static pthread_key_t gemm_scratch_key;
+static pthread_once_t gemm_scratch_once = PTHREAD_ONCE_INIT;
+
+static void gemm_scratch_clear(gemm_scratch_t *scratch){
+	if(scratch->max_dims==0){
+		return;
+	}
+	gemm_side_free(&scratch->lower);
+	gemm_side_free(&scratch->upper);
+	free(scratch->ws.res_inf);
+	free(scratch->ws.res_sup);
+	free(scratch->ws.mag);
+	free(scratch->ws.x);
+	free(scratch->ws.y);
+	free(scratch->ws.b_inf);
+	free(scratch->ws.b_sup);
+	free(scratch->ws.lb);
+	free(scratch->ws.ub);
+}
+
+static void gemm_scratch_free(void *arg){
+	gemm_scratch_t *scratch = (gemm_scratch_t *)arg;
+	gemm_scratch_clear(scratch);
+	free(scratch);
+}
+
+static void gemm_scratch_key_init(void){
+	pthread_key_create(&gemm_scratch_key, gemm_scratch_free);
+}
+
+static gemm_scratch_t * gemm_scratch_get(size_t max_dims){
+	pthread_once(&gemm_scratch_once, gemm_scratch_key_init);
+	gemm_scratch_t *scratch = (gemm_scratch_t *)pthread_getspecific(gemm_scratch_key);
+	if(scratch==NULL){
+		scratch = (gemm_scratch_t *)calloc(1,sizeof(gemm_scratch_t));
+		pthread_setspecific(gemm_scratch_key, scratch);
+	}
+	if(scratch->max_dims >= max_dims){
+		return scratch;
+	}
+	gemm_scratch_clear(scratch);
+	size_t size = GEMM_PANEL_ROWS*max_dims;
+	gemm_side_init(&scratch->lower,size,GEMM_PANEL_ROWS,true);
+	gemm_side_init(&scratch->upper,size,GEMM_PANEL_ROWS,false);
+	scratch->ws.res_inf = (double *)malloc(size*sizeof(double));
+	scratch->ws.res_sup = (double *)malloc(size*sizeof(double));
+	scratch->ws.mag = (double *)malloc(size*sizeof(double));
+	scratch->ws.x = (double *)malloc(size*sizeof(double));
+	scratch->ws.y = (double *)malloc(size*sizeof(double));
+	scratch->ws.b_inf = (double **)malloc(size*sizeof(double *));
+	scratch->ws.b_sup = (double **)malloc(size*sizeof(double *));
+	scratch->ws.lb = (double *)malloc(max_dims*sizeof(double));
+	scratch->ws.ub = (double *)malloc(max_dims*sizeof(double));
+	scratch->max_dims = max_dims;
+	return scratch;
+}
+
+
+void backsubstitute_gemm(fppoly_internal_t *pr, fppoly_t *fp, size_t layerno, size_t start, size_t end){
+	layer_t *layer = fp->layers[layerno];
+	size_t i, r;
+	int k = layer->predecessors[0]-1;
+	size_t max_dims = gemm_layer_dims(fp,k);
+	while(k >= 0){
+		k = fp->layers[k]->predecessors[0]-1;
+		size_t dims = gemm_layer_dims(fp,k);
+		if(dims > max_dims){
+			max_dims = dims;
+		}
+	}
+	gemm_scratch_t *scratch = gemm_scratch_get(max_dims);
+	gemm_side_t lower = scratch->lower;
+	gemm_side_t upper = scratch->upper;
+	gemm_workspace_t ws = scratch->ws;
+
+	for(i=start; i < end; i+=GEMM_PANEL_ROWS){
+		size_t rows = end - i < GEMM_PANEL_ROWS ? end - i : GEMM_PANEL_ROWS;
+		neuron_t **out_neurons = layer->neurons + i;
+		k = layer->predecessors[0]-1;
+		size_t num_neurons = gemm_layer_dims(fp,k);
+		gemm_side_load(&lower,out_neurons,rows,num_neurons);
+		gemm_side_load(&upper,out_neurons,rows,num_neurons);
+		size_t ids[GEMM_PANEL_ROWS];
+		for(r=0; r < rows; r++){
+			ids[r] = r;
+		}
+		size_t depth = 0;
+		while(k >= 0){
+			layer_t *aux = fp->layers[k];
+			neuron_t **aux_neurons = aux->neurons;
+			size_t j;
+			for(j=0; j < num_neurons; j++){
+				ws.lb[j] = aux_neurons[j]->lb;
+				ws.ub[j] = aux_neurons[j]->ub;
+			}
+			gemm_concretize(&lower,rows,num_neurons,ws.lb,ws.ub);
+			gemm_concretize(&upper,rows,num_neurons,ws.lb,ws.ub);
+			if(pr->backsub_early_stop || pr->backsub_max_depth > 0){
+				rows = gemm_panel_retire(pr,fp,&lower,&upper,ids,rows,num_neurons,out_neurons,depth+1,k);
+				if(rows==0){
+					break;
+				}
+			}
+			depth++;
+			k = aux->predecessors[0]-1;
+			if(aux->is_activation){
+				gemm_activation_step(pr,&lower,&ws,aux_neurons,rows,num_neurons);
+				gemm_activation_step(pr,&upper,&ws,aux_neurons,rows,num_neurons);
+			}
+			else if(aux->conv!=NULL){
+				size_t num_in_neurons = gemm_layer_dims(fp,k);
+				gemm_conv_step(pr,&lower,&ws,aux,rows,num_neurons,num_in_neurons);
+				gemm_conv_step(pr,&upper,&ws,aux,rows,num_neurons,num_in_neurons);
+				num_neurons = num_in_neurons;
+			}
+			else{
+				size_t num_in_neurons = gemm_layer_dims(fp,k);
+				gemm_affine_step(pr,&lower,&ws,aux_neurons,rows,num_neurons,num_in_neurons);
+				gemm_affine_step(pr,&upper,&ws,aux_neurons,rows,num_neurons,num_in_neurons);
+				num_neurons = num_in_neurons;
+			}
+		}
+		if(k < 0){
+			gemm_concretize(&lower,rows,num_neurons,fp->input_inf,fp->input_sup);
+			gemm_concretize(&upper,rows,num_neurons,fp->input_inf,fp->input_sup);
+		}
+		for(r=0; r < rows; r++){
+			out_neurons[ids[r]]->lb = lower.bound[r];
+			out_neurons[ids[r]]->ub = upper.bound[r];
+		}
+	}
+
+	/* the steps swap the result buffers with the panels */
+	scratch->lower = lower;
+	scratch->upper = upper;
+	scratch->ws = ws;
+}
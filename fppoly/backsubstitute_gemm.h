@@ -0,0 +1,74 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+#ifndef __BACKSUBSTITUTE_GEMM_H_INCLUDED__
+#define __BACKSUBSTITUTE_GEMM_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fppoly.h"
+#include "expr.h"
+#include "implicit_conv.h"
+#include "compute_bounds.h"
+
+/* rows of the output layer back-substituted together */
+#define GEMM_PANEL_ROWS 32
+/* column and inner-dimension tiles of the interval GEMM kernel */
+#define GEMM_TILE_COLS 256
+#define GEMM_TILE_INNER 64
+/* the panels grow with the widest layer on the path, wider networks are back-substituted neuron by neuron */
+#define GEMM_MAX_LAYER_DIMS 16384
+
+/*
+ * c += a*b for an interval coefficient a of known sign and a row b of interval
+ * coefficients. The caller passes x,y > 0 and the rows b_inf/b_sup such that
+ * the negated lower bound of a*b is max(x*b_inf, y*b_inf) and the upper bound
+ * is max(x*b_sup, y*b_sup); mag accumulates m*max(|b_inf|,|b_sup|) for the
+ * rounding term. With -DVECTOR the loop runs on AVX2/AVX-512 vectors
+ * (interval_simd.h) and gives the same results as the scalar loop.
+ */
+void gemm_axpy(double * restrict c_inf, double * restrict c_sup, double * restrict mag,
+	       double x, double y, double m, const double * restrict b_inf, const double * restrict b_sup, size_t w);
+
+/*
+ * true if the bounds of layer layerno can be computed by backsubstitute_gemm:
+ * the layer is fully connected (dense expressions), every layer on the path
+ * back to the input has a single predecessor, is not a concatenation and has
+ * at most GEMM_MAX_LAYER_DIMS neurons, and the input is a plain box.
+ */
+bool layer_is_gemm_backsubstitutable(fppoly_t *fp, size_t layerno);
+
+/*
+ * Computes lb/ub of neurons [start,end) of layer layerno by back-substituting
+ * GEMM_PANEL_ROWS lower and upper expressions at a time as dense interval
+ * matrices. The bounds agree with get_lb/ub_using_previous_layers up to the
+ * rounding terms.
+ */
+void backsubstitute_gemm(fppoly_internal_t *pr, fppoly_t *fp, size_t layerno, size_t start, size_t end);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,184 @@
+#include "batch_analysis.h"
+
+fppoly_network_t * fppoly_network_alloc(size_t num_inputs){
+	fppoly_network_t *net = (fppoly_network_t *)malloc(sizeof(fppoly_network_t));
+	net->num_inputs = num_inputs;
+	net->num_layers = 0;
+	net->max_layers = 8;
+	net->layers = (network_layer_t *)malloc(net->max_layers*sizeof(network_layer_t));
+	return net;
+}
+
+
+void fppoly_network_free(fppoly_network_t *net){
+	size_t i;
+	if(net==NULL){
+		return;
+	}
+	for(i=0; i < net->num_layers; i++){
+		network_layer_t *layer = &net->layers[i];
+		free(layer->expr_block);
+		free(layer->coeff_block);
+		if(layer->conv!=NULL){
+			conv_layer_free(layer->conv);
+		}
+	}
+	free(net->layers);
+	free(net);
+}
+
+
+static size_t network_last_dims(fppoly_network_t *net){
+	return net->num_layers==0 ? net->num_inputs : net->layers[net->num_layers-1].dims;
+}
+
+static network_layer_t * network_add_layer(fppoly_network_t *net, network_layer_type_t type, size_t dims){
+	if(net->num_layers==net->max_layers){
+		net->max_layers = 2*net->max_layers;
+		net->layers = (network_layer_t *)realloc(net->layers, net->max_layers*sizeof(network_layer_t));
+	}
+	network_layer_t *layer = &net->layers[net->num_layers];
+	layer->type = type;
+	layer->dims = dims;
+	layer->predecessor = net->num_layers;
+	layer->expr_block = NULL;
+	layer->coeff_block = NULL;
+	layer->conv = NULL;
+	layer->use_default_heuristics = true;
+	net->num_layers++;
+	return layer;
+}
+
+
+/* the expressions are laid out as in the expression block of a fully connected layer_t */
+void fppoly_network_add_fully_connected_layer(fppoly_network_t *net, double **weights, double *bias, size_t num_out_neurons, size_t num_in_neurons){
+	size_t i;
+	assert(num_in_neurons==network_last_dims(net));
+	network_layer_t *layer = network_add_layer(net, NETWORK_FULLY_CONNECTED, num_out_neurons);
+	layer->expr_block = (expr_t *)malloc(num_out_neurons*sizeof(expr_t));
+	layer->coeff_block = (double *)malloc(2*num_out_neurons*num_in_neurons*sizeof(double));
+	for(i=0; i < num_out_neurons; i++){
+		double *inf_coeff = layer->coeff_block + 2*i*num_in_neurons;
+		double *sup_coeff = inf_coeff + num_in_neurons;
+		init_dense_expr(&layer->expr_block[i], inf_coeff, sup_coeff, weights[i], bias[i], num_in_neurons);
+	}
+}
+
+
+void fppoly_network_add_convolutional_layer(fppoly_network_t *net, double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size,
+					    size_t num_filters, size_t *strides, size_t *output_size, size_t pad_top, size_t pad_left, bool has_bias){
+	assert(input_size[0]*input_size[1]*input_size[2]==network_last_dims(net));
+	output_size[2] = num_filters;
+	network_layer_t *layer = network_add_layer(net, NETWORK_CONVOLUTIONAL, output_size[0]*output_size[1]*output_size[2]);
+	layer->conv = conv_layer_alloc(filter_weights, filter_bias, input_size, filter_size, num_filters, strides, output_size, pad_top, pad_left, has_bias);
+}
+
+
+void fppoly_network_add_relu_layer(fppoly_network_t *net, bool use_default_heuristics){
+	network_layer_t *layer = network_add_layer(net, NETWORK_RELU, network_last_dims(net));
+	layer->use_default_heuristics = use_default_heuristics;
+}
+
+
+size_t fppoly_network_get_num_outputs(fppoly_network_t *net){
+	return network_last_dims(net);
+}
+
+
+/* appends layer l of the network to the analysis, pointing it at the network's expressions or filter */
+static void network_handle_layer(elina_manager_t *man, elina_abstract0_t *element, fppoly_network_t *net, size_t l){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	network_layer_t *net_layer = &net->layers[l];
+	size_t i;
+	if(net_layer->type==NETWORK_RELU){
+		handle_relu_layer(man, element, net_layer->dims, &net_layer->predecessor, 1, net_layer->use_default_heuristics);
+		return;
+	}
+	fppoly_add_new_layer(fp, net_layer->dims, &net_layer->predecessor, 1, false);
+	layer_t *layer = fp->layers[fp->numlayers-1];
+	layer->is_shared = true;
+	if(net_layer->type==NETWORK_CONVOLUTIONAL){
+		layer->conv = net_layer->conv;
+	}
+	else{
+		layer->expr_block = net_layer->expr_block;
+		layer->coeff_block = net_layer->coeff_block;
+		for(i=0; i < net_layer->dims; i++){
+			layer->neurons[i]->lexpr = &net_layer->expr_block[i];
+			layer->neurons[i]->uexpr = layer->neurons[i]->lexpr;
+		}
+	}
+	update_state_using_previous_layers_parallel(man, fp, fp->numlayers-1);
+}
+
+
+typedef struct network_batch_t{
+	elina_manager_t *man;
+	fppoly_network_t *net;
+	double *inf;
+	double *sup;
+	double *lb;
+	double *ub;
+	int *labels;
+	bool *verified;
+}network_batch_t;
+
+static void network_analyze_regions(void *args, size_t start, size_t end){
+	network_batch_t *data = (network_batch_t *)args;
+	elina_manager_t *man = data->man;
+	fppoly_network_t *net = data->net;
+	size_t num_inputs = net->num_inputs;
+	size_t num_outputs = fppoly_network_get_num_outputs(net);
+	size_t r, l, i;
+	for(r=start; r < end; r++){
+		/* the element is not handed out, so it does not take a reference on the manager shared by the threads */
+		fppoly_t *fp = (fppoly_t *)malloc(sizeof(fppoly_t));
+		fppoly_from_network_input_box(fp, 0, num_inputs, data->inf + r*num_inputs, data->sup + r*num_inputs);
+		elina_abstract0_t abs;
+		abs.value = fp;
+		abs.man = man;
+		for(l=0; l < net->num_layers; l++){
+			network_handle_layer(man, &abs, net, l);
+		}
+		neuron_t **out_neurons = fp->layers[fp->numlayers-1]->neurons;
+		for(i=0; i < num_outputs; i++){
+			data->lb[r*num_outputs + i] = -out_neurons[i]->lb;
+			data->ub[r*num_outputs + i] = out_neurons[i]->ub;
+		}
+		if(data->labels!=NULL){
+			int label = data->labels[r];
+			bool verified = label >= 0 && (size_t)label < num_outputs;
+			for(i=0; verified && i < num_outputs; i++){
+				if(i!=(size_t)label && !is_greater(man, &abs, label, i)){
+					verified = false;
+				}
+			}
+			data->verified[r] = verified;
+		}
+		fppoly_free(man, fp);
+	}
+}
+
+
+/*
+ * Regions go to the threads whole: once the pool is busy, the layer
+ * handlers of each region run sequentially in its thread, which keeps all
+ * threads busy on networks whose layers are too small to split.
+ */
+void fppoly_network_analyze_batch(elina_manager_t *man, fppoly_network_t *net, size_t num_regions, double *inf, double *sup,
+				  double *lb, double *ub, int *labels, bool *verified){
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	network_batch_t args;
+	args.man = man;
+	args.net = net;
+	args.inf = inf;
+	args.sup = sup;
+	args.lb = lb;
+	args.ub = ub;
+	args.labels = labels;
+	args.verified = verified;
+	if(net->num_layers==0){
+		return;
+	}
+	thread_pool_run(pr->pool, num_regions, 1, network_analyze_regions, (void *)&args);
+}
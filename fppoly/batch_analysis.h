@@ -0,0 +1,94 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+#ifndef __BATCH_ANALYSIS_H_INCLUDED__
+#define __BATCH_ANALYSIS_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "backsubstitute.h"
+
+typedef enum network_layer_type_t{
+	NETWORK_FULLY_CONNECTED,
+	NETWORK_CONVOLUTIONAL,
+	NETWORK_RELU,
+}network_layer_type_t;
+
+/*
+ * A layer of a compiled network. Fully connected layers keep their
+ * expressions and convolutional layers their filter; the analyses point
+ * their layers at these instead of copying them.
+ */
+typedef struct network_layer_t{
+	network_layer_type_t type;
+	size_t dims;
+	/* the previous layer, 1-based as the predecessors of layer_t, 0 for the input */
+	size_t predecessor;
+	expr_t *expr_block;
+	double *coeff_block;
+	conv_layer_t *conv;
+	bool use_default_heuristics;
+}network_layer_t;
+
+/*
+ * A feedforward network ingested once and shared, read only, by every
+ * analysis run on it. Layers are appended in order, each reading the
+ * previous one.
+ */
+typedef struct fppoly_network_t{
+	size_t num_inputs;
+	size_t num_layers;
+	size_t max_layers;
+	network_layer_t *layers;
+}fppoly_network_t;
+
+fppoly_network_t * fppoly_network_alloc(size_t num_inputs);
+
+void fppoly_network_free(fppoly_network_t *net);
+
+void fppoly_network_add_fully_connected_layer(fppoly_network_t *net, double **weights, double *bias, size_t num_out_neurons, size_t num_in_neurons);
+
+void fppoly_network_add_convolutional_layer(fppoly_network_t *net, double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size,
+					    size_t num_filters, size_t *strides, size_t *output_size, size_t pad_top, size_t pad_left, bool has_bias);
+
+void fppoly_network_add_relu_layer(fppoly_network_t *net, bool use_default_heuristics);
+
+/* neurons of the last layer */
+size_t fppoly_network_get_num_outputs(fppoly_network_t *net);
+
+/*
+ * Analyzes the input boxes [inf, sup] of num_regions regions, stored one
+ * after the other, the regions being spread over the threads of the
+ * manager. Writes the bounds of the outputs of every region to lb and ub,
+ * num_regions*fppoly_network_get_num_outputs(net) entries each, and, if
+ * labels is not NULL, whether output labels[i] is proven greater than all
+ * other outputs to verified[i]; a negative label is never verified.
+ */
+void fppoly_network_analyze_batch(elina_manager_t *man, fppoly_network_t *net, size_t num_regions, double *inf, double *sup,
+				  double *lb, double *ub, int *labels, bool *verified);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -1,10 +1,3 @@
-#ifdef GUROBI
-#include <stdlib.h>
-#include <stdio.h>
-
-#include "gurobi_c.h"
-#endif
-
 #include "compute_bounds.h"
 #include "math.h"
 
@@ -160,152 +153,13 @@ expr_t * replace_input_poly_cons_in_uexpr(fppoly_internal_t *pr, expr_t * expr,
 	return res;
 }
 
-#ifdef GUROBI
-void handle_gurobi_error(int error, GRBenv *env) {
-    if (error) {
-        printf("Gurobi error: %s\n", GRBgeterrormsg(env));
-        exit(1);
-    }
-}
-
-double substitute_spatial_gurobi(expr_t *expr, fppoly_t *fp, const int opt_sense) {
-
-    GRBenv *env = NULL;
-    GRBmodel *model = NULL;
-
-    int error;
-
-    error = GRBemptyenv(&env);
-    handle_gurobi_error(error, env);
-    error = GRBsetintparam(env, "OutputFlag", 0);
-    handle_gurobi_error(error, env);
-    error = GRBsetintparam(env, "NumericFocus", 2);
-    handle_gurobi_error(error, env);
-    error = GRBstartenv(env);
-    handle_gurobi_error(error, env);
-
-    double *lb, *ub, *obj;
-    const size_t dims = expr->size;
-    const size_t numvars = 3 * dims;
-
-    lb = malloc(numvars * sizeof(double));
-    ub = malloc(numvars * sizeof(double));
-    obj = malloc(numvars * sizeof(double));
-
-    for (size_t i = 0; i < dims; ++i) {
-        const size_t k = expr->type == DENSE ? i : expr->dim[i];
-        lb[i] = -fp->input_inf[k];
-        ub[i] = fp->input_sup[k];
-        obj[i] = opt_sense == GRB_MINIMIZE ? -expr->inf_coeff[i] : expr->sup_coeff[i];
-
-        for (size_t j = 0; j < 2; ++j) {
-            const size_t l = fp->input_uexpr[k]->dim[j];
-            lb[dims + 2 * i + j] = -fp->input_inf[l];
-            ub[dims + 2 * i + j] = fp->input_sup[l];
-            obj[dims + 2 * i + j] = 0;
-        }
-    }
-
-    error = GRBnewmodel(env, &model, NULL, numvars, obj, lb, ub, NULL, NULL);
-    handle_gurobi_error(error, env);
-    error = GRBsetintattr(model, "ModelSense", opt_sense);
-    handle_gurobi_error(error, env);
-
-    for (size_t i = 0; i < dims; ++i) {
-        const size_t k = expr->type == DENSE ? i : expr->dim[i];
-
-        int ind[] = {i, dims + 2 * i, dims + 2 * i + 1};
-
-        double lb_val[] = {
-            -1, -fp->input_lexpr[k]->inf_coeff[0], -fp->input_lexpr[k]->inf_coeff[1]
-        };
-        error = GRBaddconstr(model, 3, ind, lb_val, GRB_LESS_EQUAL, fp->input_lexpr[k]->inf_cst, NULL);
-        handle_gurobi_error(error, env);
-
-        double ub_val[] = {
-            1, -fp->input_uexpr[k]->sup_coeff[0], -fp->input_uexpr[k]->sup_coeff[1]
-        };
-        error = GRBaddconstr(model, 3, ind, ub_val, GRB_LESS_EQUAL, fp->input_uexpr[k]->sup_cst, NULL);
-        handle_gurobi_error(error, env);
-    }
-
-    size_t idx, nbr, s_idx, s_nbr;
-    const size_t num_pixels = fp->num_pixels;
-
-    for (size_t i = 0; i < fp->spatial_size; ++i) {
-        idx = fp->spatial_indices[i];
-        nbr = fp->spatial_neighbors[i];
-
-        if (expr->type == DENSE) {
-            s_idx = idx;
-            s_nbr = nbr;
-        } else {
-            s_idx = s_nbr = num_pixels;
-
-            for (size_t j = 0; j < dims; ++j) {
-                if (expr->dim[j] == idx) {
-                    s_idx = j;
-                }
-                if (expr->dim[j] == nbr) {
-                    s_nbr = j;
-                }
-            }
-
-            if ((s_idx == num_pixels) || (s_nbr == num_pixels)) {
-                continue;
-            }
-        }
-
-        int ind_x[] = {dims + 2 * s_idx, dims + 2 * s_nbr};
-        int ind_y[] = {dims + 2 * s_idx + 1, dims + 2 * s_nbr + 1};
-        double val[] = {1., -1.};
-
-        error = GRBaddconstr(model, 2, ind_x, val, GRB_LESS_EQUAL, fp->spatial_gamma, NULL);
-        handle_gurobi_error(error, env);
-        error = GRBaddconstr(model, 2, ind_y, val, GRB_LESS_EQUAL, fp->spatial_gamma, NULL);
-        handle_gurobi_error(error, env);
-        error = GRBaddconstr(model, 2, ind_x, val, GRB_GREATER_EQUAL, -fp->spatial_gamma, NULL);
-        handle_gurobi_error(error, env);
-        error = GRBaddconstr(model, 2, ind_y, val, GRB_GREATER_EQUAL, -fp->spatial_gamma, NULL);
-        handle_gurobi_error(error, env);
-    }
-
-    int opt_status;
-    double obj_val;
-
-    error = GRBoptimize(model);
-    handle_gurobi_error(error, env);
-    error = GRBgetintattr(model, GRB_INT_ATTR_STATUS, &opt_status);
-    handle_gurobi_error(error, env);
-    error = GRBgetdblattr(model, GRB_DBL_ATTR_OBJVAL, &obj_val);
-    handle_gurobi_error(error, env);
-
-    if (opt_status != GRB_OPTIMAL) {
-        printf("Gurobi model status not optimal %i\n", opt_status);
-        exit(1);
-    }
-
-    free(lb);
-    free(ub);
-    free(obj);
-
-    GRBfreemodel(model);
-    GRBfreeenv(env);
-
-    return obj_val;
-}
-#endif
-
 double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp, int layerno){
 
-#ifdef GUROBI
-    if ((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL) && layerno==-1 && fp->spatial_size > 0) {
-        return expr->inf_cst - substitute_spatial_gurobi(expr, fp, GRB_MINIMIZE);
-    }
-#endif
-
-	size_t i,k;
-	double tmp1, tmp2;
+	/* the LP also sees the spatial constraints, substituting the input polyhedron is kept as it can be tighter when the LP solver stalls */
+	double res_spatial = INFINITY;
+	if(fp->spatial_lp!=NULL && layerno==-1 && expr->inf_coeff!=NULL && expr->sup_coeff!=NULL){
+		res_spatial = expr->inf_cst + spatial_lp_bound(pr, fp->spatial_lp, expr, true);
+	}
         //printf("start\n");
         //fflush(stdout);
 	if((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL) && layerno==-1){
@@ -313,28 +167,15 @@ double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp,
 	}
         //expr_print(expr);
 	//fflush(stdout);
-	size_t dims = expr->size;
 	double res_inf = expr->inf_cst;
 	if(expr->inf_coeff==NULL || expr->sup_coeff==NULL){
 		return res_inf;
 	}
-	for(i=0; i < dims; i++){
-		//if(expr->inf_coeff[i]<0){
-		if(expr->type==DENSE){
-			k = i;
-		}
-		else{
-			k = expr->dim[i];
-		}
-			if(layerno==-1){
-				elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],fp->input_inf[k],fp->input_sup[k]);
-			}
-			else{
-				elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],fp->layers[layerno]->neurons[k]->lb,fp->layers[layerno]->neurons[k]->ub);
-			}
-			//printf("tmp1: %g\n",tmp1);
-			res_inf = res_inf + tmp1;
-			
+	if(layerno==-1){
+		res_inf = expr_concretize_bound(expr, fp->input_inf, fp->input_sup, NULL, true);
+	}
+	else{
+		res_inf = expr_concretize_bound(expr, NULL, NULL, fp->layers[layerno]->neurons, true);
 	}
 //	printf("inf: %g\n",-res_inf);
 //	fflush(stdout);
@@ -343,52 +184,36 @@ double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp,
 	}
         //printf("finish\n");
         //fflush(stdout);
-	return res_inf;
+	return fmin(res_inf, res_spatial);
 }
 
 double compute_ub_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp, int layerno){
 
-#ifdef GUROBI
-    if ((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL) && layerno==-1 && fp->spatial_size > 0) {
-        return expr->sup_cst + substitute_spatial_gurobi(expr, fp, GRB_MAXIMIZE);
-    }
-#endif
-
-	size_t i,k;
-	double tmp1, tmp2;
+	double res_spatial = INFINITY;
+	if(fp->spatial_lp!=NULL && layerno==-1 && expr->inf_coeff!=NULL && expr->sup_coeff!=NULL){
+		res_spatial = expr->sup_cst + spatial_lp_bound(pr, fp->spatial_lp, expr, false);
+	}
 
 	if((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL) && layerno==-1){
 		expr =  replace_input_poly_cons_in_uexpr(pr, expr, fp);
 	}
 
-	size_t dims = expr->size;
 	double res_sup = expr->sup_cst;
 	if(expr->inf_coeff==NULL || expr->sup_coeff==NULL){
 		return res_sup;
 	}
-	for(i=0; i < dims; i++){
-		//if(expr->inf_coeff[i]<0){
-		if(expr->type==DENSE){
-			k = i;
-		}
-		else{
-			k = expr->dim[i];
-		}		
-		if(layerno==-1){
-			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],fp->input_inf[k],fp->input_sup[k]);
-		}
-		else{
-			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],fp->layers[layerno]->neurons[k]->lb,fp->layers[layerno]->neurons[k]->ub);
-		}
-		res_sup = res_sup + tmp2;
-			
+	if(layerno==-1){
+		res_sup = expr_concretize_bound(expr, fp->input_inf, fp->input_sup, NULL, false);
+	}
+	else{
+		res_sup = expr_concretize_bound(expr, NULL, NULL, fp->layers[layerno]->neurons, false);
 	}
 	//printf("sup: %g\n",res_sup);
 	//fflush(stdout);
 	if(fp->input_lexpr!=NULL && fp->input_uexpr!=NULL && layerno==-1){
 		free_expr(expr);
 	}
-	return res_sup;
+	return fmin(res_sup, res_spatial);
 }
 
 
@@ -399,7 +224,12 @@ double get_lb_using_predecessor_layer(fppoly_internal_t * pr,fppoly_t *fp, expr_
 	double res = INFINITY;
 	res = compute_lb_from_expr(pr,lexpr,fp,k);
 	tmp_l = lexpr;
-	*lexpr_ptr = lexpr_replace_bounds(pr,lexpr,aux_neurons, fp->layers[k]->is_activation);
+	if(fp->layers[k]->conv!=NULL){
+		*lexpr_ptr = expr_replace_bounds_conv(pr,lexpr,fp->layers[k],true);
+	}
+	else{
+		*lexpr_ptr = lexpr_replace_bounds(pr,lexpr,aux_neurons, fp->layers[k]->is_activation);
+	}
 	free_expr(tmp_l);
 	return res;
 }
@@ -412,12 +242,42 @@ double get_ub_using_predecessor_layer(fppoly_internal_t * pr,fppoly_t *fp, expr_
 	double res = INFINITY;
 	tmp_u = uexpr;
 	res = compute_ub_from_expr(pr,uexpr,fp,k);
-	*uexpr_ptr = uexpr_replace_bounds(pr,uexpr,aux_neurons, fp->layers[k]->is_activation);
+	if(fp->layers[k]->conv!=NULL){
+		*uexpr_ptr = expr_replace_bounds_conv(pr,uexpr,fp->layers[k],false);
+	}
+	else{
+		*uexpr_ptr = uexpr_replace_bounds(pr,uexpr,aux_neurons, fp->layers[k]->is_activation);
+	}
 	free_expr(tmp_u);
 	return res;
 }
 
-double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+/* layers a back-substitution that has reached layer k still walks through before the input */
+size_t backsubstitution_remaining_steps(fppoly_t *fp, int k){
+	size_t res = 0;
+	while(k >= 0){
+		res++;
+		k = fp->layers[k]->predecessors[0]-1;
+	}
+	return res;
+}
+
+
+/*
+ * Whether a back-substitution that has walked through depth layers with
+ * bound res so far (the negated lower bound or the upper bound) can stop:
+ * either the depth budget is used up, or the bound is below threshold,
+ * i.e. it already decides what the caller needs to know.
+ */
+bool backsubstitution_can_stop(fppoly_internal_t *pr, double res, double threshold, size_t depth){
+	if(pr->backsub_max_depth > 0 && depth >= pr->backsub_max_depth){
+		return true;
+	}
+	return res < threshold;
+}
+
+
+double get_lb_using_previous_layers_until(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno, double threshold){
 	size_t i;
 	int k;
 	//size_t numlayers = fp->numlayers;
@@ -436,6 +296,7 @@ double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *
 		k = fp->layers[layerno]->predecessors[0]-1;
 	}	
 	double res = INFINITY;
+	size_t depth = 0;
 	while(k >=0){
 	        if(fp->layers[k]->is_concat==true){
 		//	expr_print(lexpr);
@@ -559,6 +420,12 @@ double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *
 								
 				 res =fmin(res,get_lb_using_predecessor_layer(pr,fp, &lexpr, k));
 				 k = fp->layers[k]->predecessors[0]-1;
+				 depth++;
+				 if(k >= 0 && backsubstitution_can_stop(pr,res,threshold,depth)){
+					__sync_fetch_and_add(&fp->backsub_steps_saved, backsubstitution_remaining_steps(fp,k));
+					free_expr(lexpr);
+					return res;
+				 }
 				
 			}
 			
@@ -576,6 +443,10 @@ double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *
 	
 }
 
+double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+	return get_lb_using_previous_layers_until(man, fp, expr, layerno, -INFINITY);
+}
+
 
 elina_linexpr0_t *get_output_uexpr_defined_over_previous_layers(elina_manager_t *man, elina_abstract0_t *element, int neuron_no, int prev_layer){
 	fppoly_t * fp = fppoly_of_abstract0(element);
@@ -590,8 +461,7 @@ elina_linexpr0_t *get_output_uexpr_defined_over_previous_layers(elina_manager_t
 	int k;
         fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
         
-	neuron_t ** out_neurons = fp->layers[fp->numlayers-1]->neurons;
-	expr_t *uexpr = copy_expr(out_neurons[neuron_no]->uexpr);
+	expr_t *uexpr = copy_neuron_expr(fp->layers[fp->numlayers-1], neuron_no, false);
 	
 	k = fp->layers[fp->numlayers-1]->predecessors[0]-1;
 	while(k >=prev_layer){
@@ -716,8 +586,7 @@ elina_linexpr0_t * get_output_lexpr_defined_over_previous_layers(elina_manager_t
 	size_t i;
 	int k;
         fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
-	neuron_t ** out_neurons = fp->layers[fp->numlayers-1]->neurons;
-	expr_t *lexpr = copy_expr(out_neurons[neuron_no]->lexpr);
+	expr_t *lexpr = copy_neuron_expr(fp->layers[fp->numlayers-1], neuron_no, true);
 	k = fp->layers[fp->numlayers-1]->predecessors[0]-1;
 	while(k >=prev_layer){
 	        if(fp->layers[k]->is_concat==true){
@@ -835,7 +704,7 @@ elina_linexpr0_t * get_output_lexpr_defined_over_previous_layers(elina_manager_t
 }
 
 
-double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+double get_ub_using_previous_layers_until(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno, double threshold){
 	size_t i;
 	int k;
 	//size_t numlayers = fp->numlayers;
@@ -852,6 +721,7 @@ double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *
 		k = fp->layers[layerno]->predecessors[0]-1;
 	}	
 	double res =INFINITY;
+	size_t depth = 0;
 	while(k >=0){
 		if(fp->layers[k]->is_concat==true){
                         //sort_expr(lexpr);
@@ -953,6 +823,12 @@ double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *
 				
 				 res= fmin(res,get_ub_using_predecessor_layer(pr,fp, &uexpr, k));
 				 k = fp->layers[k]->predecessors[0]-1;
+				 depth++;
+				 if(k >= 0 && backsubstitution_can_stop(pr,res,threshold,depth)){
+					__sync_fetch_and_add(&fp->backsub_steps_saved, backsubstitution_remaining_steps(fp,k));
+					free_expr(uexpr);
+					return res;
+				 }
 				 
 			}
 			
@@ -966,4 +842,8 @@ double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *
 	
 }
 
+double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+	return get_ub_using_previous_layers_until(man, fp, expr, layerno, -INFINITY);
+}
+
 
@@ -37,10 +37,23 @@ double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp,
 
 double compute_ub_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp, int layerno);
 
+size_t backsubstitution_remaining_steps(fppoly_t *fp, int k);
+
+bool backsubstitution_can_stop(fppoly_internal_t *pr, double res, double threshold, size_t depth);
+
 double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno);
 
 double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno);
 
+/*
+ * As above, but stop walking back as soon as the bound found so far (the
+ * negated lower bound, or the upper bound) is below threshold, or after
+ * the depth budget of the manager.
+ */
+double get_lb_using_previous_layers_until(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno, double threshold);
+
+double get_ub_using_previous_layers_until(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno, double threshold);
+
 elina_linexpr0_t *get_output_lexpr_defined_over_previous_layers(elina_manager_t *man, elina_abstract0_t *element, int neuron_no, int prev_layer);
 
 elina_linexpr0_t *get_output_uexpr_defined_over_previous_layers(elina_manager_t *man, elina_abstract0_t *element, int neuron_no, int prev_layer);
@@ -0,0 +1,374 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/*
+ * Checks the interval kernels of expr.c (multiply_expr, add_expr and
+ * expr_concretize_bound) against the scalar code they replace, on random
+ * dense and sparse expressions with zero, denormal, large and infinite
+ * bounds, and reports the throughput of both. In a scalar build both sides
+ * run the same code. Intervals are stored as in fppoly, the lower bound
+ * negated, so a bound is at least as wide when it is at least as large.
+ *
+ * Multiply and add have to be at least as wide as the scalar results (they
+ * are expected to be bit-identical). Concretization sums its terms in
+ * another order than the scalar loop, so it can be a few ulps tighter or
+ * wider than the sequential sum. It is checked against the exact sum of the
+ * scalar terms instead, computed with GMP rationals, and the number of
+ * tighter, equal and wider results is reported.
+ */
+
+#include <time.h>
+#include <gmp.h>
+#include "expr.h"
+
+#define NUM_SIZES 6
+
+static const size_t sizes[NUM_SIZES] = {1, 3, 7, 8, 65, 1003};
+
+static size_t num_failures = 0;
+
+
+static double random_double(void){
+	double x = 2.0*rand()/RAND_MAX - 1.0;
+	switch(rand()%8){
+		case 0:
+			return 0.0;
+		case 1:
+			/* denormal */
+			return ldexp(x, -1040 - rand()%30);
+		case 2:
+			return ldexp(x, 900 + rand()%120);
+		default:
+			return x*(rand()%1000);
+	}
+}
+
+
+/* an interval stored as in fppoly, inf is the negated lower bound */
+static void random_interval(double *inf, double *sup){
+	double a = random_double();
+	double b = random_double();
+	double l = fmin(a,b);
+	double u = fmax(a,b);
+	if(rand()%16==0){
+		l = -INFINITY;
+	}
+	if(rand()%16==0){
+		u = INFINITY;
+	}
+	*inf = -l;
+	*sup = u;
+}
+
+
+static expr_t * random_expr(size_t size, size_t num_vars, bool is_sparse){
+	expr_t *expr = alloc_expr();
+	size_t i;
+	expr->size = size;
+	expr->type = is_sparse ? SPARSE : DENSE;
+	expr->inf_coeff = (double *)malloc(size*sizeof(double));
+	expr->sup_coeff = (double *)malloc(size*sizeof(double));
+	expr->dim = NULL;
+	for(i=0; i < size; i++){
+		random_interval(&expr->inf_coeff[i], &expr->sup_coeff[i]);
+	}
+	random_interval(&expr->inf_cst, &expr->sup_cst);
+	if(is_sparse){
+		/* sorted dimensions spread over num_vars */
+		size_t k = 0;
+		expr->dim = (size_t *)malloc(size*sizeof(size_t));
+		for(i=0; i < size; i++){
+			k += 1 + rand()%((num_vars - k)/(size - i));
+			expr->dim[i] = k - 1;
+		}
+	}
+	return expr;
+}
+
+
+static bool is_wider(double res, double ref){
+	return res >= ref;
+}
+
+
+static void check(bool cond, const char *what, size_t size, bool is_sparse, size_t i){
+	if(!cond){
+		if(num_failures < 20){
+			printf("  FAILED: %s, size %zu, %s, index %zu\n", what, size, is_sparse ? "sparse" : "dense", i);
+		}
+		num_failures++;
+	}
+}
+
+
+static void test_multiply(fppoly_internal_t *pr, size_t size, bool is_sparse){
+	expr_t *expr = random_expr(size, 4*size, is_sparse);
+	double mul_inf, mul_sup, ref_inf, ref_sup;
+	size_t i;
+	random_interval(&mul_inf, &mul_sup);
+	expr_t *res = multiply_expr(pr, expr, mul_inf, mul_sup);
+	for(i=0; i < size; i++){
+		elina_double_interval_mul_expr_coeff(pr, &ref_inf, &ref_sup, mul_inf, mul_sup, expr->inf_coeff[i], expr->sup_coeff[i]);
+		check(is_wider(res->inf_coeff[i], ref_inf) && is_wider(res->sup_coeff[i], ref_sup), "multiply_expr", size, is_sparse, i);
+	}
+	free_expr(expr);
+	free_expr(res);
+}
+
+
+/* the scalar code add_expr runs for dense expressions */
+static void add_coeff_scalar(fppoly_internal_t *pr, double *a_inf, double *a_sup, double b_inf, double b_sup){
+	double maxA = fmax(fabs(*a_inf),fabs(*a_sup));
+	double maxB = fmax(fabs(b_inf),fabs(b_sup));
+	*a_inf = *a_inf + b_inf + (maxA + maxB)*pr->ulp;
+	*a_sup = *a_sup + b_sup + (maxA + maxB)*pr->ulp;
+}
+
+
+static void test_add(fppoly_internal_t *pr, size_t size){
+	expr_t *exprA = random_expr(size, size, false);
+	expr_t *exprB = random_expr(size, size, false);
+	expr_t *ref = copy_expr(exprA);
+	size_t i;
+	add_expr(pr, exprA, exprB);
+	for(i=0; i < size; i++){
+		add_coeff_scalar(pr, &ref->inf_coeff[i], &ref->sup_coeff[i], exprB->inf_coeff[i], exprB->sup_coeff[i]);
+		check(is_wider(exprA->inf_coeff[i], ref->inf_coeff[i]) && is_wider(exprA->sup_coeff[i], ref->sup_coeff[i]), "add_expr", size, false, i);
+	}
+	free_expr(exprA);
+	free_expr(exprB);
+	free_expr(ref);
+}
+
+
+/* the scalar code expr_concretize_bound replaces, one term at a time */
+static double concretize_scalar(expr_t *expr, double *inf, double *sup, neuron_t **neurons, bool is_lower, mpq_t exact, bool *exact_inf){
+	double res = is_lower ? expr->inf_cst : expr->sup_cst;
+	double tmp1, tmp2;
+	mpq_t term;
+	size_t i, k;
+	mpq_init(term);
+	*exact_inf = isinf(res);
+	if(!*exact_inf){
+		mpq_set_d(exact, res);
+	}
+	for(i=0; i < expr->size; i++){
+		k = expr->type==DENSE ? i : expr->dim[i];
+		if(neurons==NULL){
+			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],inf[k],sup[k]);
+		}
+		else{
+			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],neurons[k]->lb,neurons[k]->ub);
+		}
+		tmp1 = is_lower ? tmp1 : tmp2;
+		res = res + tmp1;
+		if(isinf(tmp1)){
+			*exact_inf = true;
+		}
+		else if(!*exact_inf){
+			mpq_set_d(term, tmp1);
+			mpq_add(exact, exact, term);
+		}
+	}
+	mpq_clear(term);
+	return res;
+}
+
+
+static void test_concretize(size_t size, bool is_sparse, bool use_neurons, size_t *counts){
+	size_t num_vars = 4*size;
+	expr_t *expr = random_expr(size, num_vars, is_sparse);
+	double *inf = (double *)malloc(num_vars*sizeof(double));
+	double *sup = (double *)malloc(num_vars*sizeof(double));
+	neuron_t **neurons = NULL;
+	mpq_t exact, bound;
+	bool exact_inf;
+	size_t i;
+	int l;
+	for(i=0; i < num_vars; i++){
+		random_interval(&inf[i], &sup[i]);
+	}
+	if(use_neurons){
+		neurons = (neuron_t **)malloc(num_vars*sizeof(neuron_t *));
+		for(i=0; i < num_vars; i++){
+			neurons[i] = (neuron_t *)calloc(1, sizeof(neuron_t));
+			neurons[i]->lb = inf[i];
+			neurons[i]->ub = sup[i];
+		}
+	}
+	mpq_init(exact);
+	mpq_init(bound);
+	for(l=0; l < 2; l++){
+		bool is_lower = l==0;
+		double res = expr_concretize_bound(expr, inf, sup, neurons, is_lower);
+		double ref = concretize_scalar(expr, inf, sup, neurons, is_lower, exact, &exact_inf);
+		if(isnan(res) || res==-INFINITY){
+			check(false, "expr_concretize_bound", size, is_sparse, 0);
+		}
+		else if(exact_inf){
+			check(res==INFINITY, "expr_concretize_bound", size, is_sparse, 0);
+		}
+		else if(res!=INFINITY){
+			mpq_set_d(bound, res);
+			check(mpq_cmp(bound, exact) >= 0, "expr_concretize_bound", size, is_sparse, 0);
+		}
+		counts[res < ref ? 0 : res==ref ? 1 : 2]++;
+	}
+	mpq_clear(exact);
+	mpq_clear(bound);
+	if(use_neurons){
+		for(i=0; i < num_vars; i++){
+			free(neurons[i]);
+		}
+		free(neurons);
+	}
+	free(inf);
+	free(sup);
+	free_expr(expr);
+}
+
+
+static double seconds(struct timespec *start){
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + 1e-9*(end.tv_nsec - start->tv_nsec);
+}
+
+
+static void benchmark(fppoly_internal_t *pr, size_t size, size_t reps){
+	expr_t *exprA = random_expr(size, size, false);
+	expr_t *exprB = random_expr(size, size, false);
+	double *res_inf = (double *)malloc(size*sizeof(double));
+	double *res_sup = (double *)malloc(size*sizeof(double));
+	double *inf = (double *)malloc(size*sizeof(double));
+	double *sup = (double *)malloc(size*sizeof(double));
+	double checksum = 0, mul_inf = 0.5, mul_sup = 1.5;
+	struct timespec start;
+	double t_vec, t_scalar;
+	size_t r, i;
+	for(i=0; i < size; i++){
+		/* normal finite bounds, so that the timings are not dominated by denormals */
+		sup[i] = rand()/(double)RAND_MAX;
+		inf[i] = sup[i] - 1;
+		exprA->sup_coeff[i] = rand()/(double)RAND_MAX;
+		exprA->inf_coeff[i] = 1 - exprA->sup_coeff[i];
+		exprB->sup_coeff[i] = rand()/(double)RAND_MAX;
+		exprB->inf_coeff[i] = -exprB->sup_coeff[i];
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r=0; r < reps; r++){
+		elina_double_interval_mul_expr_coeffs(pr, res_inf, res_sup, mul_inf, mul_sup, exprA->inf_coeff, exprA->sup_coeff, size);
+		checksum += res_sup[r%size];
+	}
+	t_vec = seconds(&start);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r=0; r < reps; r++){
+		for(i=0; i < size; i++){
+			elina_double_interval_mul_expr_coeff(pr, &res_inf[i], &res_sup[i], mul_inf, mul_sup, exprA->inf_coeff[i], exprA->sup_coeff[i]);
+		}
+		checksum += res_sup[r%size];
+	}
+	t_scalar = seconds(&start);
+	printf("  multiply:    %6.2f ns/coeff, scalar %6.2f ns/coeff\n", 1e9*t_vec/(reps*size), 1e9*t_scalar/(reps*size));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r=0; r < reps; r++){
+		add_expr(pr, exprB, exprA);
+		checksum += exprB->sup_coeff[r%size];
+	}
+	t_vec = seconds(&start);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r=0; r < reps; r++){
+		for(i=0; i < size; i++){
+			add_coeff_scalar(pr, &exprB->inf_coeff[i], &exprB->sup_coeff[i], exprA->inf_coeff[i], exprA->sup_coeff[i]);
+		}
+		checksum += exprB->sup_coeff[r%size];
+	}
+	t_scalar = seconds(&start);
+	printf("  add:         %6.2f ns/coeff, scalar %6.2f ns/coeff\n", 1e9*t_vec/(reps*size), 1e9*t_scalar/(reps*size));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r=0; r < reps; r++){
+		checksum += expr_concretize_bound(exprA, inf, sup, NULL, r%2==0);
+	}
+	t_vec = seconds(&start);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r=0; r < reps; r++){
+		double res = r%2==0 ? exprA->inf_cst : exprA->sup_cst;
+		double tmp1, tmp2;
+		for(i=0; i < size; i++){
+			elina_double_interval_mul(&tmp1,&tmp2,exprA->inf_coeff[i],exprA->sup_coeff[i],inf[i],sup[i]);
+			res = res + (r%2==0 ? tmp1 : tmp2);
+		}
+		checksum += res;
+	}
+	t_scalar = seconds(&start);
+	printf("  concretize:  %6.2f ns/coeff, scalar %6.2f ns/coeff\n", 1e9*t_vec/(reps*size), 1e9*t_scalar/(reps*size));
+	/* keeps the loops from being optimized away */
+	if(checksum==42.0){
+		printf("  checksum %g\n", checksum);
+	}
+
+	free(res_inf);
+	free(res_sup);
+	free(inf);
+	free(sup);
+	free_expr(exprA);
+	free_expr(exprB);
+}
+
+
+int main(int argc, char **argv){
+	elina_manager_t *man = fppoly_manager_alloc();
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t counts[3] = {0, 0, 0};
+	size_t num_rounds = argc > 1 ? (size_t)atol(argv[1]) : 200;
+	size_t round, s;
+	srand(42);
+
+#if defined(VECTOR) && defined(__AVX512F__)
+	printf("interval kernels: AVX-512, cpu supports avx512f: %s\n", __builtin_cpu_supports("avx512f") ? "yes" : "no");
+#elif defined(VECTOR) && defined(__AVX2__)
+	printf("interval kernels: AVX2, cpu supports avx2: %s\n", __builtin_cpu_supports("avx2") ? "yes" : "no");
+#else
+	printf("interval kernels: scalar (configure with -use-vector for AVX2/AVX-512)\n");
+#endif
+
+	for(round=0; round < num_rounds; round++){
+		for(s=0; s < NUM_SIZES; s++){
+			test_multiply(pr, sizes[s], false);
+			test_multiply(pr, sizes[s], true);
+			test_add(pr, sizes[s]);
+			test_concretize(sizes[s], false, false, counts);
+			test_concretize(sizes[s], true, false, counts);
+			test_concretize(sizes[s], false, true, counts);
+			test_concretize(sizes[s], true, true, counts);
+		}
+	}
+	printf("soundness: %zu rounds, %zu failures\n", num_rounds, num_failures);
+	printf("concretized bounds against the scalar sum: %zu tighter, %zu equal, %zu wider\n", counts[0], counts[1], counts[2]);
+
+	printf("throughput, dense expressions of size 4096:\n");
+	benchmark(pr, 4096, 2000);
+
+	elina_manager_free(man);
+	return num_failures > 0;
+}
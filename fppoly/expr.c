@@ -1,5 +1,7 @@
 #include "expr.h"
 
+#include "interval_simd.h"
+
 void elina_double_interval_add_expr_coeff(fppoly_internal_t *pr, double * res_inf, double *res_sup, double inf, double sup, double inf_expr, double sup_expr){
 	*res_inf = inf + inf_expr;
 	*res_sup = sup + sup_expr;
@@ -34,6 +36,105 @@ void elina_double_interval_mul_cst_coeff(fppoly_internal_t *pr, double * res_inf
 }
 
 
+/* res[i] = [mul_inf,mul_sup]*[inf[i],sup[i]] with the rounding term of elina_double_interval_mul_expr_coeff */
+void elina_double_interval_mul_expr_coeffs(fppoly_internal_t *pr, double *res_inf, double *res_sup, double mul_inf, double mul_sup, const double *inf, const double *sup, size_t size){
+	size_t i = 0;
+#ifdef FPPOLY_SIMD
+	vdouble b_inf = vset1(mul_inf);
+	vdouble b_sup = vset1(mul_sup);
+	vdouble ulp = vset1(pr->ulp);
+	for(; i + VLEN <= size; i+=VLEN){
+		vdouble p_inf, p_sup, e_inf, e_sup;
+		vdouble c_inf = vload(inf + i);
+		vdouble c_sup = vload(sup + i);
+		vinterval_mul(&p_inf, &p_sup, b_inf, b_sup, c_inf, c_sup);
+		vdouble err = vmul(vmax(vabs(c_inf), vabs(c_sup)), ulp);
+		vinterval_mul(&e_inf, &e_sup, b_inf, b_sup, err, err);
+		vstore(res_inf + i, vadd(p_inf, e_inf));
+		vstore(res_sup + i, vadd(p_sup, e_sup));
+	}
+#endif
+	for(; i < size; i++){
+		elina_double_interval_mul_expr_coeff(pr,&res_inf[i],&res_sup[i],mul_inf,mul_sup,inf[i],sup[i]);
+	}
+}
+
+
+/* a[i] = a[i] + b[i] with the rounding term of add_expr */
+static void add_expr_coeffs(fppoly_internal_t *pr, double *a_inf, double *a_sup, const double *b_inf, const double *b_sup, size_t size){
+	size_t i = 0;
+	double maxA, maxB;
+#ifdef FPPOLY_SIMD
+	vdouble ulp = vset1(pr->ulp);
+	for(; i + VLEN <= size; i+=VLEN){
+		vdouble x_inf = vload(a_inf + i);
+		vdouble x_sup = vload(a_sup + i);
+		vdouble y_inf = vload(b_inf + i);
+		vdouble y_sup = vload(b_sup + i);
+		vdouble err = vmul(vadd(vmax(vabs(x_inf), vabs(x_sup)), vmax(vabs(y_inf), vabs(y_sup))), ulp);
+		vstore(a_inf + i, vadd(vadd(x_inf, y_inf), err));
+		vstore(a_sup + i, vadd(vadd(x_sup, y_sup), err));
+	}
+#endif
+	for(; i < size; i++){
+		maxA = fmax(fabs(a_inf[i]),fabs(a_sup[i]));
+		maxB = fmax(fabs(b_inf[i]),fabs(b_sup[i]));
+		a_inf[i] = a_inf[i] + b_inf[i] + (maxA + maxB)*pr->ulp;
+		a_sup[i] = a_sup[i] + b_sup[i] + (maxA + maxB)*pr->ulp;
+	}
+}
+
+
+/*
+ * The constant plus the sum of the products of the coefficients with the
+ * bounds of the variables, the negated lower bound of expr if is_lower and its
+ * upper bound otherwise. The bounds are taken from neurons if given and from
+ * inf/sup otherwise.
+ */
+double expr_concretize_bound(expr_t *expr, double *inf, double *sup, neuron_t **neurons, bool is_lower){
+	size_t size = expr->size;
+	size_t i = 0, k;
+	double tmp1, tmp2;
+	double res = is_lower ? expr->inf_cst : expr->sup_cst;
+#ifdef FPPOLY_SIMD
+	vdouble acc = vset1(0.0);
+	double l[VLEN], u[VLEN];
+	for(; i + VLEN <= size; i+=VLEN){
+		vdouble c_inf, c_sup, t_inf, t_sup;
+		if(expr->type==DENSE && neurons==NULL){
+			c_inf = vload(inf + i);
+			c_sup = vload(sup + i);
+		}
+		else{
+			for(k=0; k < VLEN; k++){
+				size_t d = expr->type==DENSE ? i + k : expr->dim[i+k];
+				l[k] = neurons==NULL ? inf[d] : neurons[d]->lb;
+				u[k] = neurons==NULL ? sup[d] : neurons[d]->ub;
+			}
+			c_inf = vload(l);
+			c_sup = vload(u);
+		}
+		vinterval_mul(&t_inf, &t_sup, vload(expr->inf_coeff + i), vload(expr->sup_coeff + i), c_inf, c_sup);
+		acc = vadd(acc, is_lower ? t_inf : t_sup);
+	}
+	if(i > 0){
+		res = res + vsum(acc);
+	}
+#endif
+	for(; i < size; i++){
+		k = expr->type==DENSE ? i : expr->dim[i];
+		if(neurons==NULL){
+			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],inf[k],sup[k]);
+		}
+		else{
+			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],neurons[k]->lb,neurons[k]->ub);
+		}
+		res = res + (is_lower ? tmp1 : tmp2);
+	}
+	return res;
+}
+
+
 void expr_fprint(FILE * stream, expr_t *expr){
 	if((expr->inf_coeff==NULL) || (expr->sup_coeff==NULL)){
 		fprintf(stdout,"+ [%g, %g]\n",-expr->inf_cst,expr->sup_cst);
@@ -134,6 +235,39 @@ expr_t * create_sparse_expr(double *coeff, double cst, size_t *dim, size_t size)
 }
 
 
+/* like create_dense_expr, but the expression and its coefficients live in storage owned by the caller */
+void init_dense_expr(expr_t *expr, double *inf_coeff, double *sup_coeff, double *coeff, double cst, size_t size){
+	size_t i;
+	expr->inf_coeff = inf_coeff;
+	expr->sup_coeff = sup_coeff;
+	expr->dim = NULL;
+	expr->size = size;
+	expr->inf_cst = -cst;
+	expr->sup_cst = cst;
+	expr->type = DENSE;
+	for(i=0; i < size; i++){
+		expr->inf_coeff[i] = -coeff[i];
+		expr->sup_coeff[i] = coeff[i];
+	}
+}
+
+/* like create_sparse_expr, but the expression, its coefficients and dimensions live in storage owned by the caller */
+void init_sparse_expr(expr_t *expr, double *inf_coeff, double *sup_coeff, size_t *expr_dim, double *coeff, double cst, size_t *dim, size_t size){
+	size_t i;
+	expr->inf_coeff = size > 0 ? inf_coeff : NULL;
+	expr->sup_coeff = size > 0 ? sup_coeff : NULL;
+	expr->dim = size > 0 ? expr_dim : NULL;
+	expr->size = size;
+	expr->inf_cst = -cst;
+	expr->sup_cst = cst;
+	expr->type = SPARSE;
+	for(i=0; i < size; i++){
+		expr->inf_coeff[i] = -coeff[i];
+		expr->sup_coeff[i] = coeff[i];
+		expr->dim[i] = dim[i];
+	}
+}
+
 void free_expr(expr_t *expr){
 	if(expr->inf_coeff){
 		free(expr->inf_coeff);
@@ -316,11 +450,7 @@ expr_t * multiply_expr(fppoly_internal_t *pr, expr_t *expr, double mul_inf, doub
 	}
 	res->type = expr->type;
 	size_t i;
-	for(i=0; i < expr->size; i++){
-		//res->coeff[i] = mul_coeff*expr->coeff[i];
-		elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],mul_inf,mul_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-		
-	}
+	elina_double_interval_mul_expr_coeffs(pr,res->inf_coeff,res->sup_coeff,mul_inf,mul_sup,expr->inf_coeff,expr->sup_coeff,expr->size);
 	if(expr->type==SPARSE){
 		if(expr->size>0){
 			res->dim = (size_t*)malloc(expr->size*sizeof(size_t));
@@ -412,12 +542,7 @@ void add_expr(fppoly_internal_t *pr,expr_t * exprA, expr_t * exprB){
 			if(exprB->type==DENSE){
 				//printf("AA\n");
 				//fflush(stdout);
-				for(i=0; i < sizeB; i++){
-					maxA = fmax(fabs(exprA->inf_coeff[i]),fabs(exprA->sup_coeff[i]));
-					maxB = fmax(fabs(exprB->inf_coeff[i]),fabs(exprB->sup_coeff[i]));
-					exprA->inf_coeff[i] = exprA->inf_coeff[i] + exprB->inf_coeff[i] + (maxA + maxB)*pr->ulp;
-					exprA->sup_coeff[i] = exprA->sup_coeff[i] + exprB->sup_coeff[i] + (maxA + maxB)*pr->ulp;
-				}
+				add_expr_coeffs(pr, exprA->inf_coeff, exprA->sup_coeff, exprB->inf_coeff, exprB->sup_coeff, sizeB);
 			}
 			else{
 				//printf("AB\n");	
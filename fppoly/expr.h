@@ -37,6 +37,10 @@ void elina_double_interval_mul_expr_coeff(fppoly_internal_t *pr, double * res_in
 
 void elina_double_interval_mul_cst_coeff(fppoly_internal_t *pr, double * res_inf, double *res_sup, double inf, double sup, double inf_expr, double sup_expr);
 
+void elina_double_interval_mul_expr_coeffs(fppoly_internal_t *pr, double *res_inf, double *res_sup, double mul_inf, double mul_sup, const double *inf, const double *sup, size_t size);
+
+double expr_concretize_bound(expr_t *expr, double *inf, double *sup, neuron_t **neurons, bool is_lower);
+
 void expr_fprint(FILE * stream, expr_t *expr);
 
 void expr_print(expr_t * expr);
@@ -49,6 +53,10 @@ expr_t * create_cst_expr(double l, double u);
 
 expr_t * create_sparse_expr(double *coeff, double cst, size_t *dim, size_t size);
 
+void init_dense_expr(expr_t *expr, double *inf_coeff, double *sup_coeff, double *coeff, double cst, size_t size);
+
+void init_sparse_expr(expr_t *expr, double *inf_coeff, double *sup_coeff, size_t *expr_dim, double *coeff, double cst, size_t *dim, size_t size);
+
 void free_expr(expr_t *expr);
 
 expr_t * copy_cst_expr(expr_t *src);
@@ -19,6 +19,7 @@
  */
 
 #include "backsubstitute.h"
+#include "reanalysis.h"
 
 
 
@@ -41,6 +42,7 @@ static inline void fppoly_internal_free(fppoly_internal_t* pr)
 {
     if (pr) {
 	pr->funid = ELINA_FUNID_UNKNOWN;
+	thread_pool_free(pr->pool);
 	free(pr);
 	pr = NULL;
     }
@@ -55,6 +57,11 @@ static inline fppoly_internal_t* fppoly_internal_alloc(void)
     pr->funopt = NULL; 
     pr->min_denormal = ldexpl(1.0,-1074);
     pr->ulp = ldexpl(1.0,-52);
+    pr->pool = NULL;
+    pr->lp_backend = &lp_dual_simplex_backend;
+    pr->backsub_early_stop = false;
+    pr->backsub_max_depth = 0;
+    pr->stable_relu_fusion = false;
     return pr;
 }
 
@@ -76,6 +83,7 @@ elina_manager_t * fppoly_manager_alloc(void){
 	void** funptr;
 	fesetround(FE_UPWARD);
 	fppoly_internal_t *pr = fppoly_internal_alloc();
+	pr->pool = thread_pool_alloc(0);
 	elina_manager_t *man = elina_manager_alloc("fppoly",/* Library name */
 			"1.0", /* version */
 			pr, /* internal structure */
@@ -89,6 +97,60 @@ elina_manager_t * fppoly_manager_alloc(void){
 }
 
 
+/* num_threads = 0 uses one thread per online processor */
+void fppoly_set_num_threads(elina_manager_t *man, size_t num_threads){
+	fppoly_internal_t *pr = (fppoly_internal_t *)man->internal;
+	thread_pool_free(pr->pool);
+	pr->pool = thread_pool_alloc(num_threads);
+}
+
+
+/* "simplex" for the built-in dual simplex, "gurobi" if built with USE_GUROBI; false if name is not available */
+bool fppoly_set_lp_solver(elina_manager_t *man, const char *name){
+	fppoly_internal_t *pr = (fppoly_internal_t *)man->internal;
+	const lp_backend_t *backend = lp_backend_of_name(name);
+	if(backend==NULL){
+		return false;
+	}
+	pr->lp_backend = backend;
+	return true;
+}
+
+
+/*
+ * With early_stop, the bounds of a neuron are only refined until they
+ * exclude 0, which is all a following ReLU needs to know its phase, and
+ * the output comparisons only until they are proven. The bounds stay sound
+ * but can be looser, so this is meant for ReLU networks. max_depth limits
+ * how many layers every back-substitution walks through, 0 for no limit.
+ */
+void fppoly_set_backsubstitution_budget(elina_manager_t *man, bool early_stop, size_t max_depth){
+	fppoly_internal_t *pr = (fppoly_internal_t *)man->internal;
+	pr->backsub_early_stop = early_stop;
+	pr->backsub_max_depth = max_depth;
+}
+
+
+size_t fppoly_get_backsubstitution_steps_saved(elina_manager_t *man, elina_abstract0_t *element){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	return fp->backsub_steps_saved;
+}
+
+
+/*
+ * Fully connected layers that follow a ReLU drop the inputs whose ReLU is
+ * stably inactive and, if all others are stably active, are composed with
+ * the affine layer before the ReLU. Bounds stay sound but can be looser
+ * since the skipped layers are no longer concretized on the way back, and
+ * expressions of fused layers are over the predecessor of the layers they
+ * were composed with.
+ */
+void fppoly_set_stable_relu_fusion(elina_manager_t *man, bool enable){
+	fppoly_internal_t *pr = (fppoly_internal_t *)man->internal;
+	pr->stable_relu_fusion = enable;
+}
+
+
 neuron_t *neuron_alloc(void){
 	neuron_t *res =  (neuron_t *)malloc(sizeof(neuron_t));
 	res->lb = -INFINITY;
@@ -98,15 +160,48 @@ neuron_t *neuron_alloc(void){
 	return res;
 }
 
-layer_t * create_layer(size_t size, bool is_activation){
+/* layer arrays of at least this size are filled by the pool workers */
+#define LAYER_FIRST_TOUCH_BYTES (1 << 21)
+
+/*
+ * Fills the items [0,size) of freshly allocated layer arrays with fn. Large
+ * blocks come from mmap and get their pages on first write, so filling them
+ * in one partition per pool worker spreads them over the NUMA nodes of the
+ * workers that back-substitute through them, instead of placing them all on
+ * the node of the caller.
+ */
+static void layer_first_touch(fppoly_internal_t *pr, size_t size, size_t bytes, thread_pool_fn_t fn, void *args){
+	if(pr==NULL || bytes < LAYER_FIRST_TOUCH_BYTES){
+		fn(args, 0, size);
+		return;
+	}
+	thread_pool_run_partitioned(pr->pool, size, fn, args);
+}
+
+static void layer_init_neurons(void *args, size_t start, size_t end){
+	layer_t *layer = (layer_t *)args;
+	size_t i;
+	for(i=start; i < end; i++){
+		neuron_t *neuron = &layer->neuron_block[i];
+		neuron->lb = -INFINITY;
+		neuron->ub = INFINITY;
+		neuron->lexpr = NULL;
+		neuron->uexpr = NULL;
+		layer->neurons[i] = neuron;
+	}
+}
+
+layer_t * create_layer(fppoly_internal_t *pr, size_t size, bool is_activation){
 	layer_t *layer = (layer_t*)malloc(sizeof(layer_t));
 	layer->dims = size;
 	layer->is_activation = is_activation;
 	layer->neurons = (neuron_t**)malloc(size*sizeof(neuron_t*));
-	size_t i;
-	for(i=0; i < size; i++){
-		layer->neurons[i] = neuron_alloc();
-	}
+	layer->neuron_block = (neuron_t*)malloc(size*sizeof(neuron_t));
+	layer_first_touch(pr, size, size*(sizeof(neuron_t)+sizeof(neuron_t*)), layer_init_neurons, layer);
+	layer->expr_block = NULL;
+	layer->coeff_block = NULL;
+	layer->dim_block = NULL;
+	layer->conv = NULL;
 	layer->h_t_inf = NULL;
 	layer->h_t_sup = NULL;
 	layer->c_t_inf = NULL;
@@ -114,10 +209,53 @@ layer_t * create_layer(size_t size, bool is_activation){
 	layer->is_concat = false;
 	layer->C = NULL;
 	layer->num_channels = 0;
+	layer->fused_predecessor = 0;
+	layer->is_shared = false;
+	layer->is_relu = false;
+	layer->use_default_heuristics = true;
+	layer->changed = NULL;
 	return layer;
 }
 
 
+/*
+ * One allocation for the expressions of an affine layer and one for their
+ * coefficients (inf_coeff followed by sup_coeff of every neuron), plus the
+ * dimensions if sparse, instead of four per neuron.
+ */
+static expr_t * layer_alloc_expr_block(layer_t *layer, size_t num_coeff, bool is_sparse){
+	layer->expr_block = (expr_t *)malloc(layer->dims*sizeof(expr_t));
+	layer->coeff_block = (double *)malloc(2*num_coeff*sizeof(double));
+	layer->dim_block = is_sparse ? (size_t *)malloc(num_coeff*sizeof(size_t)) : NULL;
+	return layer->expr_block;
+}
+
+static void layer_free_expr_block(layer_t *layer){
+	free(layer->expr_block);
+	free(layer->coeff_block);
+	free(layer->dim_block);
+	layer->expr_block = NULL;
+	layer->coeff_block = NULL;
+	layer->dim_block = NULL;
+}
+
+static bool layer_owns_expr(layer_t *layer, expr_t *expr){
+	return (layer->expr_block!=NULL) && (expr >= layer->expr_block) && (expr < layer->expr_block + layer->dims);
+}
+
+/* frees the expressions of a neuron of the layer unless they live in the layer's expression block */
+static void layer_free_neuron_expr(layer_t *layer, neuron_t *neuron){
+	if(neuron->uexpr && neuron->uexpr!=neuron->lexpr && !layer_owns_expr(layer,neuron->uexpr)){
+		free_expr(neuron->uexpr);
+	}
+	if(neuron->lexpr && !layer_owns_expr(layer,neuron->lexpr)){
+		free_expr(neuron->lexpr);
+	}
+	neuron->lexpr = NULL;
+	neuron->uexpr = NULL;
+}
+
+
 void fppoly_from_network_input_box(fppoly_t *res, size_t intdim, size_t realdim, double *inf_array, double *sup_array){
 	
 	res->layers = NULL;
@@ -136,12 +274,17 @@ void fppoly_from_network_input_box(fppoly_t *res, size_t intdim, size_t realdim,
 	res->num_pixels = num_pixels;
     res->spatial_indices = NULL;
     res->spatial_neighbors = NULL;
+    res->spatial_size = 0;
+    res->spatial_lp = NULL;
+    res->backsub_steps_saved = 0;
+    res->pr = NULL;
 }
 
 
 elina_abstract0_t * fppoly_from_network_input(elina_manager_t *man, size_t intdim, size_t realdim, double *inf_array, double *sup_array){
 	fppoly_t * res = (fppoly_t *)malloc(sizeof(fppoly_t));
 	fppoly_from_network_input_box(res, intdim, realdim, inf_array, sup_array);
+	res->pr = (fppoly_internal_t *)man->internal;
 	return abstract0_of_fppoly(man,res);
 }
 
@@ -165,6 +308,7 @@ elina_abstract0_t* fppoly_from_network_input_poly(elina_manager_t *man,
     fppoly_t * res = (fppoly_t *)malloc(sizeof(fppoly_t));
 	
 	fppoly_from_network_input_box(res, intdim, realdim, inf_array, sup_array);
+	res->pr = (fppoly_internal_t *)man->internal;
 	size_t num_pixels = intdim + realdim;
 	res->input_lexpr = (expr_t **)malloc(num_pixels*sizeof(expr_t *));
 	res->input_uexpr = (expr_t **)malloc(num_pixels*sizeof(expr_t *));
@@ -203,6 +347,10 @@ elina_abstract0_t* fppoly_from_network_input_poly(elina_manager_t *man,
     res->spatial_neighbors = malloc(spatial_size * sizeof(size_t));
     memcpy(res->spatial_indices, spatial_indices, spatial_size * sizeof(size_t));
     memcpy(res->spatial_neighbors, spatial_neighbors, spatial_size * sizeof(size_t));
+    if(spatial_size > 0){
+        fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_UNKNOWN);
+        res->spatial_lp = spatial_lp_alloc(res, pr->lp_backend);
+    }
 
     return abstract0_of_fppoly(man,res);	
 }
@@ -213,7 +361,7 @@ void fppoly_add_new_layer(fppoly_t *fp, size_t size, size_t *predecessors, size_
 	if(fp->numlayers==0){
 		fp->layers = (layer_t **)malloc(2000*sizeof(layer_t *));
 	}
-	fp->layers[numlayers] = create_layer(size, is_activation);
+	fp->layers[numlayers] = create_layer(fp->pr, size, is_activation);
 	fp->layers[numlayers]->predecessors = predecessors;
 	fp->layers[numlayers]->num_predecessors = num_predecessors;
 	fp->numlayers++;
@@ -231,12 +379,60 @@ void layer_fprint(FILE * stream, layer_t * layer, char** name_of_dim){
 	size_t i;
 	for(i = 0; i < dims; i++){
 		fprintf(stream,"neuron: %zu ", i);
+		if(layer->conv!=NULL){
+			expr_t *expr = conv_neuron_expr(layer->conv, i);
+			expr_fprint(stream, expr);
+			expr_fprint(stream, expr);
+			fprintf(stream,"[%g, %g]\n",-layer->neurons[i]->lb,layer->neurons[i]->ub);
+			free_expr(expr);
+			continue;
+		}
 		neuron_fprint(stream, layer->neurons[i], name_of_dim);
 	}
 }
 
 
 
+typedef struct fc_layer_init_t{
+	layer_t *layer;
+	double **weights;
+	double *cst;
+	size_t num_coeff;
+	size_t num_in_neurons;
+	fnn_op OP;
+}fc_layer_init_t;
+
+/* sets the expressions of the neurons [start,end) of an affine layer in its expression block */
+static void fc_layer_init_exprs(void *args, size_t start, size_t end){
+	fc_layer_init_t *data = (fc_layer_init_t *)args;
+	layer_t *layer = data->layer;
+	expr_t *exprs = layer->expr_block;
+	size_t num_coeff = data->num_coeff;
+	size_t i;
+	for(i=start; i < end; i++){
+		double cst_i = data->cst[i];
+		double *inf_coeff = layer->coeff_block + 2*i*num_coeff;
+		double *sup_coeff = inf_coeff + num_coeff;
+		if(data->OP==MUL){
+			init_sparse_expr(&exprs[i], inf_coeff, sup_coeff, layer->dim_block + i, &cst_i, 0, &i, 1);
+		}
+		else if(data->OP==SUB1){
+			double coeff = -1;
+			init_sparse_expr(&exprs[i], inf_coeff, sup_coeff, layer->dim_block + i, &coeff, cst_i, &i, 1);
+		}
+		else if(data->OP==SUB2){
+			double coeff = 1;
+			init_sparse_expr(&exprs[i], inf_coeff, sup_coeff, layer->dim_block + i, &coeff, -cst_i, &i, 1);
+		}
+		else{
+			init_dense_expr(&exprs[i], inf_coeff, sup_coeff, data->weights[i], cst_i, data->num_in_neurons);
+		}
+		layer->neurons[i]->lexpr = &exprs[i];
+		layer->neurons[i]->uexpr = layer->neurons[i]->lexpr;
+	}
+}
+
+
 void handle_fully_connected_layer_with_backsubstitute(elina_manager_t* man, elina_abstract0_t* element, double **weights, double * cst, size_t num_out_neurons, size_t num_in_neurons, size_t * predecessors, size_t num_predecessors, bool alloc, fnn_op OP){
     //printf("FC start here %zu %zu %zu %zu\n",num_in_neurons,num_out_neurons,predecessors[0],num_predecessors);
     //fflush(stdout);
@@ -246,27 +442,24 @@ void handle_fully_connected_layer_with_backsubstitute(elina_manager_t* man, elin
     if(alloc){
         fppoly_add_new_layer(fp,num_out_neurons, predecessors, num_predecessors, false);
     }
-    neuron_t **out_neurons = fp->layers[numlayers]->neurons;
-    size_t i;
-    for(i=0; i < num_out_neurons; i++){
-        
-        double cst_i = cst[i];
-	if(OP==MUL){
-		out_neurons[i]->lexpr = create_sparse_expr(&cst_i, 0, &i, 1);
-        }
-	else if(OP==SUB1){
-		double coeff = -1;
-		out_neurons[i]->lexpr = create_sparse_expr(&coeff, cst_i, &i, 1);
-	}
-	else if(OP==SUB2){
-		double coeff = 1;
-		out_neurons[i]->lexpr = create_sparse_expr(&coeff, -cst_i, &i, 1);
-	}
-        else{
-		double * weight_i = weights[i];
-        	out_neurons[i]->lexpr = create_dense_expr(weight_i,cst_i,num_in_neurons);
-	}
-	out_neurons[i]->uexpr = out_neurons[i]->lexpr;
+    layer_t *layer = fp->layers[numlayers];
+    if(!alloc){
+        layer_free_expr_block(layer);
+        layer->predecessors = predecessors;
+    }
+    size_t num_coeff = OP==MATMULT ? num_in_neurons : 1;
+    layer_alloc_expr_block(layer, num_out_neurons*num_coeff, OP!=MATMULT);
+    fc_layer_init_t init;
+    init.layer = layer;
+    init.weights = weights;
+    init.cst = cst;
+    init.num_coeff = num_coeff;
+    init.num_in_neurons = num_in_neurons;
+    init.OP = OP;
+    layer_first_touch(fp->pr, num_out_neurons, 2*num_out_neurons*num_coeff*sizeof(double), fc_layer_init_exprs, &init);
+    fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+    if(pr->stable_relu_fusion && OP==MATMULT){
+        fuse_stable_relu_layer(pr, fp, numlayers);
     }
     
     update_state_using_previous_layers_parallel(man,fp,numlayers);
@@ -363,7 +556,7 @@ expr_t * elina_linexpr0_to_expr(elina_linexpr0_t *linexpr0){
 }
 
 
-void *get_upper_bound_for_linexpr0_parallel(void *args){
+void get_upper_bound_for_linexpr0_parallel(void *args, size_t idx_start, size_t idx_end){
 	
 	//elina_interval_t * res = elina_interval_alloc();
 	nn_thread_t * data = (nn_thread_t *)args;
@@ -371,8 +564,6 @@ void *get_upper_bound_for_linexpr0_parallel(void *args){
 	fppoly_t *fp = data->fp;
     fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
         size_t layerno = data->layerno;
-	size_t idx_start = data->start;
-	size_t idx_end = data->end;
 	elina_linexpr0_t ** linexpr0 = data->linexpr0;
 	double * res = data->res;
 	size_t i;
@@ -387,6 +578,9 @@ void *get_upper_bound_for_linexpr0_parallel(void *args){
 		if(fp->layers[layerno]->num_predecessors==2){
 			uexpr = copy_expr(tmp);
 		}
+		else if(fp->layers[layerno]->conv!=NULL){
+			uexpr = expr_replace_bounds_conv(pr, tmp, fp->layers[layerno], false);
+		}
 		else{
 			uexpr = uexpr_replace_bounds(pr, tmp,fp->layers[layerno]->neurons, false);
 		}
@@ -397,72 +591,22 @@ void *get_upper_bound_for_linexpr0_parallel(void *args){
     		free_expr(tmp);
 		res[i] = ub;
 	}
-	return NULL;
 }
      
 
 double *get_upper_bound_for_linexpr0(elina_manager_t *man, elina_abstract0_t *element, elina_linexpr0_t **linexpr0, size_t size, size_t layerno){
 	fppoly_t * fp = fppoly_of_abstract0(element);
-	size_t NUM_THREADS = sysconf(_SC_NPROCESSORS_ONLN);
-	nn_thread_t args[NUM_THREADS];
-	pthread_t threads[NUM_THREADS];
-	size_t i;
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	nn_thread_t args;
 	//printf("layerno %zu %zu\n",layerno,fp->layers[layerno]->predecessors[0]-1);
 	//fflush(stdout);
 	double * res = (double *)malloc(size*sizeof(double));
-	if(size < NUM_THREADS){
-		for (i = 0; i < size; i++){
-	    		args[i].start = i;
-	    		args[i].end = i+1;
-			args[i].man = man;
-			args[i].fp = fp;
-			args[i].layerno = layerno;
-			args[i].linexpr0 = linexpr0;
-			args[i].res = res;
-	    		pthread_create(&threads[i], NULL,get_upper_bound_for_linexpr0_parallel, (void*)&args[i]);
-
-	  	}
-		for (i = 0; i < size; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
-	}
-	else{
-		size_t idx_start = 0;
-		size_t idx_n = size / NUM_THREADS;
-		size_t idx_end = idx_start + idx_n;
-
-
-	  	for (i = 0; i < NUM_THREADS; i++){
-	    		args[i].start = idx_start;
-	    		args[i].end = idx_end;
-			args[i].man = man;
-			args[i].fp = fp;
-			args[i].layerno = layerno;
-			args[i].linexpr0 = linexpr0;
-			args[i].res = res;
-	    		pthread_create(&threads[i], NULL, get_upper_bound_for_linexpr0_parallel, (void*)&args[i]);
-			idx_start = idx_end;
-			idx_end = idx_start + idx_n;
-	    		if(idx_end> size){
-				idx_end = size;
-			}
-			if((i==NUM_THREADS-2)){
-				idx_end = size;
-
-			}
-	  	}
-		//idx_start = idx_end;
-	    	//idx_end = num_out_neurons;
-		//args[i].start = idx_start;
-	    	//args[i].end = idx_end;
-		//args[i].man = man;
-		//args[i].fp = fp;
-		//args[i].layerno = layerno;
-	    	//pthread_create(&threads[i], NULL,update_state_using_previous_layers, (void*)&args[i]);
-		for (i = 0; i < NUM_THREADS; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
-	}
+	args.man = man;
+	args.fp = fp;
+	args.layerno = layerno;
+	args.linexpr0 = linexpr0;
+	args.res = res;
+	thread_pool_run(pr->pool, size, 1, get_upper_bound_for_linexpr0_parallel, (void*)&args);
 	return res;
 }
 
@@ -563,7 +707,7 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 		sub->dim[1] = x;
 		
 		//layer_fprint(stdout,fp->layers[3],NULL);
-		double lb = get_lb_using_previous_layers(man, fp, sub, fp->numlayers);
+		double lb = get_lb_using_previous_layers_until(man, fp, sub, fp->numlayers, pr->backsub_early_stop ? 0 : -INFINITY);
 		
 		//free_expr(sub);
 		
@@ -590,64 +734,15 @@ void handle_convolutional_layer(elina_manager_t* man, elina_abstract0_t* element
 	assert(num_predecessors==1);
 	fppoly_t *fp = fppoly_of_abstract0(element);
 	size_t numlayers = fp->numlayers;
-	size_t i, j;
-	size_t num_pixels = input_size[0]*input_size[1]*input_size[2];
 	
 	output_size[2] = num_filters;
 	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
 	//printf("num_out_neurons: %zu %zu\n",num_out_neurons,num_pixels);
 	//fflush(stdout);
 	fppoly_add_new_layer(fp,num_out_neurons, predecessors, num_predecessors, false);
-	neuron_t ** out_neurons = fp->layers[numlayers]->neurons;
-	size_t out_x, out_y, out_z;
-        size_t inp_x, inp_y, inp_z;
-	size_t x_shift, y_shift;
-
-	
+	/* the neurons share the filter, back-substitution applies it as a transposed convolution */
+	fp->layers[numlayers]->conv = conv_layer_alloc(filter_weights, filter_bias, input_size, filter_size, num_filters, strides, output_size, pad_top, pad_left, has_bias);
 	
-	for(out_x=0; out_x < output_size[0]; out_x++) {
-	    for(out_y = 0; out_y < output_size[1]; out_y++) {
-		 for(out_z=0; out_z < output_size[2]; out_z++) {
-		     size_t mat_x = out_x*output_size[1]*output_size[2] + out_y*output_size[2] + out_z;
-		     size_t num_coeff = input_size[2]*filter_size[0]*filter_size[1];
-		     size_t actual_coeff = 0;
-		     double *coeff = (double *)malloc(num_coeff*sizeof(double));
-		     size_t *dim = (size_t *)malloc(num_coeff*sizeof(double));
-		     i=0;
-		     for(inp_z=0; inp_z <input_size[2]; inp_z++) {
-			 for(x_shift = 0; x_shift < filter_size[0]; x_shift++) {
-			     for(y_shift =0; y_shift < filter_size[1]; y_shift++) {
-				     long int x_val = out_x*strides[0]+x_shift-pad_top;	
-			  	     long int y_val = out_y*strides[1]+y_shift-pad_left;
-			  	     if(y_val<0 || y_val >= (long int)input_size[1]){
-			     			continue;
-			  	     }
-				     
-			  	     if(x_val<0 || x_val >= (long int)input_size[0]){
-			     			continue;
-			  	     }
-				     size_t mat_y = x_val*input_size[1]*input_size[2] + y_val*input_size[2] + inp_z;
-				     if(mat_y>=num_pixels){		 
-			     			continue;
-		          	     }
-				     size_t filter_index = x_shift*filter_size[1]*input_size[2]*output_size[2] + y_shift*input_size[2]*output_size[2] + inp_z*output_size[2] + out_z;
-				     coeff[i] = filter_weights[filter_index];
-				     dim[i] = mat_y;
-				     actual_coeff++;
-				     i++;
-			     }
-			}
-		    }
-		   double cst = has_bias? filter_bias[out_z] : 0;
-	           out_neurons[mat_x]->lexpr = create_sparse_expr(coeff,cst,dim,actual_coeff);
-		   sort_sparse_expr(out_neurons[mat_x]->lexpr); 
-		   out_neurons[mat_x]->uexpr = out_neurons[mat_x]->lexpr;
-		   free(coeff);
-		   free(dim);
-	        }
-	     }
-	}
-		
 	update_state_using_previous_layers_parallel(man,fp,numlayers);
 	//printf("CONV ends\n");
 	//fppoly_fprint(stdout,man,fp,NULL);
@@ -663,15 +758,15 @@ void handle_residual_layer(elina_manager_t *man, elina_abstract0_t *element, siz
 	size_t numlayers = fp->numlayers;
 	fppoly_add_new_layer(fp,num_neurons, predecessors, num_predecessors, false);
 	size_t i;
-	neuron_t **neurons = fp->layers[numlayers]->neurons;
+	layer_t *layer = fp->layers[numlayers];
+	neuron_t **neurons = layer->neurons;
+	expr_t *exprs = layer_alloc_expr_block(layer, num_neurons, true);
 	//printf("START\n");
 	//fflush(stdout);
 	for(i=0; i < num_neurons; i++){
-		double *coeff = (double*)malloc(sizeof(double));
-		coeff[0] = 1;
-		size_t *dim = (size_t*)malloc(sizeof(size_t));
-		dim[0] = i;
-		neurons[i]->lexpr = create_sparse_expr(coeff,0,dim,1);
+		double coeff = 1;
+		init_sparse_expr(&exprs[i], layer->coeff_block + 2*i, layer->coeff_block + 2*i + 1, layer->dim_block + i, &coeff, 0, &i, 1);
+		neurons[i]->lexpr = &exprs[i];
 		neurons[i]->uexpr = neurons[i]->lexpr;
 	}
 	//printf("FINISH\n");
@@ -702,13 +797,10 @@ void free_non_lstm_layer_expr(elina_manager_t *man, elina_abstract0_t *abs, size
     size_t dims = layer->dims;
     size_t i;
     for(i=0; i < dims; i++){
-        neuron_t *neuron = layer->neurons[i];
-        if(neuron->uexpr!=neuron->lexpr){
-            free_expr(neuron->uexpr);
-        }
-        if(neuron->lexpr){
-            free_expr(neuron->lexpr);
-        }
+        layer_free_neuron_expr(layer, layer->neurons[i]);
+    }
+    if(!layer->is_shared){
+        layer_free_expr_block(layer);
     }
 }
 
@@ -716,8 +808,19 @@ void layer_free(layer_t * layer){
 	size_t dims = layer->dims;
 	size_t i;
 	for(i=0; i < dims; i++){
-		free_neuron(layer->neurons[i]);
+		layer_free_neuron_expr(layer, layer->neurons[i]);
 	}
+	if(!layer->is_shared){
+		layer_free_expr_block(layer);
+		if(layer->conv!=NULL){
+			conv_layer_free(layer->conv);
+		}
+	}
+	layer->conv = NULL;
+	free(layer->changed);
+	layer->changed = NULL;
+	free(layer->neuron_block);
+	layer->neuron_block = NULL;
 	free(layer->neurons);
 	layer->neurons = NULL;
 	if(layer->h_t_inf!=NULL){
@@ -778,6 +881,8 @@ void fppoly_free(elina_manager_t *man, fppoly_t *fp){
     fp->spatial_indices = NULL;
     free(fp->spatial_neighbors);
     fp->spatial_neighbors = NULL;
+    spatial_lp_free(fp->spatial_lp);
+    fp->spatial_lp = NULL;
 
 	free(fp);
 	fp = NULL;
@@ -863,21 +968,29 @@ elina_linexpr0_t * get_expr_for_output_neuron(elina_manager_t *man, elina_abstra
 	}
 	size_t num_pixels = fp->num_pixels;
 	expr_t * expr = NULL;
-	if(is_lower){
-		expr = fp->layers[fp->numlayers-1]->neurons[i]->lexpr;
+	layer_t * layer = fp->layers[fp->numlayers-1];
+	if(layer->conv!=NULL){
+		expr = conv_neuron_expr(layer->conv, i);
+	}
+	else if(is_lower){
+		expr = layer->neurons[i]->lexpr;
 	}
 	else{
-		expr = fp->layers[fp->numlayers-1]->neurons[i]->uexpr;
+		expr = layer->neurons[i]->uexpr;
 	}
 	elina_linexpr0_t * res = NULL;
 	size_t j,k;
 	if((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL)){
+		expr_t * tmp = expr;
 		if(is_lower){
 			expr =  replace_input_poly_cons_in_lexpr(pr, expr, fp);
 		}
 		else{
 			expr =  replace_input_poly_cons_in_uexpr(pr, expr, fp);
 		}
+		if(layer->conv!=NULL){
+			free_expr(tmp);
+		}
 	}
 	size_t expr_size = expr->size;
 	if(expr->type==SPARSE){
@@ -898,7 +1011,7 @@ elina_linexpr0_t * get_expr_for_output_neuron(elina_manager_t *man, elina_abstra
 		}
 		elina_linexpr0_set_coeff_interval_double(res,k,-expr->inf_coeff[j],expr->sup_coeff[j]);
 	}
-	if((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL)){
+	if(((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL)) || (layer->conv!=NULL)){
 		free_expr(expr);
 	}
 	return res;
@@ -922,6 +1035,7 @@ void update_bounds_for_neuron(elina_manager_t *man, elina_abstract0_t *abs, size
 	neuron_t * neuron = layer->neurons[neuron_no];
 	neuron->lb = -lb;
 	neuron->ub = ub;
+	layer_mark_changed(layer, neuron_no);
 }
 
 
@@ -941,6 +1055,7 @@ void update_activation_upper_bound_for_neuron(elina_manager_t *man, elina_abstra
 	neuron->uexpr = NULL;
 	neuron->uexpr = create_sparse_expr(coeff+1, coeff[0], dim, size);
 	sort_sparse_expr(neuron->uexpr);
+	layer_mark_changed(layer, neuron_no);
 }
 
 
@@ -960,4 +1075,5 @@ void update_activation_lower_bound_for_neuron(elina_manager_t *man, elina_abstra
 	neuron->lexpr = NULL;
 	neuron->lexpr = create_sparse_expr(coeff+1, coeff[0], dim, size);
 	sort_sparse_expr(neuron->lexpr);
+	layer_mark_changed(layer, neuron_no);
 }
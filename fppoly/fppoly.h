@@ -42,6 +42,7 @@ extern "C" {
 //#include <sys/sysinfo.h>
 #include "elina_generic.h"
 #include "elina_box_meetjoin.h"
+#include "thread_pool.h"
 
 
 
@@ -57,6 +58,16 @@ typedef struct fppoly_internal_t{
   bool conv;
   double min_denormal;
   double ulp;
+  /* workers used for back-substitution */
+  thread_pool_t *pool;
+  /* solver for the LPs over spatially constrained inputs */
+  const struct lp_backend_t *lp_backend;
+  /* stop back-substituting a neuron once its bounds fix the ReLU phase or the property */
+  bool backsub_early_stop;
+  /* layers a back-substitution may walk through before concretizing, 0 for no limit */
+  size_t backsub_max_depth;
+  /* drop stably inactive ReLU inputs of affine layers and compose through stably active ones */
+  bool stable_relu_fusion;
   /* back pointer to elina_manager*/
   elina_manager_t* man;
 }fppoly_internal_t;
@@ -93,16 +104,50 @@ typedef struct neuron_t{
 	expr_t * uexpr;
 }neuron_t;
 
+/*
+ * Convolutional layer kept as its filter instead of one expression per
+ * neuron. Weights are stored as [filter_x][filter_y][filter][input channel],
+ * and the biases are zero if the layer has none.
+ */
+typedef struct conv_layer_t{
+	size_t input_size[3];
+	size_t filter_size[2];
+	size_t num_filters;
+	size_t strides[2];
+	size_t output_size[3];
+	size_t pad_top;
+	size_t pad_left;
+	double *weights;
+	double *bias;
+}conv_layer_t;
+
 typedef struct layer_t{
 	size_t dims;
+	/* views into neuron_block, kept so that neurons can be passed around by pointer */
 	neuron_t **neurons;
+	neuron_t *neuron_block;
+	/* contiguous storage of the affine expressions of fully connected and residual layers (CSR for sparse ones), NULL otherwise */
+	expr_t *expr_block;
+	double *coeff_block;
+	size_t *dim_block;
+	/* set for convolutional layers, whose neurons then have no expressions */
+	conv_layer_t *conv;
 	double * h_t_inf;
 	double * h_t_sup;
 	double * c_t_inf;
 	double * c_t_sup;
 	size_t *predecessors;
+	/* predecessor of a layer composed with earlier layers, predecessors then points here */
+	size_t fused_predecessor;
 	size_t num_predecessors;
 	bool is_activation;
+	/* set by handle_relu_layer, whose relaxations can be rebuilt from the bounds of the input */
+	bool is_relu;
+	bool use_default_heuristics;
+	/* neurons whose bounds or relaxation were set from outside since the last fppoly_reanalyze, NULL if none */
+	char *changed;
+	/* the expressions or the filter belong to a compiled network and are not freed with the layer */
+	bool is_shared;
 	bool is_concat;
 	size_t *C;
 	size_t num_channels;
@@ -123,12 +168,15 @@ typedef struct fppoly_t{
     size_t *spatial_neighbors;
     size_t spatial_size;
     double spatial_gamma;
+    struct spatial_lp_t *spatial_lp;
+    /* layer substitutions skipped by early termination and the depth budget */
+    size_t backsub_steps_saved;
+    /* manager data whose pool first-touches the layer arrays, NULL to fill them in the caller */
+    fppoly_internal_t *pr;
 }fppoly_t;
 
 
 typedef struct nn_thread_t{
-	size_t start;
-	size_t end;
 	elina_manager_t *man;
 	fppoly_t *fp;
 	size_t layerno;
@@ -139,6 +187,16 @@ typedef struct nn_thread_t{
 
 elina_manager_t* fppoly_manager_alloc(void);
 
+void fppoly_set_num_threads(elina_manager_t *man, size_t num_threads);
+
+bool fppoly_set_lp_solver(elina_manager_t *man, const char *name);
+
+void fppoly_set_backsubstitution_budget(elina_manager_t *man, bool early_stop, size_t max_depth);
+
+size_t fppoly_get_backsubstitution_steps_saved(elina_manager_t *man, elina_abstract0_t *element);
+
+void fppoly_set_stable_relu_fusion(elina_manager_t *man, bool enable);
+
 elina_abstract0_t* fppoly_from_network_input(elina_manager_t *man, size_t intdim, size_t realdim, double *inf_array, double *sup_array);
 
 void fppoly_set_network_input_box(elina_manager_t *man, elina_abstract0_t* element, size_t intdim, size_t realdim, double *inf_array, double * sup_array);
@@ -184,6 +242,8 @@ void handle_log_layer(elina_manager_t *man, elina_abstract0_t* element, size_t n
 void fppoly_fprint(FILE* stream, elina_manager_t* man, fppoly_t* fp, char** name_of_dim);
 
 
+void fppoly_from_network_input_box(fppoly_t *res, size_t intdim, size_t realdim, double *inf_array, double *sup_array);
+
 void fppoly_free(elina_manager_t *man, fppoly_t *fp);
 
 bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y, elina_dim_t x);
@@ -239,6 +299,9 @@ void update_activation_upper_bound_for_neuron(elina_manager_t *man, elina_abstra
 
 void update_activation_lower_bound_for_neuron(elina_manager_t *man, elina_abstract0_t *abs, size_t layerno, size_t neuron_no, double* coeff, size_t *dim, size_t size);
 
+/* recomputes what depends on the neurons updated by the three functions above, returns the number of recomputed neurons */
+size_t fppoly_reanalyze(elina_manager_t *man, elina_abstract0_t *element);
+
 elina_linexpr0_t *get_output_lexpr_defined_over_previous_layers(elina_manager_t *man, elina_abstract0_t *element, int neuron_no, int prev_layer);
 
 elina_linexpr0_t *get_output_uexpr_defined_over_previous_layers(elina_manager_t *man, elina_abstract0_t *element, int neuron_no, int prev_layer);
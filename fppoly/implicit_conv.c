@@ -0,0 +1,342 @@
+#include "implicit_conv.h"
+#include "interval_simd.h"
+
+conv_layer_t * conv_layer_alloc(double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size, size_t num_filters,
+				size_t *strides, size_t *output_size, size_t pad_top, size_t pad_left, bool has_bias){
+	conv_layer_t *conv = (conv_layer_t *)malloc(sizeof(conv_layer_t));
+	size_t i;
+	for(i=0; i < 3; i++){
+		conv->input_size[i] = input_size[i];
+		conv->output_size[i] = output_size[i];
+	}
+	for(i=0; i < 2; i++){
+		conv->filter_size[i] = filter_size[i];
+		conv->strides[i] = strides[i];
+	}
+	conv->num_filters = num_filters;
+	conv->pad_top = pad_top;
+	conv->pad_left = pad_left;
+	size_t num_taps = filter_size[0]*filter_size[1];
+	size_t num_channels = input_size[2];
+	conv->weights = (double *)malloc(num_taps*num_channels*num_filters*sizeof(double));
+	size_t tap, inp_z, f;
+	/* channels innermost, the transposed convolution runs along them */
+	for(tap=0; tap < num_taps; tap++){
+		for(f=0; f < num_filters; f++){
+			for(inp_z=0; inp_z < num_channels; inp_z++){
+				conv->weights[(tap*num_filters + f)*num_channels + inp_z] = filter_weights[(tap*num_channels + inp_z)*num_filters + f];
+			}
+		}
+	}
+	conv->bias = (double *)malloc(num_filters*sizeof(double));
+	for(i=0; i < num_filters; i++){
+		conv->bias[i] = has_bias ? filter_bias[i] : 0;
+	}
+	return conv;
+}
+
+
+void conv_layer_free(conv_layer_t *conv){
+	free(conv->weights);
+	free(conv->bias);
+	free(conv);
+}
+
+
+/* the range [*start,*end) of input coordinates read at output coordinate out along one axis */
+static void conv_window(size_t out, size_t stride, size_t pad, size_t filter_size, size_t input_size, size_t *start, size_t *end){
+	long int first = (long int)(out*stride) - (long int)pad;
+	long int last = first + (long int)filter_size;
+	*start = first < 0 ? 0 : (size_t)first;
+	*end = last > (long int)input_size ? input_size : (last < 0 ? 0 : (size_t)last);
+}
+
+
+expr_t * conv_neuron_expr(conv_layer_t *conv, size_t i){
+	size_t num_filters = conv->num_filters;
+	size_t num_channels = conv->input_size[2];
+	size_t out_z = i % num_filters;
+	size_t out_y = (i / num_filters) % conv->output_size[1];
+	size_t out_x = i / (num_filters*conv->output_size[1]);
+	size_t x_start, x_end, y_start, y_end;
+	conv_window(out_x, conv->strides[0], conv->pad_top, conv->filter_size[0], conv->input_size[0], &x_start, &x_end);
+	conv_window(out_y, conv->strides[1], conv->pad_left, conv->filter_size[1], conv->input_size[1], &y_start, &y_end);
+	size_t size = (x_end - x_start)*(y_end - y_start)*num_channels;
+	expr_t *expr = create_cst_expr(-conv->bias[out_z], conv->bias[out_z]);
+	if(size==0){
+		return expr;
+	}
+	expr->inf_coeff = (double *)malloc(size*sizeof(double));
+	expr->sup_coeff = (double *)malloc(size*sizeof(double));
+	expr->dim = (size_t *)malloc(size*sizeof(size_t));
+	expr->size = size;
+	size_t x, y, inp_z, j = 0;
+	/* visiting the window row by row and channels innermost yields the dimensions in increasing order */
+	for(x=x_start; x < x_end; x++){
+		size_t x_shift = x + conv->pad_top - out_x*conv->strides[0];
+		for(y=y_start; y < y_end; y++){
+			size_t y_shift = y + conv->pad_left - out_y*conv->strides[1];
+			double *w = conv->weights + ((x_shift*conv->filter_size[1] + y_shift)*num_filters + out_z)*num_channels;
+			for(inp_z=0; inp_z < num_channels; inp_z++){
+				expr->inf_coeff[j] = -w[inp_z];
+				expr->sup_coeff[j] = w[inp_z];
+				expr->dim[j] = (x*conv->input_size[1] + y)*num_channels + inp_z;
+				j++;
+			}
+		}
+	}
+	return expr;
+}
+
+
+expr_t * copy_neuron_expr(layer_t *layer, size_t i, bool is_lower){
+	if(layer->conv!=NULL){
+		return conv_neuron_expr(layer->conv, i);
+	}
+	return copy_expr(is_lower ? layer->neurons[i]->lexpr : layer->neurons[i]->uexpr);
+}
+
+
+bool conv_backsubstitute_cst(fppoly_internal_t *pr, conv_layer_t *conv, neuron_t **neurons, bool is_lower, size_t *out_box, double *a_inf, double *a_sup,
+			     double *cst_inf, double *cst_sup, char *active, size_t *box){
+	size_t num_filters = conv->num_filters;
+	size_t out_x, out_y, f;
+	double res_inf = 0.0, res_sup = 0.0, cst_mag = 0.0;
+	size_t num_terms = 0;
+	size_t p = 0;
+	box[0] = box[2] = SIZE_MAX;
+	box[1] = box[3] = 0;
+	for(out_x=out_box[0]; out_x < out_box[1]; out_x++){
+		for(out_y=out_box[2]; out_y < out_box[3]; out_y++, p++){
+			neuron_t **out_neurons = neurons + (out_x*conv->output_size[1] + out_y)*num_filters;
+			active[p] = 0;
+			for(f=0; f < num_filters; f++){
+				size_t j = p*num_filters + f;
+				double tmp1, tmp2;
+				if(a_sup[j] < 0 || a_inf[j] < 0){
+					elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,a_inf[j],a_sup[j],-conv->bias[f],conv->bias[f]);
+					res_inf = res_inf + tmp1;
+					res_sup = res_sup + tmp2;
+					active[p] = 1;
+				}
+				else if(a_inf[j]==0 && a_sup[j]==0){
+					continue;
+				}
+				else{
+					elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,out_neurons[f]->lb,out_neurons[f]->ub,a_inf[j],a_sup[j]);
+					if(is_lower){
+						res_inf = res_inf + tmp1;
+						res_sup = res_sup - tmp1;
+					}
+					else{
+						res_inf = res_inf - tmp2;
+						res_sup = res_sup + tmp2;
+					}
+					a_inf[j] = 0.0;
+					a_sup[j] = 0.0;
+				}
+				cst_mag = cst_mag + fmax(fabs(tmp1),fabs(tmp2));
+				num_terms++;
+			}
+			if(active[p]){
+				size_t start, end;
+				conv_window(out_x, conv->strides[0], conv->pad_top, conv->filter_size[0], conv->input_size[0], &start, &end);
+				box[0] = start < box[0] ? start : box[0];
+				box[1] = end > box[1] ? end : box[1];
+				conv_window(out_y, conv->strides[1], conv->pad_left, conv->filter_size[1], conv->input_size[1], &start, &end);
+				box[2] = start < box[2] ? start : box[2];
+				box[3] = end > box[3] ? end : box[3];
+			}
+		}
+	}
+	/* rounding of the accumulated sums, as add_cst_expr does term by term */
+	double err = (num_terms+1)*cst_mag*pr->ulp + num_terms*pr->min_denormal;
+	*cst_inf = *cst_inf + res_inf + err;
+	*cst_sup = *cst_sup + res_sup + err;
+	return (box[0] < box[1]) && (box[2] < box[3]);
+}
+
+
+/* the output coordinate in [start,end) that reads input coordinate in through filter tap shift, if any */
+static inline bool conv_output_coord(size_t in, size_t shift, size_t stride, size_t pad, size_t start, size_t end, size_t *out){
+	long int t = (long int)(in + pad) - (long int)shift;
+	if(t < 0 || t % (long int)stride){
+		return false;
+	}
+	*out = (size_t)t / stride;
+	return (*out >= start) && (*out < end);
+}
+
+
+/*
+ * c += a*w for an interval a = [-x, y] and a row w of exact weights: the
+ * sign of each weight picks the endpoints, x*|w| and y*|w| for a positive
+ * weight, y*|w| and x*|w| for a negative one. Written with |w| rather than
+ * -x*w because the compiler may turn c + (-x)*w into c - x*w, which is
+ * only the same under round to nearest. A product 0*inf counts as 0, as in
+ * elina_double_interval_mul. With -DVECTOR the loop runs on AVX2/AVX-512
+ * vectors (interval_simd.h) and gives the same results.
+ */
+static inline void conv_axpy(double * restrict c_inf, double * restrict c_sup, double * restrict mag,
+			     double x, double y, const double * restrict w, size_t size){
+	size_t i = 0;
+	double m = fmax(fabs(x),fabs(y));
+#ifdef FPPOLY_SIMD
+	vdouble vx = vset1(x);
+	vdouble vy = vset1(y);
+	vdouble vm = vset1(m);
+	for(; i + VLEN <= size; i+=VLEN){
+		vdouble vw = vload(w + i);
+		vdouble va = vabs(vw);
+		vstore(c_inf + i, vadd(vload(c_inf + i), vnan0(vmul(vselect_neg(vw,vx,vy), va))));
+		vstore(c_sup + i, vadd(vload(c_sup + i), vnan0(vmul(vselect_neg(vw,vy,vx), va))));
+		vstore(mag + i, vadd(vload(mag + i), vmul(vm, va)));
+	}
+#endif
+	for(; i < size; i++){
+		double a = fabs(w[i]);
+		double p1 = (w[i] < 0 ? y : x)*a;
+		double p2 = (w[i] < 0 ? x : y)*a;
+		c_inf[i] += p1==p1 ? p1 : 0.0;
+		c_sup[i] += p2==p2 ? p2 : 0.0;
+		mag[i] += m*a;
+	}
+}
+
+
+void conv_transpose(fppoly_internal_t *pr, conv_layer_t *conv, size_t *out_box, double *a_inf, double *a_sup, char *active, size_t *box,
+		    double *res_inf, double *res_sup){
+	size_t num_filters = conv->num_filters;
+	size_t num_channels = conv->input_size[2];
+	size_t out_width = out_box[3] - out_box[2];
+	size_t x, y, x_shift, y_shift, inp_z, f;
+	double *mag = (double *)malloc(num_channels*sizeof(double));
+	/* rounding of the products and of the accumulated sums, as multiply_expr and add_expr do term by term */
+	double scale = (conv->filter_size[0]*conv->filter_size[1]*num_filters+1)*pr->ulp;
+	for(x=box[0]; x < box[1]; x++){
+		for(y=box[2]; y < box[3]; y++){
+			size_t offset = ((x-box[0])*(box[3]-box[2]) + (y-box[2]))*num_channels;
+			double *c_inf = res_inf + offset;
+			double *c_sup = res_sup + offset;
+			memset(c_inf,0,num_channels*sizeof(double));
+			memset(c_sup,0,num_channels*sizeof(double));
+			memset(mag,0,num_channels*sizeof(double));
+			for(x_shift=0; x_shift < conv->filter_size[0]; x_shift++){
+				size_t out_x;
+				if(!conv_output_coord(x,x_shift,conv->strides[0],conv->pad_top,out_box[0],out_box[1],&out_x)){
+					continue;
+				}
+				for(y_shift=0; y_shift < conv->filter_size[1]; y_shift++){
+					size_t out_y;
+					if(!conv_output_coord(y,y_shift,conv->strides[1],conv->pad_left,out_box[2],out_box[3],&out_y)){
+						continue;
+					}
+					size_t p = (out_x-out_box[0])*out_width + (out_y-out_box[2]);
+					if(!active[p]){
+						continue;
+					}
+					double *b_inf = a_inf + p*num_filters;
+					double *b_sup = a_sup + p*num_filters;
+					double *w = conv->weights + (x_shift*conv->filter_size[1] + y_shift)*num_filters*num_channels;
+					for(f=0; f < num_filters; f++, w+=num_channels){
+						if(b_inf[f]==0 && b_sup[f]==0){
+							continue;
+						}
+						conv_axpy(c_inf,c_sup,mag,b_inf[f],b_sup[f],w,num_channels);
+					}
+				}
+			}
+			for(inp_z=0; inp_z < num_channels; inp_z++){
+				c_inf[inp_z] += scale*mag[inp_z];
+				c_sup[inp_z] += scale*mag[inp_z];
+			}
+		}
+	}
+	free(mag);
+}
+
+
+expr_t * expr_replace_bounds_conv(fppoly_internal_t *pr, expr_t *expr, layer_t *layer, bool is_lower){
+	if(expr->size==0){
+		return copy_cst_expr(expr);
+	}
+	if(expr->inf_coeff==NULL || expr->sup_coeff==NULL){
+		return alloc_expr();
+	}
+	conv_layer_t *conv = layer->conv;
+	size_t num_filters = conv->num_filters;
+	size_t out_height = conv->output_size[1];
+	size_t num_in_neurons = conv->input_size[0]*conv->input_size[1]*conv->input_size[2];
+	size_t i;
+	/* the coefficients are gathered over the output positions the expression spans only */
+	size_t out_box[4] = {0, conv->output_size[0], 0, out_height};
+	if(expr->type==SPARSE){
+		out_box[0] = out_box[2] = SIZE_MAX;
+		out_box[1] = out_box[3] = 0;
+		for(i=0; i < expr->size; i++){
+			size_t pos = expr->dim[i] / num_filters;
+			size_t out_x = pos / out_height;
+			size_t out_y = pos % out_height;
+			out_box[0] = out_x < out_box[0] ? out_x : out_box[0];
+			out_box[1] = out_x+1 > out_box[1] ? out_x+1 : out_box[1];
+			out_box[2] = out_y < out_box[2] ? out_y : out_box[2];
+			out_box[3] = out_y+1 > out_box[3] ? out_y+1 : out_box[3];
+		}
+	}
+	size_t out_width = out_box[3] - out_box[2];
+	size_t num_positions = (out_box[1] - out_box[0])*out_width;
+	double *a_inf = (double *)calloc(num_positions*num_filters,sizeof(double));
+	double *a_sup = (double *)calloc(num_positions*num_filters,sizeof(double));
+	for(i=0; i < expr->size; i++){
+		size_t k = expr->type==DENSE ? i : expr->dim[i];
+		size_t pos = k / num_filters;
+		size_t j = ((pos / out_height - out_box[0])*out_width + (pos % out_height - out_box[2]))*num_filters + k % num_filters;
+		a_inf[j] = expr->inf_coeff[i];
+		a_sup[j] = expr->sup_coeff[i];
+	}
+	char *active = (char *)malloc(num_positions*sizeof(char));
+	size_t box[4];
+	expr_t *res = create_cst_expr(expr->inf_cst, expr->sup_cst);
+	if(conv_backsubstitute_cst(pr,conv,layer->neurons,is_lower,out_box,a_inf,a_sup,&res->inf_cst,&res->sup_cst,active,box)){
+		size_t num_channels = conv->input_size[2];
+		size_t size = (box[1]-box[0])*(box[3]-box[2])*num_channels;
+		res->inf_coeff = (double *)malloc(size*sizeof(double));
+		res->sup_coeff = (double *)malloc(size*sizeof(double));
+		conv_transpose(pr,conv,out_box,a_inf,a_sup,active,box,res->inf_coeff,res->sup_coeff);
+		if(size==num_in_neurons){
+			res->type = DENSE;
+			res->size = size;
+		}
+		else{
+			/* the box is visited in the order of the input neurons, keep its nonzero entries */
+			size_t x, y, inp_z, j = 0, k = 0;
+			res->dim = (size_t *)malloc(size*sizeof(size_t));
+			for(x=box[0]; x < box[1]; x++){
+				for(y=box[2]; y < box[3]; y++){
+					for(inp_z=0; inp_z < num_channels; inp_z++, k++){
+						if(res->inf_coeff[k]==0 && res->sup_coeff[k]==0){
+							continue;
+						}
+						res->inf_coeff[j] = res->inf_coeff[k];
+						res->sup_coeff[j] = res->sup_coeff[k];
+						res->dim[j] = (x*conv->input_size[1] + y)*num_channels + inp_z;
+						j++;
+					}
+				}
+			}
+			res->size = j;
+			if(j==0){
+				free(res->inf_coeff);
+				free(res->sup_coeff);
+				free(res->dim);
+				res->inf_coeff = NULL;
+				res->sup_coeff = NULL;
+				res->dim = NULL;
+			}
+		}
+	}
+	free(a_inf);
+	free(a_sup);
+	free(active);
+	return res;
+}
@@ -0,0 +1,73 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+
+#ifndef __IMPLICIT_CONV_H_INCLUDED__
+#define __IMPLICIT_CONV_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fppoly.h"
+#include "expr.h"
+
+conv_layer_t * conv_layer_alloc(double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size, size_t num_filters,
+				size_t *strides, size_t *output_size, size_t pad_top, size_t pad_left, bool has_bias);
+
+void conv_layer_free(conv_layer_t *conv);
+
+/* the expression of neuron i of a convolutional layer, sparse over the input with the dimensions sorted */
+expr_t * conv_neuron_expr(conv_layer_t *conv, size_t i);
+
+/* a copy of the lower or upper expression of neuron i, built from the filter for convolutional layers */
+expr_t * copy_neuron_expr(layer_t *layer, size_t i, bool is_lower);
+
+/*
+ * First half of replacing the neurons of a convolutional layer in a row of
+ * coefficients, as expr_replace_bounds_affine. The row a covers the output
+ * rows [out_box[0],out_box[1]) and columns [out_box[2],out_box[3]), all
+ * filters, and is zero elsewhere. Adds the bias terms and the concretization
+ * of coefficients containing zero to the constant and clears the latter from
+ * a. Marks the output positions of out_box that keep a nonzero coefficient in
+ * active and returns in box the input rows [box[0],box[1]) and columns
+ * [box[2],box[3]) they read. Returns false if no position is active.
+ */
+bool conv_backsubstitute_cst(fppoly_internal_t *pr, conv_layer_t *conv, neuron_t **neurons, bool is_lower, size_t *out_box, double *a_inf, double *a_sup,
+			     double *cst_inf, double *cst_sup, char *active, size_t *box);
+
+/*
+ * Second half: the transposed convolution of the remaining coefficients,
+ * written to res_inf/res_sup for the input rows and columns of box, all
+ * channels, in the order of the input neurons.
+ */
+void conv_transpose(fppoly_internal_t *pr, conv_layer_t *conv, size_t *out_box, double *a_inf, double *a_sup, char *active, size_t *box,
+		    double *res_inf, double *res_sup);
+
+/* lexpr/uexpr_replace_bounds for a convolutional layer */
+expr_t * expr_replace_bounds_conv(fppoly_internal_t *pr, expr_t *expr, layer_t *layer, bool is_lower);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+#ifndef __INTERVAL_SIMD_H_INCLUDED__
+#define __INTERVAL_SIMD_H_INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * AVX2/AVX-512 vectors of doubles for the interval kernels of expr.c,
+ * backsubstitute_gemm.c and implicit_conv.c, used when the library is
+ * configured with vector support (-DVECTOR, -march=native); FPPOLY_SIMD is
+ * defined then. The kernels run under the same upward rounding mode as the
+ * scalar code: the negated lower and the upper bound of a product are the
+ * largest of the four upward rounded corner products, which is exactly what
+ * the scalar case split selects, and sums of upward rounded terms stay upper
+ * bounds in any order. A corner product 0*inf counts as 0, as in
+ * elina_double_interval_mul.
+ */
+#if defined(VECTOR) && (defined(__AVX512F__) || defined(__AVX2__))
+#include <immintrin.h>
+#define FPPOLY_SIMD
+#if defined(__AVX512F__)
+#define VLEN 8
+typedef __m512d vdouble;
+#define vset1(x) _mm512_set1_pd(x)
+#define vload(p) _mm512_loadu_pd(p)
+#define vstore(p,x) _mm512_storeu_pd(p,x)
+#define vadd(x,y) _mm512_add_pd(x,y)
+#define vmul(x,y) _mm512_mul_pd(x,y)
+#define vmax(x,y) _mm512_max_pd(x,y)
+#define vabs(x) _mm512_abs_pd(x)
+#define vneg(x) _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x), _mm512_set1_epi64(INT64_MIN)))
+#define vnan0(x) _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, x, _CMP_ORD_Q), x)
+/* b where w < 0, a elsewhere */
+#define vselect_neg(w,a,b) _mm512_mask_blend_pd(_mm512_cmp_pd_mask(w, _mm512_setzero_pd(), _CMP_LT_OQ), a, b)
+#else
+#define VLEN 4
+typedef __m256d vdouble;
+#define vset1(x) _mm256_set1_pd(x)
+#define vload(p) _mm256_loadu_pd(p)
+#define vstore(p,x) _mm256_storeu_pd(p,x)
+#define vadd(x,y) _mm256_add_pd(x,y)
+#define vmul(x,y) _mm256_mul_pd(x,y)
+#define vmax(x,y) _mm256_max_pd(x,y)
+#define vabs(x) _mm256_andnot_pd(_mm256_set1_pd(-0.0), x)
+#define vneg(x) _mm256_xor_pd(x, _mm256_set1_pd(-0.0))
+#define vnan0(x) _mm256_and_pd(x, _mm256_cmp_pd(x, x, _CMP_ORD_Q))
+#define vselect_neg(w,a,b) _mm256_blendv_pd(a, b, _mm256_cmp_pd(w, _mm256_setzero_pd(), _CMP_LT_OQ))
+#endif
+
+static inline void vinterval_mul(vdouble *a_inf, vdouble *a_sup, vdouble b_inf, vdouble b_sup, vdouble c_inf, vdouble c_sup){
+	vdouble nb_inf = vneg(b_inf);
+	vdouble nb_sup = vneg(b_sup);
+	*a_inf = vmax(vmax(vnan0(vmul(nb_inf,c_inf)), vnan0(vmul(b_inf,c_sup))), vmax(vnan0(vmul(b_sup,c_inf)), vnan0(vmul(nb_sup,c_sup))));
+	*a_sup = vmax(vmax(vnan0(vmul(b_inf,c_inf)), vnan0(vmul(nb_inf,c_sup))), vmax(vnan0(vmul(nb_sup,c_inf)), vnan0(vmul(b_sup,c_sup))));
+}
+
+static inline double vsum(vdouble x){
+	double tmp[VLEN];
+	double res = 0.0;
+	size_t i;
+	vstore(tmp, x);
+	for(i=0; i < VLEN; i++){
+		res = res + tmp[i];
+	}
+	return res;
+}
+#endif
+
+#endif
@@ -0,0 +1,637 @@
+#include "spatial_lp.h"
+
+#define LP_PRIMAL_TOL 1e-9
+#define LP_DUAL_TOL 1e-9
+#define LP_PIVOT_TOL 1e-9
+/* basis updates between two reinversions, which also recompute the basic values and reduced costs */
+#define LP_REINVERT 100
+
+/*
+ * Bounded revised dual simplex. The row activities r = A x are variables
+ * like the columns, so the problem is A x - r = 0 with every variable
+ * boxed, and any basis can be made dual feasible by moving the nonbasic
+ * variables to the bound their reduced cost asks for. This is what lets a
+ * new objective start from the final basis of the previous one.
+ *
+ * The basis inverse is kept in product form: B = -I E_1 ... E_k where
+ * every eta matrix E_l is the identity but for the column at position
+ * eta_pos[l]. Reinversion rebuilds the file from the slack basis with one
+ * eta per structural basic variable.
+ */
+typedef struct lp_breakpoint_t{
+	double ratio;
+	size_t col;
+}lp_breakpoint_t;
+
+typedef struct dual_simplex_t{
+	/* number of structural (and nonbasic) variables and of rows (basic variables) */
+	size_t n;
+	size_t m;
+	/* bounds and costs of the n+m variables: the columns, then the row activities */
+	double *lb;
+	double *ub;
+	double *cost;
+	/* A by columns */
+	size_t *col_start;
+	size_t *row_index;
+	double *col_value;
+	/* variable at each basis position and at each nonbasic position */
+	size_t *basic;
+	size_t *nonbasic;
+	bool *at_upper;
+	double *x_basic;
+	double *x_nonbasic;
+	/* reduced costs of the nonbasic variables */
+	double *d;
+	/* eta file */
+	size_t num_etas;
+	size_t num_updates;
+	size_t max_etas;
+	size_t max_eta_nonzeros;
+	size_t *eta_pos;
+	double *eta_pivot;
+	size_t *eta_start;
+	size_t *eta_index;
+	double *eta_value;
+	/* work vectors of size m, m, n and n+m */
+	double *work_col;
+	double *work_row;
+	double *work_pivot_row;
+	double *work_var;
+	lp_breakpoint_t *work_breakpoints;
+	bool is_fresh;
+}dual_simplex_t;
+
+
+/* v = B^{-1} v */
+static void dual_simplex_ftran(dual_simplex_t *ds, double *v){
+	size_t i, k, l;
+	for(i=0; i < ds->m; i++){
+		v[i] = -v[i];
+	}
+	for(k=0; k < ds->num_etas; k++){
+		size_t r = ds->eta_pos[k];
+		if(v[r]==0){
+			continue;
+		}
+		v[r] = v[r]/ds->eta_pivot[k];
+		for(l=ds->eta_start[k]; l < ds->eta_start[k+1]; l++){
+			v[ds->eta_index[l]] -= ds->eta_value[l]*v[r];
+		}
+	}
+}
+
+
+/* u^T = u^T B^{-1} */
+static void dual_simplex_btran(dual_simplex_t *ds, double *u){
+	size_t i, k, l;
+	for(k=ds->num_etas; k-- > 0;){
+		size_t r = ds->eta_pos[k];
+		double sum = u[r];
+		for(l=ds->eta_start[k]; l < ds->eta_start[k+1]; l++){
+			sum -= u[ds->eta_index[l]]*ds->eta_value[l];
+		}
+		u[r] = sum/ds->eta_pivot[k];
+	}
+	for(i=0; i < ds->m; i++){
+		u[i] = -u[i];
+	}
+}
+
+
+/* v += x times the column of variable var in [A -I] */
+static void dual_simplex_add_col(dual_simplex_t *ds, size_t var, double x, double *v){
+	size_t l;
+	if(var < ds->n){
+		for(l=ds->col_start[var]; l < ds->col_start[var+1]; l++){
+			v[ds->row_index[l]] += ds->col_value[l]*x;
+		}
+	}
+	else{
+		v[var-ds->n] -= x;
+	}
+}
+
+
+/* appends the eta of the column alpha = B^{-1} a entering at position r */
+static void dual_simplex_add_eta(dual_simplex_t *ds, size_t r, double *alpha){
+	size_t i;
+	if(ds->num_etas==ds->max_etas){
+		ds->max_etas = 2*ds->max_etas;
+		ds->eta_pos = (size_t *)realloc(ds->eta_pos, ds->max_etas*sizeof(size_t));
+		ds->eta_pivot = (double *)realloc(ds->eta_pivot, ds->max_etas*sizeof(double));
+		ds->eta_start = (size_t *)realloc(ds->eta_start, (ds->max_etas+1)*sizeof(size_t));
+	}
+	size_t k = ds->num_etas;
+	size_t end = ds->eta_start[k];
+	if(end + ds->m > ds->max_eta_nonzeros){
+		ds->max_eta_nonzeros = 2*ds->max_eta_nonzeros + ds->m;
+		ds->eta_index = (size_t *)realloc(ds->eta_index, ds->max_eta_nonzeros*sizeof(size_t));
+		ds->eta_value = (double *)realloc(ds->eta_value, ds->max_eta_nonzeros*sizeof(double));
+	}
+	for(i=0; i < ds->m; i++){
+		if(i!=r && alpha[i]!=0){
+			ds->eta_index[end] = i;
+			ds->eta_value[end] = alpha[i];
+			end++;
+		}
+	}
+	ds->eta_pos[k] = r;
+	ds->eta_pivot[k] = alpha[r];
+	ds->eta_start[k+1] = end;
+	ds->num_etas++;
+}
+
+
+static void dual_simplex_reset(dual_simplex_t *ds){
+	size_t i, j;
+	for(i=0; i < ds->m; i++){
+		ds->basic[i] = ds->n + i;
+	}
+	for(j=0; j < ds->n; j++){
+		ds->nonbasic[j] = j;
+		ds->at_upper[j] = false;
+	}
+	ds->num_etas = 0;
+	ds->num_updates = 0;
+	ds->is_fresh = true;
+}
+
+
+/*
+ * Rebuilds the eta file of the current basis from the slack basis,
+ * structural columns with few nonzeros first, each pivoting on its largest
+ * entry among the positions not taken yet. Returns false if the basis is
+ * numerically singular.
+ */
+static bool dual_simplex_reinvert(dual_simplex_t *ds){
+	size_t n = ds->n;
+	size_t m = ds->m;
+	size_t i, j, k;
+	bool *is_taken = (bool *)calloc(m, sizeof(bool));
+	size_t *order = (size_t *)malloc(m*sizeof(size_t));
+	size_t num_structurals = 0;
+	bool res = true;
+	for(i=0; i < m; i++){
+		if(ds->basic[i] >= n){
+			is_taken[ds->basic[i]-n] = true;
+		}
+		else{
+			order[num_structurals++] = ds->basic[i];
+		}
+	}
+	/* insertion sort by column length, the spatial LP only has a handful of distinct lengths */
+	for(j=1; j < num_structurals; j++){
+		size_t var = order[j];
+		size_t len = ds->col_start[var+1] - ds->col_start[var];
+		for(k=j; k > 0 && ds->col_start[order[k-1]+1] - ds->col_start[order[k-1]] > len; k--){
+			order[k] = order[k-1];
+		}
+		order[k] = var;
+	}
+	for(i=0; i < m; i++){
+		ds->basic[i] = n + i;
+	}
+	ds->num_etas = 0;
+	double *alpha = ds->work_col;
+	for(j=0; j < num_structurals; j++){
+		size_t var = order[j];
+		memset(alpha, 0, m*sizeof(double));
+		dual_simplex_add_col(ds, var, 1, alpha);
+		dual_simplex_ftran(ds, alpha);
+		size_t r = m;
+		double max = LP_PIVOT_TOL;
+		for(i=0; i < m; i++){
+			if(!is_taken[i] && fabs(alpha[i]) > max){
+				max = fabs(alpha[i]);
+				r = i;
+			}
+		}
+		if(r==m){
+			res = false;
+			break;
+		}
+		dual_simplex_add_eta(ds, r, alpha);
+		is_taken[r] = true;
+		ds->basic[r] = var;
+	}
+	free(is_taken);
+	free(order);
+	ds->num_updates = 0;
+	return res;
+}
+
+
+/* x_basic = -B^{-1} N x_nonbasic */
+static void dual_simplex_compute_x_basic(dual_simplex_t *ds){
+	size_t i, j;
+	double *v = ds->x_basic;
+	memset(v, 0, ds->m*sizeof(double));
+	for(j=0; j < ds->n; j++){
+		if(ds->x_nonbasic[j]!=0){
+			dual_simplex_add_col(ds, ds->nonbasic[j], ds->x_nonbasic[j], v);
+		}
+	}
+	dual_simplex_ftran(ds, v);
+	for(i=0; i < ds->m; i++){
+		v[i] = -v[i];
+	}
+}
+
+
+/* res[j] = u^T a_j for every nonbasic variable j */
+static void dual_simplex_row_product(dual_simplex_t *ds, lp_t *lp, double *u, double *res){
+	size_t n = ds->n;
+	size_t i, j, l;
+	double *acc = ds->work_var;
+	memset(acc, 0, n*sizeof(double));
+	for(i=0; i < ds->m; i++){
+		acc[n+i] = -u[i];
+		if(u[i]==0){
+			continue;
+		}
+		for(l=lp->row_start[i]; l < lp->row_start[i+1]; l++){
+			acc[lp->col_index[l]] += u[i]*lp->value[l];
+		}
+	}
+	for(j=0; j < n; j++){
+		res[j] = acc[ds->nonbasic[j]];
+	}
+}
+
+
+/* d = c_N - c_B^T B^{-1} N, nonbasic variables at the bound their reduced cost asks for, basic values to match */
+static void dual_simplex_restart(dual_simplex_t *ds, lp_t *lp, double dual_tol){
+	size_t i, j;
+	double *u = ds->work_row;
+	for(i=0; i < ds->m; i++){
+		u[i] = ds->cost[ds->basic[i]];
+	}
+	dual_simplex_btran(ds, u);
+	dual_simplex_row_product(ds, lp, u, ds->d);
+	for(j=0; j < ds->n; j++){
+		size_t var = ds->nonbasic[j];
+		ds->d[j] = ds->cost[var] - ds->d[j];
+		if(ds->d[j] > dual_tol){
+			ds->at_upper[j] = false;
+		}
+		else if(ds->d[j] < -dual_tol){
+			ds->at_upper[j] = true;
+		}
+		ds->x_nonbasic[j] = ds->at_upper[j] ? ds->ub[var] : ds->lb[var];
+	}
+	dual_simplex_compute_x_basic(ds);
+}
+
+
+/* the most infeasible basic variable, m if there is none */
+static size_t dual_simplex_leaving_row(dual_simplex_t *ds){
+	size_t i, r = ds->m;
+	double max = 0.0;
+	for(i=0; i < ds->m; i++){
+		size_t var = ds->basic[i];
+		double x = ds->x_basic[i];
+		double infeasibility = 0.0;
+		if(x < ds->lb[var] - LP_PRIMAL_TOL*(1+fabs(ds->lb[var]))){
+			infeasibility = ds->lb[var] - x;
+		}
+		else if(x > ds->ub[var] + LP_PRIMAL_TOL*(1+fabs(ds->ub[var]))){
+			infeasibility = x - ds->ub[var];
+		}
+		if(infeasibility > max){
+			max = infeasibility;
+			r = i;
+		}
+	}
+	return r;
+}
+
+
+static int lp_breakpoint_cmp(const void *a, const void *b){
+	double ra = ((const lp_breakpoint_t *)a)->ratio;
+	double rb = ((const lp_breakpoint_t *)b)->ratio;
+	return ra < rb ? -1 : (ra > rb ? 1 : 0);
+}
+
+
+/*
+ * Ratio test on the row x_basic[r] = row^T x_nonbasic, infeasibility away
+ * from its bound. The nonbasic variables whose move takes the leaving
+ * variable towards its bound zero their reduced costs in the order of the
+ * breakpoints; as long as the infeasibility is not used up by the earlier
+ * ones they only flip to their other bound (the pivot fixes the signs of
+ * their reduced costs this way). Among the breakpoints left, the Harris
+ * pass prefers large pivots within the tolerance. n if there is none.
+ */
+static size_t dual_simplex_entering_col(dual_simplex_t *ds, double *row, bool increase, double infeasibility, double dual_tol){
+	size_t n = ds->n;
+	size_t j, k, q = n;
+	size_t num_breakpoints = 0;
+	lp_breakpoint_t *breakpoints = ds->work_breakpoints;
+	for(j=0; j < n; j++){
+		size_t var = ds->nonbasic[j];
+		double a = increase==ds->at_upper[j] ? -row[j] : row[j];
+		if(a <= LP_PIVOT_TOL || ds->lb[var]==ds->ub[var]){
+			continue;
+		}
+		breakpoints[num_breakpoints].ratio = fabs(ds->d[j])/a;
+		breakpoints[num_breakpoints].col = j;
+		num_breakpoints++;
+	}
+	if(num_breakpoints==0){
+		return n;
+	}
+	qsort(breakpoints, num_breakpoints, sizeof(lp_breakpoint_t), lp_breakpoint_cmp);
+	double slope = infeasibility;
+	size_t first = 0;
+	while(first + 1 < num_breakpoints){
+		j = breakpoints[first].col;
+		size_t var = ds->nonbasic[j];
+		slope -= fabs(row[j])*(ds->ub[var] - ds->lb[var]);
+		if(slope <= 0){
+			break;
+		}
+		first++;
+	}
+	double theta_max = INFINITY;
+	for(k=first; k < num_breakpoints; k++){
+		j = breakpoints[k].col;
+		double ratio = (fabs(ds->d[j]) + dual_tol)/fabs(row[j]);
+		if(ratio < theta_max){
+			theta_max = ratio;
+		}
+	}
+	double max_pivot = 0.0;
+	for(k=first; k < num_breakpoints && breakpoints[k].ratio <= theta_max; k++){
+		j = breakpoints[k].col;
+		if(fabs(row[j]) > max_pivot){
+			max_pivot = fabs(row[j]);
+			q = j;
+		}
+	}
+	return q;
+}
+
+
+/*
+ * Exchanges the basic variable at position r, which leaves at the bound it
+ * is moved to, with the nonbasic variable at position q. row is row r and
+ * col column q of -B^{-1} N.
+ */
+static void dual_simplex_pivot(dual_simplex_t *ds, size_t r, size_t q, double *row, double *col, bool increase, double dual_tol){
+	size_t n = ds->n;
+	size_t i, j;
+	double pivot = row[q];
+	size_t leaving = ds->basic[r];
+	double bound = increase ? ds->lb[leaving] : ds->ub[leaving];
+
+	double theta = ds->d[q]/pivot;
+	for(j=0; j < n; j++){
+		ds->d[j] -= theta*row[j];
+	}
+	ds->d[q] = theta;
+
+	double delta = (bound - ds->x_basic[r])/pivot;
+	for(i=0; i < ds->m; i++){
+		ds->x_basic[i] += col[i]*delta;
+	}
+	ds->x_basic[r] = ds->x_nonbasic[q] + delta;
+	ds->x_nonbasic[q] = bound;
+	ds->at_upper[q] = !increase;
+	ds->basic[r] = ds->nonbasic[q];
+	ds->nonbasic[q] = leaving;
+
+	/* the row and the column computed through the eta file disagree on the pivot when it has become inaccurate */
+	if(fabs(col[r] - pivot) > 1e-7*(1+fabs(pivot))){
+		ds->num_updates = LP_REINVERT;
+	}
+	for(i=0; i < ds->m; i++){
+		col[i] = -col[i];
+	}
+	dual_simplex_add_eta(ds, r, col);
+	ds->num_updates++;
+
+	/* the Harris step may leave small reduced costs of the wrong sign, larger ones are fixed by a bound flip */
+	double *shift = ds->work_row;
+	bool is_flipped = false;
+	memset(shift, 0, ds->m*sizeof(double));
+	for(j=0; j < n; j++){
+		if(ds->at_upper[j] ? ds->d[j] <= 0 : ds->d[j] >= 0){
+			continue;
+		}
+		if(fabs(ds->d[j]) <= dual_tol){
+			ds->d[j] = 0.0;
+			continue;
+		}
+		size_t var = ds->nonbasic[j];
+		double x = ds->at_upper[j] ? ds->lb[var] : ds->ub[var];
+		dual_simplex_add_col(ds, var, x - ds->x_nonbasic[j], shift);
+		ds->x_nonbasic[j] = x;
+		ds->at_upper[j] = !ds->at_upper[j];
+		is_flipped = true;
+	}
+	if(is_flipped){
+		dual_simplex_ftran(ds, shift);
+		for(i=0; i < ds->m; i++){
+			ds->x_basic[i] -= shift[i];
+		}
+	}
+}
+
+
+static bool dual_simplex_run(dual_simplex_t *ds, lp_t *lp, const double *obj){
+	size_t n = ds->n;
+	size_t m = ds->m;
+	size_t i, j, iter;
+	double max_cost = 0.0;
+	memcpy(ds->cost, obj, n*sizeof(double));
+	memset(ds->cost+n, 0, m*sizeof(double));
+	for(j=0; j < n; j++){
+		max_cost = fmax(max_cost, fabs(obj[j]));
+	}
+	double dual_tol = LP_DUAL_TOL*(1+max_cost);
+	dual_simplex_restart(ds, lp, dual_tol);
+
+	double *row = ds->work_pivot_row;
+	double *col = ds->work_col;
+	double *u = ds->work_row;
+	size_t max_iter = 10*(n+m);
+	for(iter=0; iter < max_iter; iter++){
+		if(ds->num_updates >= LP_REINVERT){
+			if(!dual_simplex_reinvert(ds)){
+				return false;
+			}
+			dual_simplex_restart(ds, lp, dual_tol);
+		}
+		size_t r = dual_simplex_leaving_row(ds);
+		if(r==m){
+			return true;
+		}
+		size_t leaving = ds->basic[r];
+		bool increase = ds->x_basic[r] < ds->lb[leaving];
+		double infeasibility = increase ? ds->lb[leaving] - ds->x_basic[r] : ds->x_basic[r] - ds->ub[leaving];
+		/* row r of -B^{-1} N */
+		memset(u, 0, m*sizeof(double));
+		u[r] = -1;
+		dual_simplex_btran(ds, u);
+		dual_simplex_row_product(ds, lp, u, row);
+		size_t q = dual_simplex_entering_col(ds, row, increase, infeasibility, dual_tol);
+		if(q==n){
+			/* the row cannot reach its bound: primal infeasible */
+			return false;
+		}
+		/* column q of -B^{-1} N */
+		memset(col, 0, m*sizeof(double));
+		dual_simplex_add_col(ds, ds->nonbasic[q], -1, col);
+		dual_simplex_ftran(ds, col);
+		dual_simplex_pivot(ds, r, q, row, col, increase, dual_tol);
+		ds->is_fresh = false;
+	}
+	return false;
+}
+
+
+/* largest violation of A x = r by the current solution, relative to the size of the row */
+static double dual_simplex_residual(dual_simplex_t *ds, lp_t *lp){
+	size_t n = ds->n;
+	size_t m = ds->m;
+	size_t i, j;
+	double *x = ds->work_var;
+	double max = 0.0;
+	for(j=0; j < n; j++){
+		x[ds->nonbasic[j]] = ds->x_nonbasic[j];
+	}
+	for(i=0; i < m; i++){
+		x[ds->basic[i]] = ds->x_basic[i];
+	}
+	for(i=0; i < m; i++){
+		double sum = -x[n+i];
+		double scale = 1 + fabs(x[n+i]);
+		for(j=lp->row_start[i]; j < lp->row_start[i+1]; j++){
+			sum += lp->value[j]*x[lp->col_index[j]];
+			scale += fabs(lp->value[j]*x[lp->col_index[j]]);
+		}
+		max = fmax(max, fabs(sum)/scale);
+	}
+	return max;
+}
+
+
+static bool dual_simplex_solve(void *solver, lp_t *lp, const double *obj, double *y){
+	dual_simplex_t *ds = (dual_simplex_t *)solver;
+	size_t n = ds->n;
+	size_t i, j;
+	bool is_optimal = dual_simplex_run(ds, lp, obj);
+	/* start over from the slack basis if the warm start failed or drifted */
+	if(!ds->is_fresh && (!is_optimal || dual_simplex_residual(ds, lp) > 1e-7)){
+		dual_simplex_reset(ds);
+		is_optimal = dual_simplex_run(ds, lp, obj);
+	}
+	for(i=0; i < ds->m; i++){
+		y[i] = 0.0;
+	}
+	/* the reduced cost of a nonbasic row activity is the multiplier of its row */
+	for(j=0; j < n; j++){
+		if(ds->nonbasic[j] >= n){
+			y[ds->nonbasic[j]-n] = ds->d[j];
+		}
+	}
+	if(!is_optimal){
+		dual_simplex_reset(ds);
+	}
+	return is_optimal;
+}
+
+
+static void * dual_simplex_alloc(lp_t *lp){
+	dual_simplex_t *ds = (dual_simplex_t *)malloc(sizeof(dual_simplex_t));
+	size_t n = lp->num_cols;
+	size_t m = lp->num_rows;
+	size_t nnz = lp->row_start[m];
+	size_t i, j, l;
+	ds->n = n;
+	ds->m = m;
+	ds->lb = (double *)malloc((n+m)*sizeof(double));
+	ds->ub = (double *)malloc((n+m)*sizeof(double));
+	ds->cost = (double *)malloc((n+m)*sizeof(double));
+	memcpy(ds->lb, lp->col_lb, n*sizeof(double));
+	memcpy(ds->ub, lp->col_ub, n*sizeof(double));
+	memcpy(ds->lb+n, lp->row_lb, m*sizeof(double));
+	memcpy(ds->ub+n, lp->row_ub, m*sizeof(double));
+	ds->col_start = (size_t *)calloc(n+1, sizeof(size_t));
+	ds->row_index = (size_t *)malloc(nnz*sizeof(size_t));
+	ds->col_value = (double *)malloc(nnz*sizeof(double));
+	for(l=0; l < nnz; l++){
+		ds->col_start[lp->col_index[l]+1]++;
+	}
+	for(j=0; j < n; j++){
+		ds->col_start[j+1] += ds->col_start[j];
+	}
+	size_t *next = (size_t *)malloc(n*sizeof(size_t));
+	memcpy(next, ds->col_start, n*sizeof(size_t));
+	for(i=0; i < m; i++){
+		for(l=lp->row_start[i]; l < lp->row_start[i+1]; l++){
+			size_t k = next[lp->col_index[l]]++;
+			ds->row_index[k] = i;
+			ds->col_value[k] = lp->value[l];
+		}
+	}
+	free(next);
+	ds->basic = (size_t *)malloc(m*sizeof(size_t));
+	ds->nonbasic = (size_t *)malloc(n*sizeof(size_t));
+	ds->at_upper = (bool *)malloc(n*sizeof(bool));
+	ds->x_basic = (double *)malloc(m*sizeof(double));
+	ds->x_nonbasic = (double *)malloc(n*sizeof(double));
+	ds->d = (double *)malloc(n*sizeof(double));
+	ds->max_etas = m + LP_REINVERT + 1;
+	ds->max_eta_nonzeros = nnz + m;
+	ds->eta_pos = (size_t *)malloc(ds->max_etas*sizeof(size_t));
+	ds->eta_pivot = (double *)malloc(ds->max_etas*sizeof(double));
+	ds->eta_start = (size_t *)malloc((ds->max_etas+1)*sizeof(size_t));
+	ds->eta_index = (size_t *)malloc(ds->max_eta_nonzeros*sizeof(size_t));
+	ds->eta_value = (double *)malloc(ds->max_eta_nonzeros*sizeof(double));
+	ds->eta_start[0] = 0;
+	ds->work_col = (double *)malloc(m*sizeof(double));
+	ds->work_row = (double *)malloc(m*sizeof(double));
+	ds->work_pivot_row = (double *)malloc(n*sizeof(double));
+	ds->work_var = (double *)malloc((n+m)*sizeof(double));
+	ds->work_breakpoints = (lp_breakpoint_t *)malloc(n*sizeof(lp_breakpoint_t));
+	dual_simplex_reset(ds);
+	return ds;
+}
+
+
+static void dual_simplex_free(void *solver){
+	dual_simplex_t *ds = (dual_simplex_t *)solver;
+	free(ds->lb);
+	free(ds->ub);
+	free(ds->cost);
+	free(ds->col_start);
+	free(ds->row_index);
+	free(ds->col_value);
+	free(ds->basic);
+	free(ds->nonbasic);
+	free(ds->at_upper);
+	free(ds->x_basic);
+	free(ds->x_nonbasic);
+	free(ds->d);
+	free(ds->eta_pos);
+	free(ds->eta_pivot);
+	free(ds->eta_start);
+	free(ds->eta_index);
+	free(ds->eta_value);
+	free(ds->work_col);
+	free(ds->work_row);
+	free(ds->work_pivot_row);
+	free(ds->work_var);
+	free(ds->work_breakpoints);
+	free(ds);
+}
+
+
+const lp_backend_t lp_dual_simplex_backend = {
+	"simplex",
+	dual_simplex_alloc,
+	dual_simplex_solve,
+	dual_simplex_free,
+};
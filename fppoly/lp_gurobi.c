@@ -0,0 +1,92 @@
+#ifdef GUROBI
+#include <stdio.h>
+
+#include "gurobi_c.h"
+#include "spatial_lp.h"
+
+typedef struct gurobi_lp_t{
+	GRBenv *env;
+	GRBmodel *model;
+}gurobi_lp_t;
+
+
+static void handle_gurobi_error(int error, GRBenv *env){
+	if(error){
+		printf("Gurobi error: %s\n", GRBgeterrormsg(env));
+		exit(1);
+	}
+}
+
+
+static void * gurobi_lp_alloc(lp_t *lp){
+	gurobi_lp_t *glp = (gurobi_lp_t *)malloc(sizeof(gurobi_lp_t));
+	size_t i, j;
+	int error;
+	glp->env = NULL;
+	glp->model = NULL;
+	error = GRBemptyenv(&glp->env);
+	handle_gurobi_error(error, glp->env);
+	error = GRBsetintparam(glp->env, "OutputFlag", 0);
+	handle_gurobi_error(error, glp->env);
+	error = GRBsetintparam(glp->env, "NumericFocus", 2);
+	handle_gurobi_error(error, glp->env);
+	error = GRBstartenv(glp->env);
+	handle_gurobi_error(error, glp->env);
+
+	error = GRBnewmodel(glp->env, &glp->model, NULL, lp->num_cols, NULL, lp->col_lb, lp->col_ub, NULL, NULL);
+	handle_gurobi_error(error, glp->env);
+	int *ind = (int *)malloc(lp->num_cols*sizeof(int));
+	for(i=0; i < lp->num_rows; i++){
+		size_t start = lp->row_start[i];
+		size_t size = lp->row_start[i+1] - start;
+		for(j=0; j < size; j++){
+			ind[j] = (int)lp->col_index[start+j];
+		}
+		error = GRBaddrangeconstr(glp->model, size, ind, lp->value + start, lp->row_lb[i], lp->row_ub[i], NULL);
+		handle_gurobi_error(error, glp->env);
+	}
+	free(ind);
+	error = GRBupdatemodel(glp->model);
+	handle_gurobi_error(error, glp->env);
+	return glp;
+}
+
+
+static bool gurobi_lp_solve(void *solver, lp_t *lp, const double *obj, double *y){
+	gurobi_lp_t *glp = (gurobi_lp_t *)solver;
+	size_t i;
+	int error, status;
+	error = GRBsetdblattrarray(glp->model, GRB_DBL_ATTR_OBJ, 0, lp->num_cols, (double *)obj);
+	handle_gurobi_error(error, glp->env);
+	error = GRBoptimize(glp->model);
+	handle_gurobi_error(error, glp->env);
+	error = GRBgetintattr(glp->model, GRB_INT_ATTR_STATUS, &status);
+	handle_gurobi_error(error, glp->env);
+	if(status!=GRB_OPTIMAL){
+		for(i=0; i < lp->num_rows; i++){
+			y[i] = 0.0;
+		}
+		return false;
+	}
+	/* the multipliers of the range rows, the slack columns Gurobi adds for them do not matter for weak duality */
+	error = GRBgetdblattrarray(glp->model, GRB_DBL_ATTR_PI, 0, lp->num_rows, y);
+	handle_gurobi_error(error, glp->env);
+	return true;
+}
+
+
+static void gurobi_lp_free(void *solver){
+	gurobi_lp_t *glp = (gurobi_lp_t *)solver;
+	GRBfreemodel(glp->model);
+	GRBfreeenv(glp->env);
+	free(glp);
+}
+
+
+const lp_backend_t lp_gurobi_backend = {
+	"gurobi",
+	gurobi_lp_alloc,
+	gurobi_lp_solve,
+	gurobi_lp_free,
+};
+#endif
@@ -0,0 +1,185 @@
+#include "reanalysis.h"
+
+void layer_mark_changed(layer_t *layer, size_t neuron_no){
+	if(layer->changed==NULL){
+		layer->changed = (char *)calloc(layer->dims, sizeof(char));
+	}
+	layer->changed[neuron_no] = 1;
+}
+
+
+static bool expr_reads_affected(expr_t *expr, char *affected, size_t num_affected){
+	size_t i;
+	for(i=0; i < expr->size; i++){
+		size_t k = expr->type==DENSE ? i : expr->dim[i];
+		if(k < num_affected && affected[k] && (expr->inf_coeff[i]!=0 || expr->sup_coeff[i]!=0)){
+			return true;
+		}
+	}
+	return false;
+}
+
+
+static bool neuron_reads_affected(layer_t *layer, size_t i, char *affected, size_t num_affected){
+	neuron_t *neuron = layer->neurons[i];
+	if(layer->conv!=NULL){
+		expr_t *expr = conv_neuron_expr(layer->conv, i);
+		bool res = expr_reads_affected(expr, affected, num_affected);
+		free_expr(expr);
+		return res;
+	}
+	return expr_reads_affected(neuron->lexpr, affected, num_affected) || expr_reads_affected(neuron->uexpr, affected, num_affected);
+}
+
+
+/*
+ * Marks the neurons of layer k whose bounds or relaxation depend on an
+ * affected neuron of a predecessor, returns false if there is none. Layers
+ * whose dependencies are not visible from their expressions (LSTM layers,
+ * freed expressions, activations that change the shape) are affected as a
+ * whole as soon as one of their inputs is.
+ */
+static bool mark_affected_neurons(fppoly_t *fp, char **affected, size_t k){
+	layer_t *layer = fp->layers[k];
+	size_t dims = layer->dims;
+	size_t i, j, offset = 0;
+	bool any_input = false, any = false;
+	for(j=0; j < layer->num_predecessors; j++){
+		size_t pred = layer->predecessors[j];
+		if(pred > 0 && affected[pred-1]!=NULL){
+			any_input = true;
+		}
+	}
+	if(!any_input && layer->changed==NULL){
+		return false;
+	}
+	affected[k] = (char *)calloc(dims, sizeof(char));
+	if(any_input){
+		bool visible = layer->h_t_inf==NULL;
+		for(i=0; visible && i < dims; i++){
+			visible = layer->conv!=NULL || (layer->neurons[i]->lexpr!=NULL && layer->neurons[i]->uexpr!=NULL);
+		}
+		if(layer->is_activation){
+			size_t pred = layer->predecessors[0];
+			visible = layer->num_predecessors==1 && pred > 0 && fp->layers[pred-1]->dims==dims;
+		}
+		for(j=0; j < layer->num_predecessors; j++){
+			size_t pred = layer->predecessors[j];
+			char *in = pred > 0 ? affected[pred-1] : NULL;
+			size_t num_in = pred > 0 ? fp->layers[pred-1]->dims : 0;
+			if(in==NULL){
+				offset += num_in;
+				continue;
+			}
+			for(i=0; i < dims; i++){
+				if(affected[k][i]){
+					continue;
+				}
+				if(!visible){
+					affected[k][i] = 1;
+				}
+				else if(layer->is_activation){
+					affected[k][i] = in[i];
+				}
+				else if(layer->is_concat){
+					affected[k][i] = i >= offset && i < offset + num_in && in[i-offset];
+				}
+				else{
+					affected[k][i] = neuron_reads_affected(layer, i, in, num_in);
+				}
+			}
+			offset += num_in;
+		}
+	}
+	for(i=0; i < dims; i++){
+		if(layer->changed!=NULL && layer->changed[i]){
+			affected[k][i] = 1;
+		}
+		any = any || affected[k][i];
+	}
+	if(!any){
+		free(affected[k]);
+		affected[k] = NULL;
+	}
+	return any;
+}
+
+
+/* recomputes the affected neurons of layer k that were not set from outside, returns their number */
+static size_t recompute_affected_neurons(elina_manager_t *man, fppoly_t *fp, char **affected, size_t k){
+	layer_t *layer = fp->layers[k];
+	size_t dims = layer->dims;
+	size_t i, j, num_neurons = 0;
+	size_t *neurons = (size_t *)malloc(dims*sizeof(size_t));
+	for(i=0; i < dims; i++){
+		if(affected[k][i] && (layer->changed==NULL || !layer->changed[i])){
+			neurons[num_neurons++] = i;
+		}
+	}
+	if(layer->is_activation){
+		/* other activations keep their relaxation, it stays sound for the tighter input bounds */
+		if(!layer->is_relu){
+			num_neurons = 0;
+		}
+		for(i=0; i < num_neurons; i++){
+			update_relu_neuron(fp, layer, neurons[i]);
+		}
+	}
+	else if(layer->is_concat){
+		for(i=0; i < num_neurons; i++){
+			size_t offset = 0;
+			for(j=0; j < layer->num_predecessors; j++){
+				layer_t *pred = fp->layers[layer->predecessors[j]-1];
+				if(neurons[i] < offset + pred->dims){
+					layer->neurons[neurons[i]]->lb = pred->neurons[neurons[i]-offset]->lb;
+					layer->neurons[neurons[i]]->ub = pred->neurons[neurons[i]-offset]->ub;
+					break;
+				}
+				offset += pred->dims;
+			}
+		}
+	}
+	else if(layer->h_t_inf!=NULL){
+		num_neurons = 0;
+	}
+	else{
+		for(i=0; i < num_neurons; i++){
+			neuron_t *neuron = layer->neurons[neurons[i]];
+			if(layer->conv==NULL && (neuron->lexpr==NULL || neuron->uexpr==NULL)){
+				num_neurons = 0;
+			}
+		}
+		if(num_neurons > 0){
+			update_state_of_neurons_parallel(man, fp, k, neurons, num_neurons);
+		}
+	}
+	free(neurons);
+	return num_neurons;
+}
+
+
+/*
+ * Brings the element up to date after update_bounds_for_neuron and
+ * update_activation_*_bound_for_neuron: only the ReLU relaxations and the
+ * neuron bounds that depend on a changed neuron are recomputed, the changed
+ * neurons themselves keep the values they were given. Returns the number of
+ * recomputed neurons.
+ */
+size_t fppoly_reanalyze(elina_manager_t *man, elina_abstract0_t *element){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	size_t numlayers = fp->numlayers;
+	size_t k, res = 0;
+	char **affected = (char **)calloc(numlayers, sizeof(char *));
+	for(k=0; k < numlayers; k++){
+		if(mark_affected_neurons(fp, affected, k)){
+			res += recompute_affected_neurons(man, fp, affected, k);
+		}
+	}
+	for(k=0; k < numlayers; k++){
+		free(affected[k]);
+		free(fp->layers[k]->changed);
+		fp->layers[k]->changed = NULL;
+	}
+	free(affected);
+	return res;
+}
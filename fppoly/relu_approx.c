@@ -66,6 +66,9 @@ void handle_relu_layer(elina_manager_t *man, elina_abstract0_t* element, size_t
 	neuron_t **in_neurons = fp->layers[k]->neurons;
 	size_t i;
 	
+	fp->layers[numlayers]->is_relu = true;
+	fp->layers[numlayers]->use_default_heuristics = use_default_heuristics;
+	
 	for(i=0; i < num_neurons; i++){
 		out_neurons[i]->lb = -fmax(0.0, -in_neurons[i]->lb);
 		out_neurons[i]->ub = fmax(0,in_neurons[i]->ub);
@@ -76,3 +79,192 @@ void handle_relu_layer(elina_manager_t *man, elina_abstract0_t* element, size_t
 	
 }
 
+
+/* rebuilds the relaxation and the bounds of neuron i of a ReLU layer from the current bounds of its input */
+void update_relu_neuron(fppoly_t *fp, layer_t *layer, size_t i){
+	neuron_t *out_neuron = layer->neurons[i];
+	neuron_t *in_neuron = fp->layers[layer->predecessors[0]-1]->neurons[i];
+	free_expr(out_neuron->lexpr);
+	free_expr(out_neuron->uexpr);
+	out_neuron->lb = -fmax(0.0, -in_neuron->lb);
+	out_neuron->ub = fmax(0,in_neuron->ub);
+	out_neuron->lexpr = create_relu_expr(out_neuron, in_neuron, i, layer->use_default_heuristics, true);
+	out_neuron->uexpr = create_relu_expr(out_neuron, in_neuron, i, layer->use_default_heuristics, false);
+}
+
+
+
+typedef struct relu_fusion_t{
+	fppoly_internal_t *pr;
+	layer_t *layer;
+	layer_t *affine;
+	char *is_active;
+	double *coeff_block;
+	size_t num_in_neurons;
+	size_t num_coeff;
+}relu_fusion_t;
+
+/* 0 if the activation of neuron i is exactly 0, 1 if it is exactly its input, -1 otherwise */
+static int stable_relu_phase(neuron_t *neuron, size_t i){
+	expr_t *lexpr = neuron->lexpr;
+	expr_t *uexpr = neuron->uexpr;
+	if(lexpr==NULL || uexpr==NULL || lexpr->size!=1 || uexpr->size!=1 || lexpr->type!=SPARSE || uexpr->type!=SPARSE){
+		return -1;
+	}
+	if(lexpr->dim[0]!=i || uexpr->dim[0]!=i || lexpr->inf_cst!=0 || lexpr->sup_cst!=0 || uexpr->inf_cst!=0 || uexpr->sup_cst!=0){
+		return -1;
+	}
+	if(lexpr->inf_coeff[0]==0 && lexpr->sup_coeff[0]==0 && uexpr->inf_coeff[0]==0 && uexpr->sup_coeff[0]==0){
+		return 0;
+	}
+	if(lexpr->inf_coeff[0]==-1 && lexpr->sup_coeff[0]==1 && uexpr->inf_coeff[0]==-1 && uexpr->sup_coeff[0]==1){
+		return 1;
+	}
+	return -1;
+}
+
+/* a layer whose expressions are dense over all neurons of its single predecessor, shared by both bounds */
+static bool is_dense_affine_layer(fppoly_t *fp, layer_t *layer){
+	size_t i;
+	if(layer->is_activation || layer->conv!=NULL || layer->expr_block==NULL || layer->num_predecessors!=1 || layer->is_concat || layer->h_t_inf!=NULL){
+		return false;
+	}
+	int k = layer->predecessors[0]-1;
+	size_t num_in_neurons = k < 0 ? fp->num_pixels : fp->layers[k]->dims;
+	for(i=0; i < layer->dims; i++){
+		expr_t *expr = layer->neurons[i]->lexpr;
+		if(expr==NULL || expr!=layer->neurons[i]->uexpr || expr->type!=DENSE || expr->size!=num_in_neurons){
+			return false;
+		}
+	}
+	return true;
+}
+
+/* rows [start, end) of the product of the layer's coefficients with those of the affine layer over the active inputs, rounded as gemm_affine_step */
+static void compose_with_affine_layer(void *args, size_t start, size_t end){
+	relu_fusion_t *data = (relu_fusion_t *)args;
+	fppoly_internal_t *pr = data->pr;
+	size_t num_coeff = data->num_coeff;
+	double *mag = (double *)malloc(num_coeff*sizeof(double));
+	size_t i, j, l;
+	for(i=start; i < end; i++){
+		expr_t *expr = data->layer->neurons[i]->lexpr;
+		double *inf_coeff = data->coeff_block + 2*i*num_coeff;
+		double *sup_coeff = inf_coeff + num_coeff;
+		double inf_cst = expr->inf_cst;
+		double sup_cst = expr->sup_cst;
+		size_t num_terms = 0;
+		memset(inf_coeff,0,2*num_coeff*sizeof(double));
+		memset(mag,0,num_coeff*sizeof(double));
+		for(j=0; j < data->num_in_neurons; j++){
+			double a_inf = expr->inf_coeff[j];
+			double a_sup = expr->sup_coeff[j];
+			if(!data->is_active[j] || (a_inf==0 && a_sup==0)){
+				continue;
+			}
+			expr_t *in_expr = data->affine->neurons[j]->lexpr;
+			double tmp1, tmp2, maxA, maxB;
+			num_terms++;
+			elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,a_inf,a_sup,in_expr->inf_cst,in_expr->sup_cst);
+			maxA = fmax(fabs(inf_cst),fabs(sup_cst));
+			maxB = fmax(fabs(tmp1),fabs(tmp2));
+			inf_cst = inf_cst + tmp1 + (maxA + maxB)*pr->ulp + pr->min_denormal;
+			sup_cst = sup_cst + tmp2 + (maxA + maxB)*pr->ulp + pr->min_denormal;
+			if(a_sup < 0 || a_inf < 0){
+				bool is_negative = a_sup < 0;
+				double x = is_negative ? a_inf : -a_inf;
+				double y = is_negative ? -a_sup : a_sup;
+				double *b_inf = is_negative ? in_expr->sup_coeff : in_expr->inf_coeff;
+				double *b_sup = is_negative ? in_expr->inf_coeff : in_expr->sup_coeff;
+				gemm_axpy(inf_coeff,sup_coeff,mag,x,y,fmax(x,y),b_inf,b_sup,num_coeff);
+			}
+			else{
+				/* a weight whose interval contains 0 */
+				for(l=0; l < num_coeff; l++){
+					elina_double_interval_mul_expr_coeff(pr,&tmp1,&tmp2,a_inf,a_sup,in_expr->inf_coeff[l],in_expr->sup_coeff[l]);
+					inf_coeff[l] += tmp1;
+					sup_coeff[l] += tmp2;
+					mag[l] += fmax(fabs(tmp1),fabs(tmp2));
+				}
+			}
+		}
+		double scale = (num_terms+1)*pr->ulp;
+		for(l=0; l < num_coeff; l++){
+			inf_coeff[l] += scale*mag[l];
+			sup_coeff[l] += scale*mag[l];
+		}
+		expr->inf_cst = inf_cst;
+		expr->sup_cst = sup_cst;
+	}
+	free(mag);
+}
+
+
+/*
+ * Called on a dense affine layer before its bounds are computed. If it reads
+ * from a ReLU layer, the inputs whose ReLU is stably inactive are dropped
+ * from its expressions, their weights being multiplied by an exact 0. If in
+ * addition every input it still reads is stably active, the ReLU is the
+ * identity on them and the layer is composed with the affine layer feeding
+ * the ReLU, so that back-substitution goes directly to that layer's
+ * predecessor. Chains of such layers compose into one affine map.
+ */
+void fuse_stable_relu_layer(fppoly_internal_t *pr, fppoly_t *fp, size_t layerno){
+	layer_t *layer = fp->layers[layerno];
+	size_t i, j;
+	if(layer->is_shared || !is_dense_affine_layer(fp,layer) || layer->predecessors[0]==0){
+		return;
+	}
+	layer_t *relu = fp->layers[layer->predecessors[0]-1];
+	size_t num_in_neurons = relu->dims;
+	if(!relu->is_activation || relu->num_predecessors!=1 || relu->is_concat || relu->h_t_inf!=NULL){
+		return;
+	}
+	char *is_active = (char *)malloc(num_in_neurons*sizeof(char));
+	bool can_compose = true;
+	for(j=0; j < num_in_neurons; j++){
+		int phase = stable_relu_phase(relu->neurons[j], j);
+		is_active[j] = phase==1;
+		if(phase==0){
+			for(i=0; i < layer->dims; i++){
+				layer->neurons[i]->lexpr->inf_coeff[j] = 0.0;
+				layer->neurons[i]->lexpr->sup_coeff[j] = 0.0;
+			}
+		}
+		else if(phase==-1){
+			for(i=0; i < layer->dims; i++){
+				expr_t *expr = layer->neurons[i]->lexpr;
+				if(expr->inf_coeff[j]!=0 || expr->sup_coeff[j]!=0){
+					can_compose = false;
+					break;
+				}
+			}
+		}
+	}
+	int k = relu->predecessors[0]-1;
+	if(!can_compose || k < 0 || !is_dense_affine_layer(fp,fp->layers[k]) || fp->layers[k]->dims!=num_in_neurons){
+		free(is_active);
+		return;
+	}
+	layer_t *affine = fp->layers[k];
+	relu_fusion_t args;
+	args.pr = pr;
+	args.layer = layer;
+	args.affine = affine;
+	args.is_active = is_active;
+	args.num_in_neurons = num_in_neurons;
+	args.num_coeff = affine->neurons[0]->lexpr->size;
+	args.coeff_block = (double *)malloc(2*layer->dims*args.num_coeff*sizeof(double));
+	thread_pool_run(pr->pool, layer->dims, 1, compose_with_affine_layer, (void *)&args);
+	free(layer->coeff_block);
+	layer->coeff_block = args.coeff_block;
+	for(i=0; i < layer->dims; i++){
+		expr_t *expr = layer->neurons[i]->lexpr;
+		expr->inf_coeff = layer->coeff_block + 2*i*args.num_coeff;
+		expr->sup_coeff = expr->inf_coeff + args.num_coeff;
+		expr->size = args.num_coeff;
+	}
+	layer->fused_predecessor = affine->predecessors[0];
+	layer->predecessors = &layer->fused_predecessor;
+	free(is_active);
+}
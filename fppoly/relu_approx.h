@@ -31,6 +31,10 @@ extern "C" {
 
 void handle_relu_layer(elina_manager_t *man, elina_abstract0_t* element, size_t num_neurons, size_t *predecessors, size_t num_predecessors, bool use_default_heuristics);
 
+void update_relu_neuron(fppoly_t *fp, layer_t *layer, size_t i);
+
+void fuse_stable_relu_layer(fppoly_internal_t *pr, fppoly_t *fp, size_t layerno);
+
 #ifdef __cplusplus
  }
 #endif
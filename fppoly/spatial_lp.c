@@ -0,0 +1,244 @@
+#include "spatial_lp.h"
+
+static lp_t * lp_alloc(size_t num_cols, size_t num_rows, size_t num_nonzeros){
+	lp_t *lp = (lp_t *)malloc(sizeof(lp_t));
+	lp->num_cols = num_cols;
+	lp->num_rows = 0;
+	lp->col_lb = (double *)malloc(num_cols*sizeof(double));
+	lp->col_ub = (double *)malloc(num_cols*sizeof(double));
+	lp->row_lb = (double *)malloc(num_rows*sizeof(double));
+	lp->row_ub = (double *)malloc(num_rows*sizeof(double));
+	lp->row_start = (size_t *)malloc((num_rows+1)*sizeof(size_t));
+	lp->col_index = (size_t *)malloc(num_nonzeros*sizeof(size_t));
+	lp->value = (double *)malloc(num_nonzeros*sizeof(double));
+	lp->row_start[0] = 0;
+	return lp;
+}
+
+static void lp_free(lp_t *lp){
+	free(lp->col_lb);
+	free(lp->col_ub);
+	free(lp->row_lb);
+	free(lp->row_ub);
+	free(lp->row_start);
+	free(lp->col_index);
+	free(lp->value);
+	free(lp);
+}
+
+/* appends the row lb <= sum value[i]*x[col[i]] <= ub; infinite sides are replaced by the range of the row over the column bounds */
+static void lp_add_row(lp_t *lp, size_t size, size_t *col, double *value, double lb, double ub){
+	size_t i;
+	size_t row = lp->num_rows;
+	size_t start = lp->row_start[row];
+	double neg_min = 0.0, max = 0.0;
+	for(i=0; i < size; i++){
+		double l = lp->col_lb[col[i]];
+		double u = lp->col_ub[col[i]];
+		lp->col_index[start+i] = col[i];
+		lp->value[start+i] = value[i];
+		neg_min += fmax(-value[i]*l, -value[i]*u);
+		max += fmax(value[i]*l, value[i]*u);
+	}
+	lp->row_lb[row] = isinf(lb) ? -neg_min : lb;
+	lp->row_ub[row] = isinf(ub) ? max : ub;
+	lp->row_start[row+1] = start + size;
+	lp->num_rows++;
+}
+
+
+const lp_backend_t * lp_backend_of_name(const char *name){
+	if(strcmp(name, lp_dual_simplex_backend.name)==0){
+		return &lp_dual_simplex_backend;
+	}
+#ifdef GUROBI
+	if(strcmp(name, lp_gurobi_backend.name)==0){
+		return &lp_gurobi_backend;
+	}
+#endif
+	return NULL;
+}
+
+
+/*
+ * Columns: the pixels, then for every pixel its own copy of the flow
+ * variables its lower and upper expressions range over. Rows: the lower and
+ * upper expression of every pixel, then |flow(idx) - flow(nbr)| <= gamma
+ * for every spatial constraint and every flow component.
+ */
+spatial_lp_t * spatial_lp_alloc(fppoly_t *fp, const lp_backend_t *backend){
+	size_t num_pixels = fp->num_pixels;
+	size_t i, j, k;
+	if(num_pixels==0 || fp->input_lexpr==NULL || fp->input_uexpr==NULL){
+		return NULL;
+	}
+	size_t num_flows = fp->input_uexpr[0]->size;
+	for(k=0; k < num_pixels; k++){
+		expr_t *lexpr = fp->input_lexpr[k];
+		expr_t *uexpr = fp->input_uexpr[k];
+		if(lexpr->size!=num_flows || uexpr->size!=num_flows || num_flows==0 || lexpr->type!=SPARSE || uexpr->type!=SPARSE){
+			return NULL;
+		}
+		for(j=0; j < num_flows; j++){
+			if(lexpr->dim[j]!=uexpr->dim[j] || uexpr->dim[j]>=num_pixels){
+				return NULL;
+			}
+		}
+	}
+	size_t num_cols = num_pixels*(num_flows+1);
+	size_t num_rows = 2*num_pixels + num_flows*fp->spatial_size;
+	lp_t *lp = lp_alloc(num_cols, num_rows, 2*num_pixels*(num_flows+1) + 2*num_flows*fp->spatial_size);
+	for(k=0; k < num_pixels; k++){
+		lp->col_lb[k] = -fp->input_inf[k];
+		lp->col_ub[k] = fp->input_sup[k];
+		for(j=0; j < num_flows; j++){
+			size_t l = fp->input_uexpr[k]->dim[j];
+			lp->col_lb[num_pixels + k*num_flows + j] = -fp->input_inf[l];
+			lp->col_ub[num_pixels + k*num_flows + j] = fp->input_sup[l];
+		}
+	}
+	for(i=0; i < num_cols; i++){
+		if(isinf(lp->col_lb[i]) || isinf(lp->col_ub[i]) || isnan(lp->col_lb[i]) || isnan(lp->col_ub[i])){
+			lp_free(lp);
+			return NULL;
+		}
+	}
+	size_t *col = (size_t *)malloc((num_flows+1)*sizeof(size_t));
+	double *value = (double *)malloc((num_flows+1)*sizeof(double));
+	for(k=0; k < num_pixels; k++){
+		expr_t *lexpr = fp->input_lexpr[k];
+		expr_t *uexpr = fp->input_uexpr[k];
+		col[0] = k;
+		value[0] = 1;
+		for(j=0; j < num_flows; j++){
+			col[j+1] = num_pixels + k*num_flows + j;
+		}
+		/* x >= lexpr(flow) */
+		for(j=0; j < num_flows; j++){
+			value[j+1] = lexpr->inf_coeff[j];
+		}
+		lp_add_row(lp, num_flows+1, col, value, -lexpr->inf_cst, INFINITY);
+		/* x <= uexpr(flow) */
+		for(j=0; j < num_flows; j++){
+			value[j+1] = -uexpr->sup_coeff[j];
+		}
+		lp_add_row(lp, num_flows+1, col, value, -INFINITY, uexpr->sup_cst);
+	}
+	for(i=0; i < fp->spatial_size; i++){
+		size_t idx = fp->spatial_indices[i];
+		size_t nbr = fp->spatial_neighbors[i];
+		if(idx==nbr || idx>=num_pixels || nbr>=num_pixels){
+			continue;
+		}
+		for(j=0; j < num_flows; j++){
+			col[0] = num_pixels + idx*num_flows + j;
+			col[1] = num_pixels + nbr*num_flows + j;
+			value[0] = 1;
+			value[1] = -1;
+			lp_add_row(lp, 2, col, value, -fp->spatial_gamma, fp->spatial_gamma);
+		}
+	}
+	free(col);
+	free(value);
+
+	spatial_lp_t *slp = (spatial_lp_t *)malloc(sizeof(spatial_lp_t));
+	slp->backend = backend;
+	slp->lp = lp;
+	pthread_mutex_init(&slp->mutex, NULL);
+	slp->max_solvers = 4;
+	slp->num_solvers = 0;
+	slp->solvers = (void **)malloc(slp->max_solvers*sizeof(void *));
+	return slp;
+}
+
+
+void spatial_lp_free(spatial_lp_t *slp){
+	size_t i;
+	if(slp==NULL){
+		return;
+	}
+	for(i=0; i < slp->num_solvers; i++){
+		slp->backend->free(slp->solvers[i]);
+	}
+	free(slp->solvers);
+	pthread_mutex_destroy(&slp->mutex);
+	lp_free(slp->lp);
+	free(slp);
+}
+
+
+/* solver instances are reused across queries so that each one warm starts from the basis of its last problem */
+static void * spatial_lp_acquire(spatial_lp_t *slp){
+	void *solver = NULL;
+	pthread_mutex_lock(&slp->mutex);
+	if(slp->num_solvers > 0){
+		solver = slp->solvers[--slp->num_solvers];
+	}
+	pthread_mutex_unlock(&slp->mutex);
+	if(solver==NULL){
+		solver = slp->backend->alloc(slp->lp);
+	}
+	return solver;
+}
+
+static void spatial_lp_release(spatial_lp_t *slp, void *solver){
+	pthread_mutex_lock(&slp->mutex);
+	if(slp->num_solvers==slp->max_solvers){
+		slp->max_solvers = 2*slp->max_solvers;
+		slp->solvers = (void **)realloc(slp->solvers, slp->max_solvers*sizeof(void *));
+	}
+	slp->solvers[slp->num_solvers++] = solver;
+	pthread_mutex_unlock(&slp->mutex);
+}
+
+
+double spatial_lp_bound(fppoly_internal_t *pr, spatial_lp_t *slp, expr_t *expr, bool is_lower){
+	lp_t *lp = slp->lp;
+	size_t num_cols = lp->num_cols;
+	size_t num_rows = lp->num_rows;
+	size_t i, j;
+	/* the objective c is an interval vector, kept as [-c_inf, c_sup]; an upper bound of c is minus a lower bound of -c */
+	double *c_inf = (double *)calloc(num_cols, sizeof(double));
+	double *c_sup = (double *)calloc(num_cols, sizeof(double));
+	double *obj = (double *)calloc(num_cols, sizeof(double));
+	double *y = (double *)malloc(num_rows*sizeof(double));
+	for(i=0; i < expr->size; i++){
+		size_t k = expr->type==DENSE ? i : expr->dim[i];
+		c_inf[k] = is_lower ? expr->inf_coeff[i] : expr->sup_coeff[i];
+		c_sup[k] = is_lower ? expr->sup_coeff[i] : expr->inf_coeff[i];
+		obj[k] = -c_inf[k];
+	}
+	void *solver = spatial_lp_acquire(slp);
+	slp->backend->solve(solver, lp, obj, y);
+	spatial_lp_release(slp, solver);
+
+	/*
+	 * Weak duality: for every y and x with row_lb <= A x <= row_ub,
+	 * c^T x = (c - A^T y)^T x + y^T (A x), so the minimum of the right hand
+	 * side over the column and row bounds is a lower bound, evaluated here
+	 * with outward rounding.
+	 */
+	double res = 0.0;
+	double tmp1, tmp2;
+	for(i=0; i < num_rows; i++){
+		if(y[i]==0 || !isfinite(y[i])){
+			continue;
+		}
+		for(j=lp->row_start[i]; j < lp->row_start[i+1]; j++){
+			size_t k = lp->col_index[j];
+			c_inf[k] += lp->value[j]*y[i];
+			c_sup[k] += -lp->value[j]*y[i];
+		}
+		elina_double_interval_mul(&tmp1,&tmp2,-y[i],y[i],-lp->row_lb[i],lp->row_ub[i]);
+		res = res + tmp1;
+	}
+	for(j=0; j < num_cols; j++){
+		elina_double_interval_mul(&tmp1,&tmp2,c_inf[j],c_sup[j],-lp->col_lb[j],lp->col_ub[j]);
+		res = res + tmp1;
+	}
+	free(c_inf);
+	free(c_sup);
+	free(obj);
+	free(y);
+	return res;
+}
@@ -0,0 +1,106 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+
+#ifndef __SPATIAL_LP_H_INCLUDED__
+#define __SPATIAL_LP_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fppoly.h"
+#include "expr.h"
+
+/*
+ * min obj^T x subject to row_lb <= A x <= row_ub and col_lb <= x <= col_ub,
+ * A stored by rows. All bounds are finite.
+ */
+typedef struct lp_t{
+	size_t num_cols;
+	size_t num_rows;
+	double *col_lb;
+	double *col_ub;
+	double *row_lb;
+	double *row_ub;
+	size_t *row_start;
+	size_t *col_index;
+	double *value;
+}lp_t;
+
+/*
+ * An LP solver. alloc prepares an instance for the rows and bounds of lp,
+ * solve minimizes obj over it and writes one multiplier per row to y, and
+ * is called again on the same instance with other objectives, so solvers
+ * are expected to warm start from the previous basis. The multipliers need
+ * not be exact: bounds are derived from them by weak duality. solve returns
+ * false if it did not reach an optimum.
+ */
+typedef struct lp_backend_t{
+	const char *name;
+	void * (*alloc)(lp_t *lp);
+	bool (*solve)(void *solver, lp_t *lp, const double *obj, double *y);
+	void (*free)(void *solver);
+}lp_backend_t;
+
+/* the built-in bounded dual simplex */
+extern const lp_backend_t lp_dual_simplex_backend;
+
+#ifdef GUROBI
+extern const lp_backend_t lp_gurobi_backend;
+#endif
+
+/* the backend called name, NULL if it is not compiled in */
+const lp_backend_t * lp_backend_of_name(const char *name);
+
+/*
+ * The LP over the input pixels, the flow variables each pixel is bounded
+ * by and the spatial constraints between neighboring flows, with a stack of
+ * solver instances shared by the threads of the analysis.
+ */
+typedef struct spatial_lp_t{
+	const lp_backend_t *backend;
+	lp_t *lp;
+	pthread_mutex_t mutex;
+	void **solvers;
+	size_t num_solvers;
+	size_t max_solvers;
+}spatial_lp_t;
+
+/* NULL if the input constraints do not have the expected shape or are unbounded */
+spatial_lp_t * spatial_lp_alloc(fppoly_t *fp, const lp_backend_t *backend);
+
+void spatial_lp_free(spatial_lp_t *slp);
+
+/*
+ * Bounds the non-constant part of expr, an expression over the input, under
+ * the input and spatial constraints: the negated lower bound if is_lower,
+ * else the upper bound. The bound is sound whatever the quality of the LP
+ * solution, it is only tight if the solver converged.
+ */
+double spatial_lp_bound(fppoly_internal_t *pr, spatial_lp_t *slp, expr_t *expr, bool is_lower);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
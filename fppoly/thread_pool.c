@@ -0,0 +1,145 @@
+#include <fenv.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+
+static void thread_pool_work(thread_pool_t *pool){
+	size_t start;
+	while((start = __sync_fetch_and_add(&pool->next, pool->chunk)) < pool->size){
+		size_t end = start + pool->chunk;
+		if(end > pool->size){
+			end = pool->size;
+		}
+		pool->fn(pool->args, start, end);
+		if(pool->once){
+			break;
+		}
+	}
+}
+
+
+static void * thread_pool_worker(void *args){
+	thread_pool_t *pool = (thread_pool_t *)args;
+	size_t generation = 0;
+	pthread_mutex_lock(&pool->mutex);
+	while(true){
+		while(!pool->stop && pool->generation==generation){
+			pthread_cond_wait(&pool->work_cond, &pool->mutex);
+		}
+		if(pool->stop){
+			break;
+		}
+		generation = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+		/* bounds are only sound under the rounding mode of the caller */
+		fesetround(pool->round);
+		thread_pool_work(pool);
+		pthread_mutex_lock(&pool->mutex);
+		pool->num_active--;
+		if(pool->num_active==0){
+			pthread_cond_signal(&pool->done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+
+thread_pool_t * thread_pool_alloc(size_t num_threads){
+	thread_pool_t *pool = (thread_pool_t *)malloc(sizeof(thread_pool_t));
+	size_t i;
+	if(num_threads==0){
+		long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = nprocs > 0 ? (size_t)nprocs : 1;
+	}
+	pool->num_threads = num_threads;
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->work_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+	pool->generation = 0;
+	pool->num_active = 0;
+	pool->busy = false;
+	pool->stop = false;
+	pool->fn = NULL;
+	pool->args = NULL;
+	pool->size = 0;
+	pool->chunk = 1;
+	pool->next = 0;
+	pool->once = false;
+	pool->round = fegetround();
+	pool->threads = (pthread_t *)malloc((num_threads-1)*sizeof(pthread_t));
+	for(i=0; i < num_threads-1; i++){
+		pthread_create(&pool->threads[i], NULL, thread_pool_worker, (void *)pool);
+	}
+	return pool;
+}
+
+
+void thread_pool_free(thread_pool_t *pool){
+	size_t i;
+	if(pool==NULL){
+		return;
+	}
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = true;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->mutex);
+	for(i=0; i < pool->num_threads-1; i++){
+		pthread_join(pool->threads[i], NULL);
+	}
+	free(pool->threads);
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_cond_destroy(&pool->work_cond);
+	pthread_cond_destroy(&pool->done_cond);
+	free(pool);
+}
+
+
+static void thread_pool_start(thread_pool_t *pool, size_t size, size_t chunk, bool once, thread_pool_fn_t fn, void *args){
+	size_t start;
+	pthread_mutex_lock(&pool->mutex);
+	if(pool->busy || pool->num_threads==1 || size <= chunk){
+		pthread_mutex_unlock(&pool->mutex);
+		for(start=0; start < size; start+=chunk){
+			fn(args, start, start + chunk < size ? start + chunk : size);
+		}
+		return;
+	}
+	pool->busy = true;
+	pool->fn = fn;
+	pool->args = args;
+	pool->size = size;
+	pool->chunk = chunk;
+	pool->next = 0;
+	pool->once = once;
+	pool->round = fegetround();
+	pool->num_active = pool->num_threads-1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	thread_pool_work(pool);
+
+	pthread_mutex_lock(&pool->mutex);
+	while(pool->num_active > 0){
+		pthread_cond_wait(&pool->done_cond, &pool->mutex);
+	}
+	pool->busy = false;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+
+void thread_pool_run(thread_pool_t *pool, size_t size, size_t chunk, thread_pool_fn_t fn, void *args){
+	if(chunk==0){
+		chunk = 1;
+	}
+	thread_pool_start(pool, size, chunk, false, fn, args);
+}
+
+
+void thread_pool_run_partitioned(thread_pool_t *pool, size_t size, thread_pool_fn_t fn, void *args){
+	/* each of the num_threads threads runs thread_pool_work once per job, so with once set every one takes a partition */
+	size_t chunk = (size + pool->num_threads - 1)/pool->num_threads;
+	thread_pool_start(pool, size, chunk > 0 ? chunk : 1, true, fn, args);
+}
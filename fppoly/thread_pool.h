@@ -0,0 +1,87 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+#ifndef __THREAD_POOL_H_INCLUDED__
+#define __THREAD_POOL_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/* processes the items [start,end) of a job */
+typedef void (*thread_pool_fn_t)(void *args, size_t start, size_t end);
+
+/*
+ * Worker threads owned by the fppoly manager. A job over n items is handed
+ * out in chunks taken from a shared counter, so threads that get cheap items
+ * come back for more instead of idling at the join.
+ */
+typedef struct thread_pool_t{
+	size_t num_threads;
+	pthread_t *threads;
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+	size_t generation;
+	size_t num_active;
+	bool busy;
+	bool stop;
+	/* current job */
+	thread_pool_fn_t fn;
+	void *args;
+	size_t size;
+	size_t chunk;
+	size_t next;
+	/* every thread takes at most one chunk */
+	bool once;
+	int round;
+}thread_pool_t;
+
+/* num_threads counts the calling thread; 0 means one per online processor */
+thread_pool_t * thread_pool_alloc(size_t num_threads);
+
+void thread_pool_free(thread_pool_t *pool);
+
+/*
+ * Runs fn over [0,size) in chunks of chunk items and returns once all are
+ * done. The calling thread takes part. Calls made while the pool is busy,
+ * e.g. from inside a job, run sequentially in the caller.
+ */
+void thread_pool_run(thread_pool_t *pool, size_t size, size_t chunk, thread_pool_fn_t fn, void *args);
+
+/*
+ * Runs fn over [0,size) split into one contiguous partition per thread. Used
+ * to first-touch large arrays: on a NUMA machine the pages of each partition
+ * are then placed on the node of the thread that wrote them, instead of all
+ * on the node of the caller.
+ */
+void thread_pool_run_partitioned(thread_pool_t *pool, size_t size, thread_pool_fn_t fn, void *args);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
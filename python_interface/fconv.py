@@ -34,6 +34,15 @@ class MatDouble_c(Structure):
     ]
 
 
+class MatDoubleBatch_c(Structure):
+    _fields_ = [
+        ('num_mats', c_int),
+        ('cols', c_int),
+        ('row_offsets', POINTER(c_int)),
+        ('data', POINTER(c_double))
+    ]
+
+
 class MatInt_c(Structure):
     _fields_ = [
         ('rows', c_int),
@@ -58,6 +67,10 @@ free_MatDouble_c = fconv_api.free_MatDouble
 free_MatDouble_c.argtype = MatDouble_c
 free_MatDouble_c.restype = None
 
+free_MatDoubleBatch_c = fconv_api.free_MatDoubleBatch
+free_MatDoubleBatch_c.argtype = MatDoubleBatch_c
+free_MatDoubleBatch_c.restype = None
+
 free_MatInt_c = fconv_api.free_MatInt
 free_MatInt_c.argtype = MatInt_c
 free_MatInt_c.restype = None
@@ -83,6 +96,19 @@ for relaxation_c in [fkrelu_c, krelu_with_cdd_c,
     relaxation_c.argtype = [MatDouble_c]
     relaxation_c.restype = MatDouble_c
 
+fkrelu_batch_c = fconv_api.fkrelu_batch
+fkpool_batch_c = fconv_api.fkpool_batch
+fktanh_batch_c = fconv_api.fktanh_batch
+fksigm_batch_c = fconv_api.fksigm_batch
+
+for relaxation_batch_c in [fkrelu_batch_c, fkpool_batch_c, fktanh_batch_c, fksigm_batch_c]:
+    relaxation_batch_c.argtypes = [MatDoubleBatch_c, c_int]
+    relaxation_batch_c.restype = MatDoubleBatch_c
+
+with_cdd_fallback_stats_c = fconv_api.with_cdd_fallback_stats
+with_cdd_fallback_stats_c.argtypes = [POINTER(c_int), POINTER(c_int)]
+with_cdd_fallback_stats_c.restype = None
+
 generate_sparse_cover_c = fconv_api.generate_sparse_cover
 generate_sparse_cover_c.argtype = [c_int, c_int]
 generate_sparse_cover_c.restype = MatInt_c
@@ -148,6 +174,49 @@ def _compute_relaxation(inp_hrep: np.ndarray, activation: str, version: str) ->
     return out
 
 
+def _compute_relaxation_batch(inp_hreps, activation: str, num_threads: int) -> list:
+    """
+    Same as _compute_relaxation with version "fast" for a list of octahedra
+    with the same k, which are relaxed in parallel on num_threads threads
+    (all hardware threads if num_threads <= 0).
+    """
+    assert activation in ["relu", "pool", "tanh", "sigm"]
+    num_mats = len(inp_hreps)
+    if num_mats == 0:
+        return []
+
+    cols = inp_hreps[0].shape[1]
+    assert cols >= 2
+    assert all(inp_hrep.shape[1] == cols for inp_hrep in inp_hreps)
+    row_offsets = np.cumsum([0] + [inp_hrep.shape[0] for inp_hrep in inp_hreps])
+    data = np.concatenate([inp_hrep.flatten() for inp_hrep in inp_hreps]).tolist()
+    row_offsets_c = (c_int * (num_mats + 1))(*row_offsets.tolist())
+    data_c = (c_double * len(data))(*data)
+    inp_batch = MatDoubleBatch_c(num_mats, cols, row_offsets_c, data_c)
+
+    if activation == "relu":
+        out_batch = fkrelu_batch_c(inp_batch, num_threads)
+    elif activation == "pool":
+        out_batch = fkpool_batch_c(inp_batch, num_threads)
+    elif activation == "tanh":
+        out_batch = fktanh_batch_c(inp_batch, num_threads)
+    else:
+        out_batch = fksigm_batch_c(inp_batch, num_threads)
+
+    out_cols = out_batch.cols
+    total = out_batch.row_offsets[num_mats] * out_cols
+    out_data = np.ctypeslib.as_array(out_batch.data, shape=(total,)).copy()
+    outs = []
+    for i in range(num_mats):
+        start = out_batch.row_offsets[i]
+        end = out_batch.row_offsets[i + 1]
+        outs.append(out_data[start * out_cols:end * out_cols].reshape(end - start, out_cols))
+
+    free_MatDoubleBatch_c(out_batch)
+
+    return outs
+
+
 def ftanh_orthant(inp_hrep: np.ndarray) -> np.ndarray:
     return _compute_relaxation(inp_hrep, "tanh", "orthant")
 
@@ -188,6 +257,29 @@ def ksigm_with_cdd(inp_hrep: np.ndarray) -> np.ndarray:
     return _compute_relaxation(inp_hrep, "sigm", "cdd")
 
 
+def fkrelu_batch(inp_hreps, num_threads=0) -> list:
+    return _compute_relaxation_batch(inp_hreps, "relu", num_threads)
+
+
+def fkpool_batch(inp_hreps, num_threads=0) -> list:
+    return _compute_relaxation_batch(inp_hreps, "pool", num_threads)
+
+
+def fktanh_batch(inp_hreps, num_threads=0) -> list:
+    return _compute_relaxation_batch(inp_hreps, "tanh", num_threads)
+
+
+def fksigm_batch(inp_hreps, num_threads=0) -> list:
+    return _compute_relaxation_batch(inp_hreps, "sigm", num_threads)
+
+
+def with_cdd_fallback_stats():
+    num_calls = c_int(0)
+    num_fallbacks = c_int(0)
+    with_cdd_fallback_stats_c(byref(num_calls), byref(num_fallbacks))
+    return num_calls.value, num_fallbacks.value
+
+
 def generate_sparse_cover(n, k):
     cover_c = generate_sparse_cover_c(n, k)
     rows = cover_c.rows
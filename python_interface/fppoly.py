@@ -55,6 +55,144 @@ def fppoly_manager_alloc():
 
     return man
 
+def fppoly_set_num_threads(man, num_threads):
+    """
+    Sets the number of threads used by the manager for back-substitution.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    num_threads : c_size_t
+        Number of threads including the calling one, 0 uses one per online processor.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_set_num_threads_c = fppoly_api.fppoly_set_num_threads
+        fppoly_set_num_threads_c.restype = None
+        fppoly_set_num_threads_c.argtypes = [ElinaManagerPtr, c_size_t]
+        fppoly_set_num_threads_c(man, num_threads)
+    except:
+        print('Problem with loading/calling "fppoly_set_num_threads" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, c_size_t to the function')
+
+def fppoly_set_lp_solver(man, name):
+    """
+    Sets the LP solver used to bound expressions over spatially constrained inputs.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    name : str
+        "simplex" for the built-in dual simplex, "gurobi" if libfppoly was built with USE_GUROBI.
+
+    Returns
+    -------
+    res : c_bool
+        False if the solver is not available.
+
+    """
+
+    res = False
+    try:
+        fppoly_set_lp_solver_c = fppoly_api.fppoly_set_lp_solver
+        fppoly_set_lp_solver_c.restype = c_bool
+        fppoly_set_lp_solver_c.argtypes = [ElinaManagerPtr, c_char_p]
+        res = fppoly_set_lp_solver_c(man, name.encode('utf-8'))
+    except:
+        print('Problem with loading/calling "fppoly_set_lp_solver" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, str to the function')
+    return res
+
+def fppoly_set_backsubstitution_budget(man, early_stop, max_depth):
+    """
+    Limits back-substitution: with early_stop, neuron bounds are only refined until they exclude 0 and output comparisons until they are proven; max_depth bounds the number of layers walked through, 0 for no limit.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    early_stop : c_bool
+        Whether to stop once the bounds are conclusive.
+    max_depth : c_size_t
+        Maximum number of layers per back-substitution, 0 for no limit.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_set_backsubstitution_budget_c = fppoly_api.fppoly_set_backsubstitution_budget
+        fppoly_set_backsubstitution_budget_c.restype = None
+        fppoly_set_backsubstitution_budget_c.argtypes = [ElinaManagerPtr, c_bool, c_size_t]
+        fppoly_set_backsubstitution_budget_c(man, early_stop, max_depth)
+    except:
+        print('Problem with loading/calling "fppoly_set_backsubstitution_budget" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, c_bool, c_size_t to the function')
+
+def fppoly_get_backsubstitution_steps_saved(man, element):
+    """
+    Number of layer substitutions skipped so far by early termination and the depth budget.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the abstract element.
+
+    Returns
+    -------
+    res : c_size_t
+        Number of skipped substitutions of one expression through one layer.
+
+    """
+
+    res = 0
+    try:
+        fppoly_get_backsubstitution_steps_saved_c = fppoly_api.fppoly_get_backsubstitution_steps_saved
+        fppoly_get_backsubstitution_steps_saved_c.restype = c_size_t
+        fppoly_get_backsubstitution_steps_saved_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr]
+        res = fppoly_get_backsubstitution_steps_saved_c(man, element)
+    except:
+        print('Problem with loading/calling "fppoly_get_backsubstitution_steps_saved" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, ElinaAbstract0Ptr to the function')
+    return res
+
+def fppoly_set_stable_relu_fusion(man, enable):
+    """
+    Lets fully connected layers drop inputs whose ReLU is stably inactive and compose through ReLU layers that are stably active on all remaining inputs.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    enable : c_bool
+        Whether to fuse stable ReLU layers.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_set_stable_relu_fusion_c = fppoly_api.fppoly_set_stable_relu_fusion
+        fppoly_set_stable_relu_fusion_c.restype = None
+        fppoly_set_stable_relu_fusion_c.argtypes = [ElinaManagerPtr, c_bool]
+        fppoly_set_stable_relu_fusion_c(man, enable)
+    except:
+        print('Problem with loading/calling "fppoly_set_stable_relu_fusion" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, c_bool to the function')
+
 def fppoly_from_network_input(man, intdim, realdim, inf_array, sup_array):
     """
     Create an abstract element from perturbed input
@@ -1018,6 +1156,36 @@ def update_bounds_for_neuron(man, element,layerno, neuron_no, lb, ub):
         print('Make sure you are passing ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t, c_size_t, c_double, c_double to the function')
 
 
+def fppoly_reanalyze(man, element):
+    """
+    Recomputes the ReLU relaxations and neuron bounds that depend on neurons changed by update_bounds_for_neuron
+    or update_activation_*_bound_for_neuron since the last call.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the abstract element.
+
+    Returns
+    -------
+    res : c_size_t
+        Number of recomputed neurons.
+
+    """
+
+    res = 0
+    try:
+        fppoly_reanalyze_c = fppoly_api.fppoly_reanalyze
+        fppoly_reanalyze_c.restype = c_size_t
+        fppoly_reanalyze_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr]
+        res = fppoly_reanalyze_c(man, element)
+    except:
+        print('Problem with loading/calling "fppoly_reanalyze" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, ElinaAbstract0Ptr to the function')
+    return res
+
 
 def get_upper_bound_for_linexpr0(man,element,linexpr0, size, layerno):
     """
@@ -1359,3 +1527,223 @@ def update_activation_lower_bound_for_neuron(man, element,layerno, neuron_no, co
         print(inst)
         print('Problem with loading/calling "update_activation_lower_bound_for_neuron" from "fppoly.so"')
         print('Make sure you are passing ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t, c_size_t, POINTER(c_double), POINTER(c_size_t), c_size_t to the function')
+
+
+# ====================================================================== #
+# Compiled networks
+# ====================================================================== #
+
+class FppolyNetwork(Structure):
+    """ opaque network compiled once and shared by batched analyses """
+    pass
+
+FppolyNetworkPtr = POINTER(FppolyNetwork)
+
+
+def fppoly_network_alloc(num_inputs):
+    """
+    Create an empty network over num_inputs inputs.
+
+    Parameters
+    ----------
+    num_inputs : c_size_t
+        Number of inputs of the network.
+
+    Returns
+    -------
+    net : FppolyNetworkPtr
+        Pointer to the new network.
+
+    """
+
+    net = None
+    try:
+        fppoly_network_alloc_c = fppoly_api.fppoly_network_alloc
+        fppoly_network_alloc_c.restype = FppolyNetworkPtr
+        fppoly_network_alloc_c.argtypes = [c_size_t]
+        net = fppoly_network_alloc_c(num_inputs)
+    except:
+        print('Problem with loading/calling "fppoly_network_alloc" from "libfppoly.so"')
+        print('Make sure you are passing c_size_t to the function')
+    return net
+
+
+def fppoly_network_free(net):
+    """
+    Free a network.
+
+    Parameters
+    ----------
+    net : FppolyNetworkPtr
+        Pointer to the network.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_free_c = fppoly_api.fppoly_network_free
+        fppoly_network_free_c.restype = None
+        fppoly_network_free_c.argtypes = [FppolyNetworkPtr]
+        fppoly_network_free_c(net)
+    except:
+        print('Problem with loading/calling "fppoly_network_free" from "libfppoly.so"')
+        print('Make sure you are passing FppolyNetworkPtr to the function')
+
+
+def fppoly_network_add_fully_connected_layer(net, weights, bias, num_out_neurons, num_in_neurons):
+    """
+    Append a fully connected layer reading the previous layer, the weights are copied.
+
+    Parameters
+    ----------
+    net : FppolyNetworkPtr
+        Pointer to the network.
+    weights : POINTER(POINTER(c_double))
+        The weight matrix.
+    bias : POINTER(c_double)
+        The bias vector.
+    num_out_neurons : c_size_t
+        Number of neurons of the layer.
+    num_in_neurons : c_size_t
+        Number of neurons of the previous layer.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_add_fully_connected_layer_c = fppoly_api.fppoly_network_add_fully_connected_layer
+        fppoly_network_add_fully_connected_layer_c.restype = None
+        fppoly_network_add_fully_connected_layer_c.argtypes = [FppolyNetworkPtr, _doublepp, ndpointer(ctypes.c_double), c_size_t, c_size_t]
+        fppoly_network_add_fully_connected_layer_c(net, weights, bias, num_out_neurons, num_in_neurons)
+    except:
+        print('Problem with loading/calling "fppoly_network_add_fully_connected_layer" from "libfppoly.so"')
+        print('Make sure you are passing FppolyNetworkPtr, _doublepp, ndpointer(ctypes.c_double), c_size_t, c_size_t to the function')
+
+
+def fppoly_network_add_convolutional_layer(net, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, output_size, pad_top, pad_left, has_bias):
+    """
+    Append a convolutional layer reading the previous layer, the filter is copied.
+
+    Parameters
+    ----------
+    net : FppolyNetworkPtr
+        Pointer to the network.
+    filter_weights : POINTER(double)
+        filter weights
+    filter_bias : POINTER(double)
+        filter biases
+    input_size : POINTER(c_size_t)
+        size of the input
+    filter_size : POINTER(c_size_t)
+        size of the filters
+    num_filters : c_size_t
+        number of filters
+    strides : POINTER(c_size_t)
+        size of the strides
+    output_size : POINTER(c_size_t)
+        size of the output
+    pad_top : c_size_t
+        padding at the top
+    pad_left : c_size_t
+        padding on the left
+    has_bias : c_bool
+        if the filter has bias
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_add_convolutional_layer_c = fppoly_api.fppoly_network_add_convolutional_layer
+        fppoly_network_add_convolutional_layer_c.restype = None
+        fppoly_network_add_convolutional_layer_c.argtypes = [FppolyNetworkPtr, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_size_t), POINTER(c_size_t), c_size_t, POINTER(c_size_t), POINTER(c_size_t), c_size_t, c_size_t, c_bool]
+        fppoly_network_add_convolutional_layer_c(net, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, output_size, pad_top, pad_left, has_bias)
+    except:
+        print('Problem with loading/calling "fppoly_network_add_convolutional_layer" from "libfppoly.so"')
+        print('Make sure you are passing FppolyNetworkPtr, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_size_t), POINTER(c_size_t), c_size_t, POINTER(c_size_t), POINTER(c_size_t), c_size_t, c_size_t, c_bool to the function')
+
+
+def fppoly_network_add_relu_layer(net, use_default_heuristics):
+    """
+    Append a ReLU layer over the previous layer.
+
+    Parameters
+    ----------
+    net : FppolyNetworkPtr
+        Pointer to the network.
+    use_default_heuristics : c_bool
+        whether to use the area heuristic for the lower relaxation
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_add_relu_layer_c = fppoly_api.fppoly_network_add_relu_layer
+        fppoly_network_add_relu_layer_c.restype = None
+        fppoly_network_add_relu_layer_c.argtypes = [FppolyNetworkPtr, c_bool]
+        fppoly_network_add_relu_layer_c(net, use_default_heuristics)
+    except:
+        print('Problem with loading/calling "fppoly_network_add_relu_layer" from "libfppoly.so"')
+        print('Make sure you are passing FppolyNetworkPtr, c_bool to the function')
+
+
+def fppoly_network_analyze_batch(man, net, inf, sup, labels=None):
+    """
+    Analyze many input boxes against a compiled network in one call.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    net : FppolyNetworkPtr
+        Pointer to the network.
+    inf : numpy.ndarray
+        Lower bounds of the inputs, one row per region.
+    sup : numpy.ndarray
+        Upper bounds of the inputs, one row per region.
+    labels : numpy.ndarray
+        Optional label of every region, negative for none.
+
+    Returns
+    -------
+    lb, ub, verified : numpy.ndarray
+        Output bounds, one row per region, and whether each label is proven to be the largest output.
+
+    """
+
+    inf = np.ascontiguousarray(inf, dtype=np.double)
+    sup = np.ascontiguousarray(sup, dtype=np.double)
+    num_regions = inf.shape[0]
+    lb = ub = verified = None
+    try:
+        fppoly_network_get_num_outputs_c = fppoly_api.fppoly_network_get_num_outputs
+        fppoly_network_get_num_outputs_c.restype = c_size_t
+        fppoly_network_get_num_outputs_c.argtypes = [FppolyNetworkPtr]
+        num_outputs = fppoly_network_get_num_outputs_c(net)
+        lb = np.zeros((num_regions, num_outputs), dtype=np.double)
+        ub = np.zeros((num_regions, num_outputs), dtype=np.double)
+        verified = np.zeros(num_regions, dtype=np.bool_)
+        if labels is not None:
+            labels = np.ascontiguousarray(labels, dtype=np.intc)
+        fppoly_network_analyze_batch_c = fppoly_api.fppoly_network_analyze_batch
+        fppoly_network_analyze_batch_c.restype = None
+        fppoly_network_analyze_batch_c.argtypes = [ElinaManagerPtr, FppolyNetworkPtr, c_size_t, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double),
+                                                   ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), c_void_p, c_void_p]
+        fppoly_network_analyze_batch_c(man, net, num_regions, inf, sup, lb, ub,
+                                       None if labels is None else labels.ctypes.data_as(c_void_p),
+                                       None if labels is None else verified.ctypes.data_as(c_void_p))
+    except:
+        print('Problem with loading/calling "fppoly_network_analyze_batch" from "libfppoly.so"')
+        print('Make sure you are passing ElinaManagerPtr, FppolyNetworkPtr, numpy.ndarray, numpy.ndarray, numpy.ndarray to the function')
+    return lb, ub, verified
@@ -56,6 +56,63 @@ def zonoml_manager_alloc():
     return man
 
 
+def elina_manager_zonotope_set_max_nsym(man, max_nsym):
+    """
+    Bounds the number of noise symbols of the outputs of the ReLU layers and of the joins by an order reduction.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    max_nsym : c_size_t
+        Maximal number of noise symbols, 0 for no bound.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        elina_manager_zonotope_set_max_nsym_c = zonoml_api.elina_manager_zonotope_set_max_nsym
+        elina_manager_zonotope_set_max_nsym_c.restype = None
+        elina_manager_zonotope_set_max_nsym_c.argtypes = [ElinaManagerPtr, c_size_t]
+        elina_manager_zonotope_set_max_nsym_c(man, max_nsym)
+    except:
+        print('Problem with loading/calling "elina_manager_zonotope_set_max_nsym" from "libzonoml.so"')
+
+
+def elina_manager_zonotope_compact_nsym(man):
+    """
+    Frees the noise symbols that no zonotope of the manager uses any more and renumbers the other ones.
+    This also happens when an abstract element is freed. Only the affine forms of live elements
+    are looked at: do not keep affine forms or noise symbols outside a live element, and do not
+    use the noise symbol indices of get_affine_form_for_dim after freeing an element.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    res : c_size_t
+        Number of noise symbols freed.
+
+    """
+
+    res = None
+    try:
+        elina_manager_zonotope_compact_nsym_c = zonoml_api.elina_manager_zonotope_compact_nsym
+        elina_manager_zonotope_compact_nsym_c.restype = c_size_t
+        elina_manager_zonotope_compact_nsym_c.argtypes = [ElinaManagerPtr]
+        res = elina_manager_zonotope_compact_nsym_c(man)
+    except:
+        print('Problem with loading/calling "elina_manager_zonotope_compact_nsym" from "libzonoml.so"')
+
+    return res
+
+
 def zonotope_from_network_input(man, intdim, realdim, inf_array, sup_array):
     """
     Create the perturbed zonotope from input
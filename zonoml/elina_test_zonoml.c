@@ -19,6 +19,7 @@
  */
 
 #include <time.h>
+#include <gmp.h>
 #include "zonoml.h"
 #include "zonoml_internal.h"
 #include "zonoml_fun.h"
@@ -163,19 +164,209 @@ void test_zonoml(size_t dim, size_t nbcons){
 }
 
 
+/* random coefficient in [-1,1], scaled down at times to mix small and large terms */
+double random_coeff(void){
+	double v = 2.0*rand()/RAND_MAX - 1.0;
+	return rand()%4 ? v : v*1e-3;
+}
+
+/* adds lambda*[-x, y] exactly to the interval [-e_inf, e_sup] */
+void exact_add_mul(mpq_t e_inf, mpq_t e_sup, double lambda, double x, double y, mpq_t tmp){
+	mpq_t mu;
+	mpq_init(mu);
+	mpq_set_d(mu,fabs(lambda));
+	mpq_set_d(tmp,lambda > 0 ? x : y);
+	mpq_mul(tmp,tmp,mu);
+	mpq_add(e_inf,e_inf,tmp);
+	mpq_set_d(tmp,lambda > 0 ? y : x);
+	mpq_mul(tmp,tmp,mu);
+	mpq_add(e_sup,e_sup,tmp);
+	mpq_clear(mu);
+}
+
+/* true if the bound d is at least the exact bound e */
+bool is_upper_bound(double d, mpq_t e, mpq_t tmp){
+	mpq_set_d(tmp,d);
+	return mpq_cmp(tmp,e) >= 0;
+}
+
+/*
+ * Computes num_dst weighted sums of num_src sparse forms over num_nsym noise symbols with
+ * zonotope_aff_array_gemm and with successive calls to zonotope_aff_array_add_mul_weight, which
+ * must give the same center and coefficients. The center, the coefficients and the interval of
+ * both are also checked to contain the ones of the exact sum of the forms. Returns the number of failures.
+ */
+int test_aff_array_gemm(size_t num_src, size_t num_dst, uint_t num_nsym){
+	elina_manager_t * man = zonoml_manager_alloc();
+	zonotope_internal_t * pr = (zonotope_internal_t *)man->internal;
+	int round = fegetround();
+	size_t i, o;
+	uint_t k, size, support_size;
+	int fail = 0;
+	fesetround(FE_UPWARD);
+	for(k = 0; k < num_nsym; k++){
+		zonotope_noise_symbol_add(pr,IN);
+	}
+
+	//random sparse forms of every noise symbol, half, an eighth or none of them
+	zonotope_aff_array_t ** src = (zonotope_aff_array_t **)malloc(num_src*sizeof(zonotope_aff_array_t *));
+	uint_t * index = (uint_t *)malloc((num_nsym+1)*sizeof(uint_t));
+	for(i = 0; i < num_src; i++){
+		int density = i%4 == 0 ? 1 : i%4 == 1 ? 2 : i%4 == 2 ? 8 : 0;
+		double sum = 0, c = random_coeff();
+		size = 0;
+		for(k = 0; k < num_nsym; k++){
+			if(density && rand()%density == 0){
+				index[size++] = k;
+			}
+		}
+		src[i] = zonotope_aff_array_alloc_sparse();
+		zonotope_aff_array_set_support(src[i],index,size);
+		for(k = 0; k < size; k++){
+			double v = random_coeff();
+			src[i]->inf[k] = -v + (rand()%2 ? 1e-9 : 0);
+			src[i]->sup[k] = v;
+			sum = sum + fmax(fabs(src[i]->inf[k]),fabs(src[i]->sup[k]));
+		}
+		src[i]->begin = 0;
+		src[i]->end = size;
+		src[i]->c_inf = -c;
+		src[i]->c_sup = c;
+		src[i]->itv_inf = -c + sum;
+		src[i]->itv_sup = c + sum;
+	}
+	free(index);
+
+	double ** weights = (double **)malloc(num_dst*sizeof(double *));
+	for(o = 0; o < num_dst; o++){
+		weights[o] = (double *)malloc(num_src*sizeof(double));
+		for(i = 0; i < num_src; i++){
+			weights[o][i] = rand()%8 ? random_coeff() : 0;
+		}
+	}
+
+	uint_t * support = zonotope_aff_array_support(src,num_src,&support_size);
+	zonotope_aff_array_t ** ref = (zonotope_aff_array_t **)malloc(num_dst*sizeof(zonotope_aff_array_t *));
+	zonotope_aff_array_t ** res = (zonotope_aff_array_t **)malloc(num_dst*sizeof(zonotope_aff_array_t *));
+	double * center = (double *)malloc(num_dst*sizeof(double));
+	for(o = 0; o < num_dst; o++){
+		double c = center[o] = random_coeff();
+		ref[o] = zonotope_aff_array_alloc_dense(pr);
+		res[o] = zonotope_aff_array_alloc_sparse();
+		zonotope_aff_array_set_support(res[o],support,support_size);
+		ref[o]->c_inf = res[o]->c_inf = ref[o]->itv_inf = res[o]->itv_inf = -c;
+		ref[o]->c_sup = res[o]->c_sup = ref[o]->itv_sup = res[o]->itv_sup = c;
+		for(i = 0; i < num_src; i++){
+			zonotope_aff_array_add_mul_weight(pr,ref[o],src[i],weights[o][i]);
+		}
+	}
+	zonotope_aff_array_gemm(pr,res,num_dst,src,num_src,weights);
+
+	mpq_t * e_inf = (mpq_t *)malloc((num_nsym+1)*sizeof(mpq_t));
+	mpq_t * e_sup = (mpq_t *)malloc((num_nsym+1)*sizeof(mpq_t));
+	mpq_t ec_inf, ec_sup, range, bound, tmp;
+	mpq_inits(ec_inf,ec_sup,range,bound,tmp,NULL);
+	for(k = 0; k < num_nsym; k++){
+		mpq_init(e_inf[k]);
+		mpq_init(e_sup[k]);
+	}
+	for(o = 0; o < num_dst; o++){
+		bool same = (res[o]->c_inf == ref[o]->c_inf) && (res[o]->c_sup == ref[o]->c_sup);
+		for(k = 0; k < support_size; k++){
+			same = same && (res[o]->inf[k] == ref[o]->inf[support[k]]) && (res[o]->sup[k] == ref[o]->sup[support[k]]);
+		}
+		if(!same){
+			printf("form %lu: gemm and add_mul_weight differ\n",o);
+			fail++;
+		}
+
+		//exact sum
+		mpq_set_d(ec_inf,-center[o]);
+		mpq_set_d(ec_sup,center[o]);
+		for(k = 0; k < num_nsym; k++){
+			mpq_set_ui(e_inf[k],0,1);
+			mpq_set_ui(e_sup[k],0,1);
+		}
+		for(i = 0; i < num_src; i++){
+			double lambda = weights[o][i];
+			if(lambda == 0) continue;
+			exact_add_mul(ec_inf,ec_sup,lambda,src[i]->c_inf,src[i]->c_sup,tmp);
+			for(k = 0; k < src[i]->size; k++){
+				exact_add_mul(e_inf[src[i]->index[k]],e_sup[src[i]->index[k]],lambda,src[i]->inf[k],src[i]->sup[k],tmp);
+			}
+		}
+		//the form takes the values of its center plus or minus the largest absolute bounds of its coefficients
+		mpq_set_ui(range,0,1);
+		for(k = 0; k < num_nsym; k++){
+			mpq_abs(tmp,e_inf[k]);
+			mpq_abs(bound,e_sup[k]);
+			mpq_add(range,range,mpq_cmp(tmp,bound) > 0 ? tmp : bound);
+		}
+
+		zonotope_aff_array_t * a[2] = {ref[o], res[o]};
+		const char * name[2] = {"add_mul_weight", "gemm"};
+		int j;
+		for(j = 0; j < 2; j++){
+			bool sound = is_upper_bound(a[j]->c_inf,ec_inf,tmp) && is_upper_bound(a[j]->c_sup,ec_sup,tmp);
+			for(k = 0; k < a[j]->size; k++){
+				uint_t nsym = a[j]->index ? a[j]->index[k] : k;
+				sound = sound && is_upper_bound(a[j]->inf[k],e_inf[nsym],tmp) && is_upper_bound(a[j]->sup[k],e_sup[nsym],tmp);
+			}
+			mpq_add(bound,ec_inf,range);
+			sound = sound && is_upper_bound(a[j]->itv_inf,bound,tmp);
+			mpq_add(bound,ec_sup,range);
+			sound = sound && is_upper_bound(a[j]->itv_sup,bound,tmp);
+			if(!sound){
+				printf("form %lu: %s does not contain the exact sum\n",o,name[j]);
+				fail++;
+			}
+		}
+	}
+	printf("%lu sums of %lu forms over %u noise symbols: %s\n",num_dst,num_src,num_nsym,fail ? "failed" : "passed");
+
+	for(k = 0; k < num_nsym; k++){
+		mpq_clear(e_inf[k]);
+		mpq_clear(e_sup[k]);
+	}
+	mpq_clears(ec_inf,ec_sup,range,bound,tmp,NULL);
+	free(e_inf);
+	free(e_sup);
+	for(o = 0; o < num_dst; o++){
+		zonotope_aff_array_free(ref[o]);
+		zonotope_aff_array_free(res[o]);
+		free(weights[o]);
+	}
+	for(i = 0; i < num_src; i++){
+		zonotope_aff_array_free(src[i]);
+	}
+	free(ref);
+	free(res);
+	free(weights);
+	free(center);
+	free(src);
+	free(support);
+	fesetround(round);
+	elina_manager_free(man);
+	return fail;
+}
+
+
 
 
 int main(int argc, char **argv){
+	printf("Testing zonotope_aff_array_gemm\n");
+	int fail = test_aff_array_gemm(50,11,300) + test_aff_array_gemm(5,3,7) + test_aff_array_gemm(1,1,1);
 	if(argc < 3){
 		printf("The test requires two positive integers: (a) Number of variables and (b) Number of constraints");
-		return 0;
+		return fail != 0;
 	}
 	size_t dim = atoi(argv[1]);
 	size_t nbcons = atoi(argv[2]);
 	if(dim <=0 || nbcons <=0){
 		printf("The Input parameters should be positive\n");
-		return 0;
+		return fail != 0;
 	}
 	printf("Testing zonoml\n");
 	test_zonoml(dim,nbcons);
+	return fail != 0;
 }
@@ -171,73 +171,31 @@ zonotope_aff_t* zonotope_aff_mul_weight(zonotope_internal_t* pr, zonotope_aff_t*
     }
 }
 
-zonotope_aff_t * zonotope_aff_from_dense_weights(zonotope_internal_t * pr, double * weights, size_t offset, size_t size, zonotope_t *z){
-    zonotope_aff_t *res = zonotope_aff_alloc_init(pr);
-    size_t i;	
-    
-    for(i=0; i < size; i++){
-	zonotope_aff_t *tmp;
-	zonotope_aff_t *aff = z->paf[offset+i];
-	//printf("%.30f\n", weights[i]);
-	//zonotope_aff_fprint(pr,stdout,aff);
-        //printf("%.30f\n",aff->itv_sup);
-	//printf("\n");
-	tmp = zonotope_aff_mul_weight(pr,aff,weights[i]);
-	//printf("after mul : %.15f %.15f\n", -tmp->itv_inf ,tmp->itv_sup);
-	//zonotope_aff_fprint(pr,stdout,tmp);
-	//printf("\n");
-	//fflush(stdout);
-	zonotope_aff_t *tmp1 = res;
-	res = zonotope_aff_add(pr,tmp1,tmp,z);
-	//printf("after add: %.15f %.15f\n", -res->itv_inf,res->itv_sup);
-	//zonotope_aff_fprint(pr,stdout,tmp);
-	//printf("\n");
-	//fflush(stdout);	
-        zonotope_aff_free(pr,tmp);
-        zonotope_aff_free(pr,tmp1);
-		
-    }
-    //printf("\n");
-    return res;
-}
-
-zonotope_aff_t * zonotope_aff_from_dense_weights_bias(zonotope_internal_t* pr, double * weights, double bias, size_t offset, size_t size, zonotope_t *z){
-    zonotope_aff_t * res = zonotope_aff_from_dense_weights(pr, weights, offset, size, z);
-    res->c_inf += -bias;
-    res->c_sup += bias;
-    res->itv_inf += -bias;
-    res->itv_sup += bias;	
-    return res;
-}
-
-
-zonotope_aff_t * zonotope_aff_from_sparse_weights_bias(zonotope_internal_t* pr, double * weights, double bias, elina_dim_t *dim, size_t size, zonotope_t *z){
-    zonotope_aff_t *res = zonotope_aff_alloc_init(pr);
-    res->c_inf = -bias;
-    res->c_sup = bias;
-    res->itv_inf = -bias;
-    res->itv_sup = bias;
-    size_t i;
-	
-    for(i=0; i < size; i++){
-	
-	zonotope_aff_t *tmp;
-        elina_dim_t var = dim[i];
-	
-	zonotope_aff_t *aff = z->paf[var];
-	
-	tmp = zonotope_aff_mul_weight(pr,aff,weights[i]);
-	zonotope_aff_t *tmp1 = res;
-	res = zonotope_aff_add(pr,tmp1,tmp,z);	
-        zonotope_aff_free(pr,tmp);
-        zonotope_aff_free(pr,tmp1);
-		
-    }
-   
-    return res;
+/* number of output neurons of a thread whose affine forms are computed by one matrix product */
+#define ZONOML_MATMULT_CHUNK 64
+
+/* stores the affine form of an array form at dimension dim of z and resets the array form */
+static void zonotope_set_aff_from_array(zonotope_internal_t *pr, zonotope_t *z, size_t dim, zonotope_aff_array_t *a, bool has_bias, double bias){
+	z->paf[dim] = zonotope_aff_from_array(pr, a, z);
+	if(has_bias){
+		z->paf[dim]->c_inf += -bias;
+		z->paf[dim]->c_sup += bias;
+		z->paf[dim]->itv_inf += -bias;
+		z->paf[dim]->itv_sup += bias;
+	}
+	if (zonotope_aff_is_top(pr, z->paf[dim])) {
+	     zonotope_aff_check_free(pr, z->paf[dim]);
+	     z->paf[dim] = pr->top;
+	} 
+	else if (zonotope_aff_is_bottom(pr, z->paf[dim])) {
+	     zonotope_aff_check_free(pr, z->paf[dim]);
+	     z->paf[dim] = pr->bot;
+	}
+	z->box_inf[dim] = z->paf[dim]->itv_inf;
+	z->box_sup[dim] = z->paf[dim]->itv_sup;
+	z->paf[dim]->pby++;
 }
 
-
 void * handle_ffn_matmult_zono_parallel(void *args){
 	zonoml_ffn_matmult_thread_t * data = (zonoml_ffn_matmult_thread_t *)args;
 	zonotope_internal_t * pr = data->pr;
@@ -248,29 +206,30 @@ void * handle_ffn_matmult_zono_parallel(void *args){
 	double **weights = data->weights;
 	double *bias = data->bias;
 	bool has_bias = data->has_bias;
-	size_t expr_offset = data->expr_offset;
 	size_t expr_size = data->expr_size;
-
-	size_t offset = start_offset + idx_start;
-	size_t i;
-	for (i=idx_start; i< idx_end; i++) {
-		zonotope_aff_check_free(pr, z->paf[offset]);
-	
-		z->paf[offset] = has_bias ? zonotope_aff_from_dense_weights_bias(pr, weights[i], bias[i], expr_offset, expr_size, z) : 
-					    zonotope_aff_from_dense_weights(pr, weights[i], expr_offset, expr_size, z);
-		if (zonotope_aff_is_top(pr, z->paf[offset])) {
-	    	     zonotope_aff_check_free(pr, z->paf[offset]);
-	    	     z->paf[offset] = pr->top;
-		} 
-		else if (zonotope_aff_is_bottom(pr, z->paf[offset])) {
-	    	     zonotope_aff_check_free(pr, z->paf[offset]);
-	    	     z->paf[offset] = pr->bot;
+	zonotope_aff_array_t **inputs = data->inputs;
+	zonotope_aff_array_t *res[ZONOML_MATMULT_CHUNK];
+	uint_t support_size;
+	size_t i, j, num;
+
+	/* the outputs store the coefficients of all the noise symbols of the inputs */
+	uint_t *support = zonotope_aff_array_support(inputs, expr_size, &support_size);
+	for (j=0; j < ZONOML_MATMULT_CHUNK; j++) {
+		res[j] = zonotope_aff_array_alloc_sparse();
+		zonotope_aff_array_set_support(res[j], support, support_size);
+	}
+	free(support);
+	for (i=idx_start; i< idx_end; i+=num) {
+		num = idx_end - i < ZONOML_MATMULT_CHUNK ? idx_end - i : ZONOML_MATMULT_CHUNK;
+		zonotope_aff_array_gemm(pr, res, num, inputs, expr_size, weights + i);
+		for (j=0; j < num; j++) {
+			zonotope_aff_check_free(pr, z->paf[start_offset+i+j]);
+			zonotope_set_aff_from_array(pr, z, start_offset+i+j, res[j], has_bias, has_bias ? bias[i+j] : 0.0);
 		}
-		z->box_inf[offset] = z->paf[offset]->itv_inf;
-		z->box_sup[offset] = z->paf[offset]->itv_sup;
-		z->paf[offset]->pby++;
-		offset++;
     	}
+	for (j=0; j < ZONOML_MATMULT_CHUNK; j++) {
+		zonotope_aff_array_free(res[j]);
+	}
 	return NULL; 
 }
 
@@ -413,7 +372,7 @@ void * handle_conv_matmult_zono_parallel(void *args){
 	double *filter_weights = data->filter_weights;
 	double *filter_bias = data->filter_bias;
 
-	size_t expr_offset = data->expr_offset;
+	zonotope_aff_array_t **inputs = data->inputs;
 	size_t *input_size = data->input_size;
 	size_t *filter_size = data->filter_size;
 	size_t num_filters = data->num_filters;
@@ -423,22 +382,34 @@ void * handle_conv_matmult_zono_parallel(void *args){
 	long int pad_left = data->pad_left;  
 	bool has_bias = data->has_bias;
 	
-	size_t out_x, out_y, out_z, inp_z;
+	size_t inp_z;
 	long int x_shift, y_shift;
      
         size_t num_pixels = input_size[0]*input_size[1]*input_size[2];
+	size_t num_coeff = input_size[2]*filter_size[0]*filter_size[1];
 	
-	size_t mat_x;
+	/* the outputs at the same position have the same inputs, their affine forms are computed by one matrix product */
+	zonotope_aff_array_t **patch = (zonotope_aff_array_t **)malloc(num_coeff*sizeof(zonotope_aff_array_t *));
+	double *coeff = (double *)malloc(output_size[2]*num_coeff*sizeof(double));
+	double **coeff_rows = (double **)malloc(output_size[2]*sizeof(double *));
+	zonotope_aff_array_t **res = (zonotope_aff_array_t **)malloc(output_size[2]*sizeof(zonotope_aff_array_t *));
+	size_t r;
+	for (r=0; r < output_size[2]; r++) {
+		coeff_rows[r] = coeff + r*num_coeff;
+		res[r] = zonotope_aff_array_alloc_sparse();
+	}
+
+	size_t mat_x = idx_start;
 	size_t o12 = output_size[1]*output_size[2];
-	for (mat_x=idx_start; mat_x< idx_end; mat_x++) {
+	while (mat_x < idx_end) {
 	     size_t out_x = mat_x/o12;
 	     size_t out_y = (mat_x - out_x*o12) / output_size[2];
 	     size_t out_z =  mat_x -out_x*o12 - out_y*output_size[2];
-	     size_t num_coeff = input_size[2]*filter_size[0]*filter_size[1];
+	     size_t num_out = output_size[2] - out_z;
+	     if (num_out > idx_end - mat_x) {
+		 num_out = idx_end - mat_x;
+	     }
 	     size_t actual_coeff = 0;
-	     double *coeff = (double *)malloc(num_coeff*sizeof(double));
-	     elina_dim_t *dim = (elina_dim_t *)malloc(num_coeff*sizeof(elina_dim_t));
-	     size_t i=0;
 	     for(inp_z=0; inp_z <input_size[2]; inp_z++) {
 		  for(x_shift = 0; x_shift < (long int)filter_size[0]; x_shift++) {
 		      for(y_shift =0; y_shift < (long int)filter_size[1]; y_shift++) {
@@ -454,37 +425,44 @@ void * handle_conv_matmult_zono_parallel(void *args){
 				     
 			  size_t mat_offset = x_val*input_size[1]*input_size[2] + y_val*input_size[2] + inp_z;
 				     
-			  size_t mat_y = expr_offset + mat_offset;
 		          size_t filter_index = x_shift*filter_size[1]*input_size[2]*output_size[2] + y_shift*input_size[2]*output_size[2] + inp_z*output_size[2] + out_z;	
 			  if(mat_offset>=num_pixels){		 
 			     continue;
 		          }    
-			  coeff[i] = filter_weights[filter_index];
-			  dim[i] = mat_y;
-			  i++;
+			  patch[actual_coeff] = inputs[mat_offset];
+			  for (r=0; r < num_out; r++) {
+			     coeff_rows[r][actual_coeff] = filter_weights[filter_index + r];
+			  }
 			  actual_coeff++;
 		      }
 		   }
 	     }
 			
-	     double cst = has_bias ? filter_bias[out_z] : 0.0;
-	     z->paf[start_offset+mat_x] = zonotope_aff_from_sparse_weights_bias(pr, coeff, cst, dim, actual_coeff, z);
-			
-             if (zonotope_aff_is_top(pr, z->paf[start_offset+mat_x])) {
-	    	 zonotope_aff_check_free(pr, z->paf[start_offset+mat_x]);
-	    	 z->paf[start_offset+mat_x] = pr->top;
-	     } 
-             else if (zonotope_aff_is_bottom(pr, z->paf[start_offset+mat_x])) {
-	    	 zonotope_aff_check_free(pr, z->paf[start_offset+mat_x]);
-	    	 z->paf[start_offset+mat_x] = pr->bot;
+	     uint_t support_size;
+	     uint_t *support = zonotope_aff_array_support(patch, actual_coeff, &support_size);
+	     for (r=0; r < num_out; r++) {
+		 double cst = has_bias ? filter_bias[out_z+r] : 0.0;
+		 zonotope_aff_array_set_support(res[r], support, support_size);
+		 res[r]->c_inf = -cst;
+		 res[r]->c_sup = cst;
+		 res[r]->itv_inf = -cst;
+		 res[r]->itv_sup = cst;
 	     }
-	     z->box_inf[start_offset+mat_x] = z->paf[start_offset+mat_x]->itv_inf;
-	     z->box_sup[start_offset+mat_x] = z->paf[start_offset+mat_x]->itv_sup;
-	     z->paf[start_offset+mat_x]->pby++;
-	     free(coeff);
-	     free(dim);
-		
+	     free(support);
+	     zonotope_aff_array_gemm(pr, res, num_out, patch, actual_coeff, coeff_rows);
+	     for (r=0; r < num_out; r++) {
+		 zonotope_set_aff_from_array(pr, z, start_offset+mat_x+r, res[r], false, 0.0);
+	     }
+	     mat_x += num_out;
     	}
+
+	for (r=0; r < output_size[2]; r++) {
+		zonotope_aff_array_free(res[r]);
+	}
+	free(res);
+	free(coeff_rows);
+	free(coeff);
+	free(patch);
 	return NULL; 
 }
 
@@ -32,12 +32,8 @@ extern "C" {
 #endif
 
 
-zonotope_aff_t * zonotope_aff_from_dense_weights_bias(zonotope_internal_t* pr, double * weights, double bias, size_t offset, size_t size, zonotope_t *z);
-
 zonotope_aff_t* zonotope_aff_mul_weight(zonotope_internal_t* pr, zonotope_aff_t* src, double lambda);
 
-zonotope_aff_t * zonotope_aff_from_sparse_weights_bias(zonotope_internal_t* pr, double * weights, double bias, elina_dim_t *dim, size_t size, zonotope_t *z);
-
 #ifdef __cplusplus
 }
 #endif
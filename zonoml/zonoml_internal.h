@@ -30,6 +30,7 @@
 #include <errno.h>
 #include "zonotope.h"
 #include "zonoml.h"
+#include "zonotope_aff_array.h"
 #include "rdtsc.h"
 
 #include <pthread.h>
@@ -75,6 +76,7 @@ typedef struct zonoml_ffn_matmult_thread_t{
 	size_t expr_offset;
 	size_t expr_size;
 	bool has_bias;	
+	zonotope_aff_array_t ** inputs;
 }zonoml_ffn_matmult_thread_t;
 
 
@@ -117,6 +119,7 @@ typedef struct zonoml_conv_matmult_thread_t{
 	long int pad_left;
 	size_t *output_size;
 	bool has_bias;	
+	zonotope_aff_array_t ** inputs;
 }zonoml_conv_matmult_thread_t;
 
 
@@ -182,6 +185,13 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 		num_threads = 1;
 	}
 	
+	/* sparse forms of the inputs, shared by all the threads */
+	zonotope_aff_array_t ** inputs = (zonotope_aff_array_t **)malloc(expr_size*sizeof(zonotope_aff_array_t *));
+	size_t j;
+	for(j=0; j < expr_size; j++){
+		inputs[j] = zonotope_aff_array_from_aff(pr, z->paf[expr_offset+j]);
+	}
+	
 	zonoml_ffn_matmult_thread_t args[num_threads];
 	pthread_t threads[num_threads];
 	int i;
@@ -199,6 +209,7 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 			args[i].expr_offset = expr_offset;
 			args[i].expr_size = expr_size;   
 			args[i].has_bias = has_bias;			
+			args[i].inputs = inputs;
 	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			
 	  	}
@@ -223,6 +234,7 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 			args[i].expr_offset = expr_offset;
 			args[i].expr_size = expr_size;   
 			args[i].has_bias = has_bias;
+			args[i].inputs = inputs;
 	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
@@ -239,7 +251,10 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 			pthread_join(threads[i], NULL);
 		}
 	}
-	
+	for(j=0; j < expr_size; j++){
+		zonotope_aff_array_free(inputs[j]);
+	}
+	free(inputs);
 }
 
 static inline void relu_zono_parallel(elina_manager_t* man, zonotope_t *z, elina_dim_t start_offset, elina_dim_t num_out_neurons, bool create_new_noise_symbol, void *(*function)(void *)){
@@ -446,6 +461,14 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 		num_threads = 1;
 	}
 	
+	/* sparse forms of the inputs, shared by all the threads */
+	size_t num_pixels = input_size[0]*input_size[1]*input_size[2];
+	zonotope_aff_array_t ** inputs = (zonotope_aff_array_t **)malloc(num_pixels*sizeof(zonotope_aff_array_t *));
+	size_t j;
+	for(j=0; j < num_pixels; j++){
+		inputs[j] = zonotope_aff_array_from_aff(pr, z->paf[expr_offset+j]);
+	}
+	
 	zonoml_conv_matmult_thread_t args[num_threads];
 	pthread_t threads[num_threads];
 	int i;
@@ -469,6 +492,7 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 			args[i].pad_top = pad_top;
 			args[i].pad_left = pad_left;   
 			args[i].has_bias = has_bias;			
+			args[i].inputs = inputs;
 	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			
 	  	}
@@ -499,6 +523,7 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 			args[i].pad_top = pad_top;
 			args[i].pad_left = pad_left;   
 			args[i].has_bias = has_bias;
+			args[i].inputs = inputs;
 	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
@@ -515,7 +540,10 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 			pthread_join(threads[i], NULL);
 		}
 	}
-	
+	for(j=0; j < num_pixels; j++){
+		zonotope_aff_array_free(inputs[j]);
+	}
+	free(inputs);
 }
 
 
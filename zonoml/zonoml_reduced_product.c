@@ -588,6 +588,8 @@ elina_abstract0_t * relu_zono_layerwise(elina_manager_t* man, bool destructive,
 	//}
         zonotope_t *zo = zonotope_of_abstract0(res);
         relu_zono_parallel(man, zo, start_offset, num_dim, create_new_noise_symbol, handle_relu_zono_parallel);
+        zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+        if (pr->max_nsym) zonotope_noise_symbol_reduce(pr, zo, start_offset, num_dim, pr->max_nsym);
         res = abstract0_of_zonotope(man,zo);
        
     return res;